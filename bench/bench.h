@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace devops {
+namespace bench {
+
+struct BenchOptions {
+  // Scales corpus sizes and iteration counts; 1.0 is the default workload.
+  double scale = 1.0;
+  std::string workDir;
+};
+
+// Every benchmark is a function registered in bench_main.cpp.
+int runReadBenchmark(const BenchOptions &options);
+int runEnvBenchmark(const BenchOptions &options);
+int runTomlBenchmark(const BenchOptions &options);
+int runJsonBenchmark(const BenchOptions &options);
+int runYamlBenchmark(const BenchOptions &options);
+int runKubernetesBenchmark(const BenchOptions &options);
+int runReportBenchmark(const BenchOptions &options);
+int runWalkBenchmark(const BenchOptions &options);
+int runDetectBenchmark(const BenchOptions &options);
+int runMicroBenchmark(const BenchOptions &options);
+int runCorpusBenchmark(const BenchOptions &options);
+
+// Heap counters from AllocationCounter, which main() switches on.
+uint64_t allocationCount();
+uint64_t allocatedBytes();
+
+// Peak resident set size in KiB. resetPeakRss() lowers the high-water mark
+// to the current RSS where the OS supports it (Linux), so successive cases
+// can be compared; elsewhere peaks are cumulative.
+long peakRssKb();
+void resetPeakRss();
+
+class Stopwatch {
+public:
+  Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+  double elapsedMs() const {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start_)
+        .count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Writes `count` files of `size` bytes of config-like text into `dir` and
+// returns their paths.
+std::vector<std::string> writeSampleFiles(const std::string &dir,
+                                          const std::string &prefix,
+                                          size_t size, size_t count);
+
+void printHeader(const std::string &title);
+
+// Sends stdout and stderr to /dev/null while alive, so benchmarks of code
+// that prints measure the formatting and not a terminal. POSIX only;
+// elsewhere active() is false and output is left alone.
+class OutputSilencer {
+public:
+  OutputSilencer();
+  ~OutputSilencer();
+  OutputSilencer(const OutputSilencer &) = delete;
+  OutputSilencer &operator=(const OutputSilencer &) = delete;
+
+  bool active() const { return savedOut_ >= 0; }
+
+private:
+  int savedOut_ = -1;
+  int savedErr_ = -1;
+};
+
+} // namespace bench
+} // namespace devops
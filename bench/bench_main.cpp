@@ -0,0 +1,274 @@
+#include "allocation_counter.h"
+#include "bench.h"
+#include "corpus_generator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Benchmark {
+  const char *name;
+  const char *description;
+  int (*run)(const devops::bench::BenchOptions &);
+};
+
+const Benchmark BENCHMARKS[] = {
+    {"read", "File loading: stringstream vs Utils::readFile vs MappedFile",
+     devops::bench::runReadBenchmark},
+    {"env", "ENV validation: single-pass lexer vs std::regex baseline",
+     devops::bench::runEnvBenchmark},
+    {"toml", "TOML validation: TomlParser vs nlohmann JSON on equal input",
+     devops::bench::runTomlBenchmark},
+    {"json", "JSON validation: JsonScanner (per SIMD level) vs nlohmann DOM",
+     devops::bench::runJsonBenchmark},
+    {"yaml", "YAML validation: event stream vs YAML::Load/LoadAll trees",
+     devops::bench::runYamlBenchmark},
+    {"kubernetes", "Kubernetes manifests: bundled schema index, manifests/s",
+     devops::bench::runKubernetesBenchmark},
+    {"report", "Result output: per-line std::endl vs buffered report sink",
+     devops::bench::runReportBenchmark},
+    {"walk", "Directory walk: recursive_directory_iterator vs DirectoryWalker",
+     devops::bench::runWalkBenchmark},
+    {"detect", "File type detection: extension if-chain vs perfect hash",
+     devops::bench::runDetectBenchmark},
+    {"micro", "Hot paths on a generated corpus: latency percentiles, allocs/op",
+     devops::bench::runMicroBenchmark},
+    {"corpus", "validateDirectory end to end on a generated corpus, files/s",
+     devops::bench::runCorpusBenchmark},
+};
+
+void printUsage(const char *programName) {
+  std::cout << "Usage: " << programName
+            << " [--scale X] [--work-dir DIR] [benchmark...]\n"
+            << "       " << programName
+            << " --generate DIR [--files N] [--file-size BYTES] [--seed S]"
+               " [--invalid FRACTION]\n\n"
+            << "--generate writes the synthetic corpus the micro and corpus\n"
+            << "benchmarks use, for profiling or timing the tool itself.\n"
+            << "\nBenchmarks:\n";
+  for (const auto &benchmark : BENCHMARKS) {
+    std::cout << "  " << benchmark.name << "  " << benchmark.description
+              << "\n";
+  }
+}
+
+// Writes a corpus for use outside the benchmarks and prints what it holds.
+int generate(const std::string &dir, const devops::CorpusOptions &options) {
+  using namespace devops;
+  const Corpus corpus = generateCorpus(dir, options);
+  size_t counts[CORPUS_KIND_COUNT] = {};
+  uint64_t bytes[CORPUS_KIND_COUNT] = {};
+  for (const CorpusFile &file : corpus.files) {
+    counts[static_cast<size_t>(file.kind)]++;
+    bytes[static_cast<size_t>(file.kind)] += file.bytes;
+  }
+  std::printf("Generated %zu files (%zu invalid), %.1f KiB in %s\n",
+              corpus.files.size(), corpus.invalid,
+              static_cast<double>(corpus.bytes) / 1024.0, dir.c_str());
+  for (size_t k = 0; k < CORPUS_KIND_COUNT; k++) {
+    std::printf("  %-14s %8zu files %10.1f KiB\n",
+                corpusKindName(static_cast<CorpusKind>(k)), counts[k],
+                static_cast<double>(bytes[k]) / 1024.0);
+  }
+  return 0;
+}
+
+} // namespace
+
+namespace devops {
+namespace bench {
+
+uint64_t allocationCount() { return AllocationCounter::count(); }
+uint64_t allocatedBytes() { return AllocationCounter::bytes(); }
+
+long peakRssKb() {
+#ifdef __linux__
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      return std::strtol(line.c_str() + 6, nullptr, 10);
+    }
+  }
+#endif
+#ifndef _WIN32
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return 0;
+#endif
+}
+
+void resetPeakRss() {
+#ifdef __linux__
+  // Writing 5 to clear_refs resets VmHWM to the current RSS.
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  clearRefs << "5";
+#endif
+}
+
+std::vector<std::string> writeSampleFiles(const std::string &dir,
+                                          const std::string &prefix,
+                                          size_t size, size_t count) {
+  static const std::string record =
+      "  {\"name\": \"service\", \"image\": \"registry.local/app:1.4.2\", "
+      "\"replicas\": 3, \"ports\": [8080, 8443]},\n";
+
+  std::string content = "[\n";
+  while (content.size() + record.size() + 2 < size) {
+    content += record;
+  }
+  content += "  {}\n]";
+
+  std::vector<std::string> paths;
+  fs::create_directories(dir);
+  for (size_t i = 0; i < count; i++) {
+    std::string path =
+        (fs::path(dir) / (prefix + std::to_string(i) + ".json")).string();
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+    paths.push_back(path);
+  }
+  return paths;
+}
+
+void printHeader(const std::string &title) {
+  std::cout << "\n=== " << title << " ===\n";
+}
+
+OutputSilencer::OutputSilencer() {
+#ifndef _WIN32
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(stdout);
+  std::fflush(stderr);
+  const int devNull = open("/dev/null", O_WRONLY);
+  if (devNull < 0) {
+    return;
+  }
+  savedOut_ = dup(STDOUT_FILENO);
+  savedErr_ = dup(STDERR_FILENO);
+  if (savedOut_ < 0 || savedErr_ < 0) {
+    if (savedOut_ >= 0) {
+      close(savedOut_);
+    }
+    if (savedErr_ >= 0) {
+      close(savedErr_);
+    }
+    savedOut_ = savedErr_ = -1;
+  } else {
+    dup2(devNull, STDOUT_FILENO);
+    dup2(devNull, STDERR_FILENO);
+  }
+  close(devNull);
+#endif
+}
+
+OutputSilencer::~OutputSilencer() {
+#ifndef _WIN32
+  if (!active()) {
+    return;
+  }
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(stdout);
+  std::fflush(stderr);
+  dup2(savedOut_, STDOUT_FILENO);
+  dup2(savedErr_, STDERR_FILENO);
+  close(savedOut_);
+  close(savedErr_);
+#endif
+}
+
+} // namespace bench
+} // namespace devops
+
+int main(int argc, char *argv[]) {
+  devops::AllocationCounter::enable(true);
+  devops::bench::BenchOptions options;
+  devops::CorpusOptions corpusOptions;
+  std::string generateDir;
+  std::vector<std::string> selected;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      printUsage(argv[0]);
+      return 0;
+    } else if (arg == "--scale" && i + 1 < argc) {
+      options.scale = std::atof(argv[++i]);
+    } else if (arg == "--work-dir" && i + 1 < argc) {
+      options.workDir = argv[++i];
+    } else if (arg == "--generate" && i + 1 < argc) {
+      generateDir = argv[++i];
+    } else if (arg == "--files" && i + 1 < argc) {
+      corpusOptions.files = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--file-size" && i + 1 < argc) {
+      corpusOptions.averageBytes = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--seed" && i + 1 < argc) {
+      corpusOptions.seed = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--invalid" && i + 1 < argc) {
+      corpusOptions.invalidFraction = std::atof(argv[++i]);
+    } else {
+      selected.push_back(arg);
+    }
+  }
+
+  if (!generateDir.empty()) {
+    try {
+      return generate(generateDir, corpusOptions);
+    } catch (const std::exception &e) {
+      std::cerr << "Error: " << e.what() << "\n";
+      return 1;
+    }
+  }
+
+  bool removeWorkDir = false;
+  if (options.workDir.empty()) {
+    options.workDir =
+        (fs::temp_directory_path() / "devops-validator-bench").string();
+    removeWorkDir = true;
+  }
+
+  int status = 0;
+  bool ranAny = false;
+  for (const auto &benchmark : BENCHMARKS) {
+    bool wanted = selected.empty();
+    for (const auto &name : selected) {
+      wanted = wanted || name == benchmark.name;
+    }
+    if (wanted) {
+      ranAny = true;
+      status |= benchmark.run(options);
+    }
+  }
+
+  if (removeWorkDir) {
+    std::error_code ec;
+    fs::remove_all(options.workDir, ec);
+  }
+
+  if (!ranAny) {
+    std::cerr << "No matching benchmark\n";
+    printUsage(argv[0]);
+    return 1;
+  }
+  return status;
+}
@@ -0,0 +1,88 @@
+#include "bench.h"
+#include "file_type.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace devops {
+namespace bench {
+
+namespace {
+
+// ConfigValidator's detection before FileTypeDetector: an allocated
+// extension compared against each known one, then a substring search.
+uint32_t legacyDetect(const std::string &path) {
+  std::string ext = Utils::getFileExtension(path);
+  if (ext == ".json") {
+    return 1;
+  } else if (ext == ".yaml" || ext == ".yml") {
+    return 2;
+  } else if (ext == ".toml") {
+    return 3;
+  } else if (ext == ".env" || path.find(".env") != std::string::npos) {
+    return 4;
+  } else if (ext == ".deb" || ext == ".rpm" || ext == ".tar" ||
+             ext == ".gz" || ext == ".zip" || ext == ".tgz" ||
+             path.find("Dockerfile") != std::string::npos) {
+    return 5;
+  }
+  return 0;
+}
+
+} // namespace
+
+int runDetectBenchmark(const BenchOptions &options) {
+  printHeader("detect: extension if-chain vs perfect-hash FileTypeDetector");
+
+  const char *const names[] = {
+      "deployment.yaml", "values.yml",     "package.json", "Cargo.toml",
+      ".env.production", "Dockerfile",     "app.tar.gz",   "README.md",
+      "main.cpp",        "service.Config", "LICENSE",      "build.deb"};
+  std::vector<std::string> paths;
+  for (int dir = 0; dir < 50; dir++) {
+    for (const char *name : names) {
+      paths.push_back("services/team-" + std::to_string(dir) +
+                      "/deploy/overlays/production/" + name);
+    }
+  }
+  const size_t rounds =
+      std::max<size_t>(1, static_cast<size_t>(500 * options.scale));
+  const double lookups = static_cast<double>(paths.size() * rounds);
+
+  std::printf("%-12s %12s %12s %14s %9s\n", "impl", "lookups", "ns/lookup",
+              "allocs/lookup", "speedup");
+
+  uint64_t checksum = 0;
+  uint64_t allocBefore = allocationCount();
+  Stopwatch legacyTimer;
+  for (size_t r = 0; r < rounds; r++) {
+    for (const std::string &path : paths) {
+      checksum += legacyDetect(path);
+    }
+  }
+  const double legacyMs = legacyTimer.elapsedMs();
+  const double legacyAllocs =
+      static_cast<double>(allocationCount() - allocBefore) / lookups;
+
+  allocBefore = allocationCount();
+  Stopwatch detectorTimer;
+  for (size_t r = 0; r < rounds; r++) {
+    for (const std::string &path : paths) {
+      checksum += static_cast<uint32_t>(FileTypeDetector::fromName(path));
+    }
+  }
+  const double detectorMs = detectorTimer.elapsedMs();
+  const double detectorAllocs =
+      static_cast<double>(allocationCount() - allocBefore) / lookups;
+
+  std::printf("%-12s %12.0f %12.1f %14.2f %9s\n", "if-chain", lookups,
+              legacyMs * 1e6 / lookups, legacyAllocs, "1.00x");
+  std::printf("%-12s %12.0f %12.1f %14.2f %8.2fx\n", "detector", lookups,
+              detectorMs * 1e6 / lookups, detectorAllocs,
+              legacyMs / detectorMs);
+  std::printf("(checksum %llu)\n", static_cast<unsigned long long>(checksum));
+  return 0;
+}
+
+} // namespace bench
+} // namespace devops
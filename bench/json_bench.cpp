@@ -0,0 +1,157 @@
+#include "bench.h"
+#include "json_scanner.h"
+#include <algorithm>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+
+namespace devops {
+namespace bench {
+
+namespace {
+
+// A package-lock.json-shaped document of roughly `size` bytes.
+std::string makePackageLock(size_t size) {
+  std::string doc = "{\n  \"name\": \"app\",\n  \"version\": \"2.3.1\",\n"
+                    "  \"lockfileVersion\": 3,\n  \"packages\": {\n";
+  for (size_t i = 0; doc.size() < size; i++) {
+    const std::string n = std::to_string(i);
+    if (i > 0) {
+      doc += ",\n";
+    }
+    doc += "    \"node_modules/pkg-" + n +
+           "\": {\n"
+           "      \"version\": \"1." + n +
+           ".0\",\n"
+           "      \"resolved\": \"https://registry.npmjs.org/pkg-" + n +
+           "/-/pkg-" + n +
+           "-1.0.0.tgz\",\n"
+           "      \"integrity\": \"sha512-Zm9vYmFyYmF6cXV4Y29yZ2UgZ2FybHkg\\u00e9"
+           "dGhpbmc=\",\n"
+           "      \"dev\": true,\n"
+           "      \"license\": \"MIT\",\n"
+           "      \"engines\": {\"node\": \">=14\"},\n"
+           "      \"dependencies\": {\"dep-a\": \"^1.2.0\", \"dep-b\": "
+           "\"~0.4.1\"}\n"
+           "    }";
+  }
+  doc += "\n  }\n}\n";
+  return doc;
+}
+
+struct Outcome {
+  bool valid;
+  size_t byte;
+  bool emptyObject;
+  std::string version;
+};
+
+Outcome viaNlohmann(const std::string &doc) {
+  try {
+    nlohmann::json j = nlohmann::json::parse(doc.begin(), doc.end());
+    Outcome outcome{true, 0, j.is_object() && j.empty(), ""};
+    if (j.contains("version") && j["version"].is_string()) {
+      outcome.version = j["version"].get<std::string>();
+    }
+    return outcome;
+  } catch (const nlohmann::json::parse_error &e) {
+    return {false, e.byte, false, ""};
+  }
+}
+
+Outcome viaScanner(const std::string &doc, JsonScanner::SimdLevel level) {
+  JsonScanResult r = JsonScanner::scan(doc, level);
+  return {r.valid, r.errorByte, r.emptyRootObject,
+          r.hasVersion ? r.version : ""};
+}
+
+// Corrupts `doc` at a few deterministic places so the error paths are
+// compared too.
+std::vector<std::string> makeVariants(const std::string &doc) {
+  std::vector<std::string> variants{doc, "{}", "[]", "", "{\"version\": 1}"};
+  const char replacements[] = {'}', ']', ',', ':', '"', '\\', 'x', '\x01',
+                               '\xC3', '0', ' ', '\n'};
+  uint32_t state = 12345;
+  for (size_t i = 0; i < 400; i++) {
+    state = state * 1103515245u + 12345u;
+    std::string variant = doc.substr(0, std::min<size_t>(doc.size(), 2048));
+    variant[state % variant.size()] =
+        replacements[(state >> 16) % sizeof(replacements)];
+    variants.push_back(variant);
+  }
+  return variants;
+}
+
+} // namespace
+
+int runJsonBenchmark(const BenchOptions &options) {
+  printHeader("json: JsonScanner vs nlohmann DOM parse");
+
+  std::vector<JsonScanner::SimdLevel> levels{JsonScanner::SimdLevel::Scalar};
+  if (JsonScanner::detectedLevel() >= JsonScanner::SimdLevel::SSE42) {
+    levels.push_back(JsonScanner::SimdLevel::SSE42);
+  }
+  if (JsonScanner::detectedLevel() >= JsonScanner::SimdLevel::AVX2) {
+    levels.push_back(JsonScanner::SimdLevel::AVX2);
+  }
+  std::printf("detected: %s\n",
+              JsonScanner::levelName(JsonScanner::detectedLevel()));
+
+  // Both backends must agree on validity, error byte and extracted facts.
+  size_t disagreements = 0;
+  std::vector<std::string> variants = makeVariants(makePackageLock(16 * 1024));
+  for (const auto &variant : variants) {
+    Outcome expected = viaNlohmann(variant);
+    for (auto level : levels) {
+      Outcome actual = viaScanner(variant, level);
+      if (actual.valid != expected.valid || actual.byte != expected.byte ||
+          actual.emptyObject != expected.emptyObject ||
+          actual.version != expected.version) {
+        disagreements++;
+      }
+    }
+  }
+  std::printf("agreement: %zu documents x %zu paths, %zu disagreements\n\n",
+              variants.size(), levels.size(), disagreements);
+
+  const size_t sizes[] = {4 * 1024, 256 * 1024, 4 * 1024 * 1024};
+  std::printf("%-16s %10s %8s %10s %12s\n", "impl", "size", "iters", "MB/s",
+              "allocs/op");
+
+  size_t sink = 0;
+  for (size_t size : sizes) {
+    const std::string doc = makePackageLock(size);
+    const size_t iterations = std::max<size_t>(
+        1, static_cast<size_t>(16.0 * 1024 * 1024 /
+                               static_cast<double>(size) * options.scale));
+
+    auto measure = [&](const char *name, auto &&fn) {
+      fn(); // warm the thread-local buffers
+      uint64_t before = allocationCount();
+      Stopwatch timer;
+      for (size_t i = 0; i < iterations; i++) {
+        fn();
+      }
+      double ms = timer.elapsedMs();
+      double allocs = static_cast<double>(allocationCount() - before) /
+                      static_cast<double>(iterations);
+      double mb = static_cast<double>(doc.size()) *
+                  static_cast<double>(iterations) / (1024.0 * 1024.0);
+      std::printf("%-16s %10zu %8zu %10.1f %12.1f\n", name, doc.size(),
+                  iterations, mb / (ms / 1000.0), allocs);
+    };
+
+    measure("nlohmann DOM", [&] { sink += viaNlohmann(doc).version.size(); });
+    for (auto level : levels) {
+      std::string name = std::string("scanner/") + JsonScanner::levelName(level);
+      measure(name.c_str(), [&] {
+        sink += JsonScanner::scan(doc, level).version.size();
+      });
+    }
+  }
+
+  std::printf("(sink %zu)\n", sink);
+  return disagreements == 0 ? 0 : 1;
+}
+
+} // namespace bench
+} // namespace devops
@@ -0,0 +1,94 @@
+#include "bench.h"
+#include "json_schema.h"
+#include "kubernetes_schemas.h"
+#include "yaml_stream.h"
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include <sstream>
+
+namespace devops {
+namespace bench {
+
+namespace {
+
+// Alternating Deployments and Services, as rendered by a chart.
+std::string makeManifests(size_t count) {
+  std::string out;
+  for (size_t i = 0; i < count; i++) {
+    const std::string n = std::to_string(i);
+    if (i % 2 == 0) {
+      out += "---\n"
+             "apiVersion: apps/v1\n"
+             "kind: Deployment\n"
+             "metadata: {name: app-" + n + ", labels: {app: app-" + n + "}}\n"
+             "spec:\n"
+             "  replicas: 2\n"
+             "  selector: {matchLabels: {app: app-" + n + "}}\n"
+             "  template:\n"
+             "    metadata: {labels: {app: app-" + n + "}}\n"
+             "    spec:\n"
+             "      containers:\n"
+             "        - name: app\n"
+             "          image: registry.local/app:" + n + "\n"
+             "          ports: [{containerPort: 8080, name: http}]\n"
+             "          resources: {limits: {cpu: 500m, memory: 256Mi}}\n"
+             "          env: [{name: LOG_LEVEL, value: info}]\n";
+    } else {
+      out += "---\n"
+             "apiVersion: v1\n"
+             "kind: Service\n"
+             "metadata: {name: app-" + n + "}\n"
+             "spec:\n"
+             "  selector: {app: app-" + n + "}\n"
+             "  ports: [{port: 80, targetPort: http}]\n";
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+int runKubernetesBenchmark(const BenchOptions &options) {
+  printHeader("kubernetes: bundled schema index, manifests/s");
+
+  Stopwatch setup;
+  KubernetesSchemas schemas("latest");
+  std::printf("index for %s: %zu kinds in %.2f ms\n", schemas.version().c_str(),
+              schemas.kindCount(), setup.elapsedMs());
+
+  const size_t count =
+      static_cast<size_t>(50000.0 * options.scale) | 1; // at least one
+  const std::string manifests = makeManifests(count);
+
+  std::printf("%-22s %10s %14s %12s\n", "impl", "manifests", "manifests/s",
+              "violations");
+
+  auto run = [&](const char *name, bool check) {
+    size_t violations = 0;
+    Stopwatch timer;
+    std::istringstream in(manifests);
+    YamlStreamResult result = YamlStreamScanner::scan(
+        in, [&](size_t, const nlohmann::json &document) {
+          if (!check) {
+            return;
+          }
+          auto match = schemas.find(document["apiVersion"].get<std::string>(),
+                                    document["kind"].get<std::string>());
+          std::vector<SchemaViolation> found;
+          if (match.schema && !match.schema->validate(document, found)) {
+            violations += found.size();
+          }
+        });
+    double seconds = timer.elapsedMs() / 1000.0;
+    std::printf("%-22s %10zu %14.0f %12zu\n", name, result.documents.size(),
+                static_cast<double>(result.documents.size()) / seconds,
+                violations);
+  };
+
+  run("stream to JSON only", false);
+  run("stream + k8s schema", true);
+  return 0;
+}
+
+} // namespace bench
+} // namespace devops
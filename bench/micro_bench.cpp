@@ -0,0 +1,246 @@
+#include "artifact_analyzer.h"
+#include "bench.h"
+#include "config_validator.h"
+#include "corpus_generator.h"
+#include "directory_walker.h"
+#include "report.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace devops {
+namespace bench {
+
+namespace {
+
+struct MicroStats {
+  size_t ops = 0;
+  uint64_t bytes = 0;
+  double totalMs = 0;
+  double p50Us = 0;
+  double p90Us = 0;
+  double p99Us = 0;
+  double allocsPerOp = 0;
+};
+
+// Runs `op(i)` for i in [0, ops), timing each call on its own. `op` returns
+// the number of input bytes it processed, for MB/s. The latency buffer is
+// allocated up front so it does not show in allocs/op.
+template <typename Op> MicroStats measure(size_t ops, Op &&op) {
+  std::vector<double> latencies(ops);
+  MicroStats stats;
+  stats.ops = ops;
+
+  op(0); // warm caches and any lazily built state
+  const uint64_t allocBefore = allocationCount();
+  Stopwatch total;
+  for (size_t i = 0; i < ops; i++) {
+    const auto start = std::chrono::steady_clock::now();
+    stats.bytes += op(i);
+    latencies[i] = std::chrono::duration<double, std::micro>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  }
+  stats.totalMs = total.elapsedMs();
+  stats.allocsPerOp =
+      static_cast<double>(allocationCount() - allocBefore) / ops;
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) {
+    return latencies[std::min(ops - 1, static_cast<size_t>(p * ops))];
+  };
+  stats.p50Us = percentile(0.50);
+  stats.p90Us = percentile(0.90);
+  stats.p99Us = percentile(0.99);
+  return stats;
+}
+
+void printStatsHeader() {
+  std::printf("%-22s %8s %11s %9s %9s %9s %9s %10s\n", "case", "ops",
+              "ops/s", "MB/s", "p50 us", "p90 us", "p99 us", "allocs/op");
+}
+
+void printStats(const char *name, const MicroStats &stats) {
+  const double seconds = stats.totalMs / 1000.0;
+  std::printf("%-22s %8zu %11.0f %9.1f %9.2f %9.2f %9.2f %10.1f\n", name,
+              stats.ops, stats.ops / seconds,
+              static_cast<double>(stats.bytes) / 1e6 / seconds, stats.p50Us,
+              stats.p90Us, stats.p99Us, stats.allocsPerOp);
+}
+
+struct Sample {
+  std::string path;
+  std::string content;
+};
+
+std::vector<Sample> samplesOf(const Corpus &corpus, CorpusKind kind) {
+  std::vector<Sample> samples;
+  for (const CorpusFile &file : corpus.files) {
+    if (file.kind == kind) {
+      samples.push_back({file.path, Utils::readFile(file.path)});
+    }
+  }
+  return samples;
+}
+
+} // namespace
+
+int runMicroBenchmark(const BenchOptions &options) {
+  printHeader("micro: per-operation latency of the hot paths");
+
+  CorpusOptions corpusOptions;
+  corpusOptions.files =
+      std::max<size_t>(60, static_cast<size_t>(600 * options.scale));
+  const std::string root = options.workDir + "/micro";
+  const Corpus corpus = generateCorpus(root, corpusOptions);
+  const size_t ops =
+      std::max<size_t>(100, static_cast<size_t>(5000 * options.scale));
+
+  std::printf("corpus: %zu files, %.1f KiB, seed %llu\n", corpus.files.size(),
+              static_cast<double>(corpus.bytes) / 1024.0,
+              static_cast<unsigned long long>(corpusOptions.seed));
+  printStatsHeader();
+
+  // checkContent is what validateFile runs after reading: format dispatch
+  // plus the validator, with no cache or schema configured.
+  ConfigValidator validator;
+  const struct {
+    const char *name;
+    CorpusKind kind;
+  } validators[] = {{"validateJSON", CorpusKind::PackageJson},
+                    {"validateYAML (k8s)", CorpusKind::Kubernetes},
+                    {"validateYAML (compose)", CorpusKind::Compose},
+                    {"validateTOML", CorpusKind::Toml},
+                    {"validateEnv", CorpusKind::Env}};
+  int status = 0;
+  for (const auto &v : validators) {
+    const std::vector<Sample> samples = samplesOf(corpus, v.kind);
+    if (samples.empty()) {
+      continue;
+    }
+    size_t invalid = 0;
+    const MicroStats stats = measure(ops, [&](size_t i) {
+      const Sample &sample = samples[i % samples.size()];
+      invalid += !validator.checkContent(sample.content, sample.path).valid;
+      return sample.content.size();
+    });
+    printStats(v.name, stats);
+    if (invalid) {
+      std::printf("  %zu operations reported a valid file as invalid\n",
+                  invalid);
+      status = 1;
+    }
+  }
+
+  // A file where most lines draw a warning, for the cost of building and
+  // merging diagnostics rather than of lexing.
+  std::string noisyEnv;
+  for (int i = 0; i < 200; i++) {
+    const std::string n = std::to_string(i);
+    noisyEnv += i % 2 ? "export KEY_" + n + "=value with spaces\n"
+                      : "BAD LINE " + n + "\n";
+  }
+  printStats("validateEnv (noisy)", measure(ops / 10, [&](size_t) {
+               return validator.checkContent(noisyEnv, "noisy.env").valid
+                          ? noisyEnv.size()
+                          : 0;
+             }));
+
+  std::vector<std::string> paths;
+  for (const CorpusFile &file : corpus.files) {
+    paths.push_back(file.path);
+  }
+  printStats("Utils::readFile", measure(ops, [&](size_t i) {
+               return Utils::readFile(paths[i % paths.size()]).size();
+             }));
+
+  const std::vector<Sample> manifests =
+      samplesOf(corpus, CorpusKind::Kubernetes);
+  printStats("Utils::split (lines)", measure(ops, [&](size_t i) {
+               const Sample &sample = manifests[i % manifests.size()];
+               return Utils::split(sample.content, '\n').size() > 0
+                          ? sample.content.size()
+                          : 0;
+             }));
+
+  ArtifactAnalyzer analyzer;
+  const std::vector<Sample> dockerfiles =
+      samplesOf(corpus, CorpusKind::Dockerfile);
+  printStats("analyzeDocker", measure(ops, [&](size_t i) {
+               const Sample &sample = dockerfiles[i % dockerfiles.size()];
+               return analyzer.inspectFile(sample.path).valid
+                          ? sample.content.size()
+                          : 0;
+             }));
+
+  // One operation is a walk of the whole corpus.
+  DirectoryWalker walker;
+  const size_t walks = std::max<size_t>(10, ops / 100);
+  printStats("DirectoryWalker::walk", measure(walks, [&](size_t) {
+               uint64_t files = 0;
+               walker.walk(root, [&](const std::string &) { files++; });
+               return files == corpus.files.size() ? corpus.bytes : 0;
+             }));
+  return status;
+}
+
+int runCorpusBenchmark(const BenchOptions &options) {
+  printHeader("corpus: validateDirectory end to end on a generated tree");
+
+  CorpusOptions corpusOptions;
+  corpusOptions.files =
+      std::max<size_t>(100, static_cast<size_t>(2000 * options.scale));
+  corpusOptions.invalidFraction = 0.05;
+  const std::string root = options.workDir + "/corpus";
+  Stopwatch generateTimer;
+  const Corpus corpus = generateCorpus(root, corpusOptions);
+  std::printf("corpus: %zu files (%zu invalid), %.1f MiB, generated in "
+              "%.0f ms\n",
+              corpus.files.size(), corpus.invalid,
+              static_cast<double>(corpus.bytes) / (1024.0 * 1024.0),
+              generateTimer.elapsedMs());
+
+  std::printf("%-8s %10s %10s %10s %12s %12s\n", "jobs", "ms", "files/s",
+              "MB/s", "allocs/file", "peak RSS KiB");
+
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<unsigned> jobCounts = {1};
+  if (cores > 1) {
+    jobCounts.push_back(cores);
+  }
+
+  int status = 0;
+  for (unsigned jobs : jobCounts) {
+    ConfigValidator validator;
+    validator.setJobs(jobs);
+    resetPeakRss();
+    const uint64_t allocBefore = allocationCount();
+    ValidationResult result;
+    double ms = 0;
+    {
+      OutputSilencer silencer;
+      Stopwatch timer;
+      result = validator.validateDirectory(root);
+      Report::flush();
+      ms = timer.elapsedMs();
+    }
+    const double files = static_cast<double>(corpus.files.size());
+    std::printf("%-8u %10.1f %10.0f %10.1f %12.1f %12ld\n", jobs, ms,
+                files / (ms / 1000.0),
+                static_cast<double>(corpus.bytes) / 1e6 / (ms / 1000.0),
+                static_cast<double>(allocationCount() - allocBefore) / files,
+                peakRssKb());
+    // The cut-short files, and only they, make the directory invalid.
+    if (result.valid != (corpus.invalid == 0)) {
+      std::printf("  unexpected result: valid=%d with %zu invalid files\n",
+                  result.valid, corpus.invalid);
+      status = 1;
+    }
+  }
+  return status;
+}
+
+} // namespace bench
+} // namespace devops
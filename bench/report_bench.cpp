@@ -0,0 +1,133 @@
+#include "bench.h"
+#include "report.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+
+namespace devops {
+namespace bench {
+
+namespace {
+
+std::vector<ValidationResult> makeResults(size_t count) {
+  std::vector<ValidationResult> results(count);
+  for (size_t i = 0; i < count; i++) {
+    ValidationResult &result = results[i];
+    result.fileType = i % 2 ? "YAML" : "JSON";
+    result.valid = i % 10 != 0;
+    if (!result.valid) {
+      result.errors.push_back("YAML parse error: yaml-cpp: error at line 12, "
+                              "column 4: end of map not found");
+      result.errors.push_back("Document 2: Schema violation at /spec/replicas:"
+                              " expected integer, got string");
+    }
+    if (i % 3 == 0) {
+      result.warnings.push_back("Docker Compose 'version' field missing");
+    }
+    if (i % 2) {
+      result.notes.push_back("Detected Kubernetes manifest");
+    }
+  }
+  return results;
+}
+
+// ConfigValidator's output before the report sink: one std::endl, and so
+// one flush and write, per line.
+void legacyPrint(const std::string &path, const ValidationResult &result) {
+  std::cout << "\n"
+            << Color::BOLD << "Validating: " << path << Color::RESET
+            << std::endl;
+  for (const auto &note : result.notes) {
+    std::cout << Color::CYAN << "ℹ " << note << Color::RESET << std::endl;
+  }
+  if (result.valid) {
+    std::cout << Color::GREEN << "✓ Valid " << result.fileType << " file"
+              << Color::RESET << std::endl;
+  } else {
+    std::cerr << Color::RED << "✗ Invalid " << result.fileType << " file"
+              << Color::RESET << std::endl;
+  }
+  for (const auto &error : result.errors) {
+    std::cerr << Color::RED << "  ERROR: " << error << Color::RESET
+              << std::endl;
+  }
+  for (const auto &warning : result.warnings) {
+    std::cout << Color::YELLOW << "  WARNING: " << warning << Color::RESET
+              << std::endl;
+  }
+}
+
+} // namespace
+
+int runReportBenchmark(const BenchOptions &options) {
+  printHeader("report: per-line std::endl vs buffered report sink");
+#ifdef _WIN32
+  (void)options;
+  std::printf("skipped: needs POSIX dup2 to discard output\n");
+  return 0;
+#else
+  const size_t count =
+      std::max<size_t>(100, static_cast<size_t>(20000 * options.scale));
+  const std::vector<ValidationResult> results = makeResults(count);
+  std::vector<std::string> paths(count);
+  for (size_t i = 0; i < count; i++) {
+    paths[i] = "configs/service-" + std::to_string(i) + ".yaml";
+  }
+
+  std::printf("%-12s %10s %12s %12s %12s %9s\n", "impl", "files", "ms",
+              "files/s", "written KiB", "speedup");
+
+  // Output goes to /dev/null so only the formatting and write calls are
+  // measured, not a terminal.
+  auto silencer = std::make_unique<OutputSilencer>();
+  if (!silencer->active()) {
+    std::printf("skipped: cannot redirect output\n");
+    return 1;
+  }
+
+  Stopwatch legacyTimer;
+  for (size_t i = 0; i < count; i++) {
+    legacyPrint(paths[i], results[i]);
+  }
+  const double legacyMs = legacyTimer.elapsedMs();
+
+  struct Case {
+    const char *name;
+    ReportFormat format;
+    double ms;
+    uint64_t bytes;
+  };
+  Case cases[] = {{"human", ReportFormat::Human, 0, 0},
+                  {"jsonl", ReportFormat::JsonLines, 0, 0}};
+  for (Case &c : cases) {
+    Report::configure(c.format, ColorMode::Always);
+    const uint64_t before = Report::bytesWritten();
+    Stopwatch timer;
+    for (size_t i = 0; i < count; i++) {
+      Report::fileResult(paths[i], results[i], true);
+    }
+    Report::flush();
+    c.ms = timer.elapsedMs();
+    c.bytes = Report::bytesWritten() - before;
+  }
+  // Back to human so no JSON Lines summary is written at exit.
+  Report::configure(ReportFormat::Human, ColorMode::Auto);
+
+  silencer.reset();
+
+  const double files = static_cast<double>(count);
+  std::printf("%-12s %10zu %12.2f %12.0f %12s %9s\n", "endl", count, legacyMs,
+              files / (legacyMs / 1000.0), "-", "1.00x");
+  for (const Case &c : cases) {
+    std::printf("%-12s %10zu %12.2f %12.0f %12.1f %8.2fx\n", c.name, count,
+                c.ms, files / (c.ms / 1000.0),
+                static_cast<double>(c.bytes) / 1024.0, legacyMs / c.ms);
+  }
+  return 0;
+#endif
+}
+
+} // namespace bench
+} // namespace devops
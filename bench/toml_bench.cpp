@@ -0,0 +1,138 @@
+#include "bench.h"
+#include "toml_parser.h"
+#include <algorithm>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include <regex>
+#include <sstream>
+
+namespace devops {
+namespace bench {
+
+namespace {
+
+// The regex heuristics validateTOML used before TomlParser, for reference.
+size_t legacyRegexToml(const std::string &content) {
+  std::regex sectionRegex(R"(\[[\w\.\-]+\])");
+  std::regex keyValueRegex(R"([\w\-]+\s*=\s*.+)");
+
+  std::istringstream stream(content);
+  std::string line;
+  size_t warnings = 0;
+  while (std::getline(stream, line)) {
+    std::string trimmed = line;
+    trimmed.erase(0, trimmed.find_first_not_of(" \t"));
+    if (trimmed.empty() || trimmed[0] == '#') {
+      continue;
+    }
+    if (!std::regex_search(trimmed, sectionRegex) &&
+        !std::regex_search(trimmed, keyValueRegex)) {
+      warnings++;
+    }
+  }
+  return warnings;
+}
+
+// Builds a Cargo/pyproject-style TOML document and a JSON document with
+// the same data, both of roughly `size` bytes.
+void makeDocuments(size_t size, std::string &toml, std::string &json) {
+  toml = "title = \"generated\"\nversion = \"1.0.0\"\n\n";
+  json = "{\"title\": \"generated\", \"version\": \"1.0.0\", \"services\": [";
+
+  for (size_t i = 0; toml.size() < size; i++) {
+    const std::string n = std::to_string(i);
+    toml += "[[services]]\n"
+            "name = \"service-" + n + "\"\n"
+            "image = \"registry.local/app:" + n + "\"\n"
+            "replicas = " + std::to_string(i % 7 + 1) + "\n"
+            "cpu = 0.5\n"
+            "enabled = true\n"
+            "created = 2024-03-01T12:00:00Z\n"
+            "ports = [8080, 8443, 9090]\n"
+            "labels = { tier = \"backend\", team = \"platform\" }\n\n";
+
+    if (i > 0) {
+      json += ", ";
+    }
+    json += "{\"name\": \"service-" + n +
+            "\", \"image\": \"registry.local/app:" + n +
+            "\", \"replicas\": " + std::to_string(i % 7 + 1) +
+            ", \"cpu\": 0.5, \"enabled\": true, "
+            "\"created\": \"2024-03-01T12:00:00Z\", "
+            "\"ports\": [8080, 8443, 9090], "
+            "\"labels\": {\"tier\": \"backend\", \"team\": \"platform\"}}";
+  }
+  json += "]}";
+}
+
+template <typename Fn>
+double measureMs(size_t iterations, Fn &&fn, double &allocsPerOp) {
+  uint64_t before = allocationCount();
+  Stopwatch timer;
+  for (size_t i = 0; i < iterations; i++) {
+    fn();
+  }
+  double ms = timer.elapsedMs();
+  allocsPerOp = static_cast<double>(allocationCount() - before) /
+                static_cast<double>(iterations);
+  return ms;
+}
+
+} // namespace
+
+int runTomlBenchmark(const BenchOptions &options) {
+  printHeader("toml: TomlParser vs JSON path on equal-sized input");
+
+  const size_t sizes[] = {4 * 1024, 256 * 1024, 4 * 1024 * 1024};
+  std::printf("%-14s %10s %8s %10s %12s\n", "impl", "size", "iters", "MB/s",
+              "allocs/op");
+
+  size_t sink = 0;
+  for (size_t size : sizes) {
+    std::string toml, json;
+    makeDocuments(size, toml, json);
+    const size_t iterations = std::max<size_t>(
+        1, static_cast<size_t>(8.0 * 1024 * 1024 / static_cast<double>(size) *
+                               options.scale));
+
+    auto report = [&](const char *name, size_t bytes, double ms,
+                      double allocs) {
+      double mb = static_cast<double>(bytes) *
+                  static_cast<double>(iterations) / (1024.0 * 1024.0);
+      std::printf("%-14s %10zu %8zu %10.1f %12.1f\n", name, bytes, iterations,
+                  mb / (ms / 1000.0), allocs);
+    };
+
+    double allocs;
+    double ms = measureMs(
+        iterations,
+        [&] {
+          TomlParseResult result = TomlParser(toml).run();
+          sink += result.keys + (result.valid ? 0 : 1);
+        },
+        allocs);
+    report("TomlParser", toml.size(), ms, allocs);
+
+    ms = measureMs(
+        iterations,
+        [&] { sink += nlohmann::json::parse(json.begin(), json.end()).size(); },
+        allocs);
+    report("nlohmann JSON", json.size(), ms, allocs);
+
+    ms = measureMs(
+        std::max<size_t>(1, iterations / 8),
+        [&] { sink += legacyRegexToml(toml); }, allocs);
+    std::printf("%-14s %10zu %8zu %10.1f %12.1f\n", "legacy regex",
+                toml.size(), std::max<size_t>(1, iterations / 8),
+                static_cast<double>(toml.size()) *
+                    static_cast<double>(std::max<size_t>(1, iterations / 8)) /
+                    (1024.0 * 1024.0) / (ms / 1000.0),
+                allocs);
+  }
+
+  std::printf("(sink %zu)\n", sink);
+  return 0;
+}
+
+} // namespace bench
+} // namespace devops
@@ -0,0 +1,103 @@
+#include "bench.h"
+#include "directory_walker.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace devops {
+namespace bench {
+
+namespace {
+
+// A project-like tree: nested service directories with configs and logs,
+// a .gitignore for the logs and a large node_modules directory.
+void writeTree(const std::string &root, size_t services) {
+  fs::remove_all(root);
+  for (size_t i = 0; i < services; i++) {
+    const fs::path dir = fs::path(root) / ("service-" + std::to_string(i)) /
+                         "config" / "env";
+    fs::create_directories(dir);
+    for (int f = 0; f < 8; f++) {
+      std::ofstream(dir / ("app-" + std::to_string(f) + ".yaml")) << "a: 1\n";
+      std::ofstream(dir / ("run-" + std::to_string(f) + ".log")) << "x\n";
+    }
+  }
+  for (size_t i = 0; i < services * 4; i++) {
+    const fs::path dir =
+        fs::path(root) / "node_modules" / ("pkg-" + std::to_string(i));
+    fs::create_directories(dir);
+    for (int f = 0; f < 4; f++) {
+      std::ofstream(dir / ("package-" + std::to_string(f) + ".json")) << "{}";
+    }
+  }
+  std::ofstream(fs::path(root) / ".gitignore") << "*.log\n";
+}
+
+} // namespace
+
+int runWalkBenchmark(const BenchOptions &options) {
+  printHeader("walk: recursive_directory_iterator vs DirectoryWalker");
+
+  const std::string root = options.workDir + "/walk";
+  const size_t services =
+      std::max<size_t>(10, static_cast<size_t>(500 * options.scale));
+  writeTree(root, services);
+
+  std::printf("%-22s %10s %10s %10s %10s %9s\n", "impl", "ms", "dirs",
+              "files", "stats", "speedup");
+
+  // The scan validateDirectory used before the walker: every entry is
+  // visited, including node_modules, and is_regular_file() may stat.
+  Stopwatch baselineTimer;
+  uint64_t baselineFiles = 0;
+  uint64_t baselineDirs = 0;
+  for (const auto &entry : fs::recursive_directory_iterator(root)) {
+    if (entry.is_regular_file()) {
+      baselineFiles++;
+    } else if (entry.is_directory()) {
+      baselineDirs++;
+    }
+  }
+  const double baselineMs = baselineTimer.elapsedMs();
+  std::printf("%-22s %10.2f %10llu %10llu %10s %9s\n", "fs::recursive",
+              baselineMs, static_cast<unsigned long long>(baselineDirs + 1),
+              static_cast<unsigned long long>(baselineFiles), "-", "1.00x");
+
+  const unsigned threads = WorkStealingPool::defaultThreadCount();
+  WorkStealingPool pool(threads);
+  struct Case {
+    std::string name;
+    WalkOptions walkOptions;
+    WorkStealingPool *pool;
+  };
+  const Case cases[] = {
+      {"walker (no ignore)", WalkOptions{false, false}, nullptr},
+      {"walker", WalkOptions{}, nullptr},
+      {"walker x" + std::to_string(threads), WalkOptions{}, &pool},
+  };
+  for (const Case &c : cases) {
+    std::atomic<uint64_t> seen{0};
+    auto onFile = [&seen](const std::string &) {
+      seen.fetch_add(1, std::memory_order_relaxed);
+    };
+    const WalkStats stats =
+        DirectoryWalker(c.walkOptions).walk(root, onFile, c.pool);
+    std::printf("%-22s %10.2f %10llu %10llu %10llu %8.2fx\n", c.name.c_str(),
+                stats.elapsedMs,
+                static_cast<unsigned long long>(stats.directories),
+                static_cast<unsigned long long>(seen.load()),
+                static_cast<unsigned long long>(stats.stats),
+                baselineMs / stats.elapsedMs);
+  }
+
+  fs::remove_all(root);
+  return 0;
+}
+
+} // namespace bench
+} // namespace devops
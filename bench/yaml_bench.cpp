@@ -0,0 +1,91 @@
+#include "bench.h"
+#include "yaml_stream.h"
+#include <cstdio>
+#include <sstream>
+#include <yaml-cpp/yaml.h>
+
+namespace devops {
+namespace bench {
+
+namespace {
+
+// `helm template`-style output: many Kubernetes documents of ~1 KiB.
+std::string makeBundle(size_t size) {
+  std::string bundle;
+  for (size_t i = 0; bundle.size() < size; i++) {
+    const std::string n = std::to_string(i);
+    bundle += "---\n"
+              "apiVersion: apps/v1\n"
+              "kind: Deployment\n"
+              "metadata:\n"
+              "  name: service-" + n + "\n"
+              "  labels: {app: service-" + n + ", tier: backend}\n"
+              "spec:\n"
+              "  replicas: 3\n"
+              "  template:\n"
+              "    spec:\n"
+              "      containers:\n"
+              "        - name: app\n"
+              "          image: registry.local/app:" + n + "\n"
+              "          ports:\n"
+              "            - containerPort: 8080\n"
+              "            - containerPort: 8443\n"
+              "          env:\n"
+              "            - {name: LOG_LEVEL, value: info}\n"
+              "            - {name: REGION, value: eu-west-1}\n";
+  }
+  return bundle;
+}
+
+} // namespace
+
+int runYamlBenchmark(const BenchOptions &options) {
+  printHeader("yaml: event stream vs YAML::Load / YAML::LoadAll");
+
+  const size_t sizes[] = {64 * 1024, 8 * 1024 * 1024};
+  std::printf("%-16s %10s %6s %10s %12s %12s\n", "impl", "size", "docs",
+              "MB/s", "allocs/doc", "peak KiB");
+
+  size_t sink = 0;
+  for (size_t size : sizes) {
+    const std::string bundle =
+        makeBundle(static_cast<size_t>(static_cast<double>(size) *
+                                       options.scale));
+
+    auto measure = [&](const char *name, auto &&fn) {
+      resetPeakRss();
+      long rssBefore = peakRssKb();
+      uint64_t allocsBefore = allocationCount();
+      Stopwatch timer;
+      size_t documents = fn();
+      double ms = timer.elapsedMs();
+      double mb = static_cast<double>(bundle.size()) / (1024.0 * 1024.0);
+      std::printf("%-16s %10zu %6zu %10.1f %12.0f %12ld\n", name,
+                  bundle.size(), documents, mb / (ms / 1000.0),
+                  static_cast<double>(allocationCount() - allocsBefore) /
+                      static_cast<double>(documents ? documents : 1),
+                  peakRssKb() - rssBefore);
+      sink += documents;
+    };
+
+    // YAML::Load only sees the first document; shown for its cost.
+    measure("YAML::Load", [&] {
+      std::istringstream in(bundle);
+      return YAML::Load(in).IsMap() ? size_t{1} : size_t{0};
+    });
+    measure("YAML::LoadAll", [&] {
+      std::istringstream in(bundle);
+      return YAML::LoadAll(in).size();
+    });
+    measure("event stream", [&] {
+      std::istringstream in(bundle);
+      return YamlStreamScanner::scan(in).documents.size();
+    });
+  }
+
+  std::printf("(sink %zu)\n", sink);
+  return 0;
+}
+
+} // namespace bench
+} // namespace devops
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+namespace devops {
+
+// Counts allocations made through the global operator new, which this
+// program replaces. Counting is off by default and then costs one relaxed
+// load per allocation; the counters are totals across all threads.
+class AllocationCounter {
+public:
+  static void enable(bool enabled);
+  static uint64_t count();
+  static uint64_t bytes();
+};
+
+} // namespace devops
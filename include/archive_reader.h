@@ -0,0 +1,89 @@
+#pragma once
+
+#include "file_type.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace devops {
+
+struct ArchiveStats {
+  uint64_t members = 0;       // regular files seen
+  uint64_t extracted = 0;     // members handed to the callback
+  uint64_t bytesRead = 0;     // bytes read from the archive file
+  uint64_t bytesUnpacked = 0; // bytes of extracted members
+  // Members that were wanted but could not be extracted (too large,
+  // encrypted, bad checksum); the read carries on past them.
+  std::vector<std::string> skipped;
+};
+
+struct ArchiveEntry {
+  std::string path;
+  uint64_t size = 0; // uncompressed
+};
+
+// What list() found: counts and sizes, never member content.
+struct ArchiveListing {
+  uint64_t files = 0; // regular files
+  uint64_t directories = 0;
+  uint64_t links = 0;          // symbolic and hard links
+  uint64_t totalSize = 0;      // uncompressed bytes of the regular files
+  uint64_t archiveSize = 0;    // bytes of the archive file
+  std::vector<ArchiveEntry> largest; // biggest files, largest first
+  // Entries that would land outside the extraction directory (absolute
+  // paths, "..", links pointing out) and device files. Only the first
+  // MAX_ANOMALY_DETAILS are described.
+  uint64_t anomalies = 0;
+  std::vector<std::string> anomalyDetails;
+};
+
+// Reads tar (plain or compressed with gzip, xz or zstd), single compressed
+// files and zip archives in one sequential pass, decompressing in memory.
+// Nothing is written to disk, and at most one member plus a fixed-size
+// read buffer is held at a time. read() takes zip archives by their local
+// headers, so it never seeks to the central directory at the end.
+class ArchiveReader {
+public:
+  // Members larger than this are skipped rather than held in memory.
+  static constexpr uint64_t MAX_MEMBER_BYTES = uint64_t{64} << 20;
+  static constexpr size_t MAX_ANOMALY_DETAILS = 20;
+
+  // Decides from a member's path whether its content is needed.
+  using MemberFilter = std::function<bool(const std::string &path)>;
+  using MemberCallback =
+      std::function<void(const std::string &path, std::string_view content)>;
+
+  // The format comes from the name and, failing that, the magic bytes.
+  // Throws std::runtime_error if `path` is not a supported archive.
+  explicit ArchiveReader(std::string path);
+
+  // Calls `onMember` in archive order for every wanted regular file.
+  // Throws std::runtime_error on I/O errors and corrupt or truncated
+  // archives; members already reported stay reported.
+  ArchiveStats read(const MemberFilter &wanted,
+                    const MemberCallback &onMember) const;
+
+  // Counts the entries and their sizes without extracting anything,
+  // keeping the `largest` biggest files. Tar data is skipped (seeked over
+  // when uncompressed), so memory stays bounded for any archive size. Zip
+  // archives are listed from their central directory alone, through a
+  // memory map. Throws std::runtime_error like read().
+  ArchiveListing list(size_t largest = 5) const;
+
+  // True for names and content ArchiveReader can open.
+  static bool isArchive(const std::string &path);
+
+  // The control file of a Debian package, from its control.tar, .gz, .xz
+  // or .zst member. Only the ar headers up to that member and the member
+  // itself are read; the data.tar payload after it never is. Throws
+  // std::runtime_error for files that are not readable .deb packages.
+  static std::string readDebControl(const std::string &path);
+
+private:
+  std::string path_;
+  FileType format_;
+};
+
+} // namespace devops
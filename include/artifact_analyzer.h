@@ -1,5 +1,8 @@
 #pragma once
 
+#include "directory_walker.h"
+#include "file_type.h"
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -18,16 +21,42 @@ struct ArtifactInfo {
 class ArtifactAnalyzer {
 public:
   ArtifactInfo analyzeFile(const std::string &filePath);
+  // Like analyzeFile, but only returns the information without printing.
+  ArtifactInfo inspectFile(const std::string &filePath);
+  // Prints every artifact in the directory in path order, then a summary
+  // by type. Files are analyzed on the worker threads set by setJobs().
   void analyzeDirectory(const std::string &dirPath);
 
+  // Number of worker threads used by analyzeDirectory. 1 analyzes files one
+  // at a time on the calling thread; 0 uses every available core.
+  void setJobs(unsigned jobs);
+
+  // Also analyze the artifacts in subdirectories, skipping what the walk
+  // options exclude.
+  void setRecursive(bool recursive);
+  void setWalkOptions(const WalkOptions &options);
+
+  // Compressed bytes that analyzeDirectory streams at once. Gzip, xz and
+  // zstd files are read whole to be listed, so they wait for room in this
+  // budget; other artifacts only have their headers read and never wait.
+  // A file larger than the budget is streamed alone. 0 removes the limit.
+  void setMaxInFlightBytes(uint64_t bytes);
+
+  static constexpr uint64_t DEFAULT_MAX_IN_FLIGHT_BYTES = 256ull << 20;
+
 private:
   ArtifactInfo analyzeDeb(const std::string &filePath);
   ArtifactInfo analyzeRpm(const std::string &filePath);
   ArtifactInfo analyzeDocker(const std::string &filePath);
-  ArtifactInfo analyzeArchive(const std::string &filePath);
+  ArtifactInfo analyzeArchive(const std::string &filePath, FileType type);
 
   void printArtifactInfo(const ArtifactInfo &info);
   std::string formatSize(long bytes);
+
+  unsigned jobs_ = 1;
+  bool recursive_ = false;
+  WalkOptions walkOptions_;
+  uint64_t maxInFlightBytes_ = DEFAULT_MAX_IN_FLIGHT_BYTES;
 };
 
 } // namespace devops
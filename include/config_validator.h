@@ -1,34 +1,142 @@
 #pragma once
 
+#include "archive_reader.h"
+#include "diagnostics.h"
+#include "directory_walker.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <nlohmann/json_fwd.hpp>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace devops {
 
+class CompiledSchema;
+class KubernetesSchemas;
+class ReportBuffer;
+class ValidationCache;
+
 struct ValidationResult {
   bool valid;
-  std::vector<std::string> errors;
-  std::vector<std::string> warnings;
+  Diagnostics errors;
+  Diagnostics warnings;
+  Diagnostics notes;
   std::string fileType;
 };
 
+// How JSON files are checked. Simd runs JsonScanner, which validates
+// without building a DOM; Nlohmann parses with nlohmann::json as before and
+// is kept to cross-check the scanner.
+enum class JsonBackend { Simd, Nlohmann };
+
 class ConfigValidator {
 public:
   ValidationResult validateFile(const std::string &filePath);
   ValidationResult validateDirectory(const std::string &dirPath);
 
+  // Validates the directory once, then revalidates only the files that
+  // change until SIGINT/SIGTERM, keeping the summary up to date. Linux
+  // only; throws std::runtime_error where inotify is unavailable.
+  ValidationResult watchDirectory(const std::string &dirPath);
+
+  // Validates one file without printing anything. Safe to call from several
+  // threads at once; exceptions are reported as errors in the result.
+  ValidationResult check(const std::string &filePath);
+
+  // Validates an in-memory file; `filePath` only selects the format and is
+  // used in messages. Thread-safe like check(), but exceptions propagate.
+  ValidationResult checkContent(std::string_view content,
+                                const std::string &filePath);
+
+  // Validates the config files in a commit of the repository at `repoPath`,
+  // read from the object store without checking anything out. With
+  // `sinceRev` set only files whose blob differs from that commit are
+  // checked.
+  ValidationResult validateGitRevision(const std::string &repoPath,
+                                       const std::string &rev,
+                                       const std::string &sinceRev = "");
+
+  // Prints a result the way validateFile does.
+  void printValidationResult(const ValidationResult &result,
+                             const std::string &filePath);
+
+  // Number of worker threads used by validateDirectory. 1 validates files
+  // one at a time on the calling thread; 0 uses every available core.
+  void setJobs(unsigned jobs);
+
+  // Results are looked up in (and stored to) this cache when set.
+  void setCache(std::shared_ptr<ValidationCache> cache);
+
+  void setJsonBackend(JsonBackend backend);
+
+  // JSON and YAML documents are also checked against this schema when set.
+  void setSchema(std::shared_ptr<const CompiledSchema> schema);
+
+  // Documents with apiVersion and kind are also checked against the bundled
+  // schema for that kind when set.
+  void setKubernetesSchemas(std::shared_ptr<const KubernetesSchemas> schemas);
+
+  // Which ignore files and default excludes validateDirectory honours.
+  void setWalkOptions(const WalkOptions &options);
+
+  // Validates the config members of a tar, gzip or zip archive in one
+  // streaming pass, reporting them as "archive!member/path".
+  ValidationResult validateArchive(const std::string &archivePath);
+
+  // When set, validateFile and validateDirectory also validate the config
+  // members of archives instead of rejecting or skipping them.
+  void setInsideArchives(bool insideArchives);
+
+  static bool isConfigFile(const std::string &filePath);
+
 private:
-  ValidationResult validateJSON(const std::string &content,
+  ValidationResult checkFile(const std::string &filePath);
+
+  // validateDirectory, also recording every file's result in `files` when
+  // it is not null.
+  ValidationResult scanDirectory(const std::string &dirPath,
+                                 std::map<std::string, ValidationResult> *files);
+
+  struct ArchiveCheck {
+    ValidationResult result; // all members together
+    int files = 0;
+    int valid = 0;
+    ArchiveStats stats;
+    double elapsedMs = 0;
+  };
+  // Checks an archive's members, rendering each into `report`.
+  ArchiveCheck checkArchive(const std::string &archivePath,
+                            ReportBuffer &report);
+
+  ValidationResult validateJSON(std::string_view content,
                                 const std::string &filePath);
-  ValidationResult validateYAML(const std::string &content,
+  ValidationResult validateYAML(std::string_view content,
                                 const std::string &filePath);
-  ValidationResult validateTOML(const std::string &content,
+  ValidationResult validateTOML(std::string_view content,
                                 const std::string &filePath);
-  ValidationResult validateEnv(const std::string &content,
+  ValidationResult validateEnv(std::string_view content,
                                const std::string &filePath);
 
-  void printValidationResult(const ValidationResult &result,
-                             const std::string &filePath);
+  // Runs the schema and Kubernetes checks that are enabled on one document.
+  void checkDocument(const nlohmann::json &document, const std::string &prefix,
+                     ValidationResult &result);
+  void checkSchema(const CompiledSchema &schema, const nlohmann::json &document,
+                   const std::string &prefix, ValidationResult &result);
+  void checkKubernetes(const nlohmann::json &document,
+                       const std::string &prefix, ValidationResult &result);
+
+  unsigned jobs_ = 1;
+  JsonBackend jsonBackend_ = JsonBackend::Simd;
+  std::shared_ptr<ValidationCache> cache_;
+  std::shared_ptr<const CompiledSchema> schema_;
+  std::shared_ptr<const KubernetesSchemas> kubernetes_;
+  WalkOptions walkOptions_;
+  bool insideArchives_ = false;
+  std::atomic<uint64_t> schemaDocuments_{0};
+  std::atomic<uint64_t> schemaNanoseconds_{0};
 };
 
 } // namespace devops
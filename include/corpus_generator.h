@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace devops {
+
+// Kinds of file the corpus generator writes, in the proportions a service
+// repository tends to have them.
+enum class CorpusKind {
+  Kubernetes, // Deployment + Service manifests (.yaml)
+  Compose,    // docker-compose files (.yml)
+  PackageJson,
+  Env,
+  Dockerfile,
+  Toml, // Cargo.toml-style manifests
+};
+
+constexpr size_t CORPUS_KIND_COUNT = 6;
+
+const char *corpusKindName(CorpusKind kind);
+
+struct CorpusOptions {
+  size_t files = 1000;
+  // Average file size in bytes; individual files vary from half to one and
+  // a half times this.
+  size_t averageBytes = 2048;
+  // Fraction of files cut short so that they fail validation (Dockerfiles,
+  // which are not validated, are left whole).
+  double invalidFraction = 0.0;
+  uint64_t seed = 1;
+};
+
+struct CorpusFile {
+  std::string path;
+  CorpusKind kind;
+  size_t bytes;
+};
+
+struct Corpus {
+  std::vector<CorpusFile> files;
+  uint64_t bytes = 0;
+  size_t invalid = 0;
+};
+
+// Writes a tree of services/<name>/... under `dir`, replacing whatever was
+// there. The same options always produce byte-identical files on every
+// platform: the generator uses its own PRNG, not <random> distributions.
+Corpus generateCorpus(const std::string &dir, const CorpusOptions &options);
+
+} // namespace devops
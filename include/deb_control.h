@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace devops {
+
+// One package named by a relationship field, e.g. "libc6 (>= 2.34)".
+struct DebRelation {
+  std::string package; // including any ":any" style qualifier
+  std::string op;      // "<<", "<=", "=", ">=", ">>"; empty without version
+  std::string version;
+};
+
+// One comma-separated entry of Depends and the like. Holds more than one
+// relation when the entry lists alternatives ("mawk | gawk").
+using DebRelationGroup = std::vector<DebRelation>;
+
+// "mawk (>= 1.3) | gawk", whitespace normalised.
+std::string toString(const DebRelationGroup &group);
+
+// The fields of a Debian binary control file (deb-control(5)): "Name:
+// value" lines, continued by lines that start with a space or tab. Field
+// names compare case-insensitively.
+class DebControl {
+public:
+  using Fields = std::vector<std::pair<std::string, std::string>>;
+
+  // Parses the first paragraph of `text`. Throws std::runtime_error on
+  // lines that are neither fields nor continuations, and on fields given
+  // twice.
+  static DebControl parse(std::string_view text);
+
+  // The value of `name`, with continuation lines joined by '\n' minus
+  // their leading space and " ." lines as empty ones; null when absent.
+  const std::string *field(std::string_view name) const;
+
+  // A relationship field (Depends, Pre-Depends, Recommends, ...) split into
+  // its entries; architecture lists and build profiles are dropped. Empty
+  // when the field is absent; throws std::runtime_error when malformed.
+  std::vector<DebRelationGroup> relations(std::string_view name) const;
+
+  const Fields &fields() const { return fields_; }
+
+private:
+  Fields fields_;
+};
+
+} // namespace devops
@@ -0,0 +1,128 @@
+#pragma once
+
+/*
+ * C API of libdevops_validator: the validation engine of devops-validator
+ * without the CLI, for language bindings and other tools to link in process.
+ * Nothing here prints; results are returned as opaque handles read through
+ * accessors.
+ *
+ * Strings are NUL-terminated UTF-8. Strings returned by an accessor belong
+ * to the handle they were read from and stay valid until it is freed. Every
+ * *_free function accepts NULL. No function lets a C++ exception escape.
+ *
+ * The ABI only grows: functions are never removed or changed within a
+ * DV_ABI_VERSION.
+ */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#if defined(DV_BUILDING_LIBRARY)
+#define DV_API __declspec(dllexport)
+#else
+#define DV_API __declspec(dllimport)
+#endif
+#else
+#define DV_API __attribute__((visibility("default")))
+#endif
+
+#define DV_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct dv_validator dv_validator;
+typedef struct dv_result dv_result;
+typedef struct dv_artifact dv_artifact;
+typedef struct dv_health dv_health;
+
+typedef enum dv_message_kind {
+  DV_MESSAGE_ERROR = 0,
+  DV_MESSAGE_WARNING = 1,
+  DV_MESSAGE_NOTE = 2
+} dv_message_kind;
+
+/* Version of the library, e.g. "1.0.0", and the DV_ABI_VERSION it was
+ * built with. */
+DV_API const char *dv_version(void);
+DV_API int dv_abi_version(void);
+
+/* Message of the last failed call on this thread; "" if there is none. */
+DV_API const char *dv_last_error(void);
+
+/* Validators. Once configured, one validator may validate from several
+ * threads at once; the setters must not run concurrently with validation.
+ * dv_validator_new returns NULL only when out of memory. */
+DV_API dv_validator *dv_validator_new(void);
+DV_API void dv_validator_free(dv_validator *validator);
+
+/* Also checks Kubernetes manifests against the bundled schemas of `version`
+ * ("1.24" to "1.30", or "latest"); NULL turns the check off. Returns 0, or
+ * -1 with dv_last_error() set. */
+DV_API int dv_validator_set_kubernetes_version(dv_validator *validator,
+                                               const char *version);
+
+/* Also checks JSON and YAML documents against the JSON Schema at `path`;
+ * NULL turns the check off. Returns 0, or -1 with dv_last_error() set. */
+DV_API int dv_validator_set_schema_file(dv_validator *validator,
+                                        const char *path);
+
+/* Validate a file on disk, or `size` bytes at `data` as if read from a file
+ * called `name` (which selects the format, e.g. "deployment.yaml"). Failures
+ * such as an unreadable file are reported as errors in the result; NULL is
+ * only returned for NULL arguments or when out of memory. */
+DV_API dv_result *dv_validate_file(dv_validator *validator, const char *path);
+DV_API dv_result *dv_validate_buffer(dv_validator *validator,
+                                     const char *data, size_t size,
+                                     const char *name);
+
+DV_API int dv_result_valid(const dv_result *result);
+DV_API const char *dv_result_file_type(const dv_result *result);
+DV_API size_t dv_result_message_count(const dv_result *result,
+                                      dv_message_kind kind);
+/* NULL when `index` is out of range. */
+DV_API const char *dv_result_message(const dv_result *result,
+                                     dv_message_kind kind, size_t index);
+DV_API void dv_result_free(dv_result *result);
+
+/* Inspects a package, container or archive artifact. A missing file gives
+ * an invalid artifact with an "Error" metadata entry; NULL is only returned
+ * for a NULL path or when out of memory. */
+DV_API dv_artifact *dv_analyze_artifact(const char *path);
+
+DV_API int dv_artifact_valid(const dv_artifact *artifact);
+DV_API const char *dv_artifact_name(const dv_artifact *artifact);
+DV_API const char *dv_artifact_type(const dv_artifact *artifact);
+DV_API const char *dv_artifact_size(const dv_artifact *artifact);
+DV_API size_t dv_artifact_dependency_count(const dv_artifact *artifact);
+DV_API const char *dv_artifact_dependency(const dv_artifact *artifact,
+                                          size_t index);
+/* Metadata entries in key order. */
+DV_API size_t dv_artifact_metadata_count(const dv_artifact *artifact);
+DV_API const char *dv_artifact_metadata_key(const dv_artifact *artifact,
+                                            size_t index);
+DV_API const char *dv_artifact_metadata_value(const dv_artifact *artifact,
+                                              size_t index);
+DV_API void dv_artifact_free(dv_artifact *artifact);
+
+/* Runs the system, tool and environment checks of `devops-validator health`.
+ * Returns NULL only when out of memory. */
+DV_API dv_health *dv_check_health(void);
+
+DV_API int dv_health_healthy(const dv_health *health);
+DV_API size_t dv_health_issue_count(const dv_health *health);
+DV_API const char *dv_health_issue(const dv_health *health, size_t index);
+DV_API size_t dv_health_warning_count(const dv_health *health);
+DV_API const char *dv_health_warning(const dv_health *health, size_t index);
+/* System information, tool versions and environment variables, in key
+ * order. */
+DV_API size_t dv_health_info_count(const dv_health *health);
+DV_API const char *dv_health_info_key(const dv_health *health, size_t index);
+DV_API const char *dv_health_info_value(const dv_health *health,
+                                        size_t index);
+DV_API void dv_health_free(dv_health *health);
+
+#ifdef __cplusplus
+}
+#endif
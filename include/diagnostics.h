@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace devops {
+
+// One message of a ValidationResult. `text` points into the Diagnostics it
+// came from and is only valid while that is neither modified nor destroyed.
+struct Diagnostic {
+  std::string_view text;
+  uint32_t line = 0; // 1-based; 0 when the message has no position
+  uint32_t column = 0;
+
+  // The message as shown to users, "Line 3, column 7: text" when it has a
+  // position.
+  std::string str() const;
+  void appendTo(std::string &out) const;
+};
+
+std::ostream &operator<<(std::ostream &out, const Diagnostic &diagnostic);
+
+// The errors, warnings or notes of a result. Message text is written once,
+// back to back, into chunks owned by the list instead of one heap string
+// per message; positions are kept as numbers and only formatted when the
+// message is rendered. Moving a list, or appending an rvalue one, hands its
+// chunks over without copying any text.
+class Diagnostics {
+public:
+  using const_iterator = std::vector<Diagnostic>::const_iterator;
+
+  Diagnostics() = default;
+  Diagnostics(const Diagnostics &other);
+  Diagnostics(Diagnostics &&other) noexcept;
+  Diagnostics &operator=(const Diagnostics &other);
+  Diagnostics &operator=(Diagnostics &&other) noexcept;
+  ~Diagnostics();
+
+  void push_back(std::string_view text) { add({text}); }
+  void push_back(const Diagnostic &diagnostic) {
+    add({diagnostic.text}, diagnostic.line, diagnostic.column);
+  }
+
+  // Adds the concatenation of `parts` as one message, so that messages built
+  // from several pieces need no temporary string.
+  void add(std::initializer_list<std::string_view> parts, uint32_t line = 0,
+           uint32_t column = 0);
+
+  void append(const Diagnostics &other);
+  void append(Diagnostics &&other);
+
+  // Stable, so messages on the same line keep the order they were added in.
+  void sortByLine();
+
+  void clear();
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  const Diagnostic &operator[](size_t index) const { return entries_[index]; }
+  const Diagnostic &front() const { return entries_.front(); }
+  const Diagnostic &back() const { return entries_.back(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+  // Every message rendered with str().
+  std::vector<std::string> strings() const;
+
+private:
+  // Text storage, linked so that a list with one chunk costs one
+  // allocation.
+  struct Chunk {
+    Chunk *next;
+  };
+
+  // Enough for the few short messages most results have.
+  static constexpr size_t MIN_CHUNK = 128;
+
+  char *allocate(size_t size);
+  static void release(Chunk *chunks);
+
+  std::vector<Diagnostic> entries_;
+  Chunk *chunks_ = nullptr; // newest first
+  char *free_ = nullptr;    // unused tail of the newest chunk
+  size_t available_ = 0;
+  size_t nextChunk_ = MIN_CHUNK;
+};
+
+} // namespace devops
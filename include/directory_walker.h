@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace devops {
+
+class WorkStealingPool;
+struct IgnoreChain;
+
+// The patterns of one .gitignore-style file, compiled once. Supports
+// comments, `!` negation, trailing `/` for directories only, leading or
+// inner `/` anchoring, `*`, `?`, `[...]` classes and `**`.
+class IgnoreRules {
+public:
+  // `base` is the directory holding the file, relative to the walk root
+  // ("" for the root itself).
+  IgnoreRules(std::string_view text, std::string base);
+
+  // 1 if the last matching pattern ignores `path` (relative to the walk
+  // root), -1 if it re-includes it, 0 if no pattern matches.
+  int match(std::string_view path, bool directory) const;
+
+  size_t size() const { return rules_.size(); }
+
+private:
+  struct Rule {
+    enum Kind { Literal, Suffix, Glob };
+    std::string pattern;
+    Kind kind = Literal;
+    bool negated = false;
+    bool directoryOnly = false;
+    // Matched against the whole path below `base_` rather than the name.
+    bool anchored = false;
+  };
+
+  std::vector<Rule> rules_;
+  std::string base_; // "" or ending in '/'
+};
+
+struct WalkOptions {
+  // Honour .gitignore and .devopsignore files found during the walk; in a
+  // directory with both, .devopsignore takes precedence.
+  bool ignoreFiles = true;
+  // Skip VCS metadata, node_modules, vendor and the validation cache
+  // unless an ignore file re-includes them.
+  bool defaultExcludes = true;
+};
+
+struct WalkStats {
+  uint64_t directories = 0; // directories read
+  uint64_t files = 0;       // files reported
+  uint64_t pruned = 0;      // directories skipped without being read
+  uint64_t ignored = 0;     // files skipped by ignore rules
+  uint64_t stats = 0;       // entries whose type needed a stat call
+  double elapsedMs = 0;
+  // Directories that could not be read; the walk continues past them.
+  std::vector<std::string> errors;
+};
+
+// Whether a walk of `root` would skip a path, for paths seen after the
+// walk (e.g. by a watcher): the path or one of its directories is matched
+// by the default excludes or by an ignore file on the way down. Ignore
+// files are read on first use and kept until reload(). Not thread-safe.
+class IgnoreMatcher {
+public:
+  IgnoreMatcher(std::string root, WalkOptions options);
+  ~IgnoreMatcher();
+
+  // `path` is joined onto the root the way walk() reports it; paths
+  // outside the root are never ignored.
+  bool ignored(const std::string &path, bool directory) const;
+
+  // Forgets the ignore files read so far, after one of them changed.
+  void reload();
+
+  // .gitignore or .devopsignore.
+  static bool isIgnoreFile(const std::string &path);
+
+private:
+  // Rules in effect for files directly in `rel` ("" for the root).
+  std::shared_ptr<const IgnoreChain> chain(const std::string &rel) const;
+
+  std::string root_;
+  WalkOptions options_;
+  mutable std::unordered_map<std::string, std::shared_ptr<const IgnoreChain>>
+      chains_;
+};
+
+// Recursive file walk that reads directories with openat and getdents64
+// (readdir elsewhere), takes entry types from d_type so most entries need
+// no stat, and applies ignore rules before descending so excluded trees
+// are never read. Symlinks to files are reported; symlinked directories
+// are not followed.
+class DirectoryWalker {
+public:
+  using FileCallback = std::function<void(const std::string &path)>;
+
+  explicit DirectoryWalker(WalkOptions options = {});
+
+  // Calls `onFile` for every regular file under `root` that is not
+  // ignored, with paths joined onto `root` the way std::filesystem does.
+  // With a pool, subtrees are read by its workers in parallel and `onFile`
+  // runs on them concurrently. Returns when the walk is done; tasks that
+  // `onFile` submitted may still be running. Throws std::runtime_error if
+  // `root` cannot be read.
+  WalkStats walk(const std::string &root, const FileCallback &onFile,
+                 WorkStealingPool *pool = nullptr) const;
+
+private:
+  WalkOptions options_;
+};
+
+} // namespace devops
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "directory_walker.h"
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace devops {
+
+// Changes under the watched tree, coalesced over one debounce window.
+struct WatchBatch {
+  // Files that exist and were written, created or renamed into place.
+  std::vector<std::string> changed;
+  // Files deleted or renamed away.
+  std::vector<std::string> removed;
+  // Directories deleted or renamed away; everything below them is gone.
+  std::vector<std::string> removedDirectories;
+  // The kernel dropped events; the caller should rescan the whole tree.
+  bool overflow = false;
+  // When the first event of the batch was read.
+  std::chrono::steady_clock::time_point firstEvent;
+};
+
+// Recursive directory watch on inotify. Events are read until the tree has
+// been quiet for DEBOUNCE_MS (or MAX_DELAY_MS passed since the first one)
+// and then coalesced per path, so an editor's write-rename-chmod storm on
+// save yields a single change. Whether a touched path counts as changed or
+// removed is decided by looking at it when the batch is flushed, which
+// keeps rename-over and delete-recreate sequences correct. Directories
+// and files a DirectoryWalker with the same options would skip are not
+// watched or reported.
+//
+// Linux only; the constructor throws std::runtime_error elsewhere.
+class DirectoryWatcher {
+public:
+  static constexpr int DEBOUNCE_MS = 30;
+  static constexpr int MAX_DELAY_MS = 300;
+
+  explicit DirectoryWatcher(const std::string &root,
+                            const WalkOptions &options = {});
+  ~DirectoryWatcher();
+  DirectoryWatcher(const DirectoryWatcher &) = delete;
+  DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+
+  // Blocks until a batch is ready. Returns false once SIGINT or SIGTERM has
+  // been received.
+  bool next(WatchBatch &batch);
+
+  size_t directoryCount() const { return directories_.size(); }
+
+private:
+  // Watches `dir` and every directory below it. With `collectFiles` the
+  // files found on the way are marked touched, for directories created or
+  // moved in after startup.
+  void addTree(const std::string &dir, bool collectFiles);
+  // Reads every pending event. Returns false if reading failed.
+  bool drain(WatchBatch &batch);
+
+  IgnoreMatcher ignore_;
+  int fd_ = -1;
+  std::unordered_map<int, std::string> directories_; // watch descriptor
+  std::unordered_set<std::string> touched_;
+};
+
+} // namespace devops
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "diagnostics.h"
+#include <cstddef>
+#include <initializer_list>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace devops {
+
+// Diagnostics are sorted by line.
+struct EnvLexResult {
+  size_t variables = 0;
+  Diagnostics errors;
+  Diagnostics warnings;
+};
+
+// Single-pass lexer for dotenv files. Understands `export` prefixes, bare,
+// single- and double-quoted values (quoted values may span lines), backslash
+// escapes in double quotes and `#` comments, and reports 1-based line and
+// byte columns. Unterminated quotes are errors; questionable but loadable
+// lines are warnings.
+class EnvLexer {
+public:
+  explicit EnvLexer(std::string_view content) : content_(content) {}
+
+  EnvLexResult run();
+
+private:
+  void lexLine();
+  void lexDoubleQuoted();
+  void lexSingleQuoted();
+  void lexUnquoted();
+  void skipToLineEnd();
+  void finishLine();
+
+  bool atEnd() const { return pos_ >= content_.size(); }
+  char peek() const { return content_[pos_]; }
+  bool atLineEnd() const;
+  size_t column() const { return pos_ - lineStart_ + 1; }
+
+  void report(bool error, size_t line, size_t column,
+              std::initializer_list<std::string_view> message);
+
+  std::string_view content_;
+  size_t pos_ = 0;
+  size_t line_ = 1;
+  size_t lineStart_ = 0;
+  EnvLexResult result_;
+  std::vector<std::pair<std::string_view, size_t>> seen_;
+};
+
+} // namespace devops
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace devops {
+
+// What a file is, as far as validate and analyze are concerned. The first
+// five values are also part of ValidationCache keys; do not reorder them.
+enum class FileType : uint32_t {
+  Unknown,
+  Json,
+  Yaml,
+  Toml,
+  Env,
+  Deb,
+  Rpm,
+  Tar,
+  Gzip,
+  Zip,
+  Dockerfile,
+  Xz,
+  Zstd,
+};
+
+// Classifies files by name and, failing that, by their first bytes. Name
+// lookups go through a perfect hash table built at compile time over
+// extensions and well-known file names; nothing allocates.
+class FileTypeDetector {
+public:
+  // Bytes fromContent() looks at; enough for the tar header magic.
+  static constexpr size_t SNIFF_BYTES = 512;
+
+  // From the file name alone: the extension (case-insensitive), names such
+  // as Dockerfile and .env, and .env.* / Dockerfile.* variants. Directory
+  // components are ignored.
+  static FileType fromName(std::string_view path);
+
+  // From the start of the content: ar (.deb), RPM lead, gzip, xz, zstd, zip
+  // and tar magic, then JSON, YAML, TOML, ENV and Dockerfile heuristics on
+  // the first line that is not blank or a comment.
+  static FileType fromContent(std::string_view head);
+
+  // fromName, falling back to fromContent on the first SNIFF_BYTES of the
+  // file when the name says nothing.
+  static FileType detectFile(const std::string &path);
+
+  static bool isConfig(FileType type);
+  static bool isArtifact(FileType type);
+  // Tar, zip, and tar or single files compressed with gzip, xz or zstd.
+  static bool isArchive(FileType type);
+
+  // "JSON", "YAML", ..., "DEB package", "gzip archive", "unknown".
+  static const char *name(FileType type);
+};
+
+} // namespace devops
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace devops {
+
+class MappedFile;
+
+// SHA-1 object id. Repositories using SHA-256 object format are rejected.
+struct GitOid {
+  std::array<uint8_t, 20> bytes{};
+
+  std::string hex() const;
+  bool operator==(const GitOid &other) const { return bytes == other.bytes; }
+  bool operator!=(const GitOid &other) const { return bytes != other.bytes; }
+};
+
+struct GitTreeEntry {
+  std::string path; // '/'-separated, relative to the tree root
+  GitOid blob;
+};
+
+// Read-only access to a local repository's object store, without a
+// checkout or the git binary: loose objects and packfiles (index v2,
+// OFS_DELTA and REF_DELTA chains) are inflated with zlib directly.
+// Reads are thread-safe.
+class GitRepository {
+public:
+  // `path` may be a work tree, a `.git` directory or a bare repository.
+  // Throws std::runtime_error if no repository is found there.
+  explicit GitRepository(const std::string &path);
+  ~GitRepository();
+
+  // Resolves a revision to a commit: HEAD, branch, tag and remote names,
+  // full or abbreviated ids, and any chain of `^`, `^N`, `~N` and `^{}`
+  // suffixes. Annotated tags are peeled. Throws std::runtime_error.
+  GitOid resolve(const std::string &rev) const;
+
+  // Every regular file in the commit's tree, sorted by path. Symlinks and
+  // submodules are skipped.
+  std::vector<GitTreeEntry> listFiles(const GitOid &commit) const;
+
+  // Files of `commit` whose blob differs from the same path in `base`,
+  // including files `base` does not have. Subtrees with equal ids are not
+  // descended into, so cost scales with the size of the change.
+  std::vector<GitTreeEntry> listChangedFiles(const GitOid &base,
+                                             const GitOid &commit) const;
+
+  std::string readBlob(const GitOid &id) const;
+
+  const std::string &gitDir() const { return gitDir_; }
+
+private:
+  enum ObjectType { COMMIT = 1, TREE = 2, BLOB = 3, TAG = 4 };
+
+  struct Object {
+    int type = 0;
+    std::string data;
+  };
+
+  struct Pack;
+
+  Object readObject(const GitOid &id) const;
+  bool readLoose(const GitOid &id, Object &object) const;
+  bool readPacked(const GitOid &id, Object &object) const;
+  std::shared_ptr<const Object> readPackEntry(const Pack &pack, uint64_t offset,
+                                              int depth) const;
+
+  GitOid treeOf(const GitOid &commit) const;
+  GitOid peel(GitOid id) const;
+  GitOid parent(const GitOid &commit, unsigned n) const;
+  bool resolveRef(const std::string &name, GitOid &id, int depth = 0) const;
+  bool resolvePrefix(const std::string &hex, GitOid &id) const;
+
+  void walkTree(const GitOid &tree, const std::string &prefix,
+                std::vector<GitTreeEntry> &out) const;
+  void diffTree(const GitOid *base, const GitOid &tree,
+                const std::string &prefix,
+                std::vector<GitTreeEntry> &out) const;
+
+  std::string gitDir_;
+  std::string commonDir_; // differs from gitDir_ in linked worktrees
+  std::vector<std::unique_ptr<Pack>> packs_;
+
+  // Delta bases are usually shared by many objects in a chain; recently
+  // inflated pack entries are kept, up to BASE_CACHE_BYTES.
+  static constexpr size_t BASE_CACHE_BYTES = 64 * 1024 * 1024;
+  struct CacheKey {
+    const Pack *pack;
+    uint64_t offset;
+    bool operator==(const CacheKey &other) const {
+      return pack == other.pack && offset == other.offset;
+    }
+  };
+  struct CacheKeyHasher {
+    size_t operator()(const CacheKey &key) const {
+      return std::hash<uint64_t>()(key.offset) ^
+             std::hash<const void *>()(key.pack);
+    }
+  };
+  mutable std::mutex cacheMutex_;
+  mutable std::list<std::pair<CacheKey, std::shared_ptr<const Object>>> lru_;
+  mutable std::unordered_map<
+      CacheKey,
+      std::list<std::pair<CacheKey, std::shared_ptr<const Object>>>::iterator,
+      CacheKeyHasher>
+      cache_;
+  mutable size_t cacheBytes_ = 0;
+};
+
+} // namespace devops
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace devops {
+
+// Non-cryptographic hashing used to key caches on file content.
+class Hash {
+public:
+  // XXH64: ~10 GB/s on current hardware, stable across runs and platforms.
+  static uint64_t xxh64(const void *data, size_t length, uint64_t seed = 0);
+
+  static uint64_t xxh64(std::string_view data, uint64_t seed = 0) {
+    return xxh64(data.data(), data.size(), seed);
+  }
+};
+
+} // namespace devops
@@ -13,6 +13,8 @@ struct HealthCheckResult {
   std::map<std::string, std::string> systemInfo;
 };
 
+// The check* methods only collect results; printReport() runs them all and
+// prints.
 class HealthChecker {
 public:
   HealthCheckResult checkSystem();
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace devops {
+
+struct JsonScanResult {
+  bool valid = true;
+  // Same convention as nlohmann::json::parse_error::byte: the 1-based count
+  // of bytes read when the error was detected (length + 1 at end of input).
+  size_t errorByte = 0;
+  size_t errorLine = 0;
+  size_t errorColumn = 0;
+  std::string error;
+  // The document is well-formed but holds a number too large for a double,
+  // which nlohmann rejects as out_of_range without a position. `error`
+  // holds the message; errorByte, errorLine and errorColumn are unset.
+  bool numberOverflow = false;
+
+  bool emptyRootObject = false;
+  // Top-level "version" member, when it is a string (last one wins, like
+  // nlohmann's object insertion).
+  bool hasVersion = false;
+  std::string version;
+};
+
+// Validate-only JSON backend. Stage 1 classifies 64-byte blocks with SIMD
+// (AVX2 or SSE4.2, picked at runtime, with a portable scalar fallback) into
+// a structural index of the brackets, separators, string starts and scalar
+// starts that lie outside strings, validating escapes, control characters
+// and UTF-8 on the way. Stage 2 walks the index with a small grammar stack.
+// No DOM is built; only the few facts the validator reports are extracted.
+class JsonScanner {
+public:
+  enum class SimdLevel { Scalar, SSE42, AVX2 };
+
+  // Structural positions are indexed as 32-bit offsets.
+  static constexpr size_t MAX_INPUT_SIZE = 0xFFFFFFFFu;
+
+  static JsonScanResult scan(std::string_view input);
+
+  // Forces a code path (clamped to what the CPU supports); used by the
+  // benchmark to compare implementations.
+  static JsonScanResult scan(std::string_view input, SimdLevel level);
+
+  static SimdLevel detectedLevel();
+  static const char *levelName(SimdLevel level);
+};
+
+} // namespace devops
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace devops {
+
+struct SchemaViolation {
+  std::string path; // JSON pointer into the instance, "" for the root
+  std::string message;
+};
+
+// A JSON Schema (draft 2020-12 subset) compiled into a flat table of nodes.
+// `$ref`s are resolved to node indices once, `pattern` and
+// `patternProperties` are compiled regexes and `properties` are hash
+// lookups, so validating a document is a walk over the instance with no
+// schema interpretation left.
+//
+// Supported keywords: type, enum, const, required, properties,
+// patternProperties, additionalProperties, items, minItems, maxItems,
+// minLength, maxLength, pattern, minimum, maximum, exclusiveMinimum,
+// exclusiveMaximum, allOf, anyOf, oneOf, not and local `$ref`s (including
+// into `$defs` / `definitions`). Other keywords are ignored.
+class CompiledSchema {
+public:
+  ~CompiledSchema();
+
+  // Throws std::runtime_error for malformed schemas and unresolvable refs.
+  static std::shared_ptr<const CompiledSchema>
+  compile(const nlohmann::json &schema, uint64_t hash = 0);
+
+  // Compiles the subschema at JSON pointer `entry` of `document`; `$ref`s
+  // resolve against the whole document. Used for schema bundles that keep
+  // many entry points under shared definitions.
+  static std::shared_ptr<const CompiledSchema>
+  compile(const nlohmann::json &document, const std::string &entry,
+          uint64_t hash);
+
+  // Compiles the schema file at `path`. When `cacheDir` is not empty the
+  // compiled table is kept in <cacheDir>/schemas/<hash>.cbor and reused
+  // while the file content is unchanged.
+  static std::shared_ptr<const CompiledSchema>
+  loadFile(const std::string &path, const std::string &cacheDir);
+
+  // Returns false when the instance does not match, appending at most
+  // `maxViolations` violations.
+  bool validate(const nlohmann::json &instance,
+                std::vector<SchemaViolation> &violations,
+                size_t maxViolations = 20) const;
+
+  uint64_t hash() const { return hash_; }
+  size_t nodeCount() const;
+  bool loadedFromCache() const { return loadedFromCache_; }
+
+private:
+  struct Node;
+  class Compiler;
+
+  CompiledSchema();
+
+  bool check(uint32_t index, const nlohmann::json &instance,
+             std::string &path, std::vector<SchemaViolation> *violations,
+             size_t maxViolations) const;
+
+  nlohmann::json serialize() const;
+  static std::shared_ptr<CompiledSchema>
+  deserialize(const nlohmann::json &table);
+
+  std::vector<Node> nodes_;
+  uint64_t hash_ = 0;
+  bool loadedFromCache_ = false;
+};
+
+} // namespace devops
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace devops {
+
+class CompiledSchema;
+
+// Schemas for the built-in Kubernetes kinds, bundled into the binary so
+// manifests can be checked with no cluster and no network. The bundle is a
+// curated subset of the upstream OpenAPI definitions: top-level objects,
+// metadata, pod templates, containers and the specs of the common
+// workload, networking, policy, autoscaling and RBAC kinds are closed, so
+// misspelled fields are reported; deeper structures are only type-checked.
+//
+// One instance targets one Kubernetes minor version. Construction compiles
+// every kind that version serves into an index keyed by apiVersion and
+// kind, so checking a manifest is one hash lookup plus one schema walk.
+class KubernetesSchemas {
+public:
+  static constexpr int MIN_MINOR = 24;
+  static constexpr int MAX_MINOR = 30;
+
+  // Accepts "1.29", "v1.29", "1.29.3" or "latest". Throws
+  // std::runtime_error for versions outside the bundled range.
+  explicit KubernetesSchemas(const std::string &version);
+  ~KubernetesSchemas();
+
+  struct Match {
+    enum class Status {
+      Checked,   // `schema` is set
+      Unchecked, // served, but the bundle has no schema for it
+      Unknown,   // not a built-in kind, e.g. a CustomResource
+      NotServed, // added after or removed before the target version
+    };
+    Status status = Status::Unknown;
+    const CompiledSchema *schema = nullptr;
+    std::string reason; // set for NotServed
+  };
+
+  Match find(const std::string &apiVersion, const std::string &kind) const;
+
+  // "1.<minor>"
+  std::string version() const;
+  size_t kindCount() const { return index_.size(); }
+  // Identifies bundle and version, for keying cached results.
+  uint64_t hash() const { return hash_; }
+
+  static std::string supportedVersions();
+
+private:
+  struct Entry {
+    std::shared_ptr<const CompiledSchema> schema;
+    int added = 0;
+    int removed = 0; // 0 while still served
+  };
+
+  int minor_;
+  uint64_t hash_;
+  std::unordered_map<std::string, Entry> index_;
+};
+
+} // namespace devops
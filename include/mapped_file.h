@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace devops {
+
+// Read-only view of a whole file. Files larger than SMALL_FILE_LIMIT are
+// memory-mapped so their bytes are never copied into the heap; smaller files
+// take a single read() into an owned buffer, which is cheaper than setting up
+// a mapping. The view stays valid for the lifetime of the object.
+class MappedFile {
+public:
+  static constexpr size_t SMALL_FILE_LIMIT = 64 * 1024;
+
+  // Counters shared by every MappedFile in the process.
+  struct Stats {
+    uint64_t filesMapped;
+    uint64_t bytesMapped;
+    uint64_t filesRead;
+    uint64_t bytesCopied;
+  };
+
+  MappedFile() = default;
+  // Throws std::runtime_error if the file cannot be opened or read.
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  std::string_view view() const { return std::string_view(data_, size_); }
+  size_t size() const { return size_; }
+  bool mapped() const { return mapped_; }
+
+  static Stats stats();
+
+private:
+  void release();
+
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::unique_ptr<char[]> buffer_;
+};
+
+} // namespace devops
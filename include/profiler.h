@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace devops {
+
+// Process-wide phase timings for --profile and --trace. Each thread records
+// into its own buffer, so workers never contend; while disabled, a
+// ProfileScope costs one relaxed load and a predictable branch.
+class Profiler {
+public:
+  // Starts recording; timestamps in the trace are relative to this call.
+  static void enable();
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Steady-clock nanoseconds.
+  static uint64_t now();
+
+  // Adds one completed span. `phase` must be a string literal.
+  static void record(const char *phase, std::string_view detail,
+                     uint64_t start, uint64_t end);
+
+  // Per-phase count, total, p50 and p99 to Report::out(). Call once the
+  // work is done; spans still being recorded may be missed.
+  static void printSummary();
+
+  // Chrome trace-event JSON (chrome://tracing, Perfetto) with one track per
+  // thread. Throws std::runtime_error if `path` cannot be written.
+  static void writeTrace(const std::string &path);
+
+private:
+  static inline std::atomic<bool> enabled_{false};
+};
+
+// Times the enclosing scope as `phase` when profiling is enabled. `detail`
+// (typically a path) is shown in the trace and must outlive the scope.
+class ProfileScope {
+public:
+  explicit ProfileScope(const char *phase, std::string_view detail = {})
+      : phase_(Profiler::enabled() ? phase : nullptr) {
+    if (phase_) {
+      detail_ = detail;
+      start_ = Profiler::now();
+    }
+  }
+
+  ~ProfileScope() {
+    if (phase_) {
+      Profiler::record(phase_, detail_, start_, Profiler::now());
+    }
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  const char *phase_;
+  std::string_view detail_;
+  uint64_t start_ = 0;
+};
+
+} // namespace devops
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "corpus_generator.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace devops {
+
+// Per-file cost of one validator, one entry per trial.
+struct BenchSamples {
+  uint64_t files = 0;
+  uint64_t bytes = 0;
+  std::vector<double> nsPerFile;
+  std::vector<double> allocsPerFile;
+};
+
+// The result of one `bench` run, as saved with --save.
+struct BenchRun {
+  std::string toolVersion;
+  // The directory that was benchmarked; empty for a generated corpus.
+  std::string corpusDir;
+  CorpusOptions generated; // meaningful when corpusDir is empty
+  unsigned trials = 0;
+  unsigned cpus = 0;
+  std::map<std::string, BenchSamples> validators; // "json", "yaml", ...
+};
+
+// A validator's time or allocations, baseline against current.
+struct BenchChange {
+  std::string validator;
+  std::string metric; // "time" (ns/file) or "allocs" (allocations/file)
+  double baseline = 0; // medians over the trials
+  double current = 0;
+  double changePercent = 0;
+  double pValue = 1;
+  bool significant = false;
+  bool regression = false; // significant and slower than the threshold
+};
+
+// Fixed validation workload for catching slowdowns between releases. Each
+// trial validates every config file of the corpus in memory with each
+// validator; runs are compared trial by trial with a Mann-Whitney U test,
+// which does not assume timings are normally distributed.
+class RegressionBench {
+public:
+  // Version of the JSON written by save(); load() rejects other versions.
+  static constexpr int FORMAT_VERSION = 1;
+  // Two-sided p-value below which a change counts as real. Six trials a
+  // side is the fewest that can reach it.
+  static constexpr double SIGNIFICANCE = 0.01;
+  static constexpr unsigned DEFAULT_TRIALS = 10;
+  static constexpr size_t DEFAULT_FILES = 600;
+
+  // Benchmarks the config files under `corpusDir`, or a corpus generated
+  // with `generated` in a temporary directory when it is empty. Throws
+  // std::runtime_error if there is nothing to validate.
+  static BenchRun run(const std::string &corpusDir,
+                      const CorpusOptions &generated, unsigned trials);
+
+  // Throw std::runtime_error on I/O errors and, for load(), on files that
+  // are not a supported bench result.
+  static void save(const BenchRun &run, const std::string &path);
+  static BenchRun load(const std::string &path);
+
+  // One entry per metric of every validator in both runs. Regressions are
+  // significant changes above `thresholdPercent`.
+  static std::vector<BenchChange> compare(const BenchRun &baseline,
+                                          const BenchRun &current,
+                                          double thresholdPercent);
+
+  static void printRun(const BenchRun &run);
+  // Returns the number of regressions.
+  static size_t printComparison(const std::vector<BenchChange> &changes);
+
+  // Two-sided p-value of the Mann-Whitney U test, by the normal
+  // approximation with tie correction.
+  static double mannWhitneyP(const std::vector<double> &a,
+                             const std::vector<double> &b);
+
+  static double median(std::vector<double> values);
+};
+
+} // namespace devops
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "config_validator.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace devops {
+
+// How validation results are written. Human is the coloured text the tool
+// has always printed. The others are for CI: stdout carries only the
+// machine-readable report, and progress and summaries go to stderr.
+enum class ReportFormat { Human, JsonLines, Sarif, JUnit };
+
+// Auto enables colour only when the stream is a terminal and NO_COLOR is
+// not set.
+enum class ColorMode { Auto, Always, Never };
+
+// File results rendered by one worker. Rendering is most of the cost of
+// output, so workers fill their own buffers and the main thread merges them
+// into the report in a deterministic order.
+class ReportBuffer {
+public:
+  // `header` adds the "Validating: <path>" line used when several files
+  // are reported together.
+  void addFile(const std::string &path, const ValidationResult &result,
+               bool header = true);
+
+private:
+  friend class Report;
+  std::string text_;
+  // Kept whole for SARIF and JUnit, which are written at the end.
+  std::vector<std::pair<std::string, ValidationResult>> records_;
+  size_t files_ = 0;
+  size_t invalid_ = 0;
+};
+
+// Process-wide output. Text is collected per stream and written in large
+// chunks instead of one flush per line; flush() forces it out, and
+// whatever is left is written at exit.
+class Report {
+public:
+  enum class Level { Success, Error, Warning, Info };
+
+  // "human", "jsonl", "sarif" or "junit".
+  static bool parseFormat(const std::string &name, ReportFormat &format);
+  // "auto", "always" or "never".
+  static bool parseColorMode(const std::string &name, ColorMode &mode);
+
+  // Call before anything is written.
+  static void configure(ReportFormat format, ColorMode color);
+  static ReportFormat format();
+
+  // Human-readable text: stdout in the Human format, stderr otherwise.
+  // Colour codes are dropped when colour is off. Main thread only.
+  static std::ostream &out();
+
+  // One message line, as Utils::printInfo and friends write. Thread-safe.
+  // Errors go to stderr, after out() has been flushed to keep their order.
+  static void message(Level level, const std::string &text);
+
+  // Adds one file result to the report. Main thread only.
+  static void fileResult(const std::string &path,
+                         const ValidationResult &result, bool header = false);
+  // Appends a worker's buffer and empties it. Main thread only.
+  static void merge(ReportBuffer &buffer);
+
+  // Writes everything buffered so far. SARIF and JUnit documents are only
+  // written by finish().
+  static void flush();
+  // Writes the SARIF or JUnit document, or the JSON Lines summary, and
+  // flushes. Later calls do nothing.
+  static void finish();
+
+  // Bytes written to stdout and stderr, and time spent in those writes.
+  static uint64_t bytesWritten();
+  static uint64_t writeNanoseconds();
+};
+
+} // namespace devops
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace devops {
+
+// One Requires or Provides entry, e.g. "libc.so.6(GLIBC_2.34)(64bit)" or
+// "bash >= 4.0".
+struct RpmDependency {
+  std::string name;
+  std::string op; // "<", "<=", "=", ">=", ">"; empty without version
+  std::string version;
+
+  std::string str() const;
+};
+
+// What the main header of an RPM file says about the package.
+struct RpmPackage {
+  std::string name;
+  std::string version;
+  std::string release;
+  std::string epoch; // empty when the package has none
+  std::string arch;
+  std::string summary;
+  std::string license;
+  uint64_t installedSize = 0; // bytes
+  bool source = false;        // a .src.rpm
+  std::string payloadFormat;     // "cpio"
+  std::string payloadCompressor; // "gzip", "xz", "zstd", ...
+  std::vector<RpmDependency> requirements;
+  std::vector<RpmDependency> provides;
+  std::vector<std::string> files;
+  uint64_t headerBytes = 0; // bytes read from the file
+
+  // Reads the lead, the size of the signature header and the main header
+  // with one positioned read each, so only header bytes are read and the
+  // compressed payload after them never is. Throws std::runtime_error for
+  // files that are not RPM packages or whose headers are corrupt.
+  static RpmPackage read(const std::string &path);
+};
+
+} // namespace devops
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace devops {
+
+struct TomlParseResult {
+  bool valid = true;
+  // Position and description of the first syntax or semantic error.
+  size_t errorLine = 0;
+  size_t errorColumn = 0;
+  std::string error;
+
+  size_t keys = 0;
+  size_t tables = 0;
+};
+
+// Validating TOML 1.0 parser. It makes one pass over the buffer without
+// building a value tree; only the key structure is kept so that duplicate
+// keys, table redefinitions and illegal extensions of inline tables, arrays
+// and dotted-key tables are detected. Stops at the first error and reports
+// its 1-based line and byte column.
+class TomlParser {
+public:
+  explicit TomlParser(std::string_view content);
+  ~TomlParser();
+
+  TomlParseResult run();
+
+private:
+  struct Node;
+
+  void parseDocument();
+  void parseTableHeader();
+  void parseArrayTableHeader();
+  void parseKeyValue(Node &table);
+  std::vector<std::string> parseKey();
+  void parseValue(Node &node);
+  void parseArray();
+  void parseInlineTable(Node &node);
+  void parseScalar();
+  void parseBasicString(std::string *out);
+  void parseMultilineBasicString();
+  void parseLiteralString(std::string *out);
+  void parseMultilineLiteralString();
+  void parseEscape(std::string *out);
+
+  void checkNumber(std::string_view token, size_t column);
+  void checkDateTime(std::string_view token, size_t column);
+  void checkTime(std::string_view token, size_t column);
+
+  Node &descendForHeader(const std::vector<std::string> &keys, size_t count,
+                         const std::string &header, size_t line,
+                         size_t column);
+
+  void skipWhitespace();
+  void skipComment();
+  void skipBlankLinesAndComments();
+  void expectLineEnd();
+  bool atNewline() const;
+  void consumeNewline();
+  void consumeUtf8();
+  bool atEnd() const { return pos_ >= content_.size(); }
+  char peek() const { return content_[pos_]; }
+  size_t column() const { return pos_ - lineStart_ + 1; }
+
+  [[noreturn]] void fail(const std::string &message) const;
+  [[noreturn]] void failAt(size_t line, size_t column,
+                           const std::string &message) const;
+
+  std::string_view content_;
+  size_t pos_ = 0;
+  size_t line_ = 1;
+  size_t lineStart_ = 0;
+
+  std::unique_ptr<Node> root_;
+  Node *current_ = nullptr;
+  TomlParseResult result_;
+};
+
+} // namespace devops
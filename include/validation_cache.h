@@ -0,0 +1,84 @@
+#pragma once
+
+#include "config_validator.h"
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace devops {
+
+// Bump whenever any validator can produce a different ValidationResult for
+// the same input, so results cached by older builds are discarded.
+constexpr uint32_t kValidatorRevision = 6;
+
+struct CacheKey {
+  uint64_t hash;
+  uint64_t size;
+  uint32_t kind;
+
+  bool operator==(const CacheKey &other) const {
+    return hash == other.hash && size == other.size && kind == other.kind;
+  }
+};
+
+struct CacheKeyHasher {
+  size_t operator()(const CacheKey &key) const {
+    return static_cast<size_t>(key.hash ^
+                               (static_cast<uint64_t>(key.kind) << 56));
+  }
+};
+
+// On-disk cache of ValidationResults keyed by a content hash, so unchanged
+// files (and identical files anywhere in the tree) are parsed once. The
+// cache lives in a directory, by default .devops-validator-cache in the
+// working directory, and is invalidated as a whole when the validator
+// version or revision changes. Lookups and stores are thread-safe.
+class ValidationCache {
+public:
+  static constexpr const char *DEFAULT_DIRECTORY = ".devops-validator-cache";
+
+  explicit ValidationCache(std::string directory = DEFAULT_DIRECTORY);
+
+  // Loads previously saved results. A missing, corrupt or outdated cache
+  // file is not an error; the cache simply starts empty.
+  void load();
+
+  // Writes the cache back if anything was added. Returns false on I/O error.
+  bool save();
+
+  // `kind` distinguishes inputs that are validated differently, e.g. the
+  // same bytes in a .json and a .yaml file.
+  // `salt` distinguishes results that depend on more than the content,
+  // such as the schema they were checked against.
+  static CacheKey makeKey(std::string_view content, uint32_t kind,
+                          uint64_t salt = 0);
+
+  bool lookup(const CacheKey &key, ValidationResult &result);
+  void store(const CacheKey &key, const ValidationResult &result);
+
+  uint64_t hits() const { return hits_.load(); }
+  uint64_t misses() const { return misses_.load(); }
+  const std::string &directory() const { return directory_; }
+
+private:
+  struct Entry {
+    ValidationResult result;
+    std::atomic<bool> used{false};
+  };
+
+  std::string resultsPath() const;
+  void loadEntries();
+
+  std::string directory_;
+  std::unordered_map<CacheKey, Entry, CacheKeyHasher> entries_;
+  std::shared_mutex mutex_;
+  bool dirty_ = false;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace devops
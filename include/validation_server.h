@@ -0,0 +1,78 @@
+#pragma once
+
+#include "config_validator.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace devops {
+
+class ValidationCache;
+class WorkStealingPool;
+
+// Long-lived validation daemon on a Unix domain socket. It keeps one
+// ConfigValidator, and with it the compiled schemas and the result cache,
+// warm across requests, so editor and pre-commit integrations only pay for
+// a connect and the validation itself.
+//
+// Protocol: newline-delimited JSON, one response line per request line,
+// any number of requests per connection.
+//   {"paths": ["/abs/file.yaml", ...]}
+//     -> {"results": [{"path", "valid", "fileType", "errors", "warnings",
+//                      "notes"}, ...]}
+//   {"command": "shutdown"} -> {"ok": true}
+// Malformed requests get {"error": "..."}. Paths are resolved by the
+// server, so clients send absolute paths.
+//
+// Every connection is served on its own thread; requests with several
+// files spread them over a shared worker pool.
+class ValidationServer {
+public:
+  // `cache` may be null. It is saved periodically and on shutdown.
+  ValidationServer(ConfigValidator &validator,
+                   std::shared_ptr<ValidationCache> cache,
+                   std::string socketPath, unsigned jobs);
+  ~ValidationServer();
+
+  // Binds the socket and serves until stop() or SIGINT/SIGTERM. Throws
+  // std::runtime_error if the socket cannot be bound, e.g. because another
+  // server is already listening on it.
+  void run();
+  void stop() { stopping_ = true; }
+
+private:
+  void serveConnection(int fd);
+  std::string handleRequest(const std::string &line);
+  std::vector<ValidationResult> validatePaths(
+      const std::vector<std::string> &paths);
+
+  ConfigValidator &validator_;
+  std::shared_ptr<ValidationCache> cache_;
+  std::string socketPath_;
+  std::unique_ptr<WorkStealingPool> pool_;
+  std::atomic<bool> stopping_{false};
+
+  std::mutex connectionsMutex_;
+  std::condition_variable connectionsDone_;
+  size_t connections_ = 0;
+};
+
+class ValidationClient {
+public:
+  using FileResult = std::pair<std::string, ValidationResult>;
+
+  // Sends `paths` to the server on `socketPath`. Returns false with `error`
+  // set when the server cannot be reached or answers with an error.
+  static bool validate(const std::string &socketPath,
+                       const std::vector<std::string> &paths,
+                       std::vector<FileResult> &results, std::string &error);
+
+  // Asks the server to exit after finishing in-flight requests.
+  static bool shutdown(const std::string &socketPath, std::string &error);
+};
+
+} // namespace devops
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace devops {
+
+// Fixed-size thread pool where every worker owns a task deque. Workers take
+// tasks from the front of their own deque and, when it runs dry, steal from
+// the back of a sibling's deque. Tasks submitted from inside a worker go to
+// that worker's deque, so recursive work stays local until someone is idle.
+class WorkStealingPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingPool(unsigned threads);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  // Tasks must not throw; a task that needs to report failure should record
+  // it in state owned by the caller.
+  void submit(Task task);
+
+  // Blocks until every submitted task (including tasks submitted by tasks)
+  // has finished running.
+  void wait();
+
+  unsigned size() const { return static_cast<unsigned>(threads_.size()); }
+
+  // Number of workers to use when the caller asked for "all cores".
+  static unsigned defaultThreadCount();
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void run(unsigned index);
+  bool popLocal(unsigned index, Task &task);
+  bool steal(unsigned thief, Task &task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable workAvailable_;
+  std::condition_variable allDone_;
+  size_t queued_ = 0;
+  size_t pending_ = 0;
+  bool stopping_ = false;
+
+  std::atomic<unsigned> nextWorker_{0};
+};
+
+} // namespace devops
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <nlohmann/json_fwd.hpp>
+#include <string>
+#include <vector>
+
+namespace devops {
+
+// What the configuration checks need to know about one YAML document.
+struct YamlDocumentFacts {
+  enum class Root { Null, Scalar, Sequence, Map };
+
+  Root root = Root::Null;
+  size_t line = 0; // 1-based line the document starts on
+
+  // Keys present in a top-level mapping.
+  bool hasServices = false;
+  bool hasVersion = false;
+  bool hasApiVersion = false;
+  bool hasKind = false;
+
+  // Top-level sequence whose first item is a mapping with "hosts".
+  bool hasHostsInFirstItem = false;
+};
+
+struct YamlStreamResult {
+  bool valid = true;
+  std::string error;
+  // Every document parsed before the first error, in stream order.
+  std::vector<YamlDocumentFacts> documents;
+};
+
+// Validates every document of a YAML stream with yaml-cpp's event parser
+// instead of YAML::Load. No node tree is built: an event handler tracks
+// the nesting and records the top-level keys the checks use, so memory
+// does not grow with document size.
+class YamlStreamScanner {
+public:
+  // Receives each document, converted to JSON, as soon as it is parsed.
+  using DocumentCallback =
+      std::function<void(size_t index, const nlohmann::json &document)>;
+
+  // When `onDocument` is set every document is also converted to JSON
+  // (YAML 1.2 core schema scalars, anchors and `<<` merge keys resolved),
+  // one document at a time.
+  static YamlStreamResult scan(std::istream &input,
+                               const DocumentCallback &onDocument = nullptr);
+};
+
+} // namespace devops
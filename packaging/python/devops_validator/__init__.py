@@ -1,6 +1,20 @@
 """
 DevOps Validator - Python wrapper.
+
+With the compiled extension (built against libdevops_validator), files and
+in-memory buffers are validated in process:
+
+    from devops_validator import Validator
+    result = Validator().validate_buffer(b'{"name": "app"}', "package.json")
+    result["valid"], result["errors"]
+
+Without it only the `devops-validator` command wrapper is available.
 """
 
 __version__ = "1.0.0"
 __author__ = "neonix888"
+
+try:
+    from ._core import Validator, analyze_artifact, check_health, version
+except ImportError:
+    pass
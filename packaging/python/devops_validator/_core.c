@@ -0,0 +1,308 @@
+/*
+ * In-process bindings to libdevops_validator through its C API. Validation
+ * runs with the GIL released, so threads validating at once run in
+ * parallel.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <string.h>
+
+#include "devops_validator.h"
+
+typedef struct {
+  PyObject_HEAD
+  dv_validator *validator;
+} ValidatorObject;
+
+typedef const char *(*Accessor)(const void *handle, size_t index);
+
+static PyObject *string(const char *value) {
+  return PyUnicode_DecodeUTF8(value, (Py_ssize_t)strlen(value), "replace");
+}
+
+static PyObject *string_list(size_t count, Accessor get, const void *handle) {
+  PyObject *list = PyList_New((Py_ssize_t)count);
+  if (!list) {
+    return NULL;
+  }
+  for (size_t i = 0; i < count; i++) {
+    PyObject *item = string(get(handle, i));
+    if (!item) {
+      Py_DECREF(list);
+      return NULL;
+    }
+    PyList_SET_ITEM(list, (Py_ssize_t)i, item);
+  }
+  return list;
+}
+
+static PyObject *string_dict(size_t count, Accessor key, Accessor value,
+                             const void *handle) {
+  PyObject *dict = PyDict_New();
+  if (!dict) {
+    return NULL;
+  }
+  for (size_t i = 0; i < count; i++) {
+    PyObject *item = string(value(handle, i));
+    if (!item || PyDict_SetItemString(dict, key(handle, i), item) < 0) {
+      Py_XDECREF(item);
+      Py_DECREF(dict);
+      return NULL;
+    }
+    Py_DECREF(item);
+  }
+  return dict;
+}
+
+/* Adapters from the typed accessors to string_list/string_dict. */
+
+static const char *result_error(const void *r, size_t i) {
+  return dv_result_message(r, DV_MESSAGE_ERROR, i);
+}
+static const char *result_warning(const void *r, size_t i) {
+  return dv_result_message(r, DV_MESSAGE_WARNING, i);
+}
+static const char *result_note(const void *r, size_t i) {
+  return dv_result_message(r, DV_MESSAGE_NOTE, i);
+}
+static const char *artifact_dependency(const void *a, size_t i) {
+  return dv_artifact_dependency(a, i);
+}
+static const char *artifact_key(const void *a, size_t i) {
+  return dv_artifact_metadata_key(a, i);
+}
+static const char *artifact_value(const void *a, size_t i) {
+  return dv_artifact_metadata_value(a, i);
+}
+static const char *health_issue(const void *h, size_t i) {
+  return dv_health_issue(h, i);
+}
+static const char *health_warning(const void *h, size_t i) {
+  return dv_health_warning(h, i);
+}
+static const char *health_key(const void *h, size_t i) {
+  return dv_health_info_key(h, i);
+}
+static const char *health_value(const void *h, size_t i) {
+  return dv_health_info_value(h, i);
+}
+
+static PyObject *raise_last_error(void) {
+  PyErr_SetString(PyExc_RuntimeError, dv_last_error());
+  return NULL;
+}
+
+/* Converts and frees `result`. */
+static PyObject *result_to_dict(dv_result *result) {
+  if (!result) {
+    return raise_last_error();
+  }
+  PyObject *dict = Py_BuildValue(
+      "{s:O,s:s,s:N,s:N,s:N}", "valid",
+      dv_result_valid(result) ? Py_True : Py_False, "file_type",
+      dv_result_file_type(result), "errors",
+      string_list(dv_result_message_count(result, DV_MESSAGE_ERROR),
+                  result_error, result),
+      "warnings",
+      string_list(dv_result_message_count(result, DV_MESSAGE_WARNING),
+                  result_warning, result),
+      "notes",
+      string_list(dv_result_message_count(result, DV_MESSAGE_NOTE),
+                  result_note, result));
+  dv_result_free(result);
+  return dict;
+}
+
+static int Validator_init(ValidatorObject *self, PyObject *args,
+                          PyObject *kwargs) {
+  static char *keywords[] = {"kubernetes_version", "schema", NULL};
+  const char *kubernetesVersion = NULL;
+  PyObject *schema = Py_None;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$zO", keywords,
+                                   &kubernetesVersion, &schema)) {
+    return -1;
+  }
+
+  dv_validator_free(self->validator);
+  self->validator = dv_validator_new();
+  if (!self->validator) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  if (kubernetesVersion &&
+      dv_validator_set_kubernetes_version(self->validator,
+                                          kubernetesVersion) < 0) {
+    PyErr_SetString(PyExc_ValueError, dv_last_error());
+    return -1;
+  }
+  if (schema != Py_None) {
+    PyObject *path = NULL;
+    if (!PyUnicode_FSConverter(schema, &path)) {
+      return -1;
+    }
+    const int status = dv_validator_set_schema_file(self->validator,
+                                                    PyBytes_AS_STRING(path));
+    Py_DECREF(path);
+    if (status < 0) {
+      PyErr_SetString(PyExc_ValueError, dv_last_error());
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static void Validator_dealloc(ValidatorObject *self) {
+  dv_validator_free(self->validator);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *Validator_validate_buffer(ValidatorObject *self,
+                                           PyObject *args,
+                                           PyObject *kwargs) {
+  static char *keywords[] = {"data", "name", NULL};
+  Py_buffer data;
+  const char *name;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s*s", keywords, &data,
+                                   &name)) {
+    return NULL;
+  }
+  dv_result *result;
+  Py_BEGIN_ALLOW_THREADS
+  result = dv_validate_buffer(self->validator, data.buf, (size_t)data.len,
+                              name);
+  Py_END_ALLOW_THREADS
+  PyBuffer_Release(&data);
+  return result_to_dict(result);
+}
+
+static PyObject *Validator_validate_file(ValidatorObject *self,
+                                         PyObject *arg) {
+  PyObject *path = NULL;
+  if (!PyUnicode_FSConverter(arg, &path)) {
+    return NULL;
+  }
+  dv_result *result;
+  Py_BEGIN_ALLOW_THREADS
+  result = dv_validate_file(self->validator, PyBytes_AS_STRING(path));
+  Py_END_ALLOW_THREADS
+  Py_DECREF(path);
+  return result_to_dict(result);
+}
+
+static PyMethodDef Validator_methods[] = {
+    {"validate_buffer", (PyCFunction)(void (*)(void))Validator_validate_buffer,
+     METH_VARARGS | METH_KEYWORDS,
+     "validate_buffer(data, name) -> dict\n\n"
+     "Validates bytes or str as if read from a file called `name`, which\n"
+     "selects the format."},
+    {"validate_file", (PyCFunction)Validator_validate_file, METH_O,
+     "validate_file(path) -> dict"},
+    {NULL, NULL, 0, NULL}};
+
+static PyTypeObject ValidatorType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "devops_validator._core.Validator",
+    .tp_basicsize = sizeof(ValidatorObject),
+    .tp_dealloc = (destructor)Validator_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Validator(*, kubernetes_version=None, schema=None)\n\n"
+              "Validates config files. Results are dicts with valid,\n"
+              "file_type, errors, warnings and notes.",
+    .tp_methods = Validator_methods,
+    .tp_init = (initproc)Validator_init,
+    .tp_new = PyType_GenericNew,
+};
+
+static PyObject *analyze_artifact(PyObject *module, PyObject *arg) {
+  (void)module;
+  PyObject *path = NULL;
+  if (!PyUnicode_FSConverter(arg, &path)) {
+    return NULL;
+  }
+  dv_artifact *artifact;
+  Py_BEGIN_ALLOW_THREADS
+  artifact = dv_analyze_artifact(PyBytes_AS_STRING(path));
+  Py_END_ALLOW_THREADS
+  Py_DECREF(path);
+  if (!artifact) {
+    return raise_last_error();
+  }
+  PyObject *dict = Py_BuildValue(
+      "{s:O,s:s,s:s,s:s,s:N,s:N}", "valid",
+      dv_artifact_valid(artifact) ? Py_True : Py_False, "name",
+      dv_artifact_name(artifact), "type", dv_artifact_type(artifact), "size",
+      dv_artifact_size(artifact), "dependencies",
+      string_list(dv_artifact_dependency_count(artifact), artifact_dependency,
+                  artifact),
+      "metadata",
+      string_dict(dv_artifact_metadata_count(artifact), artifact_key,
+                  artifact_value, artifact));
+  dv_artifact_free(artifact);
+  return dict;
+}
+
+static PyObject *check_health(PyObject *module, PyObject *unused) {
+  (void)module;
+  (void)unused;
+  dv_health *health;
+  Py_BEGIN_ALLOW_THREADS
+  health = dv_check_health();
+  Py_END_ALLOW_THREADS
+  if (!health) {
+    return raise_last_error();
+  }
+  PyObject *dict = Py_BuildValue(
+      "{s:O,s:N,s:N,s:N}", "healthy",
+      dv_health_healthy(health) ? Py_True : Py_False, "issues",
+      string_list(dv_health_issue_count(health), health_issue, health),
+      "warnings",
+      string_list(dv_health_warning_count(health), health_warning, health),
+      "info",
+      string_dict(dv_health_info_count(health), health_key, health_value,
+                  health));
+  dv_health_free(health);
+  return dict;
+}
+
+static PyObject *version(PyObject *module, PyObject *unused) {
+  (void)module;
+  (void)unused;
+  return PyUnicode_FromString(dv_version());
+}
+
+static PyMethodDef module_methods[] = {
+    {"analyze_artifact", analyze_artifact, METH_O,
+     "analyze_artifact(path) -> dict"},
+    {"check_health", check_health, METH_NOARGS, "check_health() -> dict"},
+    {"version", version, METH_NOARGS,
+     "version() -> str\n\nVersion of the loaded libdevops_validator."},
+    {NULL, NULL, 0, NULL}};
+
+static struct PyModuleDef module = {
+    PyModuleDef_HEAD_INIT, "devops_validator._core",
+    "In-process bindings to libdevops_validator.", -1, module_methods,
+    NULL, NULL, NULL, NULL};
+
+PyMODINIT_FUNC PyInit__core(void) {
+  if (dv_abi_version() != DV_ABI_VERSION) {
+    PyErr_Format(PyExc_ImportError,
+                 "libdevops_validator has ABI version %d, expected %d",
+                 dv_abi_version(), DV_ABI_VERSION);
+    return NULL;
+  }
+  if (PyType_Ready(&ValidatorType) < 0) {
+    return NULL;
+  }
+  PyObject *m = PyModule_Create(&module);
+  if (!m) {
+    return NULL;
+  }
+  Py_INCREF(&ValidatorType);
+  if (PyModule_AddObject(m, "Validator", (PyObject *)&ValidatorType) < 0) {
+    Py_DECREF(&ValidatorType);
+    Py_DECREF(m);
+    return NULL;
+  }
+  return m;
+}
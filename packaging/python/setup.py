@@ -3,10 +3,13 @@
 Python wrapper for devops-validator CLI tool.
 
 This package downloads the appropriate binary for your platform
-and provides a Python interface to the devops-validator tool.
+and provides a Python interface to the devops-validator tool. Where
+libdevops_validator and its header are installed, it also builds the
+devops_validator._core extension, which validates in process. Point
+DEVOPS_VALIDATOR_PREFIX at a non-standard install prefix.
 """
 
-from setuptools import setup, find_packages
+from setuptools import setup, find_packages, Extension
 from setuptools.command.install import install
 import platform
 import urllib.request
@@ -16,6 +19,19 @@ import stat
 VERSION = "1.0.0"
 REPO = "neonix888/devops-validator"
 
+PREFIX = os.environ.get("DEVOPS_VALIDATOR_PREFIX", "/usr/local")
+
+# Optional: without the library the package is just the CLI wrapper
+core = Extension(
+    "devops_validator._core",
+    sources=["devops_validator/_core.c"],
+    include_dirs=[os.path.join(PREFIX, "include")],
+    library_dirs=[os.path.join(PREFIX, "lib")],
+    runtime_library_dirs=[os.path.join(PREFIX, "lib")],
+    libraries=["devops_validator"],
+    optional=True,
+)
+
 class BinaryInstall(install):
     """Custom installation to download platform-specific binary."""
 
@@ -58,6 +74,7 @@ setup(
     author_email="neonix888@github.com",
     url=f"https://github.com/{REPO}",
     packages=find_packages(),
+    ext_modules=[core],
     entry_points={
         "console_scripts": [
             "devops-validator=devops_validator.cli:main",
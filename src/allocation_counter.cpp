@@ -0,0 +1,127 @@
+#include "allocation_counter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> allocationBytes{0};
+
+// Every replaced operator new allocates here; null when out of memory.
+// Memory from an aligned allocation must go back through freeAligned().
+void *allocate(std::size_t size, std::size_t alignment = 0) {
+  if (counting.load(std::memory_order_relaxed)) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+  }
+  if (size == 0) {
+    size = 1;
+  }
+  if (alignment == 0) {
+    return std::malloc(size);
+  }
+#ifdef _WIN32
+  return _aligned_malloc(size, alignment);
+#else
+  // aligned_alloc wants a multiple of the alignment.
+  return std::aligned_alloc(alignment,
+                            (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void freeAligned(void *p) {
+#ifdef _WIN32
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  if (void *p = allocate(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  if (void *p = allocate(size, static_cast<std::size_t>(alignment))) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t &) noexcept {
+  return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void *p, std::align_val_t) noexcept {
+  freeAligned(p);
+}
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  freeAligned(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+  freeAligned(p);
+}
+void operator delete(void *p, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  freeAligned(p);
+}
+void operator delete[](void *p, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+  freeAligned(p);
+}
+
+namespace devops {
+
+void AllocationCounter::enable(bool enabled) {
+  counting.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::count() { return allocations.load(); }
+
+uint64_t AllocationCounter::bytes() { return allocationBytes.load(); }
+
+} // namespace devops
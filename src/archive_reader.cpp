@@ -0,0 +1,1330 @@
+#include "archive_reader.h"
+#include "file_type.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define fseeko _fseeki64
+#define ftello _ftelli64
+#endif
+
+#ifdef DEVOPS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef DEVOPS_HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef DEVOPS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace devops {
+
+namespace {
+
+constexpr size_t BUFFER_SIZE = 256 * 1024;
+constexpr size_t TAR_BLOCK = 512;
+
+uint16_t le16(const char *p) {
+  const auto *u = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<uint16_t>(u[0] | u[1] << 8);
+}
+
+uint32_t le32(const char *p) {
+  return le16(p) | static_cast<uint32_t>(le16(p + 2)) << 16;
+}
+
+uint64_t le64(const char *p) {
+  return le32(p) | static_cast<uint64_t>(le32(p + 4)) << 32;
+}
+
+std::string tooLarge(const std::string &path) {
+  return path + " (larger than " +
+         std::to_string(ArchiveReader::MAX_MEMBER_BYTES >> 20) + " MiB)";
+}
+
+// Tar and zip members are often stored as "./name".
+std::string memberPath(std::string path) {
+  while (path.compare(0, 2, "./") == 0) {
+    path.erase(0, 2);
+  }
+  return path;
+}
+
+// The archive file, read front to back through one fixed buffer.
+class InputFile {
+public:
+  explicit InputFile(const std::string &path)
+      : file_(std::fopen(path.c_str(), "rb")), buffer_(BUFFER_SIZE) {
+    if (!file_) {
+      throw std::runtime_error("cannot open " + path + ": " +
+                               std::strerror(errno));
+    }
+  }
+  ~InputFile() { std::fclose(file_); }
+  InputFile(const InputFile &) = delete;
+  InputFile &operator=(const InputFile &) = delete;
+
+  // Makes at least one byte available; false at end of file.
+  bool fill() {
+    if (pos_ < end_) {
+      return true;
+    }
+    pos_ = 0;
+    end_ = std::fread(buffer_.data(), 1, buffer_.size(), file_);
+    if (end_ == 0 && std::ferror(file_)) {
+      throw std::runtime_error("archive read failed");
+    }
+    bytesRead_ += end_;
+    return end_ > 0;
+  }
+
+  const char *data() const { return buffer_.data() + pos_; }
+  size_t available() const { return end_ - pos_; }
+  void consume(size_t n) { pos_ += n; }
+
+  size_t read(char *out, size_t n) {
+    size_t done = 0;
+    while (done < n && fill()) {
+      const size_t chunk = std::min(n - done, available());
+      std::memcpy(out + done, data(), chunk);
+      consume(chunk);
+      done += chunk;
+    }
+    return done;
+  }
+
+  // Discards `n` bytes, seeking past any that are not buffered yet. False
+  // when the file ends first.
+  bool skip(uint64_t n) {
+    const size_t buffered =
+        static_cast<size_t>(std::min<uint64_t>(n, available()));
+    consume(buffered);
+    n -= buffered;
+    if (n == 0) {
+      return true;
+    }
+    if (n > static_cast<uint64_t>(INT64_MAX) ||
+        fseeko(file_, static_cast<int64_t>(n), SEEK_CUR) != 0) {
+      throw std::runtime_error("archive seek failed");
+    }
+    if (size_ < 0) {
+      const int64_t here = ftello(file_);
+      fseeko(file_, 0, SEEK_END);
+      size_ = ftello(file_);
+      fseeko(file_, here, SEEK_SET);
+    }
+    return ftello(file_) <= size_;
+  }
+
+  uint64_t bytesRead() const { return bytesRead_; }
+
+private:
+  std::FILE *file_;
+  int64_t size_ = -1; // looked up on the first seek
+  std::vector<char> buffer_;
+  size_t pos_ = 0;
+  size_t end_ = 0;
+  uint64_t bytesRead_ = 0;
+};
+
+class Stream {
+public:
+  virtual ~Stream() = default;
+  // Fills up to `n` bytes; fewer only at the end of the stream.
+  virtual size_t read(char *out, size_t n) = 0;
+
+  // Discards `n` bytes; false when the stream ends first.
+  virtual bool skip(uint64_t n) {
+    char buffer[16 * 1024];
+    while (n > 0) {
+      const size_t chunk =
+          static_cast<size_t>(std::min<uint64_t>(n, sizeof(buffer)));
+      if (read(buffer, chunk) != chunk) {
+        return false;
+      }
+      n -= chunk;
+    }
+    return true;
+  }
+};
+
+class FileStream : public Stream {
+public:
+  explicit FileStream(InputFile &in) : in_(in) {}
+  size_t read(char *out, size_t n) override { return in_.read(out, n); }
+  bool skip(uint64_t n) override { return in_.skip(n); }
+
+private:
+  InputFile &in_;
+};
+
+class MemoryStream : public Stream {
+public:
+  explicit MemoryStream(std::string_view data) : data_(data) {}
+  size_t read(char *out, size_t n) override {
+    n = std::min(n, data_.size());
+    std::memcpy(out, data_.data(), n);
+    data_.remove_prefix(n);
+    return n;
+  }
+
+private:
+  std::string_view data_;
+};
+
+// Inflates straight out of the InputFile buffer, consuming only the bytes
+// zlib used so whatever follows the compressed data stays readable.
+class InflateStream : public Stream {
+public:
+  enum class Kind { Gzip, RawDeflate };
+
+  InflateStream(InputFile &in, Kind kind) : in_(in), kind_(kind) {
+#ifdef DEVOPS_HAVE_ZLIB
+    std::memset(&stream_, 0, sizeof(stream_));
+    // 16 + MAX_WBITS expects a gzip header; a negative size, no header.
+    const int bits = kind == Kind::Gzip ? 16 + MAX_WBITS : -MAX_WBITS;
+    if (inflateInit2(&stream_, bits) != Z_OK) {
+      throw std::runtime_error("zlib initialisation failed");
+    }
+#else
+    throw std::runtime_error("built without zlib; compressed archives are "
+                             "unavailable");
+#endif
+  }
+
+  ~InflateStream() override {
+#ifdef DEVOPS_HAVE_ZLIB
+    inflateEnd(&stream_);
+#endif
+  }
+
+  size_t read(char *out, size_t n) override {
+#ifdef DEVOPS_HAVE_ZLIB
+    size_t produced = 0;
+    while (produced < n && !finished_) {
+      if (!in_.fill()) {
+        throw std::runtime_error("truncated compressed data");
+      }
+      const size_t availIn = std::min<size_t>(in_.available(), UINT32_MAX);
+      const size_t availOut = std::min<size_t>(n - produced, UINT32_MAX);
+      stream_.next_in =
+          reinterpret_cast<Bytef *>(const_cast<char *>(in_.data()));
+      stream_.avail_in = static_cast<uInt>(availIn);
+      stream_.next_out = reinterpret_cast<Bytef *>(out + produced);
+      stream_.avail_out = static_cast<uInt>(availOut);
+      const int status = ::inflate(&stream_, Z_NO_FLUSH);
+      in_.consume(availIn - stream_.avail_in);
+      produced += availOut - stream_.avail_out;
+
+      if (status == Z_STREAM_END) {
+        // gzip files may hold several members back to back; anything else
+        // after the last one (often zero padding) is ignored.
+        if (kind_ == Kind::Gzip && in_.fill() &&
+            static_cast<unsigned char>(in_.data()[0]) == 0x1F) {
+          inflateReset(&stream_);
+        } else {
+          finished_ = true;
+        }
+      } else if (status != Z_OK && status != Z_BUF_ERROR) {
+        throw std::runtime_error("corrupt compressed data");
+      }
+    }
+    return produced;
+#else
+    (void)out;
+    (void)n;
+    return 0;
+#endif
+  }
+
+private:
+  InputFile &in_;
+  Kind kind_;
+  bool finished_ = false;
+#ifdef DEVOPS_HAVE_ZLIB
+  z_stream stream_;
+#endif
+};
+
+// Decompresses .xz data straight out of the InputFile buffer, like
+// InflateStream; concatenated streams are read as one.
+class XzStream : public Stream {
+public:
+  explicit XzStream(InputFile &in) : in_(in) {
+#ifdef DEVOPS_HAVE_LZMA
+    if (lzma_stream_decoder(&stream_, UINT64_MAX, LZMA_CONCATENATED) !=
+        LZMA_OK) {
+      throw std::runtime_error("liblzma initialisation failed");
+    }
+#else
+    throw std::runtime_error("built without liblzma; xz archives are "
+                             "unavailable");
+#endif
+  }
+
+  ~XzStream() override {
+#ifdef DEVOPS_HAVE_LZMA
+    lzma_end(&stream_);
+#endif
+  }
+
+  size_t read(char *out, size_t n) override {
+#ifdef DEVOPS_HAVE_LZMA
+    size_t produced = 0;
+    while (produced < n && !finished_) {
+      // LZMA_FINISH once the file is exhausted lets the decoder tell a
+      // complete stream from a truncated one.
+      const bool more = in_.fill();
+      stream_.next_in = reinterpret_cast<const uint8_t *>(in_.data());
+      stream_.avail_in = more ? in_.available() : 0;
+      stream_.next_out = reinterpret_cast<uint8_t *>(out + produced);
+      stream_.avail_out = n - produced;
+      const size_t availIn = stream_.avail_in;
+      const size_t availOut = stream_.avail_out;
+      const lzma_ret status =
+          lzma_code(&stream_, more ? LZMA_RUN : LZMA_FINISH);
+      in_.consume(availIn - stream_.avail_in);
+      produced += availOut - stream_.avail_out;
+      if (status == LZMA_STREAM_END) {
+        finished_ = true;
+      } else if (status != LZMA_OK) {
+        throw std::runtime_error(status == LZMA_BUF_ERROR
+                                     ? "truncated compressed data"
+                                     : "corrupt compressed data");
+      }
+    }
+    return produced;
+#else
+    (void)out;
+    (void)n;
+    return 0;
+#endif
+  }
+
+private:
+  InputFile &in_;
+  bool finished_ = false;
+#ifdef DEVOPS_HAVE_LZMA
+  lzma_stream stream_ = LZMA_STREAM_INIT;
+#endif
+};
+
+// Decompresses .zst data straight out of the InputFile buffer, like
+// InflateStream; consecutive frames are read as one.
+class ZstdStream : public Stream {
+public:
+  explicit ZstdStream(InputFile &in) : in_(in) {
+#ifdef DEVOPS_HAVE_ZSTD
+    stream_ = ZSTD_createDStream();
+    if (!stream_) {
+      throw std::bad_alloc();
+    }
+#else
+    throw std::runtime_error("built without libzstd; zstd archives are "
+                             "unavailable");
+#endif
+  }
+
+  ~ZstdStream() override {
+#ifdef DEVOPS_HAVE_ZSTD
+    ZSTD_freeDStream(stream_);
+#endif
+  }
+
+  size_t read(char *out, size_t n) override {
+#ifdef DEVOPS_HAVE_ZSTD
+    size_t produced = 0;
+    while (produced < n) {
+      ZSTD_outBuffer output{out + produced, n - produced, 0};
+      if (!in_.fill()) {
+        // Output may still be pending inside the decoder.
+        ZSTD_inBuffer input{nullptr, 0, 0};
+        const size_t status =
+            ZSTD_decompressStream(stream_, &output, &input);
+        if (ZSTD_isError(status)) {
+          throw std::runtime_error("corrupt compressed data");
+        }
+        produced += output.pos;
+        frameDone_ = status == 0;
+        if (output.pos == 0) {
+          if (!frameDone_) {
+            throw std::runtime_error("truncated compressed data");
+          }
+          break;
+        }
+        continue;
+      }
+      ZSTD_inBuffer input{in_.data(), in_.available(), 0};
+      const size_t status = ZSTD_decompressStream(stream_, &output, &input);
+      if (ZSTD_isError(status)) {
+        throw std::runtime_error("corrupt compressed data");
+      }
+      in_.consume(input.pos);
+      produced += output.pos;
+      frameDone_ = status == 0;
+    }
+    return produced;
+#else
+    (void)out;
+    (void)n;
+    return 0;
+#endif
+  }
+
+private:
+  InputFile &in_;
+  bool frameDone_ = false;
+#ifdef DEVOPS_HAVE_ZSTD
+  ZSTD_DStream *stream_ = nullptr;
+#endif
+};
+
+// Reads or discards `size` bytes into `content` (when not null).
+void readExact(Stream &in, uint64_t size, std::string *content) {
+  if (content) {
+    content->resize(size);
+    if (in.read(content->data(), size) != size) {
+      throw std::runtime_error("truncated archive");
+    }
+  } else if (!in.skip(size)) {
+    throw std::runtime_error("truncated archive");
+  }
+}
+
+uint64_t parseOctal(const char *field, size_t length) {
+  // GNU tar stores sizes of 8 GiB and more in base 256.
+  if (static_cast<unsigned char>(field[0]) & 0x80) {
+    uint64_t value = static_cast<unsigned char>(field[0]) & 0x7F;
+    for (size_t i = 1; i < length; i++) {
+      value = value << 8 | static_cast<unsigned char>(field[i]);
+    }
+    return value;
+  }
+  uint64_t value = 0;
+  size_t i = 0;
+  while (i < length && field[i] == ' ') {
+    i++;
+  }
+  for (; i < length && field[i] >= '0' && field[i] <= '7'; i++) {
+    value = value << 3 | static_cast<uint64_t>(field[i] - '0');
+  }
+  return value;
+}
+
+bool isZeroBlock(const char *block) {
+  return std::all_of(block, block + TAR_BLOCK, [](char c) { return c == 0; });
+}
+
+bool validTarChecksum(const char *block) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < TAR_BLOCK; i++) {
+    // The checksum field itself counts as spaces.
+    sum += i >= 148 && i < 156 ? ' ' : static_cast<unsigned char>(block[i]);
+  }
+  return parseOctal(block + 148, 8) == sum;
+}
+
+std::string headerString(const char *field, size_t length) {
+  return std::string(field, strnlen(field, length));
+}
+
+// Applies the "path", "linkpath" and "size" records of a pax extended
+// header.
+void parsePax(std::string_view records, std::string &path, std::string &link,
+              uint64_t &size, bool &hasSize) {
+  while (!records.empty()) {
+    const size_t space = records.find(' ');
+    if (space == std::string_view::npos) {
+      break;
+    }
+    const uint64_t length =
+        std::strtoull(std::string(records.substr(0, space)).c_str(), nullptr,
+                      10);
+    if (length <= space || length > records.size()) {
+      break;
+    }
+    std::string_view record = records.substr(space + 1, length - space - 2);
+    records.remove_prefix(length);
+    const size_t equals = record.find('=');
+    if (equals == std::string_view::npos) {
+      continue;
+    }
+    const std::string_view key = record.substr(0, equals);
+    const std::string_view value = record.substr(equals + 1);
+    if (key == "path") {
+      path = std::string(value);
+    } else if (key == "linkpath") {
+      link = std::string(value);
+    } else if (key == "size") {
+      size = std::strtoull(std::string(value).c_str(), nullptr, 10);
+      hasSize = true;
+    }
+  }
+}
+
+struct TarEntry {
+  std::string path; // without leading "./"
+  std::string link; // target of symbolic and hard links
+  char type;        // the typeflag, with every regular file as '0'
+  uint64_t size;
+};
+
+// Walks the tar headers of `in`; `first` is the already read first header
+// block. `extract(entry)` decides whether a member's data is read and
+// passed to `onData(entry, content)` or skipped unread.
+template <typename Extract, typename OnData>
+void walkTar(Stream &in, const char *first, Extract &&extract,
+             OnData &&onData) {
+  char block[TAR_BLOCK];
+  std::memcpy(block, first, TAR_BLOCK);
+  std::string content;
+  std::string longPath;
+  std::string longLink;
+  std::string paxPath;
+  std::string paxLink;
+  uint64_t paxSize = 0;
+  bool hasPaxSize = false;
+
+  for (;;) {
+    if (isZeroBlock(block)) {
+      return; // end-of-archive marker
+    }
+    if (!validTarChecksum(block)) {
+      throw std::runtime_error("corrupt tar header");
+    }
+    const char type = block[156];
+    uint64_t size = parseOctal(block + 124, 12);
+    const uint64_t padding = (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK;
+
+    if (type == 'L' || type == 'K' || type == 'x' || type == 'g') {
+      // GNU long name or link target, or pax records for the next member
+      // or all of them.
+      if (size > (1 << 20)) {
+        throw std::runtime_error("corrupt tar header");
+      }
+      readExact(in, size, &content);
+      readExact(in, padding, nullptr);
+      if (type == 'L') {
+        longPath = headerString(content.data(), content.size());
+      } else if (type == 'K') {
+        longLink = headerString(content.data(), content.size());
+      } else if (type == 'x') {
+        parsePax(content, paxPath, paxLink, paxSize, hasPaxSize);
+      }
+    } else {
+      TarEntry entry;
+      if (!paxPath.empty()) {
+        entry.path = paxPath;
+      } else if (!longPath.empty()) {
+        entry.path = longPath;
+      } else {
+        entry.path = headerString(block, 100);
+        const std::string prefix = headerString(block + 345, 155);
+        if (std::memcmp(block + 257, "ustar", 5) == 0 && !prefix.empty()) {
+          entry.path = prefix + "/" + entry.path;
+        }
+      }
+      entry.path = memberPath(std::move(entry.path));
+      if (!paxLink.empty()) {
+        entry.link = paxLink;
+      } else if (!longLink.empty()) {
+        entry.link = longLink;
+      } else {
+        entry.link = headerString(block + 157, 100);
+      }
+      entry.type = type == '\0' || type == '7' ? '0' : type;
+      entry.size = hasPaxSize ? paxSize : size;
+      const uint64_t dataPadding =
+          (TAR_BLOCK - entry.size % TAR_BLOCK) % TAR_BLOCK;
+      longPath.clear();
+      longLink.clear();
+      paxPath.clear();
+      paxLink.clear();
+      hasPaxSize = false;
+
+      const bool wanted = extract(entry);
+      readExact(in, entry.size, wanted ? &content : nullptr);
+      readExact(in, dataPadding, nullptr);
+      if (wanted) {
+        onData(entry, content);
+      }
+    }
+
+    if (in.read(block, TAR_BLOCK) != TAR_BLOCK) {
+      return; // archives cut after the last member are tolerated
+    }
+  }
+}
+
+// Reads the wanted regular files of a tar archive.
+void readTar(Stream &in, const char *first,
+             const ArchiveReader::MemberFilter &wanted,
+             const ArchiveReader::MemberCallback &onMember,
+             ArchiveStats &stats) {
+  walkTar(
+      in, first,
+      [&](const TarEntry &entry) {
+        if (entry.type != '0') {
+          return false;
+        }
+        stats.members++;
+        if (!wanted(entry.path)) {
+          return false;
+        }
+        if (entry.size > ArchiveReader::MAX_MEMBER_BYTES) {
+          stats.skipped.push_back(tooLarge(entry.path));
+          return false;
+        }
+        return true;
+      },
+      [&](const TarEntry &entry, std::string_view content) {
+        stats.extracted++;
+        stats.bytesUnpacked += content.size();
+        onMember(entry.path, content);
+      });
+}
+
+// Whole-buffer decompressors for .deb control archives, which are small
+// enough to hold in memory. Output is capped at MAX_MEMBER_BYTES.
+
+[[noreturn]] void controlTooLarge() {
+  throw std::runtime_error(tooLarge("control.tar"));
+}
+
+std::string gunzip(std::string_view data) {
+#ifdef DEVOPS_HAVE_ZLIB
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+    throw std::runtime_error("zlib initialisation failed");
+  }
+  std::string out;
+  std::vector<char> buffer(64 * 1024);
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  int status = Z_OK;
+  while (status != Z_STREAM_END) {
+    stream.next_out = reinterpret_cast<Bytef *>(buffer.data());
+    stream.avail_out = static_cast<uInt>(buffer.size());
+    status = ::inflate(&stream, Z_NO_FLUSH);
+    out.append(buffer.data(), buffer.size() - stream.avail_out);
+    if (status != Z_OK && status != Z_STREAM_END) {
+      inflateEnd(&stream);
+      throw std::runtime_error("corrupt compressed data");
+    }
+    if (out.size() > ArchiveReader::MAX_MEMBER_BYTES) {
+      inflateEnd(&stream);
+      controlTooLarge();
+    }
+  }
+  inflateEnd(&stream);
+  return out;
+#else
+  (void)data;
+  throw std::runtime_error("built without zlib; control.tar.gz is "
+                           "unavailable");
+#endif
+}
+
+std::string unxz(std::string_view data) {
+#ifdef DEVOPS_HAVE_LZMA
+  lzma_stream stream = LZMA_STREAM_INIT;
+  if (lzma_stream_decoder(&stream, UINT64_MAX, 0) != LZMA_OK) {
+    throw std::runtime_error("liblzma initialisation failed");
+  }
+  std::string out;
+  std::vector<char> buffer(64 * 1024);
+  stream.next_in = reinterpret_cast<const uint8_t *>(data.data());
+  stream.avail_in = data.size();
+  lzma_ret status = LZMA_OK;
+  while (status != LZMA_STREAM_END) {
+    stream.next_out = reinterpret_cast<uint8_t *>(buffer.data());
+    stream.avail_out = buffer.size();
+    status = lzma_code(&stream, LZMA_FINISH);
+    out.append(buffer.data(), buffer.size() - stream.avail_out);
+    if (status != LZMA_OK && status != LZMA_STREAM_END) {
+      lzma_end(&stream);
+      throw std::runtime_error("corrupt compressed data");
+    }
+    if (out.size() > ArchiveReader::MAX_MEMBER_BYTES) {
+      lzma_end(&stream);
+      controlTooLarge();
+    }
+  }
+  lzma_end(&stream);
+  return out;
+#else
+  (void)data;
+  throw std::runtime_error("built without liblzma; control.tar.xz is "
+                           "unavailable");
+#endif
+}
+
+std::string unzstd(std::string_view data) {
+#ifdef DEVOPS_HAVE_ZSTD
+  std::unique_ptr<ZSTD_DStream, size_t (*)(ZSTD_DStream *)> stream(
+      ZSTD_createDStream(), ZSTD_freeDStream);
+  if (!stream) {
+    throw std::bad_alloc();
+  }
+  std::string out;
+  std::vector<char> buffer(64 * 1024);
+  ZSTD_inBuffer in{data.data(), data.size(), 0};
+  for (;;) {
+    ZSTD_outBuffer chunk{buffer.data(), buffer.size(), 0};
+    const size_t status = ZSTD_decompressStream(stream.get(), &chunk, &in);
+    if (ZSTD_isError(status)) {
+      throw std::runtime_error("corrupt compressed data");
+    }
+    out.append(buffer.data(), chunk.pos);
+    if (out.size() > ArchiveReader::MAX_MEMBER_BYTES) {
+      controlTooLarge();
+    }
+    if (status == 0) {
+      return out; // end of the frame
+    }
+    if (in.pos == in.size && chunk.pos < chunk.size) {
+      throw std::runtime_error("truncated compressed data");
+    }
+  }
+#else
+  (void)data;
+  throw std::runtime_error("built without libzstd; control.tar.zst is "
+                           "unavailable");
+#endif
+}
+
+// The size field of an ar member header: decimal, padded with spaces.
+uint64_t parseArSize(const char *field, size_t length) {
+  uint64_t value = 0;
+  size_t i = 0;
+  for (; i < length && field[i] >= '0' && field[i] <= '9'; i++) {
+    value = value * 10 + static_cast<uint64_t>(field[i] - '0');
+  }
+  if (i == 0) {
+    throw std::runtime_error("corrupt ar header");
+  }
+  return value;
+}
+
+// The "control" file of an uncompressed control.tar.
+std::string controlFromTar(std::string_view tar, const std::string &member) {
+  MemoryStream in(tar);
+  char block[TAR_BLOCK];
+  if (in.read(block, TAR_BLOCK) != TAR_BLOCK) {
+    throw std::runtime_error("truncated " + member);
+  }
+  std::string control;
+  bool found = false;
+  ArchiveStats stats;
+  readTar(
+      in, block, [](const std::string &path) { return path == "control"; },
+      [&](const std::string &, std::string_view content) {
+        control.assign(content);
+        found = true;
+      },
+      stats);
+  if (!found) {
+    throw std::runtime_error("no control file in " + member);
+  }
+  return control;
+}
+
+bool crcMatches(const std::string &content, uint32_t expected) {
+#ifdef DEVOPS_HAVE_ZLIB
+  uLong crc = crc32(0L, Z_NULL, 0);
+  // zlib lengths are 32-bit; members are far below that limit.
+  crc = crc32(crc, reinterpret_cast<const Bytef *>(content.data()),
+              static_cast<uInt>(content.size()));
+  return static_cast<uint32_t>(crc) == expected;
+#else
+  (void)content;
+  (void)expected;
+  return true;
+#endif
+}
+
+void readZip(InputFile &file, const ArchiveReader::MemberFilter &wanted,
+             const ArchiveReader::MemberCallback &onMember,
+             ArchiveStats &stats) {
+  constexpr uint32_t LOCAL_HEADER = 0x04034b50;
+  constexpr uint32_t DATA_DESCRIPTOR = 0x08074b50;
+  FileStream in(file);
+  std::vector<char> scratch(64 * 1024);
+  std::string content;
+
+  for (;;) {
+    char signature[4];
+    if (in.read(signature, 4) != 4) {
+      throw std::runtime_error("truncated zip archive");
+    }
+    if (le32(signature) != LOCAL_HEADER) {
+      return; // central directory: every member has been read
+    }
+    char header[26];
+    if (in.read(header, sizeof(header)) != sizeof(header)) {
+      throw std::runtime_error("truncated zip archive");
+    }
+    const uint16_t flags = le16(header + 2);
+    const uint16_t method = le16(header + 4);
+    uint32_t crc = le32(header + 10);
+    uint64_t compressedSize = le32(header + 14);
+    uint64_t size = le32(header + 18);
+    std::string path;
+    std::string extra;
+    readExact(in, le16(header + 22), &path);
+    readExact(in, le16(header + 24), &extra);
+
+    // Zip64 sizes live in extra field 0x0001.
+    bool zip64 = false;
+    for (size_t pos = 0; pos + 4 <= extra.size();) {
+      const uint16_t id = le16(&extra[pos]);
+      const uint16_t length = le16(&extra[pos + 2]);
+      if (id == 0x0001 && length >= 16 && pos + 4 + length <= extra.size()) {
+        size = le64(&extra[pos + 4]);
+        compressedSize = le64(&extra[pos + 12]);
+        zip64 = true;
+      }
+      pos += 4 + length;
+    }
+
+    const bool directory = !path.empty() && path.back() == '/';
+    const bool descriptor = flags & 0x08;
+    path = memberPath(std::move(path));
+    bool want = false;
+    if (!directory) {
+      stats.members++;
+      want = wanted(path);
+    }
+
+    if (flags & 0x01 || (method != 0 && method != 8)) {
+      if (descriptor) {
+        throw std::runtime_error("cannot stream zip member " + path +
+                                 ": its size is only in the central "
+                                 "directory");
+      }
+      readExact(in, compressedSize, nullptr);
+      if (want) {
+        stats.skipped.push_back(
+            path + (flags & 0x01 ? " (encrypted)"
+                                 : " (compression method " +
+                                       std::to_string(method) + ")"));
+      }
+      continue;
+    }
+
+    bool extracted = false;
+    if (method == 0) {
+      if (descriptor && compressedSize == 0 && !directory) {
+        throw std::runtime_error("cannot stream zip member " + path +
+                                 ": its size is only in the central "
+                                 "directory");
+      }
+      extracted = want && compressedSize <= ArchiveReader::MAX_MEMBER_BYTES;
+      readExact(in, compressedSize, extracted ? &content : nullptr);
+    } else if (!want && !descriptor) {
+      readExact(in, compressedSize, nullptr);
+    } else {
+      // Deflated: inflate to the end of the stream, which also finds the
+      // end of the data when the sizes follow it in a descriptor.
+      InflateStream inflated(file, InflateStream::Kind::RawDeflate);
+      content.clear();
+      extracted = want;
+      size_t n;
+      while ((n = inflated.read(scratch.data(), scratch.size())) > 0) {
+        if (extracted &&
+            content.size() + n > ArchiveReader::MAX_MEMBER_BYTES) {
+          extracted = false;
+          content.clear();
+          content.shrink_to_fit();
+        } else if (extracted) {
+          content.append(scratch.data(), n);
+        }
+      }
+    }
+
+    if (descriptor) {
+      // CRC and sizes, after an optional signature.
+      char field[4];
+      if (in.read(field, 4) != 4 ||
+          (le32(field) == DATA_DESCRIPTOR && in.read(field, 4) != 4)) {
+        throw std::runtime_error("truncated zip archive");
+      }
+      crc = le32(field);
+      char sizes[16];
+      const size_t length = zip64 ? 16 : 8;
+      if (in.read(sizes, length) != length) {
+        throw std::runtime_error("truncated zip archive");
+      }
+      size = zip64 ? le64(sizes + 8) : le32(sizes + 4);
+    }
+
+    if (want && !extracted) {
+      stats.skipped.push_back(tooLarge(path));
+    } else if (extracted) {
+      if (content.size() != size || !crcMatches(content, crc)) {
+        stats.skipped.push_back(path + " (CRC or size mismatch)");
+        continue;
+      }
+      stats.extracted++;
+      stats.bytesUnpacked += content.size();
+      onMember(path, content);
+    }
+  }
+}
+
+// True when `path`, taken relative to the extraction directory, leaves it:
+// absolute paths, drive letters, or more ".." than directories before.
+bool escapes(std::string_view path) {
+  if (path.empty()) {
+    return false;
+  }
+  if (path.front() == '/' || path.front() == '\\' ||
+      (path.size() >= 2 && path[1] == ':')) {
+    return true;
+  }
+  int64_t depth = 0;
+  while (!path.empty()) {
+    const size_t slash = path.find_first_of("/\\");
+    const std::string_view part = path.substr(0, slash);
+    path.remove_prefix(slash == std::string_view::npos ? path.size()
+                                                       : slash + 1);
+    if (part == "..") {
+      if (--depth < 0) {
+        return true;
+      }
+    } else if (!part.empty() && part != ".") {
+      depth++;
+    }
+  }
+  return false;
+}
+
+// Collects an ArchiveListing entry by entry, keeping only the biggest files
+// and the first anomalies.
+class Lister {
+public:
+  Lister(ArchiveListing &listing, size_t largest)
+      : listing_(listing), largest_(largest) {}
+
+  void file(const std::string &path, uint64_t size) {
+    checkPath(path);
+    listing_.files++;
+    listing_.totalSize += size;
+    if (largest_ == 0) {
+      return;
+    }
+    // A min-heap of the biggest files so far.
+    std::vector<ArchiveEntry> &top = listing_.largest;
+    if (top.size() == largest_) {
+      if (size <= top.front().size) {
+        return;
+      }
+      std::pop_heap(top.begin(), top.end(), bigger);
+      top.pop_back();
+    }
+    top.push_back({path, size});
+    std::push_heap(top.begin(), top.end(), bigger);
+  }
+
+  void directory(const std::string &path) {
+    if (path.empty()) {
+      return; // "./", the archive root
+    }
+    checkPath(path);
+    listing_.directories++;
+  }
+
+  // Link targets are relative to the link's directory for symbolic links
+  // and to the archive root for hard links.
+  void link(const std::string &path, const std::string &target,
+            bool symbolic) {
+    checkPath(path);
+    listing_.links++;
+    const std::string_view parent(
+        path.data(), symbolic ? path.find_last_of("/\\") + 1 : 0);
+    const bool absolute =
+        !target.empty() && (target.front() == '/' || target.front() == '\\');
+    if (absolute || escapes(std::string(parent) + target)) {
+      anomaly(path + " -> " + target +
+              (symbolic ? " (symlink" : " (hard link") +
+              (absolute ? " to an absolute path)" : " outside the archive)"));
+    }
+  }
+
+  // A symbolic link whose target cannot be read without decompressing.
+  void uncheckedLink(const std::string &path) {
+    checkPath(path);
+    listing_.links++;
+    anomaly(path + " (symlink with a compressed target)");
+  }
+
+  void special(const std::string &path, const char *what) {
+    checkPath(path);
+    anomaly(path + " (" + what + ")");
+  }
+
+  void anomaly(std::string detail) {
+    if (listing_.anomalies++ < ArchiveReader::MAX_ANOMALY_DETAILS) {
+      listing_.anomalyDetails.push_back(std::move(detail));
+    }
+  }
+
+  void finish() {
+    std::sort_heap(listing_.largest.begin(), listing_.largest.end(), bigger);
+  }
+
+private:
+  static bool bigger(const ArchiveEntry &a, const ArchiveEntry &b) {
+    return a.size > b.size;
+  }
+
+  void checkPath(const std::string &path) {
+    if (escapes(path)) {
+      anomaly(path + " (path outside the archive)");
+    }
+  }
+
+  ArchiveListing &listing_;
+  size_t largest_;
+};
+
+// Lists a zip archive from its central directory, found through the end
+// of central directory record. Only those bytes of the mapping are
+// touched; nothing is decompressed.
+void listZip(const std::string &path, Lister &lister) {
+  constexpr uint32_t END_RECORD = 0x06054b50;
+  constexpr uint32_t ZIP64_LOCATOR = 0x07064b50;
+  constexpr uint32_t ZIP64_END_RECORD = 0x06064b50;
+  constexpr uint32_t CENTRAL_HEADER = 0x02014b50;
+  constexpr uint32_t LOCAL_HEADER = 0x04034b50;
+  constexpr size_t END_SIZE = 22;
+  const MappedFile file(path);
+  const std::string_view data = file.view();
+  const auto corrupt = [] {
+    return std::runtime_error("corrupt zip central directory");
+  };
+
+  // The record ends the file, unless followed by a comment of up to 64 KiB.
+  if (data.size() < END_SIZE) {
+    throw corrupt();
+  }
+  size_t end = data.size() - END_SIZE;
+  const size_t lowest = end > 0xFFFF ? end - 0xFFFF : 0;
+  while (le32(&data[end]) != END_RECORD) {
+    if (end == lowest) {
+      throw corrupt();
+    }
+    end--;
+  }
+  uint64_t entries = le16(&data[end + 10]);
+  uint64_t directorySize = le32(&data[end + 12]);
+  uint64_t offset = le32(&data[end + 16]);
+  if (end >= 20 && le32(&data[end - 20]) == ZIP64_LOCATOR) {
+    const uint64_t record = le64(&data[end - 12]);
+    if (data.size() < 56 || record > data.size() - 56 ||
+        le32(&data[record]) != ZIP64_END_RECORD) {
+      throw corrupt();
+    }
+    entries = le64(&data[record + 32]);
+    directorySize = le64(&data[record + 40]);
+    offset = le64(&data[record + 48]);
+  }
+  if (offset > data.size() || directorySize > data.size() - offset) {
+    throw corrupt();
+  }
+
+  std::string_view directory = data.substr(offset, directorySize);
+  for (uint64_t i = 0; i < entries; i++) {
+    if (directory.size() < 46 || le32(directory.data()) != CENTRAL_HEADER) {
+      throw corrupt();
+    }
+    const char *header = directory.data();
+    const uint16_t madeBy = le16(header + 4);
+    const uint16_t method = le16(header + 10);
+    uint64_t compressedSize = le32(header + 20);
+    uint64_t size = le32(header + 24);
+    const size_t nameLength = le16(header + 28);
+    const size_t extraLength = le16(header + 30);
+    const size_t commentLength = le16(header + 32);
+    const uint32_t attributes = le32(header + 38);
+    uint64_t localOffset = le32(header + 42);
+    const size_t length = 46 + nameLength + extraLength + commentLength;
+    if (directory.size() < length) {
+      throw corrupt();
+    }
+    const std::string name(header + 46, nameLength);
+    const std::string_view extra(header + 46 + nameLength, extraLength);
+    directory.remove_prefix(length);
+
+    // Zip64 field 0x0001 holds, in order, each size that is 0xFFFFFFFF.
+    for (size_t pos = 0; pos + 4 <= extra.size();) {
+      const uint16_t id = le16(&extra[pos]);
+      const size_t fieldLength = le16(&extra[pos + 2]);
+      if (id == 0x0001) {
+        std::string_view field = extra.substr(pos + 4, fieldLength);
+        for (uint64_t *value : {&size, &compressedSize, &localOffset}) {
+          if (*value == 0xFFFFFFFF && field.size() >= 8) {
+            *value = le64(field.data());
+            field.remove_prefix(8);
+          }
+        }
+      }
+      pos += 4 + fieldLength;
+    }
+
+    const uint32_t mode = attributes >> 16;
+    const bool fromUnix = madeBy >> 8 == 3;
+    if (!name.empty() && (name.back() == '/' || name.back() == '\\')) {
+      lister.directory(name);
+    } else if (fromUnix && (mode & 0170000) == 0120000) {
+      // The link target is the member's data; when stored uncompressed it
+      // is read in place from behind the local header.
+      std::string target;
+      if (method == 0 && data.size() >= 30 && localOffset <= data.size() - 30 &&
+          le32(&data[localOffset]) == LOCAL_HEADER) {
+        const uint64_t start = localOffset + 30 +
+                               le16(&data[localOffset + 26]) +
+                               le16(&data[localOffset + 28]);
+        if (start <= data.size() && compressedSize <= data.size() - start) {
+          target.assign(&data[start], compressedSize);
+        }
+      }
+      if (target.empty()) {
+        lister.uncheckedLink(name);
+      } else {
+        lister.link(name, target, true);
+      }
+    } else {
+      lister.file(name, size);
+    }
+  }
+}
+
+// The member name of a single compressed file: the archive's name without
+// its compression suffix.
+std::string singleFileName(const std::string &archive) {
+  std::string name = archive.substr(archive.find_last_of("/\\") + 1);
+  for (const char *suffix : {".gz", ".xz", ".zst"}) {
+    const size_t length = std::strlen(suffix);
+    if (name.size() > length &&
+        name.compare(name.size() - length, length, suffix) == 0) {
+      name.resize(name.size() - length);
+      break;
+    }
+  }
+  return name;
+}
+
+// The tar stream of a tar or compressed archive, decompressing as needed.
+std::unique_ptr<Stream> openStream(InputFile &file, FileType format) {
+  switch (format) {
+  case FileType::Gzip:
+    return std::make_unique<InflateStream>(file, InflateStream::Kind::Gzip);
+  case FileType::Xz:
+    return std::make_unique<XzStream>(file);
+  case FileType::Zstd:
+    return std::make_unique<ZstdStream>(file);
+  default:
+    return std::make_unique<FileStream>(file);
+  }
+}
+
+// Reads the first tar header block; false when the stream is not a tar
+// archive (for compressed formats, a single compressed file).
+bool readTarStart(Stream &in, char *block, size_t &n) {
+  n = in.read(block, TAR_BLOCK);
+  return n == TAR_BLOCK && (isZeroBlock(block) || validTarChecksum(block));
+}
+
+} // namespace
+
+ArchiveReader::ArchiveReader(std::string path)
+    : path_(std::move(path)), format_(FileTypeDetector::detectFile(path_)) {
+  if (!FileTypeDetector::isArchive(format_)) {
+    throw std::runtime_error("not a tar, gzip, xz, zstd or zip archive: " +
+                             path_);
+  }
+}
+
+bool ArchiveReader::isArchive(const std::string &path) {
+  return FileTypeDetector::isArchive(FileTypeDetector::detectFile(path));
+}
+
+std::string ArchiveReader::readDebControl(const std::string &path) {
+  InputFile file(path);
+  FileStream in(file);
+  char magic[8];
+  if (in.read(magic, sizeof(magic)) != sizeof(magic) ||
+      std::memcmp(magic, "!<arch>\n", sizeof(magic)) != 0) {
+    throw std::runtime_error("not a Debian package: " + path);
+  }
+
+  // debian-binary comes first and data.tar after control.tar; anything in
+  // between (signatures) is skipped.
+  std::string content;
+  bool first = true;
+  for (;;) {
+    char header[60];
+    const size_t n = in.read(header, sizeof(header));
+    if (n == 0) {
+      break;
+    }
+    if (n != sizeof(header) || header[58] != '`' || header[59] != '\n') {
+      throw std::runtime_error("corrupt ar header in " + path);
+    }
+    std::string name = headerString(header, 16);
+    name.erase(name.find_last_not_of(' ') + 1);
+    if (!name.empty() && name.back() == '/') {
+      name.pop_back(); // GNU ar terminates names with a slash
+    }
+    const uint64_t size = parseArSize(header + 48, 10);
+
+    if (first) {
+      if (name != "debian-binary" || size > 64) {
+        throw std::runtime_error("not a Debian package: " + path);
+      }
+      readExact(in, size, &content);
+      if (content.compare(0, 2, "2.") != 0) {
+        content.erase(content.find_last_not_of("\n") + 1);
+        throw std::runtime_error("unsupported .deb format version " +
+                                 content);
+      }
+      first = false;
+    } else if (name.compare(0, 11, "control.tar") == 0) {
+      if (size > MAX_MEMBER_BYTES) {
+        controlTooLarge();
+      }
+      readExact(in, size, &content);
+      const std::string_view suffix = std::string_view(name).substr(11);
+      if (suffix.empty()) {
+        return controlFromTar(content, name);
+      } else if (suffix == ".gz") {
+        return controlFromTar(gunzip(content), name);
+      } else if (suffix == ".xz") {
+        return controlFromTar(unxz(content), name);
+      } else if (suffix == ".zst") {
+        return controlFromTar(unzstd(content), name);
+      }
+      throw std::runtime_error("unsupported control archive " + name);
+    } else if (name.compare(0, 8, "data.tar") == 0) {
+      break;
+    } else {
+      readExact(in, size, nullptr);
+    }
+    readExact(in, size % 2, nullptr); // members are 2-byte aligned
+  }
+  throw std::runtime_error("no control.tar member in " + path);
+}
+
+ArchiveStats ArchiveReader::read(const MemberFilter &wanted,
+                                 const MemberCallback &onMember) const {
+  ArchiveStats stats;
+  InputFile file(path_);
+
+  if (format_ == FileType::Zip) {
+    readZip(file, wanted, onMember, stats);
+  } else {
+    const std::unique_ptr<Stream> stream = openStream(file, format_);
+    Stream &in = *stream;
+    char block[TAR_BLOCK];
+    size_t n = 0;
+    if (readTarStart(in, block, n)) {
+      readTar(in, block, wanted, onMember, stats);
+    } else if (format_ != FileType::Tar) {
+      // A single compressed file: the member is named after the archive.
+      const std::string path = singleFileName(path_);
+      stats.members++;
+      if (wanted(path)) {
+        std::string content(block, n);
+        std::vector<char> scratch(64 * 1024);
+        size_t chunk;
+        bool fits = true;
+        while ((chunk = in.read(scratch.data(), scratch.size())) > 0) {
+          fits = fits && content.size() + chunk <= MAX_MEMBER_BYTES;
+          if (fits) {
+            content.append(scratch.data(), chunk);
+          }
+        }
+        if (!fits) {
+          stats.skipped.push_back(tooLarge(path));
+        } else {
+          stats.extracted++;
+          stats.bytesUnpacked += content.size();
+          onMember(path, content);
+        }
+      }
+    } else {
+      throw std::runtime_error("corrupt tar archive: " + path_);
+    }
+  }
+
+  stats.bytesRead = file.bytesRead();
+  return stats;
+}
+
+ArchiveListing ArchiveReader::list(size_t largest) const {
+  ArchiveListing listing;
+  listing.archiveSize = std::filesystem::file_size(path_);
+  Lister lister(listing, largest);
+
+  if (format_ == FileType::Zip) {
+    listZip(path_, lister);
+  } else {
+    InputFile file(path_);
+    const std::unique_ptr<Stream> stream = openStream(file, format_);
+    Stream &in = *stream;
+    char block[TAR_BLOCK];
+    size_t n = 0;
+    if (readTarStart(in, block, n)) {
+      walkTar(
+          in, block,
+          [&](const TarEntry &entry) {
+            switch (entry.type) {
+            case '0':
+              lister.file(entry.path, entry.size);
+              break;
+            case '1':
+            case '2':
+              lister.link(entry.path, entry.link, entry.type == '2');
+              break;
+            case '3':
+            case '4':
+              lister.special(entry.path, "device file");
+              break;
+            case '5':
+              lister.directory(entry.path);
+              break;
+            default:
+              break; // FIFOs, sparse and volume headers
+            }
+            return false;
+          },
+          [](const TarEntry &, std::string_view) {});
+    } else if (format_ != FileType::Tar) {
+      // A single compressed file, decompressed only to learn its size.
+      uint64_t size = n;
+      std::vector<char> scratch(64 * 1024);
+      size_t chunk;
+      while ((chunk = in.read(scratch.data(), scratch.size())) > 0) {
+        size += chunk;
+      }
+      lister.file(singleFileName(path_), size);
+    } else {
+      throw std::runtime_error("corrupt tar archive: " + path_);
+    }
+  }
+
+  lister.finish();
+  return listing;
+}
+
+} // namespace devops
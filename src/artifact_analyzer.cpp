@@ -1,33 +1,54 @@
 #include "artifact_analyzer.h"
+#include "archive_reader.h"
+#include "deb_control.h"
+#include "file_type.h"
+#include "profiler.h"
+#include "report.h"
+#include "rpm_header.h"
 #include "utils.h"
-#include <array>
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <filesystem>
 #include <fstream>
-#include <iostream>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <sstream>
-
-// Platform-specific popen/pclose
-#ifdef _WIN32
-#define popen _popen
-#define pclose _pclose
-#endif
+#include <string_view>
 
 namespace fs = std::filesystem;
 
 namespace devops {
 
 ArtifactInfo ArtifactAnalyzer::analyzeFile(const std::string &filePath) {
+  if (!Utils::fileExists(filePath)) {
+    Utils::printError("File not found: " + filePath);
+    ArtifactInfo info;
+    info.valid = false;
+    return info;
+  }
+
+  ArtifactInfo info = inspectFile(filePath);
+  printArtifactInfo(info);
+  return info;
+}
+
+ArtifactInfo ArtifactAnalyzer::inspectFile(const std::string &filePath) {
+  ProfileScope scope("analyze", filePath);
   ArtifactInfo info;
   info.valid = false;
 
   if (!Utils::fileExists(filePath)) {
-    Utils::printError("File not found: " + filePath);
+    info.name = fs::path(filePath).filename().string();
+    info.metadata["Error"] = "File not found";
     return info;
   }
 
-  std::string ext = Utils::getFileExtension(filePath);
+  const FileType type = FileTypeDetector::detectFile(filePath);
   info.name = fs::path(filePath).filename().string();
 
   try {
@@ -36,43 +57,88 @@ ArtifactInfo ArtifactAnalyzer::analyzeFile(const std::string &filePath) {
     info.size = "unknown";
   }
 
-  if (ext == ".deb") {
+  if (type == FileType::Deb) {
     info = analyzeDeb(filePath);
-  } else if (ext == ".rpm") {
+  } else if (type == FileType::Rpm) {
     info = analyzeRpm(filePath);
-  } else if (filePath.find("Dockerfile") != std::string::npos) {
+  } else if (type == FileType::Dockerfile) {
     info = analyzeDocker(filePath);
-  } else if (ext == ".tar" || ext == ".gz" || ext == ".zip" || ext == ".tgz") {
-    info = analyzeArchive(filePath);
+  } else if (FileTypeDetector::isArchive(type)) {
+    info = analyzeArchive(filePath, type);
   } else {
     info.type = "Unknown";
     info.valid = true;
   }
 
-  printArtifactInfo(info);
   return info;
 }
 
+void ArtifactAnalyzer::setJobs(unsigned jobs) { jobs_ = jobs; }
+
+void ArtifactAnalyzer::setRecursive(bool recursive) { recursive_ = recursive; }
+
+void ArtifactAnalyzer::setWalkOptions(const WalkOptions &options) {
+  walkOptions_ = options;
+}
+
+void ArtifactAnalyzer::setMaxInFlightBytes(uint64_t bytes) {
+  maxInFlightBytes_ = bytes;
+}
+
 void ArtifactAnalyzer::analyzeDirectory(const std::string &dirPath) {
   Utils::printInfo("Analyzing artifacts in: " + dirPath);
 
-  int filesAnalyzed = 0;
+  struct Slot {
+    std::string path;
+    FileType type = FileType::Unknown;
+    uint64_t bytes = 0;
+    // What the slot holds of the in-flight budget while it runs: the whole
+    // file for streamed formats, nothing for the ones read by their headers.
+    uint64_t weight = 0;
+    ArtifactInfo info;
+    bool done = false;
+  };
+  std::vector<std::unique_ptr<Slot>> slots;
+  std::mutex slotsMutex;
+
+  // Sniffing the type reads each file's first bytes, so with a pool the
+  // walk and the sniffing both run on the workers.
+  unsigned jobs = jobs_ == 0 ? WorkStealingPool::defaultThreadCount() : jobs_;
+  std::unique_ptr<WorkStealingPool> pool;
+  if (jobs > 1) {
+    pool = std::make_unique<WorkStealingPool>(jobs);
+  }
+  auto found = [&](const std::string &path) {
+    const FileType type = FileTypeDetector::detectFile(path);
+    if (!FileTypeDetector::isArtifact(type)) {
+      return;
+    }
+    auto slot = std::make_unique<Slot>();
+    slot->path = path;
+    slot->type = type;
+    std::error_code ec;
+    const uintmax_t bytes = fs::file_size(path, ec);
+    slot->bytes = ec ? 0 : static_cast<uint64_t>(bytes);
+    if (type == FileType::Gzip || type == FileType::Xz ||
+        type == FileType::Zstd) {
+      slot->weight = slot->bytes;
+    }
+    std::lock_guard<std::mutex> lock(slotsMutex);
+    slots.push_back(std::move(slot));
+  };
 
   try {
-    for (const auto &entry : fs::directory_iterator(dirPath)) {
-      if (entry.is_regular_file()) {
-        std::string path = entry.path().string();
-        std::string ext = Utils::getFileExtension(path);
-
-        if (ext == ".deb" || ext == ".rpm" || ext == ".tar" || ext == ".gz" ||
-            ext == ".zip" || ext == ".tgz" ||
-            path.find("Dockerfile") != std::string::npos) {
-
-          std::cout << "\n"
-                    << Color::BOLD << "=== " << path << " ===" << Color::RESET
-                    << std::endl;
-          analyzeFile(path);
-          filesAnalyzed++;
+    ProfileScope scope("walk", dirPath);
+    if (recursive_) {
+      const WalkStats walk =
+          DirectoryWalker(walkOptions_).walk(dirPath, found, pool.get());
+      for (const std::string &error : walk.errors) {
+        Utils::printError("Directory scan error: " + error);
+      }
+    } else {
+      for (const auto &entry : fs::directory_iterator(dirPath)) {
+        if (entry.is_regular_file()) {
+          found(entry.path().string());
         }
       }
     }
@@ -80,9 +146,112 @@ void ArtifactAnalyzer::analyzeDirectory(const std::string &dirPath) {
     Utils::printError(std::string("Directory scan error: ") + e.what());
   }
 
-  std::cout << "\n"
-            << Color::BOLD << "Total artifacts analyzed: " << filesAnalyzed
-            << Color::RESET << std::endl;
+  // Work is started in the order results are printed, so the next result
+  // to print is usually the oldest one running.
+  std::sort(slots.begin(), slots.end(),
+            [](const std::unique_ptr<Slot> &a, const std::unique_ptr<Slot> &b) {
+              return a->path < b->path;
+            });
+
+  std::mutex doneMutex;
+  std::condition_variable doneCv;
+  // Streamed files beyond the budget wait here, in order, without holding
+  // a worker; each one that finishes starts those that then fit.
+  std::deque<Slot *> waiting;
+  uint64_t inFlight = 0;
+  auto fits = [&](const Slot &slot) {
+    return maxInFlightBytes_ == 0 || inFlight == 0 ||
+           inFlight + slot.weight <= maxInFlightBytes_;
+  };
+  std::function<void(Slot *)> start;
+  start = [&](Slot *slot) {
+    pool->submit([&, slot] {
+      try {
+        slot->info = inspectFile(slot->path);
+      } catch (const std::exception &e) {
+        slot->info.name = fs::path(slot->path).filename().string();
+        slot->info.metadata["Error"] = e.what();
+        slot->info.valid = false;
+      }
+      std::lock_guard<std::mutex> lock(doneMutex);
+      slot->done = true;
+      if (slot->weight > 0) {
+        inFlight -= slot->weight;
+        while (!waiting.empty() && fits(*waiting.front())) {
+          inFlight += waiting.front()->weight;
+          start(waiting.front());
+          waiting.pop_front();
+        }
+      }
+      doneCv.notify_all();
+    });
+  };
+  if (pool) {
+    std::lock_guard<std::mutex> lock(doneMutex);
+    for (const auto &slot : slots) {
+      if (slot->weight == 0) {
+        start(slot.get());
+      } else if (waiting.empty() && fits(*slot)) {
+        inFlight += slot->weight;
+        start(slot.get());
+      } else {
+        waiting.push_back(slot.get());
+      }
+    }
+  }
+
+  struct Totals {
+    size_t count = 0;
+    size_t incomplete = 0;
+    uint64_t bytes = 0;
+  };
+  std::map<std::string, Totals> byType;
+  Totals total;
+  for (const auto &slot : slots) {
+    if (pool) {
+      std::unique_lock<std::mutex> lock(doneMutex);
+      doneCv.wait(lock, [&slot] { return slot->done; });
+    } else {
+      slot->info = inspectFile(slot->path);
+    }
+
+    Report::out() << "\n"
+                  << Color::BOLD << "=== " << slot->path << " ==="
+                  << Color::RESET << '\n';
+    printArtifactInfo(slot->info);
+    for (Totals *totals : {&byType[FileTypeDetector::name(slot->type)],
+                           &total}) {
+      totals->count++;
+      totals->incomplete += slot->info.valid ? 0 : 1;
+      totals->bytes += slot->bytes;
+    }
+    slot->info = ArtifactInfo(); // printed; only the totals are kept
+  }
+  if (pool) {
+    pool->wait();
+  }
+
+  std::ostream &out = Report::out();
+  out << "\n"
+      << Color::BOLD << "=== Artifact Summary ===" << Color::RESET << '\n';
+  char row[128];
+  std::snprintf(row, sizeof(row), "%-16s %8s %11s %12s", "Type", "Count",
+                "Incomplete", "Size");
+  out << Color::BOLD << row << Color::RESET << '\n';
+  auto printRow = [&](const std::string &type, const Totals &totals) {
+    std::snprintf(row, sizeof(row), "%-16s %8zu %11zu %12s", type.c_str(),
+                  totals.count, totals.incomplete,
+                  formatSize(static_cast<long>(totals.bytes)).c_str());
+    out << row << '\n';
+  };
+  for (const auto &[type, totals] : byType) {
+    printRow(type, totals);
+  }
+  printRow("Total", total);
+
+  out << "\n"
+      << Color::BOLD << "Total artifacts analyzed: " << total.count
+      << Color::RESET << '\n';
 }
 
 ArtifactInfo ArtifactAnalyzer::analyzeDeb(const std::string &filePath) {
@@ -96,40 +265,46 @@ ArtifactInfo ArtifactAnalyzer::analyzeDeb(const std::string &filePath) {
     info.size = "unknown";
   }
 
-  // Try to get package info using dpkg-deb
-  std::string cmd = "dpkg-deb -I \"" + filePath + "\" 2>/dev/null";
-  FILE *pipe = popen(cmd.c_str(), "r");
-
-  if (pipe) {
-    std::array<char, 128> buffer;
-    std::string result;
-
-    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-      result += buffer.data();
+  ProfileScope scope("deb", filePath);
+  try {
+    const DebControl control =
+        DebControl::parse(ArchiveReader::readDebControl(filePath));
+    for (const char *name : {"Package", "Version", "Architecture",
+                             "Maintainer", "Section", "Priority",
+                             "Homepage"}) {
+      if (const std::string *value = control.field(name)) {
+        info.metadata[name] = *value;
+      }
     }
-
-    pclose(pipe);
-
-    // Parse the output
-    std::istringstream stream(result);
-    std::string line;
-    while (std::getline(stream, line)) {
-      if (line.find("Package:") != std::string::npos) {
-        info.metadata["Package"] = line.substr(line.find(":") + 2);
-      } else if (line.find("Version:") != std::string::npos) {
-        info.metadata["Version"] = line.substr(line.find(":") + 2);
-      } else if (line.find("Architecture:") != std::string::npos) {
-        info.metadata["Architecture"] = line.substr(line.find(":") + 2);
-      } else if (line.find("Depends:") != std::string::npos) {
-        std::string deps = line.substr(line.find(":") + 2);
-        info.dependencies = Utils::split(deps, ',');
+    if (const std::string *description = control.field("Description")) {
+      // Just the synopsis; the long description follows on later lines.
+      info.metadata["Description"] =
+          description->substr(0, description->find('\n'));
+    }
+    if (const std::string *size = control.field("Installed-Size")) {
+      // Given in KiB
+      char *end = nullptr;
+      const long kib = std::strtol(size->c_str(), &end, 10);
+      info.metadata["Installed-Size"] =
+          !size->empty() && *end == '\0' && kib >= 0 ? formatSize(kib * 1024)
+                                                      : *size;
+    }
+    for (const char *field : {"Depends", "Pre-Depends", "Recommends"}) {
+      std::string prefix;
+      if (std::string_view(field) != "Depends") {
+        prefix = std::string(field) + ": ";
+      }
+      for (const DebRelationGroup &group : control.relations(field)) {
+        info.dependencies.push_back(prefix + toString(group));
       }
     }
-
-    info.valid = true;
-  } else {
-    info.metadata["Note"] = "dpkg-deb not available - limited analysis";
-    info.valid = true;
+    info.valid = control.field("Package") && control.field("Version");
+    if (!info.valid) {
+      info.metadata["Error"] = "control file has no Package or Version";
+    }
+  } catch (const std::exception &e) {
+    info.metadata["Error"] = e.what();
+    info.valid = false;
   }
 
   return info;
@@ -146,37 +321,42 @@ ArtifactInfo ArtifactAnalyzer::analyzeRpm(const std::string &filePath) {
     info.size = "unknown";
   }
 
-  // Try to get package info using rpm
-  std::string cmd = "rpm -qip \"" + filePath + "\" 2>/dev/null";
-  FILE *pipe = popen(cmd.c_str(), "r");
-
-  if (pipe) {
-    std::array<char, 128> buffer;
-    std::string result;
-
-    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-      result += buffer.data();
+  ProfileScope scope("rpm", filePath);
+  try {
+    const RpmPackage package = RpmPackage::read(filePath);
+    info.metadata["Name"] = package.name;
+    info.metadata["Version"] = package.version;
+    info.metadata["Release"] = package.release;
+    if (!package.epoch.empty()) {
+      info.metadata["Epoch"] = package.epoch;
     }
-
-    pclose(pipe);
-
-    // Parse the output
-    std::istringstream stream(result);
-    std::string line;
-    while (std::getline(stream, line)) {
-      if (line.find("Name") != std::string::npos) {
-        info.metadata["Name"] = line.substr(line.find(":") + 2);
-      } else if (line.find("Version") != std::string::npos) {
-        info.metadata["Version"] = line.substr(line.find(":") + 2);
-      } else if (line.find("Architecture") != std::string::npos) {
-        info.metadata["Architecture"] = line.substr(line.find(":") + 2);
-      }
+    info.metadata["Architecture"] = package.source ? "src" : package.arch;
+    if (!package.summary.empty()) {
+      info.metadata["Summary"] = package.summary;
+    }
+    if (!package.license.empty()) {
+      info.metadata["License"] = package.license;
+    }
+    info.metadata["Installed-Size"] =
+        formatSize(static_cast<long>(package.installedSize));
+    info.metadata["Files"] = std::to_string(package.files.size());
+    if (!package.payloadFormat.empty()) {
+      // Payloads without a compressor tag are gzip-compressed.
+      info.metadata["Payload"] =
+          package.payloadFormat + ", " +
+          (package.payloadCompressor.empty() ? "gzip"
+                                             : package.payloadCompressor);
+    }
+    for (const RpmDependency &dependency : package.requirements) {
+      info.dependencies.push_back(dependency.str());
+    }
+    for (const RpmDependency &dependency : package.provides) {
+      info.dependencies.push_back("Provides: " + dependency.str());
     }
-
-    info.valid = true;
-  } else {
-    info.metadata["Note"] = "rpm command not available - limited analysis";
     info.valid = true;
+  } catch (const std::exception &e) {
+    info.metadata["Error"] = e.what();
+    info.valid = false;
   }
 
   return info;
@@ -224,7 +404,8 @@ ArtifactInfo ArtifactAnalyzer::analyzeDocker(const std::string &filePath) {
   return info;
 }
 
-ArtifactInfo ArtifactAnalyzer::analyzeArchive(const std::string &filePath) {
+ArtifactInfo ArtifactAnalyzer::analyzeArchive(const std::string &filePath,
+                                              FileType type) {
   ArtifactInfo info;
   info.type = "Archive";
   info.name = fs::path(filePath).filename().string();
@@ -235,55 +416,74 @@ ArtifactInfo ArtifactAnalyzer::analyzeArchive(const std::string &filePath) {
     info.size = "unknown";
   }
 
-  std::string ext = Utils::getFileExtension(filePath);
-  info.metadata["Format"] = ext;
-
-  // Try to list contents
-  std::string cmd;
-  if (ext == ".tar" || ext == ".tgz" || ext == ".gz") {
-    cmd = "tar -tzf \"" + filePath + "\" 2>/dev/null | wc -l";
-  } else if (ext == ".zip") {
-    cmd = "unzip -l \"" + filePath + "\" 2>/dev/null | tail -1";
-  }
+  info.metadata["Format"] = FileTypeDetector::name(type);
 
-  if (!cmd.empty()) {
-    FILE *pipe = popen(cmd.c_str(), "r");
-    if (pipe) {
-      char buffer[128];
-      if (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        info.metadata["Files"] = std::string(buffer);
+  ProfileScope scope("archive", filePath);
+  try {
+    const ArchiveListing listing = ArchiveReader(filePath).list();
+    info.metadata["Files"] = std::to_string(listing.files);
+    if (listing.directories > 0) {
+      info.metadata["Directories"] = std::to_string(listing.directories);
+    }
+    if (listing.links > 0) {
+      info.metadata["Links"] = std::to_string(listing.links);
+    }
+    info.metadata["Uncompressed Size"] =
+        formatSize(static_cast<long>(listing.totalSize));
+    if (listing.archiveSize > 0) {
+      char ratio[32];
+      snprintf(ratio, sizeof(ratio), "%.2f:1",
+               static_cast<double>(listing.totalSize) /
+                   static_cast<double>(listing.archiveSize));
+      info.metadata["Compression Ratio"] = ratio;
+    }
+    std::string largest;
+    for (const ArchiveEntry &entry : listing.largest) {
+      largest += (largest.empty() ? "" : ", ") + entry.path + " (" +
+                 formatSize(static_cast<long>(entry.size)) + ")";
+    }
+    if (!largest.empty()) {
+      info.metadata["Largest Files"] = largest;
+    }
+    if (listing.anomalies > 0) {
+      std::string anomalies = std::to_string(listing.anomalies);
+      for (const std::string &detail : listing.anomalyDetails) {
+        anomalies += "\n    " + detail;
+      }
+      if (listing.anomalies > listing.anomalyDetails.size()) {
+        anomalies += "\n    ...";
       }
-      pclose(pipe);
+      info.metadata["Anomalies"] = anomalies;
     }
+    info.valid = true;
+  } catch (const std::exception &e) {
+    info.metadata["Error"] = e.what();
+    info.valid = false;
   }
-
-  info.valid = true;
   return info;
 }
 
 void ArtifactAnalyzer::printArtifactInfo(const ArtifactInfo &info) {
-  std::cout << Color::BOLD << "Type: " << Color::RESET << info.type
-            << std::endl;
-  std::cout << Color::BOLD << "Name: " << Color::RESET << info.name
-            << std::endl;
+  std::ostream &out = Report::out();
+  out << Color::BOLD << "Type: " << Color::RESET << info.type << '\n';
+  out << Color::BOLD << "Name: " << Color::RESET << info.name << '\n';
 
   if (!info.size.empty()) {
-    std::cout << Color::BOLD << "Size: " << Color::RESET << info.size
-              << std::endl;
+    out << Color::BOLD << "Size: " << Color::RESET << info.size << '\n';
   }
 
   if (!info.metadata.empty()) {
-    std::cout << Color::BOLD << "Metadata:" << Color::RESET << std::endl;
+    out << Color::BOLD << "Metadata:" << Color::RESET << '\n';
     for (const auto &[key, value] : info.metadata) {
-      std::cout << "  " << Color::CYAN << key << ": " << Color::RESET << value
-                << std::endl;
+      out << "  " << Color::CYAN << key << ": " << Color::RESET << value
+          << '\n';
     }
   }
 
   if (!info.dependencies.empty()) {
-    std::cout << Color::BOLD << "Dependencies:" << Color::RESET << std::endl;
+    out << Color::BOLD << "Dependencies:" << Color::RESET << '\n';
     for (const auto &dep : info.dependencies) {
-      std::cout << "  - " << dep << std::endl;
+      out << "  - " << dep << '\n';
     }
   }
 
@@ -0,0 +1,312 @@
+#include "devops_validator.h"
+#include "artifact_analyzer.h"
+#include "config_validator.h"
+#include "health_checker.h"
+#include "json_schema.h"
+#include "kubernetes_schemas.h"
+#include <exception>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifndef DEVOPS_VALIDATOR_VERSION
+#define DEVOPS_VALIDATOR_VERSION "unknown"
+#endif
+
+using KeyValues = std::vector<std::pair<std::string, std::string>>;
+
+struct dv_validator {
+  devops::ConfigValidator validator;
+};
+
+// Messages are rendered once, since accessors hand out C strings.
+struct dv_result {
+  bool valid = false;
+  std::string fileType;
+  std::vector<std::string> errors;
+  std::vector<std::string> warnings;
+  std::vector<std::string> notes;
+};
+
+// Maps are flattened so that accessors by index are O(1).
+struct dv_artifact {
+  devops::ArtifactInfo info;
+  KeyValues metadata;
+};
+
+struct dv_health {
+  devops::HealthCheckResult result;
+  KeyValues info;
+};
+
+namespace {
+
+thread_local std::string lastError;
+
+void setError(std::string message) { lastError = std::move(message); }
+
+// Runs `body`, turning any exception into dv_last_error() and `failure`.
+template <typename T, typename Body> T guarded(T failure, Body &&body) {
+  try {
+    return body();
+  } catch (const std::bad_alloc &) {
+    setError("Out of memory");
+  } catch (const std::exception &e) {
+    setError(e.what());
+  } catch (...) {
+    setError("Unknown error");
+  }
+  return failure;
+}
+
+template <typename T>
+const char *at(const std::vector<T> &items, size_t index) {
+  return index < items.size() ? items[index].c_str() : nullptr;
+}
+
+const char *keyAt(const KeyValues &items, size_t index) {
+  return index < items.size() ? items[index].first.c_str() : nullptr;
+}
+
+const char *valueAt(const KeyValues &items, size_t index) {
+  return index < items.size() ? items[index].second.c_str() : nullptr;
+}
+
+const std::vector<std::string> *messages(const dv_result *result,
+                                         dv_message_kind kind) {
+  if (!result) {
+    return nullptr;
+  }
+  switch (kind) {
+  case DV_MESSAGE_ERROR:
+    return &result->errors;
+  case DV_MESSAGE_WARNING:
+    return &result->warnings;
+  case DV_MESSAGE_NOTE:
+    return &result->notes;
+  }
+  return nullptr;
+}
+
+dv_result *newResult(const devops::ValidationResult &result) {
+  auto converted = std::make_unique<dv_result>();
+  converted->valid = result.valid;
+  converted->fileType = result.fileType;
+  converted->errors = result.errors.strings();
+  converted->warnings = result.warnings.strings();
+  converted->notes = result.notes.strings();
+  return converted.release();
+}
+
+template <typename T>
+void append(std::vector<T> &to, const std::vector<T> &from) {
+  to.insert(to.end(), from.begin(), from.end());
+}
+
+} // namespace
+
+extern "C" {
+
+const char *dv_version(void) { return DEVOPS_VALIDATOR_VERSION; }
+
+int dv_abi_version(void) { return DV_ABI_VERSION; }
+
+const char *dv_last_error(void) { return lastError.c_str(); }
+
+dv_validator *dv_validator_new(void) {
+  return guarded<dv_validator *>(nullptr, [] {
+    auto *validator = new dv_validator();
+    validator->validator.setJobs(1);
+    return validator;
+  });
+}
+
+void dv_validator_free(dv_validator *validator) { delete validator; }
+
+int dv_validator_set_kubernetes_version(dv_validator *validator,
+                                        const char *version) {
+  return guarded(-1, [&] {
+    if (!validator) {
+      throw std::invalid_argument("validator is NULL");
+    }
+    validator->validator.setKubernetesSchemas(
+        version ? std::make_shared<devops::KubernetesSchemas>(version)
+                : nullptr);
+    return 0;
+  });
+}
+
+int dv_validator_set_schema_file(dv_validator *validator, const char *path) {
+  return guarded(-1, [&] {
+    if (!validator) {
+      throw std::invalid_argument("validator is NULL");
+    }
+    validator->validator.setSchema(
+        path ? devops::CompiledSchema::loadFile(path, std::string())
+             : nullptr);
+    return 0;
+  });
+}
+
+dv_result *dv_validate_file(dv_validator *validator, const char *path) {
+  return guarded<dv_result *>(nullptr, [&] {
+    if (!validator || !path) {
+      throw std::invalid_argument("validator and path must not be NULL");
+    }
+    return newResult(validator->validator.check(path));
+  });
+}
+
+dv_result *dv_validate_buffer(dv_validator *validator, const char *data,
+                              size_t size, const char *name) {
+  return guarded<dv_result *>(nullptr, [&] {
+    if (!validator || (!data && size > 0) || !name) {
+      throw std::invalid_argument("validator, data and name must not be NULL");
+    }
+    devops::ValidationResult result;
+    try {
+      result = validator->validator.checkContent(std::string_view(data, size),
+                                                 name);
+    } catch (const std::exception &e) {
+      // Same as ConfigValidator::check() does for files.
+      result.valid = false;
+      result.errors.add({"Validation failed: ", e.what()});
+    }
+    return newResult(result);
+  });
+}
+
+int dv_result_valid(const dv_result *result) {
+  return result && result->valid;
+}
+
+const char *dv_result_file_type(const dv_result *result) {
+  return result ? result->fileType.c_str() : "";
+}
+
+size_t dv_result_message_count(const dv_result *result, dv_message_kind kind) {
+  const std::vector<std::string> *list = messages(result, kind);
+  return list ? list->size() : 0;
+}
+
+const char *dv_result_message(const dv_result *result, dv_message_kind kind,
+                              size_t index) {
+  const std::vector<std::string> *list = messages(result, kind);
+  return list ? at(*list, index) : nullptr;
+}
+
+void dv_result_free(dv_result *result) { delete result; }
+
+dv_artifact *dv_analyze_artifact(const char *path) {
+  return guarded<dv_artifact *>(nullptr, [&] {
+    if (!path) {
+      throw std::invalid_argument("path must not be NULL");
+    }
+    auto artifact = std::make_unique<dv_artifact>();
+    artifact->info = devops::ArtifactAnalyzer().inspectFile(path);
+    artifact->metadata.assign(artifact->info.metadata.begin(),
+                              artifact->info.metadata.end());
+    return artifact.release();
+  });
+}
+
+int dv_artifact_valid(const dv_artifact *artifact) {
+  return artifact && artifact->info.valid;
+}
+
+const char *dv_artifact_name(const dv_artifact *artifact) {
+  return artifact ? artifact->info.name.c_str() : "";
+}
+
+const char *dv_artifact_type(const dv_artifact *artifact) {
+  return artifact ? artifact->info.type.c_str() : "";
+}
+
+const char *dv_artifact_size(const dv_artifact *artifact) {
+  return artifact ? artifact->info.size.c_str() : "";
+}
+
+size_t dv_artifact_dependency_count(const dv_artifact *artifact) {
+  return artifact ? artifact->info.dependencies.size() : 0;
+}
+
+const char *dv_artifact_dependency(const dv_artifact *artifact,
+                                   size_t index) {
+  return artifact ? at(artifact->info.dependencies, index) : nullptr;
+}
+
+size_t dv_artifact_metadata_count(const dv_artifact *artifact) {
+  return artifact ? artifact->metadata.size() : 0;
+}
+
+const char *dv_artifact_metadata_key(const dv_artifact *artifact,
+                                     size_t index) {
+  return artifact ? keyAt(artifact->metadata, index) : nullptr;
+}
+
+const char *dv_artifact_metadata_value(const dv_artifact *artifact,
+                                       size_t index) {
+  return artifact ? valueAt(artifact->metadata, index) : nullptr;
+}
+
+void dv_artifact_free(dv_artifact *artifact) { delete artifact; }
+
+dv_health *dv_check_health(void) {
+  return guarded<dv_health *>(nullptr, [] {
+    devops::HealthChecker checker;
+    auto health = std::make_unique<dv_health>();
+    devops::HealthCheckResult &merged = health->result;
+    merged.healthy = true;
+    for (const devops::HealthCheckResult &part :
+         {checker.checkSystem(), checker.checkTools(),
+          checker.checkEnvironment()}) {
+      merged.healthy = merged.healthy && part.healthy;
+      append(merged.issues, part.issues);
+      append(merged.warnings, part.warnings);
+      merged.systemInfo.insert(part.systemInfo.begin(),
+                               part.systemInfo.end());
+    }
+    health->info.assign(merged.systemInfo.begin(), merged.systemInfo.end());
+    return health.release();
+  });
+}
+
+int dv_health_healthy(const dv_health *health) {
+  return health && health->result.healthy;
+}
+
+size_t dv_health_issue_count(const dv_health *health) {
+  return health ? health->result.issues.size() : 0;
+}
+
+const char *dv_health_issue(const dv_health *health, size_t index) {
+  return health ? at(health->result.issues, index) : nullptr;
+}
+
+size_t dv_health_warning_count(const dv_health *health) {
+  return health ? health->result.warnings.size() : 0;
+}
+
+const char *dv_health_warning(const dv_health *health, size_t index) {
+  return health ? at(health->result.warnings, index) : nullptr;
+}
+
+size_t dv_health_info_count(const dv_health *health) {
+  return health ? health->info.size() : 0;
+}
+
+const char *dv_health_info_key(const dv_health *health, size_t index) {
+  return health ? keyAt(health->info, index) : nullptr;
+}
+
+const char *dv_health_info_value(const dv_health *health, size_t index) {
+  return health ? valueAt(health->info, index) : nullptr;
+}
+
+void dv_health_free(dv_health *health) { delete health; }
+
+} // extern "C"
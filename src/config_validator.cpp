@@ -1,55 +1,210 @@
 #include "config_validator.h"
+#include "archive_reader.h"
+#include "directory_watcher.h"
+#include "env_lexer.h"
+#include "file_type.h"
+#include "git_repository.h"
+#include "json_scanner.h"
+#include "json_schema.h"
+#include "kubernetes_schemas.h"
+#include "mapped_file.h"
+#include "profiler.h"
+#include "report.h"
+#include "toml_parser.h"
 #include "utils.h"
+#include "validation_cache.h"
+#include "work_stealing_pool.h"
+#include "yaml_stream.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
-#include <iostream>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
-#include <regex>
-#include <yaml-cpp/yaml.h>
+#include <streambuf>
 
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
 namespace devops {
 
+namespace {
+
+bool isArchiveName(const std::string &path) {
+  return FileTypeDetector::isArchive(FileTypeDetector::fromName(path));
+}
+
+// Lets stream-based parsers read a buffer in place instead of copying it
+// into a std::istringstream.
+class ViewStreamBuf : public std::streambuf {
+public:
+  explicit ViewStreamBuf(std::string_view view) {
+    char *begin = const_cast<char *>(view.data());
+    setg(begin, begin, begin + view.size());
+  }
+};
+
+} // namespace
+
 ValidationResult ConfigValidator::validateFile(const std::string &filePath) {
+  if (insideArchives_ && ArchiveReader::isArchive(filePath)) {
+    return validateArchive(filePath);
+  }
+  ValidationResult result = checkFile(filePath);
+  printValidationResult(result, filePath);
+  return result;
+}
+
+ValidationResult ConfigValidator::check(const std::string &filePath) {
+  try {
+    return checkFile(filePath);
+  } catch (const std::exception &e) {
+    ValidationResult result;
+    result.valid = false;
+    result.errors.push_back(std::string("Validation failed: ") + e.what());
+    return result;
+  }
+}
+
+void ConfigValidator::setJobs(unsigned jobs) { jobs_ = jobs; }
+
+void ConfigValidator::setCache(std::shared_ptr<ValidationCache> cache) {
+  cache_ = std::move(cache);
+}
+
+void ConfigValidator::setJsonBackend(JsonBackend backend) {
+  jsonBackend_ = backend;
+}
+
+void ConfigValidator::setSchema(std::shared_ptr<const CompiledSchema> schema) {
+  schema_ = std::move(schema);
+}
+
+void ConfigValidator::setKubernetesSchemas(
+    std::shared_ptr<const KubernetesSchemas> schemas) {
+  kubernetes_ = std::move(schemas);
+}
+
+void ConfigValidator::setWalkOptions(const WalkOptions &options) {
+  walkOptions_ = options;
+}
+
+void ConfigValidator::setInsideArchives(bool insideArchives) {
+  insideArchives_ = insideArchives;
+}
+
+bool ConfigValidator::isConfigFile(const std::string &filePath) {
+  return FileTypeDetector::isConfig(FileTypeDetector::fromName(filePath));
+}
+
+ValidationResult ConfigValidator::checkFile(const std::string &filePath) {
   ValidationResult result;
   result.valid = false;
 
   if (!Utils::fileExists(filePath)) {
-    result.errors.push_back("File not found: " + filePath);
+    result.errors.add({"File not found: ", filePath});
     return result;
   }
 
-  std::string content;
+  MappedFile file;
   try {
-    content = Utils::readFile(filePath);
+    // Mapped pages are faulted in by the parser, so part of the cost of
+    // reading shows up under parse.
+    ProfileScope scope("read", filePath);
+    file = MappedFile(filePath);
   } catch (const std::exception &e) {
-    result.errors.push_back(std::string("Failed to read file: ") + e.what());
+    result.errors.add({"Failed to read file: ", e.what()});
     return result;
   }
 
-  std::string ext = Utils::getFileExtension(filePath);
+  return checkContent(file.view(), filePath);
+}
 
-  if (ext == ".json") {
+ValidationResult ConfigValidator::checkContent(std::string_view content,
+                                               const std::string &filePath) {
+  ValidationResult result;
+  FileType format = FileTypeDetector::fromName(filePath);
+  if (format == FileType::Unknown) {
+    format = FileTypeDetector::fromContent(
+        content.substr(0, FileTypeDetector::SNIFF_BYTES));
+  }
+  if (!FileTypeDetector::isConfig(format)) {
+    result.valid = false;
+    result.fileType = FileTypeDetector::name(format);
+    if (format == FileType::Unknown) {
+      result.errors.push_back(
+          "Unrecognised file type: expected JSON, YAML, TOML or ENV");
+    } else {
+      const bool archive = FileTypeDetector::isArchive(format);
+      result.errors.add({"Not a config file (", FileTypeDetector::name(format),
+                         "); use ", archive ? "--inside-archives or " : "",
+                         "'analyze'"});
+    }
+    return result;
+  }
+
+  CacheKey key{};
+  if (cache_) {
+    // The backend is part of the key so cross-checking runs never see the
+    // other backend's cached results.
+    uint32_t kind = static_cast<uint32_t>(format);
+    if (format == FileType::Json) {
+      kind |= static_cast<uint32_t>(jsonBackend_) << 8;
+    }
+    // Results checked against schemas are keyed by the schemas as well.
+    const uint64_t salt = (schema_ ? schema_->hash() : 0) ^
+                          (kubernetes_ ? kubernetes_->hash() : 0);
+    ProfileScope scope("cache", filePath);
+    key = ValidationCache::makeKey(content, kind, salt);
+    if (cache_->lookup(key, result)) {
+      return result;
+    }
+  }
+
+  switch (format) {
+  case FileType::Json: {
+    ProfileScope scope("parse.json", filePath);
     result = validateJSON(content, filePath);
-  } else if (ext == ".yaml" || ext == ".yml") {
+    break;
+  }
+  case FileType::Yaml: {
+    ProfileScope scope("parse.yaml", filePath);
     result = validateYAML(content, filePath);
-  } else if (ext == ".toml") {
+    break;
+  }
+  case FileType::Toml: {
+    ProfileScope scope("parse.toml", filePath);
     result = validateTOML(content, filePath);
-  } else if (ext == ".env" || filePath.find(".env") != std::string::npos) {
+    break;
+  }
+  case FileType::Env: {
+    ProfileScope scope("parse.env", filePath);
     result = validateEnv(content, filePath);
-  } else {
-    result.warnings.push_back("Unknown file type, attempting JSON parse");
-    result = validateJSON(content, filePath);
+    break;
+  }
+  default:
+    break;
+  }
+
+  if (cache_) {
+    cache_->store(key, result);
   }
 
-  printValidationResult(result, filePath);
   return result;
 }
 
 ValidationResult
 ConfigValidator::validateDirectory(const std::string &dirPath) {
+  return scanDirectory(dirPath, nullptr);
+}
+
+ValidationResult ConfigValidator::scanDirectory(
+    const std::string &dirPath,
+    std::map<std::string, ValidationResult> *files) {
   ValidationResult overallResult;
   overallResult.valid = true;
   overallResult.fileType = "directory";
@@ -59,61 +214,504 @@ ConfigValidator::validateDirectory(const std::string &dirPath) {
   int filesChecked = 0;
   int filesValid = 0;
 
+  // Files are handed to the pool as soon as the walk finds them, but results
+  // are reported in sorted path order so that parallel and sequential runs
+  // produce identical output.
+  struct Slot {
+    std::string path;
+    ValidationResult result;
+    ReportBuffer report; // rendered by the worker that checked the file
+    bool archive = false;
+    int files = 1; // config files checked: an archive's members
+    int valid = 0;
+    bool done = false;
+  };
+  auto checkSlot = [this](Slot &slot) {
+    if (slot.archive) {
+      ArchiveCheck check = checkArchive(slot.path, slot.report);
+      slot.result = std::move(check.result);
+      slot.files = check.files;
+      slot.valid = check.valid;
+      return;
+    }
+    try {
+      slot.result = checkFile(slot.path);
+    } catch (const std::exception &e) {
+      slot.result.valid = false;
+      slot.result.errors.add({"Validation failed: ", e.what()});
+    }
+    slot.valid = slot.result.valid ? 1 : 0;
+    slot.report.addFile(slot.path, slot.result);
+  };
+  std::vector<std::unique_ptr<Slot>> slots;
+  std::mutex doneMutex;
+  std::condition_variable doneCv;
+
+  unsigned jobs = jobs_ == 0 ? WorkStealingPool::defaultThreadCount() : jobs_;
+  std::unique_ptr<WorkStealingPool> pool;
+  if (jobs > 1) {
+    pool = std::make_unique<WorkStealingPool>(jobs);
+  }
+
+  // With a pool the walk itself runs on the workers too, so files found in
+  // different subtrees are reported concurrently.
+  std::mutex slotsMutex;
+  WalkStats walk;
   try {
-    for (const auto &entry : fs::recursive_directory_iterator(dirPath)) {
-      if (entry.is_regular_file()) {
-        std::string path = entry.path().string();
-        std::string ext = Utils::getFileExtension(path);
-
-        if (ext == ".json" || ext == ".yaml" || ext == ".yml" ||
-            ext == ".toml" || ext == ".env" ||
-            path.find(".env") != std::string::npos) {
-
-          std::cout << "\n"
-                    << Color::BOLD << "Validating: " << path << Color::RESET
-                    << std::endl;
-          ValidationResult result = validateFile(path);
-          filesChecked++;
-
-          if (result.valid) {
-            filesValid++;
-          } else {
-            overallResult.valid = false;
-            overallResult.errors.insert(overallResult.errors.end(),
-                                        result.errors.begin(),
-                                        result.errors.end());
+    ProfileScope scope("walk", dirPath);
+    DirectoryWalker walker(walkOptions_);
+    walk = walker.walk(
+        dirPath,
+        [&](const std::string &path) {
+          // Archives are picked by name too, so scans never open other
+          // files to sniff them.
+          const bool archive = insideArchives_ && isArchiveName(path);
+          if (!archive && !isConfigFile(path)) {
+            return;
+          }
+          Slot *slot;
+          {
+            std::lock_guard<std::mutex> lock(slotsMutex);
+            slots.push_back(std::make_unique<Slot>());
+            slot = slots.back().get();
           }
+          slot->path = path;
+          slot->archive = archive;
+
+          if (pool) {
+            pool->submit([slot, &checkSlot, &doneMutex, &doneCv] {
+              checkSlot(*slot);
+              {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                slot->done = true;
+              }
+              doneCv.notify_all();
+            });
+          }
+        },
+        pool.get());
+    for (const std::string &error : walk.errors) {
+      overallResult.errors.add({"Directory scan error: ", error});
+      overallResult.valid = false;
+    }
+  } catch (const std::exception &e) {
+    overallResult.errors.add({"Directory scan error: ", e.what()});
+    overallResult.valid = false;
+  }
 
-          overallResult.warnings.insert(overallResult.warnings.end(),
-                                        result.warnings.begin(),
-                                        result.warnings.end());
-        }
-      }
+  std::sort(slots.begin(), slots.end(),
+            [](const std::unique_ptr<Slot> &a, const std::unique_ptr<Slot> &b) {
+              return a->path < b->path;
+            });
+
+  for (const auto &slot : slots) {
+    if (pool) {
+      std::unique_lock<std::mutex> lock(doneMutex);
+      doneCv.wait(lock, [&slot] { return slot->done; });
+    } else {
+      checkSlot(*slot);
+    }
+
+    ValidationResult &result = slot->result;
+    Report::merge(slot->report);
+    filesChecked += slot->files;
+    filesValid += slot->valid;
+    if (files && !slot->archive) {
+      (*files)[slot->path] = result;
+    }
+
+    // The slot is done with, so its messages are moved rather than copied.
+    if (!result.valid) {
+      overallResult.valid = false;
+      overallResult.errors.append(std::move(result.errors));
+    }
+    overallResult.warnings.append(std::move(result.warnings));
+  }
+
+  std::ostream &out = Report::out();
+  out << "\n"
+      << Color::BOLD << "=== Directory Validation Summary ===" << Color::RESET
+      << '\n';
+  out << "Files checked: " << filesChecked << '\n';
+  out << "Files valid: " << filesValid << '\n';
+  out << "Files invalid: " << (filesChecked - filesValid) << '\n';
+  char walked[160];
+  std::snprintf(walked, sizeof(walked),
+                "Walk: %llu directories, %llu files in %.1f ms "
+                "(%llu pruned, %llu ignored)",
+                static_cast<unsigned long long>(walk.directories),
+                static_cast<unsigned long long>(walk.files), walk.elapsedMs,
+                static_cast<unsigned long long>(walk.pruned),
+                static_cast<unsigned long long>(walk.ignored));
+  out << walked << '\n';
+  if (cache_) {
+    out << "Cache hits: " << cache_->hits() << ", misses: " << cache_->misses()
+        << '\n';
+  }
+  if (schema_ || kubernetes_) {
+    // Throughput of the schema checks alone, summed over worker threads.
+    const uint64_t documents = schemaDocuments_.load();
+    const double seconds =
+        static_cast<double>(schemaNanoseconds_.load()) / 1e9;
+    out << "Schema: " << documents << " documents checked";
+    if (documents > 0 && seconds > 0) {
+      out << ", " << static_cast<uint64_t>(documents / seconds) << " docs/s";
+    }
+    out << '\n';
+  }
+  // Time spent writing output, results included.
+  Report::flush();
+  char written[96];
+  std::snprintf(written, sizeof(written), "Output: %.1f KiB written in %.1f ms",
+                static_cast<double>(Report::bytesWritten()) / 1024.0,
+                static_cast<double>(Report::writeNanoseconds()) / 1e6);
+  out << written << '\n';
+
+  return overallResult;
+}
+
+ConfigValidator::ArchiveCheck
+ConfigValidator::checkArchive(const std::string &archivePath,
+                              ReportBuffer &report) {
+  ProfileScope scope("archive", archivePath);
+  const auto start = std::chrono::steady_clock::now();
+  ArchiveCheck check;
+  check.result.valid = true;
+  check.result.fileType = "archive";
+
+  auto onMember = [&](const std::string &path, std::string_view content) {
+    ValidationResult result;
+    try {
+      result = checkContent(content, path);
+    } catch (const std::exception &e) {
+      result.valid = false;
+      result.errors.add({"Validation failed: ", e.what()});
+    }
+    report.addFile(archivePath + "!" + path, result);
+
+    check.files++;
+    if (result.valid) {
+      check.valid++;
+    } else {
+      check.result.valid = false;
+      check.result.errors.append(std::move(result.errors));
+    }
+    check.result.warnings.append(std::move(result.warnings));
+  };
+
+  try {
+    ArchiveReader reader(archivePath);
+    check.stats = reader.read(
+        [](const std::string &path) { return isConfigFile(path); }, onMember);
+    for (const std::string &skipped : check.stats.skipped) {
+      check.result.warnings.add({"Skipped ", archivePath, "!", skipped});
+    }
+  } catch (const std::exception &e) {
+    // Reported like an unreadable file, after any members already checked.
+    ValidationResult failed;
+    failed.valid = false;
+    failed.fileType = "archive";
+    failed.errors.add({"Archive read failed: ", e.what()});
+    report.addFile(archivePath, failed);
+    check.result.valid = false;
+    check.result.errors.push_back(failed.errors.back());
+  }
+
+  check.elapsedMs = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  return check;
+}
+
+ValidationResult
+ConfigValidator::validateArchive(const std::string &archivePath) {
+  Utils::printInfo("Scanning archive: " + archivePath);
+
+  ReportBuffer report;
+  ArchiveCheck check = checkArchive(archivePath, report);
+  Report::merge(report);
+  for (const std::string &skipped : check.stats.skipped) {
+    Utils::printWarning("Skipped " + archivePath + "!" + skipped);
+  }
+
+  std::ostream &out = Report::out();
+  out << "\n"
+      << Color::BOLD << "=== Archive Validation Summary ===" << Color::RESET
+      << '\n';
+  out << "Files checked: " << check.files << '\n';
+  out << "Files valid: " << check.valid << '\n';
+  out << "Files invalid: " << (check.files - check.valid) << '\n';
+  char read[160];
+  std::snprintf(read, sizeof(read),
+                "Archive: %llu members, %.1f KiB read, %.1f KiB unpacked in "
+                "%.1f ms",
+                static_cast<unsigned long long>(check.stats.members),
+                static_cast<double>(check.stats.bytesRead) / 1024.0,
+                static_cast<double>(check.stats.bytesUnpacked) / 1024.0,
+                check.elapsedMs);
+  out << read << '\n';
+
+  return check.result;
+}
+
+ValidationResult
+ConfigValidator::validateGitRevision(const std::string &repoPath,
+                                     const std::string &rev,
+                                     const std::string &sinceRev) {
+  ValidationResult overallResult;
+  overallResult.valid = true;
+  overallResult.fileType = "git";
+
+  std::vector<GitTreeEntry> entries;
+  std::unique_ptr<GitRepository> repo;
+  try {
+    repo = std::make_unique<GitRepository>(repoPath);
+    const GitOid commit = repo->resolve(rev);
+    Utils::printInfo("Scanning " + rev + " (" + commit.hex().substr(0, 12) +
+                     ") in " + repo->gitDir());
+    if (sinceRev.empty()) {
+      entries = repo->listFiles(commit);
+    } else {
+      const GitOid base = repo->resolve(sinceRev);
+      entries = repo->listChangedFiles(base, commit);
+      Utils::printInfo(std::to_string(entries.size()) +
+                       " files changed since " + sinceRev);
     }
   } catch (const std::exception &e) {
-    overallResult.errors.push_back(std::string("Directory scan error: ") +
-                                   e.what());
     overallResult.valid = false;
+    overallResult.errors.push_back(e.what());
+    Utils::printError(e.what());
+    return overallResult;
+  }
+
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [](const GitTreeEntry &entry) {
+                                 return !isConfigFile(entry.path);
+                               }),
+                entries.end());
+
+  // Blobs are inflated and results rendered on the workers too; the
+  // repository is thread-safe. Structured reports name files by their path
+  // in the tree, the human one by <rev>:<path>.
+  const bool human = Report::format() == ReportFormat::Human;
+  std::vector<ValidationResult> results(entries.size());
+  std::vector<ReportBuffer> reports(entries.size());
+  auto checkEntry = [this, &repo, &entries, &results, &reports, &rev,
+                     human](size_t i) {
+    ValidationResult result;
+    try {
+      const std::string content = repo->readBlob(entries[i].blob);
+      result = checkContent(content, entries[i].path);
+    } catch (const std::exception &e) {
+      result.valid = false;
+      result.errors.add({"Validation failed: ", e.what()});
+    }
+    reports[i].addFile(human ? rev + ":" + entries[i].path : entries[i].path,
+                       result);
+    results[i] = std::move(result);
+  };
+
+  unsigned jobs = jobs_ == 0 ? WorkStealingPool::defaultThreadCount() : jobs_;
+  if (jobs > 1 && entries.size() > 1) {
+    WorkStealingPool pool(jobs);
+    for (size_t i = 0; i < entries.size(); i++) {
+      pool.submit([&checkEntry, i] { checkEntry(i); });
+    }
+    pool.wait();
+  } else {
+    for (size_t i = 0; i < entries.size(); i++) {
+      checkEntry(i);
+    }
   }
 
-  std::cout << "\n"
-            << Color::BOLD
-            << "=== Directory Validation Summary ===" << Color::RESET
-            << std::endl;
-  std::cout << "Files checked: " << filesChecked << std::endl;
-  std::cout << "Files valid: " << filesValid << std::endl;
-  std::cout << "Files invalid: " << (filesChecked - filesValid) << std::endl;
+  int filesValid = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    ValidationResult &result = results[i];
+    Report::merge(reports[i]);
+
+    if (result.valid) {
+      filesValid++;
+    } else {
+      overallResult.valid = false;
+      overallResult.errors.append(std::move(result.errors));
+    }
+    overallResult.warnings.append(std::move(result.warnings));
+  }
+
+  const int filesChecked = static_cast<int>(entries.size());
+  std::ostream &out = Report::out();
+  out << "\n"
+      << Color::BOLD << "=== Revision Validation Summary ===" << Color::RESET
+      << '\n';
+  out << "Files checked: " << filesChecked << '\n';
+  out << "Files valid: " << filesValid << '\n';
+  out << "Files invalid: " << (filesChecked - filesValid) << '\n';
+  if (cache_) {
+    out << "Cache hits: " << cache_->hits() << ", misses: " << cache_->misses()
+        << '\n';
+  }
 
   return overallResult;
 }
 
-ValidationResult ConfigValidator::validateJSON(const std::string &content,
+ValidationResult ConfigValidator::watchDirectory(const std::string &dirPath) {
+  // Watches are in place before the first pass, so files changed during it
+  // are revalidated afterwards rather than missed.
+  DirectoryWatcher watcher(dirPath, walkOptions_);
+  std::map<std::string, ValidationResult> files;
+  scanDirectory(dirPath, &files);
+
+  unsigned jobs = jobs_ == 0 ? WorkStealingPool::defaultThreadCount() : jobs_;
+  std::unique_ptr<WorkStealingPool> pool;
+  if (jobs > 1) {
+    pool = std::make_unique<WorkStealingPool>(jobs);
+  }
+
+  Utils::printInfo("Watching " + std::to_string(watcher.directoryCount()) +
+                   " directories under " + dirPath + " (Ctrl+C to stop)");
+  Report::flush();
+
+  uint64_t batches = 0;
+  uint64_t revalidated = 0;
+  double totalLatencyMs = 0;
+  double maxLatencyMs = 0;
+  const auto watchStart = std::chrono::steady_clock::now();
+  const std::clock_t cpuStart = std::clock();
+
+  WatchBatch batch;
+  while (watcher.next(batch)) {
+    if (batch.overflow) {
+      Utils::printWarning("File events were lost, rescanning " + dirPath);
+      files.clear();
+      scanDirectory(dirPath, &files);
+      Report::flush();
+      continue;
+    }
+
+    for (const std::string &dir : batch.removedDirectories) {
+      const std::string prefix = dir + "/";
+      for (auto it = files.lower_bound(prefix);
+           it != files.end() && it->first.compare(0, prefix.size(), prefix) == 0;) {
+        Utils::printInfo("Removed: " + it->first);
+        it = files.erase(it);
+      }
+    }
+    for (const std::string &path : batch.removed) {
+      if (files.erase(path)) {
+        Utils::printInfo("Removed: " + path);
+      }
+    }
+
+    std::vector<std::string> paths;
+    for (const std::string &path : batch.changed) {
+      if (isConfigFile(path)) {
+        paths.push_back(path);
+      }
+    }
+    std::vector<ValidationResult> results(paths.size());
+    if (pool && paths.size() > 1) {
+      for (size_t i = 0; i < paths.size(); i++) {
+        pool->submit([this, &paths, &results, i] {
+          results[i] = check(paths[i]);
+        });
+      }
+      pool->wait();
+    } else {
+      for (size_t i = 0; i < paths.size(); i++) {
+        results[i] = check(paths[i]);
+      }
+    }
+    for (size_t i = 0; i < paths.size(); i++) {
+      Report::fileResult(paths[i], results[i], true);
+      files[paths[i]] = std::move(results[i]);
+    }
+    Report::flush();
+
+    // Event-to-result latency: from reading the batch's first event to its
+    // last result being printed, debounce window included.
+    const double latencyMs =
+        std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - batch.firstEvent)
+            .count();
+    batches++;
+    revalidated += paths.size();
+    totalLatencyMs += latencyMs;
+    maxLatencyMs = std::max(maxLatencyMs, latencyMs);
+
+    size_t valid = 0;
+    for (const auto &[path, result] : files) {
+      valid += result.valid ? 1 : 0;
+    }
+    char latency[32];
+    std::snprintf(latency, sizeof(latency), "%.1f", latencyMs);
+    Utils::printInfo("Files: " + std::to_string(files.size()) + ", valid: " +
+                     std::to_string(valid) + ", invalid: " +
+                     std::to_string(files.size() - valid) + " (revalidated " +
+                     std::to_string(paths.size()) + " in " + latency + " ms)");
+    Report::flush();
+  }
+
+  const double wallSeconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - watchStart)
+                                 .count();
+  const double cpuSeconds =
+      static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+  ValidationResult overallResult;
+  overallResult.valid = true;
+  overallResult.fileType = "directory";
+  for (const auto &[path, result] : files) {
+    overallResult.valid = overallResult.valid && result.valid;
+  }
+
+  char line[160];
+  std::ostream &out = Report::out();
+  out << "\n" << Color::BOLD << "=== Watch Summary ===" << Color::RESET << '\n';
+  out << "Batches: " << batches << ", files revalidated: " << revalidated
+      << '\n';
+  std::snprintf(line, sizeof(line),
+                "Event-to-result latency: mean %.1f ms, max %.1f ms",
+                batches ? totalLatencyMs / static_cast<double>(batches) : 0.0,
+                maxLatencyMs);
+  out << line << '\n';
+  std::snprintf(line, sizeof(line), "CPU: %.3f s over %.1f s watching (%.2f%%)",
+                cpuSeconds, wallSeconds,
+                wallSeconds > 0 ? 100.0 * cpuSeconds / wallSeconds : 0.0);
+  out << line << '\n';
+
+  return overallResult;
+}
+
+ValidationResult ConfigValidator::validateJSON(std::string_view content,
                                                const std::string &filePath) {
   ValidationResult result;
   result.fileType = "JSON";
 
+  // Schema checks need a document, so they always take the DOM path.
+  if (jsonBackend_ == JsonBackend::Simd && !schema_ && !kubernetes_ &&
+      content.size() <= JsonScanner::MAX_INPUT_SIZE) {
+    JsonScanResult scan = JsonScanner::scan(content);
+    result.valid = scan.valid;
+    if (scan.numberOverflow) {
+      result.errors.add({"JSON number out of range: ", scan.error});
+      return result;
+    }
+    if (!scan.valid) {
+      result.errors.add({"JSON parse error at byte ",
+                         std::to_string(scan.errorByte), ": ", scan.error});
+      return result;
+    }
+    if (scan.emptyRootObject) {
+      result.warnings.push_back("JSON object is empty");
+    }
+    if (scan.hasVersion) {
+      result.notes.add({"Version: ", scan.version});
+    }
+    return result;
+  }
+
   try {
-    json j = json::parse(content);
+    json j = json::parse(content.begin(), content.end());
     result.valid = true;
 
     // Additional checks
@@ -123,166 +721,233 @@ ValidationResult ConfigValidator::validateJSON(const std::string &content,
 
     // Check for common DevOps config patterns
     if (j.contains("version") && j["version"].is_string()) {
-      Utils::printInfo("Version: " + j["version"].get<std::string>());
+      result.notes.add(
+          {"Version: ", j["version"].get_ref<const std::string &>()});
     }
 
+    checkDocument(j, "", result);
+
   } catch (const json::parse_error &e) {
     result.valid = false;
-    result.errors.push_back("JSON parse error at byte " +
-                            std::to_string(e.byte) + ": " + e.what());
+    result.errors.add(
+        {"JSON parse error at byte ", std::to_string(e.byte), ": ", e.what()});
+  } catch (const json::out_of_range &e) {
+    // 406: a number that overflows a double while parsing.
+    if (e.id != 406) {
+      throw;
+    }
+    result.valid = false;
+    result.errors.add({"JSON number out of range: ", e.what()});
   }
 
   return result;
 }
 
-ValidationResult ConfigValidator::validateYAML(const std::string &content,
+ValidationResult ConfigValidator::validateYAML(std::string_view content,
                                                const std::string &filePath) {
   ValidationResult result;
   result.fileType = "YAML";
 
-  try {
-    YAML::Node config = YAML::Load(content);
-    result.valid = true;
+  // Schema results are held per document until the stream is done, since
+  // only then is it known whether messages need a document prefix.
+  std::vector<ValidationResult> schemaResults;
+  YamlStreamScanner::DocumentCallback onDocument;
+  if (schema_ || kubernetes_) {
+    onDocument = [this, &schemaResults](size_t, const json &document) {
+      schemaResults.emplace_back();
+      schemaResults.back().valid = true;
+      checkDocument(document, "", schemaResults.back());
+    };
+  }
+
+  ViewStreamBuf buffer(content);
+  std::istream stream(&buffer);
+  YamlStreamResult scan = YamlStreamScanner::scan(stream, onDocument);
+  result.valid = scan.valid;
+
+  // Multi-document streams (e.g. Kubernetes bundles) report per document.
+  const bool multiDocument =
+      scan.documents.size() > 1 || (!scan.valid && !scan.documents.empty());
+  if (multiDocument) {
+    result.notes.push_back(
+        scan.valid ? std::to_string(scan.documents.size()) + " documents"
+                   : "Documents parsed before the error: " +
+                         std::to_string(scan.documents.size()));
+  }
 
-    if (config.IsNull()) {
-      result.warnings.push_back("YAML file is empty");
+  for (size_t i = 0; i < scan.documents.size(); i++) {
+    const YamlDocumentFacts &doc = scan.documents[i];
+    const std::string prefix =
+        multiDocument ? "Document " + std::to_string(i + 1) + ": " : "";
+
+    if (doc.root == YamlDocumentFacts::Root::Null) {
+      result.warnings.add({prefix, multiDocument ? "YAML document is empty"
+                                                 : "YAML file is empty"});
     }
 
     // Check for Ansible playbook
-    if (config.IsSequence() && config.size() > 0 && config[0]["hosts"]) {
-      Utils::printInfo("Detected Ansible playbook");
+    if (doc.root == YamlDocumentFacts::Root::Sequence &&
+        doc.hasHostsInFirstItem) {
+      result.notes.add({prefix, "Detected Ansible playbook"});
     }
 
     // Check for Docker Compose
-    if (config["services"]) {
-      Utils::printInfo("Detected Docker Compose file");
-      if (!config["version"]) {
-        result.warnings.push_back("Docker Compose 'version' field missing");
+    if (doc.hasServices) {
+      result.notes.add({prefix, "Detected Docker Compose file"});
+      if (!doc.hasVersion) {
+        result.warnings.add({prefix, "Docker Compose 'version' field missing"});
       }
     }
 
     // Check for Kubernetes
-    if (config["apiVersion"] && config["kind"]) {
-      Utils::printInfo("Detected Kubernetes manifest");
+    if (doc.hasApiVersion && doc.hasKind) {
+      result.notes.add({prefix, "Detected Kubernetes manifest"});
     }
 
-  } catch (const YAML::Exception &e) {
-    result.valid = false;
-    result.errors.push_back(std::string("YAML parse error: ") + e.what());
+    if (i < schemaResults.size()) {
+      const ValidationResult &checked = schemaResults[i];
+      result.valid = result.valid && checked.valid;
+      for (const Diagnostic &error : checked.errors) {
+        result.errors.add({prefix, error.text}, error.line, error.column);
+      }
+      for (const Diagnostic &note : checked.notes) {
+        result.notes.add({prefix, note.text}, note.line, note.column);
+      }
+    }
+  }
+
+  if (scan.valid && scan.documents.empty()) {
+    result.warnings.push_back("YAML file is empty");
+  }
+
+  if (!scan.valid) {
+    result.errors.push_back(
+        multiDocument ? "YAML parse error in document " +
+                            std::to_string(scan.documents.size() + 1) + ": " +
+                            scan.error
+                      : "YAML parse error: " + scan.error);
   }
 
   return result;
 }
 
-ValidationResult ConfigValidator::validateTOML(const std::string &content,
+ValidationResult ConfigValidator::validateTOML(std::string_view content,
                                                const std::string &filePath) {
   ValidationResult result;
   result.fileType = "TOML";
 
-  // Basic TOML validation (regex-based since we don't have a TOML library)
-  // Check for basic TOML syntax
-  std::regex sectionRegex(R"(\[[\w\.\-]+\])");
-  std::regex keyValueRegex(R"([\w\-]+\s*=\s*.+)");
-
-  bool hasContent = false;
-  std::istringstream stream(content);
-  std::string line;
-  int lineNum = 0;
-
-  while (std::getline(stream, line)) {
-    lineNum++;
-    // Skip comments and empty lines
-    std::string trimmed = line;
-    trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-
-    if (trimmed.empty() || trimmed[0] == '#') {
-      continue;
-    }
+  TomlParseResult parsed = TomlParser(content).run();
+  result.valid = parsed.valid;
 
-    hasContent = true;
-
-    // Check if it's a section or key-value pair
-    if (!std::regex_search(trimmed, sectionRegex) &&
-        !std::regex_search(trimmed, keyValueRegex)) {
-      result.warnings.push_back("Line " + std::to_string(lineNum) +
-                                " doesn't match TOML syntax: " + trimmed);
-    }
-  }
-
-  if (!hasContent) {
+  if (!parsed.valid) {
+    result.errors.add({parsed.error}, static_cast<uint32_t>(parsed.errorLine),
+                      static_cast<uint32_t>(parsed.errorColumn));
+  } else if (parsed.keys == 0 && parsed.tables == 0) {
     result.warnings.push_back("TOML file appears to be empty");
   }
 
-  result.valid = true; // We're lenient with TOML
   return result;
 }
 
-ValidationResult ConfigValidator::validateEnv(const std::string &content,
+ValidationResult ConfigValidator::validateEnv(std::string_view content,
                                               const std::string &filePath) {
   ValidationResult result;
   result.fileType = "ENV";
 
-  std::regex envRegex(R"(^[\w]+=[^\s]*)");
-  std::regex commentRegex(R"(^\s*#)");
-
-  std::istringstream stream(content);
-  std::string line;
-  int lineNum = 0;
-  int validVars = 0;
-
-  while (std::getline(stream, line)) {
-    lineNum++;
+  EnvLexResult lexed = EnvLexer(content).run();
+  result.valid = lexed.errors.empty();
+  result.errors = std::move(lexed.errors);
+  result.warnings = std::move(lexed.warnings);
 
-    if (line.empty() || std::regex_search(line, commentRegex)) {
-      continue;
-    }
-
-    if (std::regex_search(line, envRegex)) {
-      validVars++;
-
-      // Check for unquoted values with spaces
-      if (line.find('=') != std::string::npos) {
-        std::string value = line.substr(line.find('=') + 1);
-        if (value.find(' ') != std::string::npos && value[0] != '"' &&
-            value[0] != '\'') {
-          result.warnings.push_back("Line " + std::to_string(lineNum) +
-                                    ": unquoted value with spaces");
-        }
-      }
-    } else {
-      result.warnings.push_back("Line " + std::to_string(lineNum) +
-                                " doesn't match ENV syntax: " + line);
-    }
-  }
-
-  if (validVars == 0) {
+  if (lexed.variables == 0) {
     result.warnings.push_back("No valid environment variables found");
   }
 
-  result.valid = true;
-  Utils::printInfo("Found " + std::to_string(validVars) +
-                   " environment variables");
+  result.notes.add(
+      {"Found ", std::to_string(lexed.variables), " environment variables"});
 
   return result;
 }
 
-void ConfigValidator::printValidationResult(const ValidationResult &result,
-                                            const std::string &filePath) {
-  if (result.valid) {
-    Utils::printSuccess("Valid " + result.fileType + " file");
-  } else {
-    Utils::printError("Invalid " + result.fileType + " file");
+void ConfigValidator::checkDocument(const json &document,
+                                    const std::string &prefix,
+                                    ValidationResult &result) {
+  if (schema_) {
+    checkSchema(*schema_, document, prefix, result);
+  }
+  if (kubernetes_) {
+    checkKubernetes(document, prefix, result);
   }
+}
 
-  for (const auto &error : result.errors) {
-    std::cerr << Color::RED << "  ERROR: " << error << Color::RESET
-              << std::endl;
+void ConfigValidator::checkKubernetes(const json &document,
+                                      const std::string &prefix,
+                                      ValidationResult &result) {
+  if (!document.is_object()) {
+    return;
+  }
+  auto apiVersion = document.find("apiVersion");
+  auto kind = document.find("kind");
+  if (apiVersion == document.end() || !apiVersion->is_string() ||
+      kind == document.end() || !kind->is_string()) {
+    return;
   }
 
-  for (const auto &warning : result.warnings) {
-    std::cout << Color::YELLOW << "  WARNING: " << warning << Color::RESET
-              << std::endl;
+  const std::string &group = apiVersion->get_ref<const std::string &>();
+  const std::string &name = kind->get_ref<const std::string &>();
+  KubernetesSchemas::Match match = kubernetes_->find(group, name);
+  switch (match.status) {
+  case KubernetesSchemas::Match::Status::Checked:
+    checkSchema(*match.schema, document, prefix, result);
+    break;
+  case KubernetesSchemas::Match::Status::NotServed:
+    result.valid = false;
+    result.errors.add({prefix, match.reason});
+    break;
+  case KubernetesSchemas::Match::Status::Unchecked:
+  case KubernetesSchemas::Match::Status::Unknown:
+    result.notes.add({prefix, "No bundled Kubernetes ", kubernetes_->version(),
+                      " schema for ", group, " ", name, ", not checked"});
+    break;
   }
 }
 
+void ConfigValidator::checkSchema(const CompiledSchema &schema,
+                                  const json &document,
+                                  const std::string &prefix,
+                                  ValidationResult &result) {
+  constexpr size_t MAX_VIOLATIONS = 20;
+  std::vector<SchemaViolation> violations;
+  ProfileScope scope("schema");
+
+  auto start = std::chrono::steady_clock::now();
+  bool valid = schema.validate(document, violations, MAX_VIOLATIONS);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  schemaDocuments_.fetch_add(1, std::memory_order_relaxed);
+  schemaNanoseconds_.fetch_add(
+      static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count()),
+      std::memory_order_relaxed);
+
+  if (valid) {
+    return;
+  }
+  result.valid = false;
+  for (const auto &violation : violations) {
+    result.errors.add({prefix, "Schema violation at ",
+                       violation.path.empty() ? "(root)" : violation.path,
+                       ": ", violation.message});
+  }
+  if (violations.size() == MAX_VIOLATIONS) {
+    result.errors.add({prefix, "Further schema violations were not reported"});
+  }
+}
+
+void ConfigValidator::printValidationResult(const ValidationResult &result,
+                                            const std::string &filePath) {
+  Report::fileResult(filePath, result);
+}
+
 } // namespace devops
@@ -0,0 +1,272 @@
+#include "corpus_generator.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace devops {
+
+namespace {
+
+// SplitMix64: tiny, fast and identical everywhere.
+class Rng {
+public:
+  explicit Rng(uint64_t seed) : state_(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [0, bound).
+  size_t below(size_t bound) { return static_cast<size_t>(next() % bound); }
+
+  double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+  template <size_t N> const char *pick(const char *const (&items)[N]) {
+    return items[below(N)];
+  }
+
+private:
+  uint64_t state_;
+};
+
+const char *const WORDS[] = {"api",     "auth",   "billing", "cache",
+                             "catalog", "gateway", "ledger", "metrics",
+                             "orders",  "search", "session", "worker"};
+const char *const IMAGES[] = {"nginx:1.25",      "redis:7.2",
+                              "postgres:16",     "node:20-alpine",
+                              "python:3.12-slim", "golang:1.22"};
+const char *const STAGES[] = {"development", "staging", "production", "test"};
+
+// Every random draw is a separate statement: the operands of `+` are
+// evaluated in an unspecified order, which would make output differ
+// between compilers.
+std::string version(Rng &rng) {
+  const size_t major = rng.below(4);
+  const size_t minor = rng.below(30);
+  const size_t patch = rng.below(20);
+  return std::to_string(major) + "." + std::to_string(minor) + "." +
+         std::to_string(patch);
+}
+
+std::string kubernetes(Rng &rng, const std::string &name, size_t target) {
+  const size_t replicas = 1 + rng.below(5);
+  const std::string tag = version(rng);
+  const size_t port = 8000 + rng.below(1000);
+
+  std::string text = "apiVersion: apps/v1\nkind: Deployment\nmetadata:\n";
+  text += "  name: " + name + "\n  labels:\n    app: " + name + "\n";
+  text += "    tier: backend\nspec:\n";
+  text += "  replicas: " + std::to_string(replicas) + "\n";
+  text += "  selector:\n    matchLabels:\n      app: " + name + "\n";
+  text += "  template:\n    metadata:\n      labels:\n";
+  text += "        app: " + name + "\n    spec:\n      containers:\n";
+  text += "        - name: app\n          image: registry.example.com/" + name +
+          ":" + tag + "\n";
+  text += "          ports:\n            - containerPort: " +
+          std::to_string(port) + "\n";
+  text += "          resources:\n            limits:\n";
+  text += "              cpu: 500m\n              memory: 256Mi\n";
+  text += "          env:\n";
+
+  std::string service = "---\napiVersion: v1\nkind: Service\nmetadata:\n";
+  service += "  name: " + name + "\nspec:\n  selector:\n    app: " + name;
+  service += "\n  ports:\n    - port: 80\n      targetPort: 8080\n";
+
+  for (size_t i = 0; text.size() + service.size() < target; i++) {
+    const std::string key = rng.pick(WORDS);
+    const std::string value = rng.pick(WORDS);
+    const size_t suffix = rng.below(100000);
+    text += "            - name: " + key + "_" + std::to_string(i) +
+            "\n              value: \"" + value + "-" +
+            std::to_string(suffix) + "\"\n";
+  }
+  return text + service;
+}
+
+std::string compose(Rng &rng, size_t target) {
+  std::string text = "services:\n";
+  for (size_t i = 0; text.size() < target; i++) {
+    const std::string name = rng.pick(WORDS);
+    const std::string image = rng.pick(IMAGES);
+    const size_t port = 80 + rng.below(9000);
+    const std::string stage = rng.pick(STAGES);
+    text += "  " + name + "-" + std::to_string(i) + ":\n";
+    text += "    image: " + image + "\n    restart: unless-stopped\n";
+    text += "    ports:\n      - \"" + std::to_string(8000 + i) + ":" +
+            std::to_string(port) + "\"\n";
+    text += "    environment:\n      LOG_LEVEL: info\n";
+    text += "      STAGE: " + stage + "\n";
+  }
+  return text;
+}
+
+std::string packageJson(Rng &rng, const std::string &name, size_t target) {
+  std::string text = "{\n  \"name\": \"@example/" + name + "\",\n";
+  text += "  \"version\": \"" + version(rng) + "\",\n";
+  text += "  \"private\": true,\n  \"scripts\": {\n";
+  text += "    \"build\": \"tsc -p .\",\n    \"test\": \"jest --ci\"\n  },\n";
+  text += "  \"dependencies\": {\n";
+  for (size_t i = 0; text.size() < target; i++) {
+    const std::string dependency = rng.pick(WORDS);
+    const std::string range = version(rng);
+    text += i ? ",\n" : "";
+    text += "    \"" + dependency + "-lib-" + std::to_string(i) + "\": \"^" +
+            range + "\"";
+  }
+  return text + "\n  }\n}\n";
+}
+
+std::string env(Rng &rng, size_t target) {
+  std::string text = "# " + std::string(rng.pick(STAGES)) + " settings\n";
+  for (size_t i = 0; text.size() < target; i++) {
+    std::string key = rng.pick(WORDS);
+    for (char &c : key) {
+      c = static_cast<char>(c - 'a' + 'A');
+    }
+    key += "_" + std::to_string(i);
+    const size_t style = rng.below(4);
+    const std::string first = rng.pick(WORDS);
+    const std::string second = rng.pick(WORDS);
+    const size_t number = rng.below(65536);
+    if (style == 0) {
+      text += key + "=\"" + first + " " + second + "\"\n";
+    } else if (style == 1) {
+      text += "export " + key + "=" + std::to_string(number) + "\n";
+    } else {
+      text += key + "=" + first + "-" + std::to_string(number % 1000) + "\n";
+    }
+  }
+  return text;
+}
+
+std::string dockerfile(Rng &rng, size_t target) {
+  const bool multiStage = rng.below(2) == 0;
+  const std::string image = rng.pick(IMAGES);
+  std::string text = "FROM " + image + (multiStage ? " AS build" : "");
+  text += "\nWORKDIR /app\nCOPY . .\n";
+  for (size_t i = 0; text.size() + 80 < target; i++) {
+    const std::string tool = rng.pick(WORDS);
+    const std::string scratch = rng.pick(WORDS);
+    text += "RUN " + tool + "-setup --step " + std::to_string(i) +
+            " && rm -rf /tmp/" + scratch + "\n";
+  }
+  if (multiStage) {
+    text += "FROM gcr.io/distroless/base\nCOPY --from=build /app /app\n";
+  }
+  return text + "EXPOSE 8080\nCMD [\"/app/server\"]\n";
+}
+
+std::string toml(Rng &rng, const std::string &name, size_t target) {
+  std::string text = "[package]\nname = \"" + name + "\"\n";
+  text += "version = \"" + version(rng) + "\"\nedition = \"2021\"\n\n";
+  text += "[dependencies]\n";
+  for (size_t i = 0; text.size() + 40 < target; i++) {
+    const std::string crate = rng.pick(WORDS);
+    const bool inlineTable = rng.below(3) == 0;
+    const std::string range = version(rng);
+    text += crate + "-crate-" + std::to_string(i);
+    text += inlineTable ? " = { version = \"" + range +
+                              "\", features = [\"full\"] }\n"
+                        : " = \"" + range + "\"\n";
+  }
+  return text + "\n[[bin]]\nname = \"" + name + "\"\npath = \"src/main.rs\"\n";
+}
+
+// Cumulative weights out of 100, in CorpusKind order.
+const unsigned KIND_WEIGHTS[CORPUS_KIND_COUNT] = {35, 45, 65, 80, 90, 100};
+
+} // namespace
+
+const char *corpusKindName(CorpusKind kind) {
+  switch (kind) {
+  case CorpusKind::Kubernetes:
+    return "kubernetes";
+  case CorpusKind::Compose:
+    return "compose";
+  case CorpusKind::PackageJson:
+    return "package.json";
+  case CorpusKind::Env:
+    return "env";
+  case CorpusKind::Dockerfile:
+    return "dockerfile";
+  case CorpusKind::Toml:
+    return "toml";
+  }
+  return "unknown";
+}
+
+Corpus generateCorpus(const std::string &dir, const CorpusOptions &options) {
+  fs::remove_all(dir);
+  Rng rng(options.seed);
+  Corpus corpus;
+
+  for (size_t i = 0; i < options.files; i++) {
+    // About eight files per service directory.
+    const std::string service = std::string(WORDS[(i / 8) % 12]) + "-" +
+                                std::to_string(i / 8);
+    const fs::path serviceDir = fs::path(dir) / "services" / service;
+    const size_t target =
+        options.averageBytes / 2 + rng.below(options.averageBytes + 1);
+    const std::string id = std::to_string(i);
+
+    const size_t roll = rng.below(100);
+    size_t k = 0;
+    while (roll >= KIND_WEIGHTS[k]) {
+      k++;
+    }
+    const CorpusKind kind = static_cast<CorpusKind>(k);
+
+    fs::path path;
+    std::string text;
+    switch (kind) {
+    case CorpusKind::Kubernetes:
+      path = serviceDir / "k8s" / ("deployment-" + id + ".yaml");
+      text = kubernetes(rng, service, target);
+      break;
+    case CorpusKind::Compose:
+      path = serviceDir / ("docker-compose." + id + ".yml");
+      text = compose(rng, target);
+      break;
+    case CorpusKind::PackageJson:
+      path = serviceDir / ("web-" + id) / "package.json";
+      text = packageJson(rng, service, target);
+      break;
+    case CorpusKind::Env:
+      path = serviceDir / (".env." + std::string(STAGES[i % 4]) + "-" + id);
+      text = env(rng, target);
+      break;
+    case CorpusKind::Dockerfile:
+      path = serviceDir / ("Dockerfile." + id);
+      text = dockerfile(rng, target);
+      break;
+    case CorpusKind::Toml:
+      path = serviceDir / ("crate-" + id) / "Cargo.toml";
+      text = toml(rng, service, target);
+      break;
+    }
+
+    // Dockerfiles are not validated, so there is nothing to break.
+    const bool cut = rng.unit() < options.invalidFraction;
+    if (cut && kind != CorpusKind::Dockerfile) {
+      // Cutting a file in half is not always enough to break it; an
+      // unclosed bracket or, for ENV, quote on a line of its own always is.
+      // (Cut inside a quoted scalar, yaml-cpp takes the rest as its value.)
+      text.resize(text.rfind('\n', text.size() / 2) + 1);
+      text += kind == CorpusKind::Env ? "BROKEN=\"\n" : "{[\n";
+      corpus.invalid++;
+    }
+
+    fs::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+    corpus.files.push_back({path.string(), kind, text.size()});
+    corpus.bytes += text.size();
+  }
+  return corpus;
+}
+
+} // namespace devops
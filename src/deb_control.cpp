@@ -0,0 +1,190 @@
+#include "deb_control.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace devops {
+
+namespace {
+
+bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+std::string_view trim(std::string_view text) {
+  while (!text.empty() && isBlank(text.front())) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && isBlank(text.back())) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+char lower(char c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool sameName(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(),
+                    [](char x, char y) { return lower(x) == lower(y); });
+}
+
+// "pkg:any (>= 1.0) [amd64] <!nocheck>"; only the name and the version
+// constraint are kept.
+DebRelation parseRelation(std::string_view text, std::string_view field) {
+  text = trim(text);
+  DebRelation relation;
+  size_t i = 0;
+  while (i < text.size() && !isBlank(text[i]) && text[i] != '(' &&
+         text[i] != '[' && text[i] != '<') {
+    i++;
+  }
+  relation.package = std::string(text.substr(0, i));
+  const std::string_view rest = trim(text.substr(i));
+
+  if (!rest.empty() && rest.front() == '(') {
+    const size_t close = rest.find(')');
+    if (close == std::string_view::npos) {
+      throw std::runtime_error("unterminated version in " +
+                               std::string(field) + ": " + std::string(text));
+    }
+    std::string_view constraint = trim(rest.substr(1, close - 1));
+    size_t opLength = 0;
+    while (opLength < constraint.size() &&
+           (constraint[opLength] == '<' || constraint[opLength] == '>' ||
+            constraint[opLength] == '=')) {
+      opLength++;
+    }
+    relation.op = std::string(constraint.substr(0, opLength));
+    relation.version = std::string(trim(constraint.substr(opLength)));
+    // "<" and ">" are obsolete spellings of "<=" and ">=".
+    if (relation.op == "<" || relation.op == ">") {
+      relation.op += '=';
+    }
+    if (relation.op.empty()) {
+      relation.op = "=";
+    }
+    if (relation.version.empty() ||
+        (relation.op != "<<" && relation.op != "<=" && relation.op != "=" &&
+         relation.op != ">=" && relation.op != ">>")) {
+      throw std::runtime_error("bad version constraint in " +
+                               std::string(field) + ": " + std::string(text));
+    }
+  }
+  if (relation.package.empty()) {
+    throw std::runtime_error("missing package name in " + std::string(field));
+  }
+  return relation;
+}
+
+} // namespace
+
+std::string toString(const DebRelationGroup &group) {
+  std::string text;
+  for (const DebRelation &relation : group) {
+    if (!text.empty()) {
+      text += " | ";
+    }
+    text += relation.package;
+    if (!relation.op.empty()) {
+      text += " (" + relation.op + " " + relation.version + ")";
+    }
+  }
+  return text;
+}
+
+DebControl DebControl::parse(std::string_view text) {
+  DebControl control;
+  size_t lineNumber = 0;
+  while (!text.empty()) {
+    const size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    lineNumber++;
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+
+    if (trim(line).empty()) {
+      if (!control.fields_.empty()) {
+        break; // end of the paragraph
+      }
+      continue;
+    }
+    if (line.front() == '#') {
+      continue;
+    }
+    if (line.front() == ' ' || line.front() == '\t') {
+      if (control.fields_.empty()) {
+        throw std::runtime_error("Line " + std::to_string(lineNumber) +
+                                 ": continuation line before any field");
+      }
+      std::string_view continued = trim(line);
+      std::string &value = control.fields_.back().second;
+      value += '\n';
+      if (continued != ".") {
+        value += continued;
+      }
+      continue;
+    }
+
+    const size_t colon = line.find(':');
+    const std::string_view name =
+        colon == std::string_view::npos ? line : line.substr(0, colon);
+    if (colon == std::string_view::npos || name.empty() ||
+        std::any_of(name.begin(), name.end(), isBlank)) {
+      throw std::runtime_error("Line " + std::to_string(lineNumber) +
+                               ": expected 'Field: value'");
+    }
+    if (control.field(name)) {
+      throw std::runtime_error("Line " + std::to_string(lineNumber) +
+                               ": duplicate field " + std::string(name));
+    }
+    control.fields_.emplace_back(std::string(name),
+                                 std::string(trim(line.substr(colon + 1))));
+  }
+  return control;
+}
+
+const std::string *DebControl::field(std::string_view name) const {
+  for (const auto &[key, value] : fields_) {
+    if (sameName(key, name)) {
+      return &value;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<DebRelationGroup>
+DebControl::relations(std::string_view name) const {
+  std::vector<DebRelationGroup> groups;
+  const std::string *value = field(name);
+  if (!value) {
+    return groups;
+  }
+  std::string_view rest = *value;
+  while (!rest.empty()) {
+    const size_t comma = rest.find(',');
+    const std::string_view entry = trim(rest.substr(0, comma));
+    rest.remove_prefix(comma == std::string_view::npos ? rest.size()
+                                                       : comma + 1);
+    if (entry.empty()) {
+      continue; // trailing commas are allowed
+    }
+    DebRelationGroup group;
+    std::string_view alternatives = entry;
+    for (;;) {
+      const size_t bar = alternatives.find('|');
+      group.push_back(parseRelation(alternatives.substr(0, bar), name));
+      if (bar == std::string_view::npos) {
+        break;
+      }
+      alternatives.remove_prefix(bar + 1);
+    }
+    groups.push_back(std::move(group));
+  }
+  return groups;
+}
+
+} // namespace devops
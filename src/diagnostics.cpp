@@ -0,0 +1,191 @@
+#include "diagnostics.h"
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <utility>
+
+namespace devops {
+
+namespace {
+
+// Each chunk of a growing list is twice the size of the one before, from
+// Diagnostics::MIN_CHUNK up to this.
+constexpr size_t MAX_CHUNK = 64 * 1024;
+
+} // namespace
+
+std::string Diagnostic::str() const {
+  std::string rendered;
+  appendTo(rendered);
+  return rendered;
+}
+
+void Diagnostic::appendTo(std::string &out) const {
+  if (line != 0) {
+    out += "Line ";
+    out += std::to_string(line);
+    if (column != 0) {
+      out += ", column ";
+      out += std::to_string(column);
+    }
+    out += ": ";
+  }
+  out += text;
+}
+
+std::ostream &operator<<(std::ostream &out, const Diagnostic &diagnostic) {
+  if (diagnostic.line != 0) {
+    out << "Line " << diagnostic.line;
+    if (diagnostic.column != 0) {
+      out << ", column " << diagnostic.column;
+    }
+    out << ": ";
+  }
+  return out << diagnostic.text;
+}
+
+Diagnostics::Diagnostics(const Diagnostics &other) { append(other); }
+
+Diagnostics::Diagnostics(Diagnostics &&other) noexcept
+    : entries_(std::move(other.entries_)),
+      chunks_(std::exchange(other.chunks_, nullptr)),
+      free_(std::exchange(other.free_, nullptr)),
+      available_(std::exchange(other.available_, 0)),
+      nextChunk_(std::exchange(other.nextChunk_, MIN_CHUNK)) {
+  other.entries_.clear();
+}
+
+Diagnostics &Diagnostics::operator=(const Diagnostics &other) {
+  if (this != &other) {
+    clear();
+    append(other);
+  }
+  return *this;
+}
+
+Diagnostics &Diagnostics::operator=(Diagnostics &&other) noexcept {
+  if (this != &other) {
+    release(chunks_);
+    entries_ = std::move(other.entries_);
+    chunks_ = std::exchange(other.chunks_, nullptr);
+    free_ = std::exchange(other.free_, nullptr);
+    available_ = std::exchange(other.available_, 0);
+    nextChunk_ = std::exchange(other.nextChunk_, MIN_CHUNK);
+    other.entries_.clear();
+  }
+  return *this;
+}
+
+Diagnostics::~Diagnostics() { release(chunks_); }
+
+void Diagnostics::release(Chunk *chunks) {
+  while (chunks) {
+    Chunk *next = chunks->next;
+    ::operator delete(chunks);
+    chunks = next;
+  }
+}
+
+char *Diagnostics::allocate(size_t size) {
+  if (size > available_) {
+    const size_t bytes = std::max(size, nextChunk_);
+    nextChunk_ = std::min(nextChunk_ * 2, MAX_CHUNK);
+    auto *chunk = static_cast<Chunk *>(::operator new(sizeof(Chunk) + bytes));
+    chunk->next = chunks_;
+    chunks_ = chunk;
+    free_ = reinterpret_cast<char *>(chunk + 1);
+    available_ = bytes;
+  }
+  char *at = free_;
+  free_ += size;
+  available_ -= size;
+  return at;
+}
+
+void Diagnostics::add(std::initializer_list<std::string_view> parts,
+                      uint32_t line, uint32_t column) {
+  size_t size = 0;
+  for (std::string_view part : parts) {
+    size += part.size();
+  }
+  char *text = allocate(size);
+  char *out = text;
+  for (std::string_view part : parts) {
+    if (!part.empty()) {
+      std::memcpy(out, part.data(), part.size());
+      out += part.size();
+    }
+  }
+  entries_.push_back({std::string_view(text, size), line, column});
+}
+
+void Diagnostics::append(const Diagnostics &other) {
+  size_t size = 0;
+  for (const Diagnostic &entry : other) {
+    size += entry.text.size();
+  }
+  // One block for all of it; the copies stay in `other`'s order.
+  char *out = allocate(size);
+  const size_t count = other.size(); // `other` may be this list
+  entries_.reserve(entries_.size() + count);
+  for (size_t i = 0; i < count; i++) {
+    Diagnostic entry = other.entries_[i];
+    if (!entry.text.empty()) {
+      std::memcpy(out, entry.text.data(), entry.text.size());
+      entry.text = std::string_view(out, entry.text.size());
+      out += entry.text.size();
+    }
+    entries_.push_back(entry);
+  }
+}
+
+void Diagnostics::append(Diagnostics &&other) {
+  if (other.empty() || &other == this) {
+    return;
+  }
+  if (empty() && !chunks_) {
+    *this = std::move(other);
+    return;
+  }
+  // The texts stay where they are; only ownership of their chunks moves.
+  // They go behind this list's newest chunk, which new messages still use.
+  entries_.insert(entries_.end(), other.entries_.begin(),
+                  other.entries_.end());
+  if (!chunks_) {
+    chunks_ = std::exchange(other.chunks_, nullptr);
+  } else if (other.chunks_) {
+    Chunk *last = other.chunks_;
+    while (last->next) {
+      last = last->next;
+    }
+    last->next = chunks_->next;
+    chunks_->next = std::exchange(other.chunks_, nullptr);
+  }
+  other.clear();
+}
+
+void Diagnostics::sortByLine() {
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const Diagnostic &a, const Diagnostic &b) {
+                     return a.line < b.line;
+                   });
+}
+
+void Diagnostics::clear() {
+  entries_.clear();
+  release(std::exchange(chunks_, nullptr));
+  free_ = nullptr;
+  available_ = 0;
+  nextChunk_ = MIN_CHUNK;
+}
+
+std::vector<std::string> Diagnostics::strings() const {
+  std::vector<std::string> rendered;
+  rendered.reserve(entries_.size());
+  for (const Diagnostic &entry : entries_) {
+    rendered.push_back(entry.str());
+  }
+  return rendered;
+}
+
+} // namespace devops
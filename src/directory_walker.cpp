@@ -0,0 +1,691 @@
+#include "directory_walker.h"
+#include "work_stealing_pool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace devops {
+
+// Ignore files in effect for one directory: its own, then its parent's.
+struct IgnoreChain {
+  std::shared_ptr<const IgnoreChain> parent;
+  std::vector<IgnoreRules> rules; // later entries take precedence
+};
+
+namespace {
+
+const char *const DEFAULT_EXCLUDES = ".git/\n"
+                                     ".hg/\n"
+                                     ".svn/\n"
+                                     "node_modules/\n"
+                                     "vendor/\n"
+                                     ".devops-validator-cache/\n";
+
+const char *const IGNORE_FILES[] = {".gitignore", ".devopsignore"};
+
+// Glob match in the style of git's wildmatch: `*` and `?` stop at '/',
+// `**` does not, and "**/" also matches no directory at all.
+bool globMatch(const char *p, const char *pe, const char *s, const char *se) {
+  while (p < pe) {
+    char c = *p;
+    if (c == '*') {
+      if (p + 1 < pe && p[1] == '*') {
+        p += 2;
+        if (p < pe && *p == '/') {
+          const char *rest = p + 1;
+          if (globMatch(rest, pe, s, se)) {
+            return true;
+          }
+          for (const char *t = s; t < se; t++) {
+            if (*t == '/' && globMatch(rest, pe, t + 1, se)) {
+              return true;
+            }
+          }
+          return false;
+        }
+        for (const char *t = s;; t++) {
+          if (globMatch(p, pe, t, se)) {
+            return true;
+          }
+          if (t == se) {
+            return false;
+          }
+        }
+      }
+      p++;
+      for (const char *t = s;; t++) {
+        if (globMatch(p, pe, t, se)) {
+          return true;
+        }
+        if (t == se || *t == '/') {
+          return false;
+        }
+      }
+    }
+
+    if (s == se) {
+      return false;
+    }
+    if (c == '?') {
+      if (*s == '/') {
+        return false;
+      }
+      p++;
+      s++;
+      continue;
+    }
+    if (c == '[') {
+      const char *q = p + 1;
+      const bool negate = q < pe && (*q == '!' || *q == '^');
+      if (negate) {
+        q++;
+      }
+      const char *close = q < pe && *q == ']' ? q + 1 : q;
+      while (close < pe && *close != ']') {
+        close++;
+      }
+      if (close < pe) {
+        bool matched = false;
+        for (const char *r = q; r < close; r++) {
+          if (r + 2 < close && r[1] == '-') {
+            matched |= *s >= r[0] && *s <= r[2];
+            r += 2;
+          } else {
+            matched |= *s == *r;
+          }
+        }
+        if (matched == negate || *s == '/') {
+          return false;
+        }
+        p = close + 1;
+        s++;
+        continue;
+      }
+      // No closing bracket: a literal '['.
+    }
+    if (c == '\\' && p + 1 < pe) {
+      c = *++p;
+    }
+    if (c != *s) {
+      return false;
+    }
+    p++;
+    s++;
+  }
+  return s == se;
+}
+
+std::string joinPath(const std::string &dir, const std::string &name) {
+  if (dir.empty() || dir.back() == '/') {
+    return dir + name;
+  }
+  return dir + "/" + name;
+}
+
+bool isIgnored(const IgnoreChain *chain, const std::string &path,
+               bool directory) {
+  for (; chain; chain = chain->parent.get()) {
+    for (auto it = chain->rules.rbegin(); it != chain->rules.rend(); ++it) {
+      const int verdict = it->match(path, directory);
+      if (verdict != 0) {
+        return verdict > 0;
+      }
+    }
+  }
+  return false;
+}
+
+enum class EntryType { File, Directory, Other };
+
+struct RawEntry {
+  std::string name;
+  EntryType type;
+};
+
+// State shared by every directory of one walk().
+struct Walk {
+  Walk(const WalkOptions &options, const DirectoryWalker::FileCallback &onFile,
+       WorkStealingPool *pool)
+      : options(options), onFile(onFile), pool(pool) {}
+
+  const WalkOptions &options;
+  const DirectoryWalker::FileCallback &onFile;
+  WorkStealingPool *pool;
+
+  std::atomic<uint64_t> directories{0};
+  std::atomic<uint64_t> files{0};
+  std::atomic<uint64_t> pruned{0};
+  std::atomic<uint64_t> ignored{0};
+  std::atomic<uint64_t> stats{0};
+
+  std::mutex mutex; // guards the fields below
+  std::condition_variable finished;
+  size_t pending = 0;
+  std::vector<std::string> errors;
+
+  void error(const std::string &message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    errors.push_back(message);
+  }
+};
+
+#ifdef _WIN32
+
+bool readEntries(const std::string &path, std::vector<RawEntry> &entries,
+                 Walk &walk) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  for (fs::directory_iterator it(path, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    const fs::file_status status = it->symlink_status(ec);
+    EntryType type = EntryType::Other;
+    if (fs::is_directory(status)) {
+      type = EntryType::Directory;
+    } else if (fs::is_regular_file(status)) {
+      type = EntryType::File;
+    } else if (fs::is_symlink(status)) {
+      walk.stats++;
+      type = it->is_regular_file(ec) ? EntryType::File : EntryType::Other;
+    }
+    entries.push_back({it->path().filename().string(), type});
+  }
+  if (ec) {
+    walk.error("cannot read directory " + path + ": " + ec.message());
+    return false;
+  }
+  return true;
+}
+
+std::string readIgnoreFile(const std::string &dir, const char *name) {
+  std::ifstream in(joinPath(dir, name), std::ios::binary);
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  return buffer.str();
+}
+
+#else
+
+EntryType typeFromMode(mode_t mode) {
+  return S_ISREG(mode)   ? EntryType::File
+         : S_ISDIR(mode) ? EntryType::Directory
+                         : EntryType::Other;
+}
+
+// Resolves entries whose d_type is unknown (some filesystems) or a
+// symlink; symlinks count as files only when they point at one.
+EntryType statEntry(int dirFd, const char *name, unsigned char dType,
+                    Walk &walk) {
+  struct stat st;
+  walk.stats++;
+  if (dType != DT_LNK) {
+    if (fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+      return EntryType::Other;
+    }
+    if (!S_ISLNK(st.st_mode)) {
+      return typeFromMode(st.st_mode);
+    }
+  }
+  if (fstatat(dirFd, name, &st, 0) != 0 || !S_ISREG(st.st_mode)) {
+    return EntryType::Other;
+  }
+  return EntryType::File;
+}
+
+EntryType entryType(int dirFd, const char *name, unsigned char dType,
+                    Walk &walk) {
+  switch (dType) {
+  case DT_REG:
+    return EntryType::File;
+  case DT_DIR:
+    return EntryType::Directory;
+  case DT_LNK:
+  case DT_UNKNOWN:
+    return statEntry(dirFd, name, dType, walk);
+  default:
+    return EntryType::Other;
+  }
+}
+
+bool isDotOrDotDot(const char *name) {
+  return name[0] == '.' &&
+         (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+#ifdef __linux__
+
+// Layout the getdents64 system call fills in.
+struct LinuxDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+bool readEntries(int fd, const std::string &path,
+                 std::vector<RawEntry> &entries, Walk &walk) {
+  // One buffer per thread; large enough that most directories are read in
+  // a single call.
+  thread_local std::vector<char> buffer(64 * 1024);
+  for (;;) {
+    const long n = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+    if (n == 0) {
+      return true;
+    }
+    if (n < 0) {
+      walk.error("cannot read directory " + path + ": " +
+                 std::strerror(errno));
+      return false;
+    }
+    for (long offset = 0; offset < n;) {
+      const auto *entry =
+          reinterpret_cast<const LinuxDirent64 *>(buffer.data() + offset);
+      offset += entry->d_reclen;
+      if (!isDotOrDotDot(entry->d_name)) {
+        entries.push_back({entry->d_name,
+                           entryType(fd, entry->d_name, entry->d_type, walk)});
+      }
+    }
+  }
+}
+
+#else
+
+bool readEntries(int fd, const std::string &path,
+                 std::vector<RawEntry> &entries, Walk &walk) {
+  // fdopendir takes ownership of its descriptor, so it gets a copy.
+  const int copy = dup(fd);
+  DIR *dir = copy < 0 ? nullptr : fdopendir(copy);
+  if (!dir) {
+    if (copy >= 0) {
+      close(copy);
+    }
+    walk.error("cannot read directory " + path + ": " + std::strerror(errno));
+    return false;
+  }
+  while (const dirent *entry = readdir(dir)) {
+    if (!isDotOrDotDot(entry->d_name)) {
+      entries.push_back(
+          {entry->d_name, entryType(fd, entry->d_name, entry->d_type, walk)});
+    }
+  }
+  closedir(dir);
+  return true;
+}
+
+#endif
+
+std::string readIgnoreFile(int dirFd, const char *name) {
+  std::string text;
+  const int fd = openat(dirFd, name, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return text;
+  }
+  char chunk[4096];
+  ssize_t n;
+  while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+    text.append(chunk, static_cast<size_t>(n));
+  }
+  close(fd);
+  return text;
+}
+
+#endif
+
+// Reads one directory, reports its files and walks its subdirectories:
+// inline (opened relative to this one) without a pool, as pool tasks with
+// one. `parentFd` and `name` locate the directory when it is below -1.
+void walkDirectory(Walk &walk, const std::string &path, const std::string &rel,
+                   std::shared_ptr<const IgnoreChain> chain, int parentFd,
+                   const char *name) {
+  std::vector<RawEntry> entries;
+#ifdef _WIN32
+  (void)parentFd;
+  (void)name;
+  if (!readEntries(path, entries, walk)) {
+    return;
+  }
+#else
+  const int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+  const int fd = parentFd >= 0 ? openat(parentFd, name, flags | O_NOFOLLOW)
+                               : openat(AT_FDCWD, path.c_str(), flags);
+  if (fd < 0) {
+    walk.error("cannot open directory " + path + ": " + std::strerror(errno));
+    return;
+  }
+  const bool readable = readEntries(fd, path, entries, walk);
+  if (!readable) {
+    close(fd);
+    return;
+  }
+#endif
+  walk.directories++;
+
+  if (walk.options.ignoreFiles) {
+    std::vector<IgnoreRules> rules;
+    for (const char *ignoreFile : IGNORE_FILES) {
+      for (const RawEntry &entry : entries) {
+        if (entry.type == EntryType::File && entry.name == ignoreFile) {
+#ifdef _WIN32
+          rules.emplace_back(readIgnoreFile(path, ignoreFile),
+                             rel.empty() ? rel : rel + "/");
+#else
+          rules.emplace_back(readIgnoreFile(fd, ignoreFile),
+                             rel.empty() ? rel : rel + "/");
+#endif
+        }
+      }
+    }
+    if (!rules.empty()) {
+      auto next = std::make_shared<IgnoreChain>();
+      next->parent = std::move(chain);
+      next->rules = std::move(rules);
+      chain = std::move(next);
+    }
+  }
+
+  for (const RawEntry &entry : entries) {
+    if (entry.type == EntryType::Other) {
+      continue;
+    }
+    const bool directory = entry.type == EntryType::Directory;
+    std::string childRel = rel.empty() ? entry.name : rel + "/" + entry.name;
+    if (isIgnored(chain.get(), childRel, directory)) {
+      (directory ? walk.pruned : walk.ignored)++;
+      continue;
+    }
+
+    std::string childPath = joinPath(path, entry.name);
+    if (!directory) {
+      walk.files++;
+      walk.onFile(childPath);
+    } else if (walk.pool) {
+      {
+        std::lock_guard<std::mutex> lock(walk.mutex);
+        walk.pending++;
+      }
+      walk.pool->submit([&walk, childPath = std::move(childPath),
+                         childRel = std::move(childRel), chain] {
+        walkDirectory(walk, childPath, childRel, chain, -1, nullptr);
+        std::lock_guard<std::mutex> lock(walk.mutex);
+        if (--walk.pending == 0) {
+          walk.finished.notify_all();
+        }
+      });
+    } else {
+#ifdef _WIN32
+      walkDirectory(walk, childPath, childRel, chain, -1, nullptr);
+#else
+      walkDirectory(walk, childPath, childRel, chain, fd, entry.name.c_str());
+#endif
+    }
+  }
+
+#ifndef _WIN32
+  close(fd);
+#endif
+}
+
+} // namespace
+
+IgnoreRules::IgnoreRules(std::string_view text, std::string base)
+    : base_(std::move(base)) {
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t end = text.find('\n', pos);
+    if (end == std::string_view::npos) {
+      end = text.size();
+    }
+    std::string line(text.substr(pos, end - pos));
+    pos = end + 1;
+
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    // Trailing spaces are dropped unless escaped with a backslash.
+    while (!line.empty() && line.back() == ' ' &&
+           !(line.size() > 1 && line[line.size() - 2] == '\\')) {
+      line.pop_back();
+    }
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    Rule rule;
+    if (line[0] == '!') {
+      rule.negated = true;
+      line.erase(0, 1);
+    } else if (line[0] == '\\' && line.size() > 1 &&
+               (line[1] == '!' || line[1] == '#')) {
+      line.erase(0, 1);
+    }
+    if (!line.empty() && line.back() == '/') {
+      rule.directoryOnly = true;
+      line.pop_back();
+    }
+    if (!line.empty() && line[0] == '/') {
+      rule.anchored = true;
+      line.erase(0, 1);
+    }
+    if (line.empty()) {
+      continue;
+    }
+    rule.anchored |= line.find('/') != std::string::npos;
+
+    const bool wildcard = line.find_first_of("*?[\\") != std::string::npos;
+    if (!wildcard) {
+      rule.kind = Rule::Literal;
+    } else if (line[0] == '*' && !rule.anchored &&
+               line.find_first_of("*?[\\", 1) == std::string::npos) {
+      rule.kind = Rule::Suffix;
+      line.erase(0, 1);
+    } else {
+      rule.kind = Rule::Glob;
+    }
+    rule.pattern = std::move(line);
+    rules_.push_back(std::move(rule));
+  }
+}
+
+int IgnoreRules::match(std::string_view path, bool directory) const {
+  if (!base_.empty()) {
+    if (path.compare(0, base_.size(), base_) != 0) {
+      return 0;
+    }
+    path.remove_prefix(base_.size());
+  }
+  const size_t slash = path.rfind('/');
+  const std::string_view name =
+      slash == std::string_view::npos ? path : path.substr(slash + 1);
+
+  for (auto it = rules_.rbegin(); it != rules_.rend(); ++it) {
+    const Rule &rule = *it;
+    if (rule.directoryOnly && !directory) {
+      continue;
+    }
+    const std::string_view subject = rule.anchored ? path : name;
+    bool matched;
+    switch (rule.kind) {
+    case Rule::Literal:
+      matched = subject == rule.pattern;
+      break;
+    case Rule::Suffix:
+      matched = subject.size() >= rule.pattern.size() &&
+                subject.compare(subject.size() - rule.pattern.size(),
+                                rule.pattern.size(), rule.pattern) == 0;
+      break;
+    default:
+      matched = globMatch(rule.pattern.data(),
+                          rule.pattern.data() + rule.pattern.size(),
+                          subject.data(), subject.data() + subject.size());
+    }
+    if (matched) {
+      return rule.negated ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+IgnoreMatcher::IgnoreMatcher(std::string root, WalkOptions options)
+    : root_(std::move(root)), options_(options) {}
+
+IgnoreMatcher::~IgnoreMatcher() = default;
+
+bool IgnoreMatcher::ignored(const std::string &path, bool directory) const {
+  if (path.size() <= root_.size() ||
+      path.compare(0, root_.size(), root_) != 0) {
+    return false;
+  }
+  size_t begin = root_.size();
+  if (root_.empty() || root_.back() != '/') {
+    if (path[begin] != '/') {
+      return false;
+    }
+    begin++;
+  }
+  const std::string rel = path.substr(begin);
+
+  // Checked one component at a time, as the walk prunes directories.
+  std::string dir; // holding the component; "" for the root
+  size_t start = 0;
+  while (true) {
+    const size_t slash = rel.find('/', start);
+    const bool last = slash == std::string::npos;
+    std::string prefix = last ? rel : rel.substr(0, slash);
+    if (isIgnored(chain(dir).get(), prefix, directory || !last)) {
+      return true;
+    }
+    if (last) {
+      return false;
+    }
+    dir = std::move(prefix);
+    start = slash + 1;
+  }
+}
+
+void IgnoreMatcher::reload() { chains_.clear(); }
+
+bool IgnoreMatcher::isIgnoreFile(const std::string &path) {
+  const size_t slash = path.rfind('/');
+  const std::string name =
+      slash == std::string::npos ? path : path.substr(slash + 1);
+  for (const char *ignoreFile : IGNORE_FILES) {
+    if (name == ignoreFile) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::shared_ptr<const IgnoreChain>
+IgnoreMatcher::chain(const std::string &rel) const {
+  auto found = chains_.find(rel);
+  if (found != chains_.end()) {
+    return found->second;
+  }
+
+  std::shared_ptr<const IgnoreChain> parent;
+  if (rel.empty()) {
+    auto base = std::make_shared<IgnoreChain>();
+    if (options_.defaultExcludes) {
+      base->rules.emplace_back(DEFAULT_EXCLUDES, "");
+    }
+    parent = std::move(base);
+  } else {
+    const size_t slash = rel.rfind('/');
+    parent = chain(slash == std::string::npos ? "" : rel.substr(0, slash));
+  }
+
+  std::shared_ptr<const IgnoreChain> result = parent;
+  if (options_.ignoreFiles) {
+    const std::string dir = rel.empty() ? root_ : joinPath(root_, rel);
+    std::vector<IgnoreRules> rules;
+    for (const char *ignoreFile : IGNORE_FILES) {
+#ifdef _WIN32
+      std::string text = readIgnoreFile(dir, ignoreFile);
+#else
+      std::string text =
+          readIgnoreFile(AT_FDCWD, joinPath(dir, ignoreFile).c_str());
+#endif
+      if (!text.empty()) {
+        rules.emplace_back(text, rel.empty() ? rel : rel + "/");
+      }
+    }
+    if (!rules.empty()) {
+      auto next = std::make_shared<IgnoreChain>();
+      next->parent = std::move(parent);
+      next->rules = std::move(rules);
+      result = std::move(next);
+    }
+  }
+  chains_[rel] = result;
+  return result;
+}
+
+DirectoryWalker::DirectoryWalker(WalkOptions options) : options_(options) {}
+
+WalkStats DirectoryWalker::walk(const std::string &root,
+                                const FileCallback &onFile,
+                                WorkStealingPool *pool) const {
+  const auto start = std::chrono::steady_clock::now();
+  Walk walk(options_, onFile, pool);
+
+  auto chain = std::make_shared<IgnoreChain>();
+  if (options_.defaultExcludes) {
+    chain->rules.emplace_back(DEFAULT_EXCLUDES, "");
+  }
+
+  if (pool) {
+    walk.pending = 1;
+    pool->submit([&walk, &root, chain] {
+      walkDirectory(walk, root, "", chain, -1, nullptr);
+      std::lock_guard<std::mutex> lock(walk.mutex);
+      if (--walk.pending == 0) {
+        walk.finished.notify_all();
+      }
+    });
+    std::unique_lock<std::mutex> lock(walk.mutex);
+    walk.finished.wait(lock, [&walk] { return walk.pending == 0; });
+  } else {
+    walkDirectory(walk, root, "", chain, -1, nullptr);
+  }
+
+  if (walk.directories == 0) {
+    throw std::runtime_error(walk.errors.empty()
+                                 ? "cannot read directory " + root
+                                 : walk.errors.front());
+  }
+
+  WalkStats stats;
+  stats.directories = walk.directories;
+  stats.files = walk.files;
+  stats.pruned = walk.pruned;
+  stats.ignored = walk.ignored;
+  stats.stats = walk.stats;
+  stats.errors = std::move(walk.errors);
+  stats.elapsedMs = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  return stats;
+}
+
+} // namespace devops
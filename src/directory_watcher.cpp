@@ -0,0 +1,217 @@
+#include "directory_watcher.h"
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace devops {
+
+#ifndef __linux__
+
+DirectoryWatcher::DirectoryWatcher(const std::string &root,
+                                   const WalkOptions &options)
+    : ignore_(root, options) {
+  throw std::runtime_error("watch mode needs inotify and is only supported "
+                           "on Linux");
+}
+
+DirectoryWatcher::~DirectoryWatcher() = default;
+
+bool DirectoryWatcher::next(WatchBatch &) { return false; }
+
+void DirectoryWatcher::addTree(const std::string &, bool) {}
+
+bool DirectoryWatcher::drain(WatchBatch &) { return false; }
+
+#else
+
+namespace {
+
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF |
+                                IN_ONLYDIR | IN_DONT_FOLLOW;
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void onSignal(int) { interrupted = 1; }
+
+int millisecondsUntil(std::chrono::steady_clock::time_point deadline) {
+  auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now());
+  return static_cast<int>(std::max<int64_t>(0, left.count()));
+}
+
+} // namespace
+
+DirectoryWatcher::DirectoryWatcher(const std::string &root,
+                                   const WalkOptions &options)
+    : ignore_(root, options) {
+  fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd_ < 0) {
+    throw std::runtime_error(std::string("inotify_init1: ") +
+                             std::strerror(errno));
+  }
+  addTree(root, false);
+  if (directories_.empty()) {
+    ::close(fd_);
+    throw std::runtime_error("cannot watch " + root + ": " +
+                             std::strerror(errno));
+  }
+
+  // No SA_RESTART, so a signal also wakes the blocking poll() in next().
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = onSignal;
+  ::sigemptyset(&action.sa_mask);
+  ::sigaction(SIGINT, &action, nullptr);
+  ::sigaction(SIGTERM, &action, nullptr);
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+void DirectoryWatcher::addTree(const std::string &dir, bool collectFiles) {
+  int wd = ::inotify_add_watch(fd_, dir.c_str(), WATCH_MASK);
+  if (wd < 0) {
+    return; // vanished already, or not a directory
+  }
+  directories_[wd] = dir;
+
+  std::error_code ec;
+  for (fs::directory_iterator it(dir, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    const std::string path = it->path().string();
+    const bool directory = it->is_directory(ec) && !it->is_symlink(ec);
+    if (ignore_.ignored(path, directory)) {
+      continue;
+    }
+    if (directory) {
+      addTree(path, collectFiles);
+    } else if (collectFiles) {
+      touched_.insert(path);
+    }
+  }
+}
+
+bool DirectoryWatcher::drain(WatchBatch &batch) {
+  alignas(inotify_event) char buffer[64 * 1024];
+  while (true) {
+    ssize_t length = ::read(fd_, buffer, sizeof(buffer));
+    if (length < 0) {
+      return errno == EAGAIN || errno == EINTR;
+    }
+
+    for (char *p = buffer; p < buffer + length;) {
+      const auto *event = reinterpret_cast<const inotify_event *>(p);
+      p += sizeof(inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        batch.overflow = true;
+        continue;
+      }
+      if (event->mask & IN_IGNORED) {
+        directories_.erase(event->wd);
+        continue;
+      }
+      auto dir = directories_.find(event->wd);
+      if (dir == directories_.end() || event->len == 0) {
+        continue;
+      }
+      // Joined like directory_iterator does, so paths match the first pass.
+      const std::string path = (fs::path(dir->second) / event->name).string();
+
+      if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          if (!ignore_.ignored(path, true)) {
+            addTree(path, true);
+          }
+        } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+          batch.removedDirectories.push_back(path);
+          // A directory moved elsewhere in the tree keeps its watch but
+          // under the old name; drop it and let IN_MOVED_TO re-add it.
+          for (auto it = directories_.begin(); it != directories_.end();) {
+            if (it->second == path ||
+                it->second.compare(0, path.size() + 1, path + "/") == 0) {
+              ::inotify_rm_watch(fd_, it->first);
+              it = directories_.erase(it);
+            } else {
+              ++it;
+            }
+          }
+        }
+      } else {
+        if (IgnoreMatcher::isIgnoreFile(path)) {
+          ignore_.reload();
+        }
+        touched_.insert(path);
+      }
+    }
+  }
+}
+
+bool DirectoryWatcher::next(WatchBatch &batch) {
+  batch = WatchBatch();
+  touched_.clear();
+
+  pollfd pfd{fd_, POLLIN, 0};
+  while (!interrupted) {
+    // Block (waking on signals) until the first event.
+    if (::poll(&pfd, 1, -1) <= 0) {
+      continue;
+    }
+    batch.firstEvent = std::chrono::steady_clock::now();
+    const auto deadline =
+        batch.firstEvent + std::chrono::milliseconds(MAX_DELAY_MS);
+
+    // Keep reading until the tree is quiet or the batch is too old.
+    while (!interrupted) {
+      if (!drain(batch)) {
+        throw std::runtime_error(std::string("reading inotify events: ") +
+                                 std::strerror(errno));
+      }
+      const int wait = std::min(DEBOUNCE_MS, millisecondsUntil(deadline));
+      if (wait == 0 || ::poll(&pfd, 1, wait) == 0) {
+        break;
+      }
+    }
+
+    for (const std::string &path : touched_) {
+      std::error_code ec;
+      if (fs::is_regular_file(path, ec)) {
+        // Checked now rather than per event, as the batch may have changed
+        // an ignore file.
+        if (!ignore_.ignored(path, false)) {
+          batch.changed.push_back(path);
+        }
+      } else if (!fs::exists(fs::symlink_status(path, ec))) {
+        batch.removed.push_back(path);
+      }
+    }
+    touched_.clear();
+    std::sort(batch.changed.begin(), batch.changed.end());
+    std::sort(batch.removed.begin(), batch.removed.end());
+
+    if (!batch.changed.empty() || !batch.removed.empty() ||
+        !batch.removedDirectories.empty() || batch.overflow) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#endif
+
+} // namespace devops
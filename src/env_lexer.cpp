@@ -0,0 +1,320 @@
+#include "env_lexer.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace devops {
+
+namespace {
+
+bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+bool isKeyChar(char c) {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+         (c >= '0' && c <= '9') || c == '_';
+}
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Escapes understood inside double quotes by dotenv, Docker Compose and
+// POSIX shells alike.
+bool isKnownEscape(char c) {
+  switch (c) {
+  case 'n':
+  case 'r':
+  case 't':
+  case '"':
+  case '\'':
+  case '\\':
+  case '$':
+  case '`':
+    return true;
+  default:
+    return false;
+  }
+}
+
+std::string describe(char c) {
+  if (c == '\r') {
+    return "carriage return";
+  }
+  return std::string("'") + c + "'";
+}
+
+} // namespace
+
+EnvLexResult EnvLexer::run() {
+  std::unordered_map<std::string_view, size_t> seen;
+
+  while (!atEnd()) {
+    lexLine();
+  }
+
+  // Duplicate detection runs once over the collected keys.
+  for (const auto &[key, line] : seen_) {
+    auto [it, inserted] = seen.emplace(key, line);
+    if (!inserted) {
+      report(false, line, 1,
+             {"duplicate variable '", key, "' (first defined on line ",
+              std::to_string(it->second), ")"});
+    }
+  }
+
+  result_.errors.sortByLine();
+  result_.warnings.sortByLine();
+  return std::move(result_);
+}
+
+bool EnvLexer::atLineEnd() const {
+  if (atEnd() || content_[pos_] == '\n') {
+    return true;
+  }
+  return content_[pos_] == '\r' &&
+         (pos_ + 1 == content_.size() || content_[pos_ + 1] == '\n');
+}
+
+void EnvLexer::skipToLineEnd() {
+  size_t end = content_.find('\n', pos_);
+  pos_ = end == std::string_view::npos ? content_.size() : end;
+}
+
+void EnvLexer::finishLine() {
+  if (!atEnd()) {
+    pos_++; // '\n'
+  }
+  line_++;
+  lineStart_ = pos_;
+}
+
+void EnvLexer::report(bool error, size_t line, size_t column,
+                      std::initializer_list<std::string_view> message) {
+  (error ? result_.errors : result_.warnings)
+      .add(message, static_cast<uint32_t>(line), static_cast<uint32_t>(column));
+}
+
+void EnvLexer::lexLine() {
+  while (!atEnd() && isBlank(peek())) {
+    pos_++;
+  }
+
+  if (atLineEnd()) {
+    skipToLineEnd();
+    finishLine();
+    return;
+  }
+
+  if (peek() == '#') {
+    skipToLineEnd();
+    finishLine();
+    return;
+  }
+
+  if (content_.compare(pos_, 6, "export") == 0 &&
+      pos_ + 6 < content_.size() && isBlank(content_[pos_ + 6])) {
+    pos_ += 6;
+    while (!atEnd() && isBlank(peek())) {
+      pos_++;
+    }
+    if (atLineEnd()) {
+      report(false, line_, column(), {"missing variable name after 'export'"});
+      skipToLineEnd();
+      finishLine();
+      return;
+    }
+  }
+
+  size_t keyStart = pos_;
+  size_t keyColumn = column();
+  while (!atEnd() && isKeyChar(peek())) {
+    pos_++;
+  }
+  std::string_view key = content_.substr(keyStart, pos_ - keyStart);
+
+  if (key.empty()) {
+    report(false, line_, column(),
+           {"expected variable name, found ", describe(peek())});
+    skipToLineEnd();
+    finishLine();
+    return;
+  }
+
+  size_t keyEnd = pos_;
+  while (!atEnd() && isBlank(peek())) {
+    pos_++;
+  }
+
+  if (atLineEnd()) {
+    report(false, line_, column(),
+           {"missing '=' after variable name '", key, "'"});
+    skipToLineEnd();
+    finishLine();
+    return;
+  }
+
+  if (peek() != '=') {
+    report(false, line_, column(),
+           {"unexpected ", describe(peek()), " in variable name '", key,
+            "'"});
+    skipToLineEnd();
+    finishLine();
+    return;
+  }
+
+  if (isDigit(key[0])) {
+    report(false, line_, keyColumn,
+           {"variable name '", key, "' starts with a digit"});
+  }
+  if (pos_ != keyEnd) {
+    report(false, line_, keyEnd - lineStart_ + 1, {"whitespace before '='"});
+  }
+
+  pos_++; // '='
+  result_.variables++;
+  seen_.emplace_back(key, line_);
+
+  if (!atEnd() && isBlank(peek())) {
+    report(false, line_, column(), {"whitespace after '='"});
+    while (!atEnd() && isBlank(peek())) {
+      pos_++;
+    }
+  }
+
+  if (atLineEnd()) {
+    skipToLineEnd();
+    finishLine();
+    return;
+  }
+
+  switch (peek()) {
+  case '"':
+    lexDoubleQuoted();
+    break;
+  case '\'':
+    lexSingleQuoted();
+    break;
+  default:
+    lexUnquoted();
+    break;
+  }
+}
+
+void EnvLexer::lexDoubleQuoted() {
+  const size_t openLine = line_;
+  const size_t openColumn = column();
+  pos_++; // opening quote
+
+  for (;;) {
+    size_t next = content_.find_first_of("\"\\\n", pos_);
+    if (next == std::string_view::npos) {
+      pos_ = content_.size();
+      report(true, openLine, openColumn, {"unterminated double-quoted value"});
+      return;
+    }
+    pos_ = next;
+
+    char c = peek();
+    if (c == '"') {
+      pos_++;
+      break;
+    }
+
+    if (c == '\n') {
+      pos_++;
+      line_++;
+      lineStart_ = pos_;
+      continue;
+    }
+
+    // Backslash escape
+    if (pos_ + 1 >= content_.size()) {
+      pos_ = content_.size();
+      report(true, openLine, openColumn, {"unterminated double-quoted value"});
+      return;
+    }
+
+    char escaped = content_[pos_ + 1];
+    if (escaped == '\n') {
+      pos_ += 2;
+      line_++;
+      lineStart_ = pos_;
+      continue;
+    }
+    if (!isKnownEscape(escaped)) {
+      report(false, line_, column(),
+             {"unknown escape sequence '\\", std::string_view(&escaped, 1),
+              "'"});
+    }
+    pos_ += 2;
+  }
+
+  while (!atEnd() && isBlank(peek())) {
+    pos_++;
+  }
+  if (!atLineEnd() && peek() != '#') {
+    report(false, line_, column(),
+           {"unexpected characters after quoted value"});
+  }
+  skipToLineEnd();
+  finishLine();
+}
+
+void EnvLexer::lexSingleQuoted() {
+  const size_t openLine = line_;
+  const size_t openColumn = column();
+  pos_++; // opening quote
+
+  for (;;) {
+    size_t next = content_.find_first_of("'\n", pos_);
+    if (next == std::string_view::npos) {
+      pos_ = content_.size();
+      report(true, openLine, openColumn, {"unterminated single-quoted value"});
+      return;
+    }
+    pos_ = next + 1;
+    if (content_[next] == '\'') {
+      break;
+    }
+    line_++;
+    lineStart_ = pos_;
+  }
+
+  while (!atEnd() && isBlank(peek())) {
+    pos_++;
+  }
+  if (!atLineEnd() && peek() != '#') {
+    report(false, line_, column(),
+           {"unexpected characters after quoted value"});
+  }
+  skipToLineEnd();
+  finishLine();
+}
+
+void EnvLexer::lexUnquoted() {
+  const size_t valueColumn = column();
+  size_t end = content_.find('\n', pos_);
+  if (end == std::string_view::npos) {
+    end = content_.size();
+  }
+
+  // An inline comment starts at a '#' preceded by whitespace.
+  size_t valueEnd = end;
+  for (size_t i = pos_ + 1; i < end; i++) {
+    if (content_[i] == '#' && isBlank(content_[i - 1])) {
+      valueEnd = i;
+      break;
+    }
+  }
+  while (valueEnd > pos_ && (isBlank(content_[valueEnd - 1]) ||
+                             content_[valueEnd - 1] == '\r')) {
+    valueEnd--;
+  }
+
+  std::string_view value = content_.substr(pos_, valueEnd - pos_);
+  if (value.find_first_of(" \t") != std::string_view::npos) {
+    report(false, line_, valueColumn, {"unquoted value with spaces"});
+  }
+
+  pos_ = end;
+  finishLine();
+}
+
+} // namespace devops
@@ -0,0 +1,334 @@
+#include "file_type.h"
+#include <cstdio>
+
+namespace devops {
+
+namespace {
+
+struct NameKey {
+  std::string_view text; // lower case
+  FileType type;
+};
+
+// Extensions (with the dot) and whole file names.
+constexpr NameKey NAME_KEYS[] = {
+    {".json", FileType::Json},
+    {".yaml", FileType::Yaml},
+    {".yml", FileType::Yaml},
+    {".toml", FileType::Toml},
+    {".env", FileType::Env},
+    {".deb", FileType::Deb},
+    {".rpm", FileType::Rpm},
+    {".tar", FileType::Tar},
+    {".gz", FileType::Gzip},
+    {".tgz", FileType::Gzip},
+    {".zip", FileType::Zip},
+    {".xz", FileType::Xz},
+    {".txz", FileType::Xz},
+    {".zst", FileType::Zstd},
+    {".tzst", FileType::Zstd},
+    {".dockerfile", FileType::Dockerfile},
+    {"dockerfile", FileType::Dockerfile},
+    {"containerfile", FileType::Dockerfile},
+};
+
+constexpr size_t TABLE_SIZE = 32; // power of two
+constexpr size_t MAX_KEY_LENGTH = 16;
+
+constexpr char lower(char c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// FNV-1a over the lower-cased key, with the seed as the offset basis and
+// a final mix so that neighbouring seeds give unrelated slots.
+constexpr uint32_t hashName(std::string_view text, uint32_t seed) {
+  uint32_t h = seed;
+  for (char c : text) {
+    h ^= static_cast<unsigned char>(lower(c));
+    h *= 16777619u;
+  }
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  return h;
+}
+
+constexpr bool collisionFree(uint32_t seed) {
+  bool used[TABLE_SIZE] = {};
+  for (const NameKey &key : NAME_KEYS) {
+    const size_t slot = hashName(key.text, seed) & (TABLE_SIZE - 1);
+    if (used[slot]) {
+      return false;
+    }
+    used[slot] = true;
+  }
+  return true;
+}
+
+// The first seed that sends every key to its own slot, so a lookup is one
+// hash and one comparison.
+constexpr uint32_t findSeed() {
+  uint32_t seed = 2166136261u;
+  while (!collisionFree(seed)) {
+    seed++;
+  }
+  return seed;
+}
+
+constexpr uint32_t SEED = findSeed();
+
+struct NameTable {
+  NameKey slots[TABLE_SIZE];
+};
+
+constexpr NameTable buildTable() {
+  NameTable table{};
+  for (const NameKey &key : NAME_KEYS) {
+    table.slots[hashName(key.text, SEED) & (TABLE_SIZE - 1)] = key;
+  }
+  return table;
+}
+
+constexpr NameTable TABLE = buildTable();
+
+constexpr FileType lookup(std::string_view text) {
+  if (text.empty() || text.size() > MAX_KEY_LENGTH) {
+    return FileType::Unknown;
+  }
+  const NameKey &slot = TABLE.slots[hashName(text, SEED) & (TABLE_SIZE - 1)];
+  if (slot.text.size() != text.size()) {
+    return FileType::Unknown;
+  }
+  for (size_t i = 0; i < text.size(); i++) {
+    if (lower(text[i]) != slot.text[i]) {
+      return FileType::Unknown;
+    }
+  }
+  return slot.type;
+}
+
+static_assert(lookup(".json") == FileType::Json, "perfect hash lookup");
+static_assert(lookup("Dockerfile") == FileType::Dockerfile,
+              "lookups are case-insensitive");
+static_assert(lookup(".jsn") == FileType::Unknown, "misses compare keys");
+
+constexpr bool startsWithNoCase(std::string_view text,
+                                std::string_view prefix) {
+  if (text.size() < prefix.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < prefix.size(); i++) {
+    if (lower(text[i]) != prefix[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+bool isKeyChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.';
+}
+
+// Guesses a text format from its first meaningful line.
+FileType sniffText(std::string_view text) {
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t end = text.find('\n', pos);
+    if (end == std::string_view::npos) {
+      end = text.size();
+    }
+    std::string_view line = text.substr(pos, end - pos);
+    pos = end + 1;
+
+    while (!line.empty() && isSpace(line.front())) {
+      line.remove_prefix(1);
+    }
+    while (!line.empty() && isSpace(line.back())) {
+      line.remove_suffix(1);
+    }
+    if (line.empty()) {
+      continue;
+    }
+    if (line[0] == '#') {
+      // "# syntax=..." opens many Dockerfiles; other comments say nothing.
+      if (startsWithNoCase(line, "# syntax=")) {
+        return FileType::Dockerfile;
+      }
+      continue;
+    }
+
+    if (line[0] == '{') {
+      return FileType::Json;
+    }
+    if (line[0] == '[') {
+      // "[section]" and "[[array]]" are TOML tables; anything else is a
+      // JSON array.
+      size_t i = line.size() > 1 && line[1] == '[' ? 2 : 1;
+      const size_t keyStart = i;
+      while (i < line.size() && (isKeyChar(line[i]) || line[i] == '"')) {
+        i++;
+      }
+      return i > keyStart && i < line.size() && line[i] == ']'
+                 ? FileType::Toml
+                 : FileType::Json;
+    }
+    if (line == "---" || line.substr(0, 4) == "--- " ||
+        line.substr(0, 5) == "%YAML" || line.substr(0, 2) == "- ") {
+      return FileType::Yaml;
+    }
+    if (startsWithNoCase(line, "from ") || startsWithNoCase(line, "arg ")) {
+      return FileType::Dockerfile;
+    }
+    if (line.substr(0, 7) == "export ") {
+      return FileType::Env;
+    }
+
+    size_t i = 0;
+    while (i < line.size() && isKeyChar(line[i])) {
+      i++;
+    }
+    if (i == 0 || i == line.size()) {
+      return FileType::Unknown;
+    }
+    // KEY=value is ENV; key = value is TOML; key: value is YAML.
+    const size_t keyEnd = i;
+    while (i < line.size() && isSpace(line[i])) {
+      i++;
+    }
+    if (i < line.size() && line[i] == '=') {
+      return i == keyEnd ? FileType::Env : FileType::Toml;
+    }
+    if (i < line.size() && line[i] == ':' &&
+        (i + 1 == line.size() || isSpace(line[i + 1]))) {
+      return FileType::Yaml;
+    }
+    return FileType::Unknown;
+  }
+  return FileType::Unknown;
+}
+
+} // namespace
+
+FileType FileTypeDetector::fromName(std::string_view path) {
+  const size_t slash = path.find_last_of("/\\");
+  const std::string_view base =
+      slash == std::string_view::npos ? path : path.substr(slash + 1);
+
+  const FileType whole = lookup(base);
+  if (whole != FileType::Unknown) {
+    return whole;
+  }
+  if (startsWithNoCase(base, ".env.")) {
+    return FileType::Env;
+  }
+  if (startsWithNoCase(base, "dockerfile.") ||
+      startsWithNoCase(base, "containerfile.")) {
+    return FileType::Dockerfile;
+  }
+  const size_t dot = base.rfind('.');
+  if (dot == std::string_view::npos) {
+    return FileType::Unknown;
+  }
+  return lookup(base.substr(dot));
+}
+
+FileType FileTypeDetector::fromContent(std::string_view head) {
+  if (head.substr(0, 8) == "!<arch>\n") {
+    // A .deb is an ar archive whose first member is debian-binary.
+    return head.substr(8, 13) == "debian-binary" ? FileType::Deb
+                                                 : FileType::Unknown;
+  }
+  if (head.substr(0, 4) == "\xED\xAB\xEE\xDB") {
+    return FileType::Rpm;
+  }
+  if (head.substr(0, 2) == "\x1F\x8B") {
+    return FileType::Gzip;
+  }
+  if (head.substr(0, 6) == std::string_view("\xFD" "7zXZ\0", 6)) {
+    return FileType::Xz;
+  }
+  if (head.substr(0, 4) == "\x28\xB5\x2F\xFD") {
+    return FileType::Zstd;
+  }
+  if (head.substr(0, 4) == "PK\x03\x04" || head.substr(0, 4) == "PK\x05\x06") {
+    return FileType::Zip;
+  }
+  if (head.size() >= 262 && head.substr(257, 5) == "ustar") {
+    return FileType::Tar;
+  }
+  if (head.find('\0') != std::string_view::npos) {
+    return FileType::Unknown; // binary
+  }
+  if (head.substr(0, 3) == "\xEF\xBB\xBF") {
+    head.remove_prefix(3);
+  }
+  return sniffText(head);
+}
+
+FileType FileTypeDetector::detectFile(const std::string &path) {
+  const FileType type = fromName(path);
+  if (type != FileType::Unknown) {
+    return type;
+  }
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (!file) {
+    return FileType::Unknown;
+  }
+  char head[SNIFF_BYTES];
+  const size_t n = std::fread(head, 1, sizeof(head), file);
+  std::fclose(file);
+  return fromContent(std::string_view(head, n));
+}
+
+bool FileTypeDetector::isConfig(FileType type) {
+  return type == FileType::Json || type == FileType::Yaml ||
+         type == FileType::Toml || type == FileType::Env;
+}
+
+bool FileTypeDetector::isArtifact(FileType type) {
+  return type == FileType::Deb || type == FileType::Rpm ||
+         type == FileType::Dockerfile || isArchive(type);
+}
+
+bool FileTypeDetector::isArchive(FileType type) {
+  return type == FileType::Tar || type == FileType::Gzip ||
+         type == FileType::Xz || type == FileType::Zstd ||
+         type == FileType::Zip;
+}
+
+const char *FileTypeDetector::name(FileType type) {
+  switch (type) {
+  case FileType::Json:
+    return "JSON";
+  case FileType::Yaml:
+    return "YAML";
+  case FileType::Toml:
+    return "TOML";
+  case FileType::Env:
+    return "ENV";
+  case FileType::Deb:
+    return "DEB package";
+  case FileType::Rpm:
+    return "RPM package";
+  case FileType::Tar:
+    return "tar archive";
+  case FileType::Gzip:
+    return "gzip archive";
+  case FileType::Zip:
+    return "zip archive";
+  case FileType::Xz:
+    return "xz archive";
+  case FileType::Zstd:
+    return "zstd archive";
+  case FileType::Dockerfile:
+    return "Dockerfile";
+  case FileType::Unknown:
+    break;
+  }
+  return "unknown";
+}
+
+} // namespace devops
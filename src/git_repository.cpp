@@ -0,0 +1,773 @@
+#include "git_repository.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef DEVOPS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace devops {
+
+namespace {
+
+constexpr int OBJ_OFS_DELTA = 6;
+constexpr int OBJ_REF_DELTA = 7;
+
+// Longer chains than git itself writes (--depth defaults to 50) are treated
+// as corrupt, which also stops cycles.
+constexpr int MAX_DELTA_DEPTH = 4096;
+
+constexpr uint32_t IDX_MAGIC = 0xff744f63;
+
+uint32_t readBE32(const uint8_t *p) {
+  return (static_cast<uint32_t>(p[0]) << 24) |
+         (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool isHex(std::string_view s) {
+  return !s.empty() && std::all_of(s.begin(), s.end(),
+                                   [](char c) { return hexValue(c) >= 0; });
+}
+
+bool parseOid(std::string_view hex, GitOid &id) {
+  if (hex.size() < 40 || !isHex(hex.substr(0, 40))) {
+    return false;
+  }
+  for (size_t i = 0; i < 20; i++) {
+    id.bytes[i] =
+        static_cast<uint8_t>(hexValue(hex[2 * i]) * 16 + hexValue(hex[2 * i + 1]));
+  }
+  return true;
+}
+
+std::string readSmallFile(const fs::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return std::string();
+  }
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  return buffer.str();
+}
+
+std::string trim(std::string s) {
+  while (!s.empty() && (s.back() == '\n' || s.back() == '\r' ||
+                        s.back() == ' ' || s.back() == '\t')) {
+    s.pop_back();
+  }
+  return s;
+}
+
+// Inflates a zlib stream. With `expected` set the output must be exactly
+// that long, as pack entries record their size.
+void inflateInto(const uint8_t *data, size_t length, std::string &out,
+                 size_t expected) {
+#ifdef DEVOPS_HAVE_ZLIB
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  if (inflateInit(&stream) != Z_OK) {
+    throw std::runtime_error("zlib initialisation failed");
+  }
+  out.assign(expected ? expected : std::max<size_t>(length * 4, 256), '\0');
+  stream.next_in = const_cast<Bytef *>(data);
+  size_t produced = 0;
+  int status = Z_OK;
+  // Fed in 1 GiB slices because zlib lengths are 32-bit.
+  constexpr size_t SLICE = size_t{1} << 30;
+  size_t consumed = 0;
+  while (status == Z_OK) {
+    if (produced == out.size()) {
+      if (expected) {
+        break; // more output than the header promised
+      }
+      out.resize(out.size() * 2);
+    }
+    stream.next_out = reinterpret_cast<Bytef *>(&out[produced]);
+    stream.avail_out =
+        static_cast<uInt>(std::min(out.size() - produced, SLICE));
+    stream.next_in = const_cast<Bytef *>(data + consumed);
+    stream.avail_in = static_cast<uInt>(std::min(length - consumed, SLICE));
+    const uInt availIn = stream.avail_in;
+    const uInt availOut = stream.avail_out;
+    status = ::inflate(&stream, Z_NO_FLUSH);
+    consumed += availIn - stream.avail_in;
+    produced += availOut - stream.avail_out;
+    if (status == Z_BUF_ERROR && stream.avail_in == 0 && consumed == length) {
+      break; // input ended before the stream did
+    }
+    if (status == Z_BUF_ERROR) {
+      status = Z_OK;
+    }
+  }
+  inflateEnd(&stream);
+  if (status != Z_STREAM_END || (expected && produced != expected)) {
+    throw std::runtime_error("corrupt zlib stream");
+  }
+  out.resize(produced);
+#else
+  (void)data;
+  (void)length;
+  (void)out;
+  (void)expected;
+  throw std::runtime_error("built without zlib; git object reading is "
+                           "unavailable");
+#endif
+}
+
+uint64_t readDeltaSize(const std::string &delta, size_t &pos) {
+  uint64_t size = 0;
+  int shift = 0;
+  uint8_t c;
+  do {
+    if (pos >= delta.size() || shift > 56) {
+      throw std::runtime_error("corrupt delta header");
+    }
+    c = static_cast<uint8_t>(delta[pos++]);
+    size |= static_cast<uint64_t>(c & 0x7F) << shift;
+    shift += 7;
+  } while (c & 0x80);
+  return size;
+}
+
+std::string applyDelta(const std::string &base, const std::string &delta) {
+  size_t pos = 0;
+  if (readDeltaSize(delta, pos) != base.size()) {
+    throw std::runtime_error("delta base size mismatch");
+  }
+  const uint64_t resultSize = readDeltaSize(delta, pos);
+  std::string result;
+  result.reserve(resultSize);
+
+  while (pos < delta.size()) {
+    const uint8_t op = static_cast<uint8_t>(delta[pos++]);
+    if (op & 0x80) {
+      uint64_t offset = 0, size = 0;
+      for (int i = 0; i < 4; i++) {
+        if (op & (1 << i)) {
+          if (pos >= delta.size()) {
+            throw std::runtime_error("truncated delta");
+          }
+          offset |= static_cast<uint64_t>(static_cast<uint8_t>(delta[pos++]))
+                    << (8 * i);
+        }
+      }
+      for (int i = 0; i < 3; i++) {
+        if (op & (0x10 << i)) {
+          if (pos >= delta.size()) {
+            throw std::runtime_error("truncated delta");
+          }
+          size |= static_cast<uint64_t>(static_cast<uint8_t>(delta[pos++]))
+                  << (8 * i);
+        }
+      }
+      if (size == 0) {
+        size = 0x10000;
+      }
+      if (offset + size > base.size()) {
+        throw std::runtime_error("delta copy out of range");
+      }
+      result.append(base, offset, size);
+    } else if (op != 0) {
+      if (pos + op > delta.size()) {
+        throw std::runtime_error("truncated delta");
+      }
+      result.append(delta, pos, op);
+      pos += op;
+    } else {
+      throw std::runtime_error("corrupt delta opcode");
+    }
+  }
+  if (result.size() != resultSize) {
+    throw std::runtime_error("delta result size mismatch");
+  }
+  return result;
+}
+
+struct TreeItem {
+  std::string name;
+  bool directory;
+  bool file; // regular file; symlinks and submodules are neither
+  GitOid id;
+};
+
+std::vector<TreeItem> parseTree(const std::string &data) {
+  std::vector<TreeItem> items;
+  size_t pos = 0;
+  while (pos < data.size()) {
+    size_t space = data.find(' ', pos);
+    size_t nul = data.find('\0', space == std::string::npos ? pos : space);
+    if (space == std::string::npos || nul == std::string::npos ||
+        nul + 21 > data.size()) {
+      throw std::runtime_error("corrupt tree object");
+    }
+    const std::string mode = data.substr(pos, space - pos);
+    TreeItem item;
+    item.name = data.substr(space + 1, nul - space - 1);
+    item.directory = mode == "40000";
+    item.file = mode.size() == 6 && mode.compare(0, 3, "100") == 0;
+    std::memcpy(item.id.bytes.data(), data.data() + nul + 1, 20);
+    items.push_back(std::move(item));
+    pos = nul + 21;
+  }
+  return items;
+}
+
+} // namespace
+
+std::string GitOid::hex() const {
+  static const char DIGITS[] = "0123456789abcdef";
+  std::string out(40, '0');
+  for (size_t i = 0; i < 20; i++) {
+    out[2 * i] = DIGITS[bytes[i] >> 4];
+    out[2 * i + 1] = DIGITS[bytes[i] & 15];
+  }
+  return out;
+}
+
+struct GitRepository::Pack {
+  MappedFile index;
+  MappedFile data;
+  const uint8_t *fanout = nullptr;
+  const uint8_t *names = nullptr;
+  const uint8_t *offsets32 = nullptr;
+  const uint8_t *offsets64 = nullptr;
+  uint32_t count = 0;
+
+  const uint8_t *bytes() const {
+    return reinterpret_cast<const uint8_t *>(data.view().data());
+  }
+
+  // Range of index positions whose first byte is `first`.
+  std::pair<uint32_t, uint32_t> bucket(uint8_t first) const {
+    uint32_t begin = first == 0 ? 0 : readBE32(fanout + 4 * (first - 1));
+    return {begin, readBE32(fanout + 4 * first)};
+  }
+
+  const uint8_t *name(uint32_t i) const { return names + 20 * size_t{i}; }
+
+  uint64_t offset(uint32_t i) const {
+    uint32_t small = readBE32(offsets32 + 4 * size_t{i});
+    if (!(small & 0x80000000)) {
+      return small;
+    }
+    const uint8_t *p = offsets64 + 8 * size_t{small & 0x7FFFFFFF};
+    return (static_cast<uint64_t>(readBE32(p)) << 32) | readBE32(p + 4);
+  }
+
+  bool find(const GitOid &id, uint64_t &out) const {
+    auto [lo, hi] = bucket(id.bytes[0]);
+    while (lo < hi) {
+      uint32_t mid = lo + (hi - lo) / 2;
+      int cmp = std::memcmp(name(mid), id.bytes.data(), 20);
+      if (cmp == 0) {
+        out = offset(mid);
+        return true;
+      }
+      if (cmp < 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return false;
+  }
+};
+
+GitRepository::GitRepository(const std::string &path) {
+  fs::path root(path);
+  std::error_code ec;
+  if (fs::is_directory(root / ".git", ec)) {
+    gitDir_ = (root / ".git").string();
+  } else if (fs::is_regular_file(root / ".git", ec)) {
+    // Worktrees and submodules: ".git" is a file naming the real directory.
+    std::string link = trim(readSmallFile(root / ".git"));
+    if (link.compare(0, 8, "gitdir: ") != 0) {
+      throw std::runtime_error("unrecognised .git file in " + path);
+    }
+    fs::path target(link.substr(8));
+    gitDir_ = (target.is_absolute() ? target : root / target).string();
+  } else if (fs::is_regular_file(root / "HEAD", ec) &&
+             fs::is_directory(root / "objects", ec)) {
+    gitDir_ = root.string();
+  } else {
+    throw std::runtime_error("not a git repository: " + path);
+  }
+
+  commonDir_ = gitDir_;
+  std::string common = trim(readSmallFile(fs::path(gitDir_) / "commondir"));
+  if (!common.empty()) {
+    fs::path target(common);
+    commonDir_ =
+        (target.is_absolute() ? target : fs::path(gitDir_) / target).string();
+  }
+
+  std::string config = readSmallFile(fs::path(commonDir_) / "config");
+  if (config.find("objectformat = sha256") != std::string::npos ||
+      config.find("objectFormat = sha256") != std::string::npos) {
+    throw std::runtime_error("SHA-256 repositories are not supported");
+  }
+
+  const fs::path packDir = fs::path(commonDir_) / "objects" / "pack";
+  for (fs::directory_iterator it(packDir, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    const fs::path idx = it->path();
+    if (idx.extension() != ".idx") {
+      continue;
+    }
+    fs::path packPath = idx;
+    packPath.replace_extension(".pack");
+    if (!fs::exists(packPath)) {
+      continue;
+    }
+
+    auto pack = std::make_unique<Pack>();
+    pack->index = MappedFile(idx.string());
+    pack->data = MappedFile(packPath.string());
+    const auto *p = reinterpret_cast<const uint8_t *>(pack->index.view().data());
+    const size_t size = pack->index.size();
+    if (size < 8 + 1024 || readBE32(p) != IDX_MAGIC || readBE32(p + 4) != 2) {
+      throw std::runtime_error("unsupported pack index (only version 2): " +
+                               idx.string());
+    }
+    pack->fanout = p + 8;
+    pack->count = readBE32(pack->fanout + 4 * 255);
+    pack->names = pack->fanout + 1024;
+    pack->offsets32 = pack->names + 24 * size_t{pack->count}; // skips CRCs
+    pack->offsets64 = pack->offsets32 + 4 * size_t{pack->count};
+    if (static_cast<size_t>(pack->offsets64 - p) > size ||
+        pack->data.size() < 12 + 20 || // header and trailing checksum
+        std::memcmp(pack->data.view().data(), "PACK", 4) != 0) {
+      throw std::runtime_error("corrupt pack: " + packPath.string());
+    }
+    packs_.push_back(std::move(pack));
+  }
+}
+
+GitRepository::~GitRepository() = default;
+
+bool GitRepository::readLoose(const GitOid &id, Object &object) const {
+  const std::string hex = id.hex();
+  const fs::path path =
+      fs::path(commonDir_) / "objects" / hex.substr(0, 2) / hex.substr(2);
+  std::error_code ec;
+  if (!fs::is_regular_file(path, ec)) {
+    return false;
+  }
+  MappedFile file(path.string());
+  std::string raw;
+  inflateInto(reinterpret_cast<const uint8_t *>(file.view().data()),
+              file.size(), raw, 0);
+
+  size_t nul = raw.find('\0');
+  size_t space = raw.find(' ');
+  if (nul == std::string::npos || space == std::string::npos || space > nul) {
+    throw std::runtime_error("corrupt loose object " + hex);
+  }
+  const std::string type = raw.substr(0, space);
+  object.type = type == "commit" ? COMMIT
+                : type == "tree" ? TREE
+                : type == "blob" ? BLOB
+                : type == "tag"  ? TAG
+                                 : 0;
+  object.data = raw.substr(nul + 1);
+  return true;
+}
+
+std::shared_ptr<const GitRepository::Object>
+GitRepository::readPackEntry(const Pack &pack, uint64_t offset,
+                             int depth) const {
+  const CacheKey key{&pack, offset};
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return it->second->second;
+    }
+  }
+  if (depth > MAX_DELTA_DEPTH) {
+    throw std::runtime_error("delta chain too deep");
+  }
+
+  const uint8_t *base = pack.bytes();
+  const size_t end = pack.data.size() - 20; // trailing checksum
+  size_t pos = static_cast<size_t>(offset);
+  auto next = [&]() -> uint8_t {
+    if (pos >= end) {
+      throw std::runtime_error("pack entry out of range");
+    }
+    return base[pos++];
+  };
+
+  uint8_t c = next();
+  const int type = (c >> 4) & 7;
+  uint64_t size = c & 15;
+  for (int shift = 4; c & 0x80; shift += 7) {
+    c = next();
+    size |= static_cast<uint64_t>(c & 0x7F) << shift;
+  }
+
+  auto object = std::make_shared<Object>();
+  if (type == OBJ_OFS_DELTA || type == OBJ_REF_DELTA) {
+    std::shared_ptr<const Object> deltaBase;
+    if (type == OBJ_OFS_DELTA) {
+      c = next();
+      uint64_t distance = c & 0x7F;
+      while (c & 0x80) {
+        c = next();
+        distance = ((distance + 1) << 7) | (c & 0x7F);
+      }
+      if (distance == 0 || distance > offset) {
+        throw std::runtime_error("corrupt OFS_DELTA offset");
+      }
+      deltaBase = readPackEntry(pack, offset - distance, depth + 1);
+    } else {
+      if (pos + 20 > end) {
+        throw std::runtime_error("pack entry out of range");
+      }
+      GitOid baseId;
+      std::memcpy(baseId.bytes.data(), base + pos, 20);
+      pos += 20;
+      uint64_t baseOffset;
+      if (pack.find(baseId, baseOffset)) {
+        deltaBase = readPackEntry(pack, baseOffset, depth + 1);
+      } else {
+        deltaBase = std::make_shared<Object>(readObject(baseId));
+      }
+    }
+    std::string delta;
+    inflateInto(base + pos, end - pos, delta, static_cast<size_t>(size));
+    object->type = deltaBase->type;
+    object->data = applyDelta(deltaBase->data, delta);
+  } else if (type >= COMMIT && type <= TAG) {
+    object->type = type;
+    inflateInto(base + pos, end - pos, object->data, static_cast<size_t>(size));
+  } else {
+    throw std::runtime_error("unknown pack object type " +
+                             std::to_string(type));
+  }
+
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  if (cache_.find(key) == cache_.end() &&
+      object->data.size() < BASE_CACHE_BYTES / 4) {
+    lru_.emplace_front(key, object);
+    cache_[key] = lru_.begin();
+    cacheBytes_ += object->data.size();
+    while (cacheBytes_ > BASE_CACHE_BYTES) {
+      cacheBytes_ -= lru_.back().second->data.size();
+      cache_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+  }
+  return object;
+}
+
+bool GitRepository::readPacked(const GitOid &id, Object &object) const {
+  for (const auto &pack : packs_) {
+    uint64_t offset;
+    if (pack->find(id, offset)) {
+      object = *readPackEntry(*pack, offset, 0);
+      return true;
+    }
+  }
+  return false;
+}
+
+GitRepository::Object GitRepository::readObject(const GitOid &id) const {
+  Object object;
+  if (readPacked(id, object) || readLoose(id, object)) {
+    return object;
+  }
+  throw std::runtime_error("object " + id.hex() + " not found");
+}
+
+std::string GitRepository::readBlob(const GitOid &id) const {
+  Object object = readObject(id);
+  if (object.type != BLOB) {
+    throw std::runtime_error("object " + id.hex() + " is not a blob");
+  }
+  return std::move(object.data);
+}
+
+GitOid GitRepository::peel(GitOid id) const {
+  for (int i = 0; i < 16; i++) {
+    Object object = readObject(id);
+    if (object.type == COMMIT) {
+      return id;
+    }
+    if (object.type != TAG || object.data.compare(0, 7, "object ") != 0 ||
+        !parseOid(std::string_view(object.data).substr(7), id)) {
+      throw std::runtime_error("object " + id.hex() + " is not a commit");
+    }
+  }
+  throw std::runtime_error("tag chain too long");
+}
+
+GitOid GitRepository::treeOf(const GitOid &commit) const {
+  Object object = readObject(commit);
+  GitOid tree;
+  if (object.type != COMMIT || object.data.compare(0, 5, "tree ") != 0 ||
+      !parseOid(std::string_view(object.data).substr(5), tree)) {
+    throw std::runtime_error("corrupt commit " + commit.hex());
+  }
+  return tree;
+}
+
+GitOid GitRepository::parent(const GitOid &commit, unsigned n) const {
+  Object object = readObject(commit);
+  std::istringstream lines(object.data);
+  std::string line;
+  unsigned seen = 0;
+  while (std::getline(lines, line) && !line.empty()) {
+    GitOid id;
+    if (line.compare(0, 7, "parent ") == 0 &&
+        parseOid(std::string_view(line).substr(7), id) && ++seen == n) {
+      return id;
+    }
+  }
+  throw std::runtime_error("commit " + commit.hex() + " has no parent " +
+                           std::to_string(n));
+}
+
+bool GitRepository::resolveRef(const std::string &name, GitOid &id,
+                               int depth) const {
+  if (depth > 8 || name.find("..") != std::string::npos) {
+    return false;
+  }
+  // HEAD and other pseudo-refs are per worktree; refs/ are shared.
+  const bool perWorktree = name.find('/') == std::string::npos;
+  const fs::path loose =
+      fs::path(perWorktree ? gitDir_ : commonDir_) / name;
+  std::error_code ec;
+  if (fs::is_regular_file(loose, ec)) {
+    std::string content = trim(readSmallFile(loose));
+    if (content.compare(0, 5, "ref: ") == 0) {
+      return resolveRef(content.substr(5), id, depth + 1);
+    }
+    return parseOid(content, id);
+  }
+
+  std::istringstream packed(readSmallFile(fs::path(commonDir_) /
+                                          "packed-refs"));
+  std::string line;
+  while (std::getline(packed, line)) {
+    if (line.size() > 41 && line[40] == ' ' && line.compare(41, std::string::npos, name) == 0) {
+      return parseOid(line, id);
+    }
+  }
+  return false;
+}
+
+bool GitRepository::resolvePrefix(const std::string &hex, GitOid &id) const {
+  std::string lower = hex;
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](char c) { return static_cast<char>(std::tolower(c)); });
+  std::vector<std::string> matches;
+
+  auto matchesPrefix = [&lower](const GitOid &candidate) {
+    return candidate.hex().compare(0, lower.size(), lower) == 0;
+  };
+
+  for (const auto &pack : packs_) {
+    GitOid low;
+    for (size_t i = 0; i < lower.size(); i++) {
+      const int v = hexValue(lower[i]);
+      low.bytes[i / 2] |= static_cast<uint8_t>(i % 2 ? v : v << 4);
+    }
+    auto [lo, hi] = pack->bucket(low.bytes[0]);
+    // First index entry not below the prefix padded with zeros.
+    while (lo < hi) {
+      uint32_t mid = lo + (hi - lo) / 2;
+      if (std::memcmp(pack->name(mid), low.bytes.data(), 20) < 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    for (uint32_t i = lo; i < pack->count; i++) {
+      GitOid candidate;
+      std::memcpy(candidate.bytes.data(), pack->name(i), 20);
+      if (!matchesPrefix(candidate)) {
+        break;
+      }
+      matches.push_back(candidate.hex());
+    }
+  }
+
+  const fs::path dir =
+      fs::path(commonDir_) / "objects" / lower.substr(0, 2);
+  std::error_code ec;
+  for (fs::directory_iterator it(dir, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    const std::string full = lower.substr(0, 2) + it->path().filename().string();
+    if (full.size() == 40 && full.compare(0, lower.size(), lower) == 0) {
+      matches.push_back(full);
+    }
+  }
+
+  std::sort(matches.begin(), matches.end());
+  matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+  if (matches.size() > 1) {
+    throw std::runtime_error("ambiguous object id prefix " + hex);
+  }
+  return matches.size() == 1 && parseOid(matches[0], id);
+}
+
+GitOid GitRepository::resolve(const std::string &rev) const {
+  const size_t suffix = rev.find_first_of("^~");
+  const std::string name = rev.substr(0, suffix);
+  if (name.empty()) {
+    throw std::runtime_error("invalid revision '" + rev + "'");
+  }
+
+  // Same lookup order as git's rev-parse.
+  GitOid id;
+  bool found = false;
+  for (const std::string &candidate :
+       {name, "refs/" + name, "refs/tags/" + name, "refs/heads/" + name,
+        "refs/remotes/" + name, "refs/remotes/" + name + "/HEAD"}) {
+    if (resolveRef(candidate, id)) {
+      found = true;
+      break;
+    }
+  }
+  if (!found && name.size() >= 4 && name.size() <= 40 && isHex(name)) {
+    found = resolvePrefix(name, id);
+  }
+  if (!found) {
+    throw std::runtime_error("unknown revision '" + name + "'");
+  }
+  id = peel(id);
+
+  size_t pos = suffix;
+  while (pos != std::string::npos && pos < rev.size()) {
+    const char op = rev[pos++];
+    if (op == '^' && pos < rev.size() && rev[pos] == '{') {
+      const size_t close = rev.find('}', pos);
+      const std::string what =
+          close == std::string::npos ? "" : rev.substr(pos + 1, close - pos - 1);
+      if (close == std::string::npos || (!what.empty() && what != "commit")) {
+        throw std::runtime_error("unsupported revision suffix in '" + rev +
+                                 "'");
+      }
+      pos = close + 1;
+      continue; // already peeled to a commit
+    }
+
+    size_t digits = pos;
+    while (digits < rev.size() && std::isdigit(static_cast<unsigned char>(rev[digits]))) {
+      digits++;
+    }
+    const unsigned n =
+        digits > pos ? static_cast<unsigned>(std::stoul(rev.substr(pos, digits - pos)))
+                     : 1;
+    pos = digits;
+    if (op == '^') {
+      if (n > 0) {
+        id = parent(id, n);
+      }
+    } else if (op == '~') {
+      for (unsigned i = 0; i < n; i++) {
+        id = parent(id, 1);
+      }
+    } else {
+      throw std::runtime_error("invalid revision '" + rev + "'");
+    }
+  }
+  return id;
+}
+
+void GitRepository::walkTree(const GitOid &tree, const std::string &prefix,
+                             std::vector<GitTreeEntry> &out) const {
+  Object object = readObject(tree);
+  if (object.type != TREE) {
+    throw std::runtime_error("object " + tree.hex() + " is not a tree");
+  }
+  for (const TreeItem &item : parseTree(object.data)) {
+    if (item.directory) {
+      walkTree(item.id, prefix + item.name + "/", out);
+    } else if (item.file) {
+      out.push_back({prefix + item.name, item.id});
+    }
+  }
+}
+
+void GitRepository::diffTree(const GitOid *base, const GitOid &tree,
+                             const std::string &prefix,
+                             std::vector<GitTreeEntry> &out) const {
+  if (!base) {
+    walkTree(tree, prefix, out);
+    return;
+  }
+  std::unordered_map<std::string, TreeItem> before;
+  for (TreeItem &item : parseTree(readObject(*base).data)) {
+    before.emplace(item.name, std::move(item));
+  }
+
+  Object object = readObject(tree);
+  for (const TreeItem &item : parseTree(object.data)) {
+    auto old = before.find(item.name);
+    const bool same = old != before.end() && old->second.id == item.id &&
+                      old->second.directory == item.directory;
+    if (same) {
+      continue;
+    }
+    if (item.directory) {
+      const bool wasDirectory = old != before.end() && old->second.directory;
+      diffTree(wasDirectory ? &old->second.id : nullptr, item.id,
+               prefix + item.name + "/", out);
+    } else if (item.file) {
+      out.push_back({prefix + item.name, item.id});
+    }
+  }
+}
+
+std::vector<GitTreeEntry>
+GitRepository::listFiles(const GitOid &commit) const {
+  std::vector<GitTreeEntry> files;
+  walkTree(treeOf(commit), "", files);
+  std::sort(files.begin(), files.end(),
+            [](const GitTreeEntry &a, const GitTreeEntry &b) {
+              return a.path < b.path;
+            });
+  return files;
+}
+
+std::vector<GitTreeEntry>
+GitRepository::listChangedFiles(const GitOid &base,
+                                const GitOid &commit) const {
+  std::vector<GitTreeEntry> files;
+  const GitOid baseTree = treeOf(base);
+  const GitOid tree = treeOf(commit);
+  if (baseTree != tree) {
+    diffTree(&baseTree, tree, "", files);
+  }
+  std::sort(files.begin(), files.end(),
+            [](const GitTreeEntry &a, const GitTreeEntry &b) {
+              return a.path < b.path;
+            });
+  return files;
+}
+
+} // namespace devops
@@ -1,9 +1,10 @@
 #include "health_checker.h"
+#include "profiler.h"
+#include "report.h"
 #include "utils.h"
 #include <array>
 #include <cstdlib>
 #include <fstream>
-#include <iostream>
 #include <sstream>
 
 #ifdef _WIN32
@@ -17,12 +18,25 @@
 
 namespace devops {
 
+namespace {
+
+// Essential DevOps tools
+const char *const TOOLS[] = {"git",       "docker", "kubectl", "ansible",
+                             "terraform", "cmake",  "make",    "gcc",
+                             "python3",   "node",   "npm"};
+
+// Important environment variables
+const char *const ENV_VARS[] = {"PATH",           "HOME", "USER",
+                                "SHELL",          "CI",   "GITHUB_ACTIONS",
+                                "DOCKER_HOST"};
+
+} // namespace
+
 HealthCheckResult HealthChecker::checkSystem() {
+  ProfileScope scope("health.system");
   HealthCheckResult result;
   result.healthy = true;
 
-  Utils::printInfo("Checking system information...");
-
   result.systemInfo["OS"] = getOSInfo();
   result.systemInfo["CPU"] = getCPUInfo();
   result.systemInfo["Memory"] = getMemoryInfo();
@@ -32,24 +46,15 @@ HealthCheckResult HealthChecker::checkSystem() {
 }
 
 HealthCheckResult HealthChecker::checkTools() {
+  ProfileScope scope("health.tools");
   HealthCheckResult result;
   result.healthy = true;
 
-  Utils::printInfo("Checking DevOps tools...");
-
-  // Essential DevOps tools
-  std::vector<std::string> tools = {"git",       "docker", "kubectl", "ansible",
-                                    "terraform", "cmake",  "make",    "gcc",
-                                    "python3",   "node",   "npm"};
-
-  for (const auto &tool : tools) {
+  for (const std::string tool : TOOLS) {
     if (checkCommand(tool)) {
-      std::string version = getCommandVersion(tool);
-      result.systemInfo[tool] = version;
-      Utils::printSuccess(tool + ": " + version);
+      result.systemInfo[tool] = getCommandVersion(tool);
     } else {
       result.warnings.push_back(tool + " not found");
-      Utils::printWarning(tool + " not found");
     }
   }
 
@@ -57,20 +62,14 @@ HealthCheckResult HealthChecker::checkTools() {
 }
 
 HealthCheckResult HealthChecker::checkEnvironment() {
+  ProfileScope scope("health.environment");
   HealthCheckResult result;
   result.healthy = true;
 
-  Utils::printInfo("Checking environment variables...");
-
-  // Check important environment variables
-  std::vector<std::string> envVars = {
-      "PATH", "HOME", "USER", "SHELL", "CI", "GITHUB_ACTIONS", "DOCKER_HOST"};
-
-  for (const auto &var : envVars) {
+  for (const std::string var : ENV_VARS) {
     const char *value = std::getenv(var.c_str());
     if (value) {
       result.systemInfo[var] = value;
-      Utils::printSuccess(var + " is set");
     } else {
       if (var == "CI" || var == "GITHUB_ACTIONS" || var == "DOCKER_HOST") {
         // These are optional
@@ -85,31 +84,43 @@ HealthCheckResult HealthChecker::checkEnvironment() {
 }
 
 void HealthChecker::printReport() {
-  std::cout << "\n"
-            << Color::BOLD << Color::CYAN
-            << "==================================================" << std::endl
-            << "         DEVOPS SYSTEM HEALTH REPORT" << std::endl
-            << "=================================================="
-            << Color::RESET << std::endl;
+  std::ostream &out = Report::out();
+  out << "\n"
+      << Color::BOLD << Color::CYAN
+      << "==================================================" << '\n'
+      << "         DEVOPS SYSTEM HEALTH REPORT" << '\n'
+      << "==================================================" << Color::RESET
+      << '\n';
 
+  Utils::printInfo("Checking system information...");
   auto systemResult = checkSystem();
-  std::cout << "\n"
-            << Color::BOLD << "System Information:" << Color::RESET
-            << std::endl;
+  out << "\n" << Color::BOLD << "System Information:" << Color::RESET << '\n';
   for (const auto &[key, value] : systemResult.systemInfo) {
-    std::cout << "  " << Color::CYAN << key << ": " << Color::RESET << value
-              << std::endl;
+    out << "  " << Color::CYAN << key << ": " << Color::RESET << value << '\n';
   }
 
+  Utils::printInfo("Checking DevOps tools...");
   auto toolsResult = checkTools();
-  std::cout << "\n"
-            << Color::BOLD << "DevOps Tools:" << Color::RESET << std::endl;
-  // Already printed during check
+  for (const std::string tool : TOOLS) {
+    auto it = toolsResult.systemInfo.find(tool);
+    if (it != toolsResult.systemInfo.end()) {
+      Utils::printSuccess(tool + ": " + it->second);
+    } else {
+      Utils::printWarning(tool + " not found");
+    }
+  }
+  out << "\n" << Color::BOLD << "DevOps Tools:" << Color::RESET << '\n';
 
+  Utils::printInfo("Checking environment variables...");
   auto envResult = checkEnvironment();
+  for (const std::string var : ENV_VARS) {
+    if (std::getenv(var.c_str())) {
+      Utils::printSuccess(var + " is set");
+    }
+  }
 
   // Summary
-  std::cout << "\n" << Color::BOLD << "Summary:" << Color::RESET << std::endl;
+  out << "\n" << Color::BOLD << "Summary:" << Color::RESET << '\n';
 
   int totalWarnings = systemResult.warnings.size() +
                       toolsResult.warnings.size() + envResult.warnings.size();
@@ -121,9 +132,9 @@ void HealthChecker::printReport() {
                         " warnings");
   }
 
-  std::cout << Color::BOLD << Color::CYAN
-            << "=================================================="
-            << Color::RESET << std::endl;
+  out << Color::BOLD << Color::CYAN
+      << "==================================================" << Color::RESET
+      << '\n';
 }
 
 bool HealthChecker::checkCommand(const std::string &command) {
@@ -133,6 +144,7 @@ bool HealthChecker::checkCommand(const std::string &command) {
   std::string cmd = "command -v " + command + " >/dev/null 2>&1";
 #endif
 
+  ProfileScope scope("subprocess.which", command);
   return (system(cmd.c_str()) == 0);
 }
 
@@ -165,6 +177,7 @@ std::string HealthChecker::getCommandVersion(const std::string &command) {
     versionCmd = command + " --version 2>&1 | head -1";
   }
 
+  ProfileScope scope("subprocess.version", command);
   FILE *pipe = popen(versionCmd.c_str(), "r");
   if (!pipe) {
     return "installed";
@@ -241,6 +254,7 @@ std::string HealthChecker::getDiskInfo() {
   }
   return "Unknown";
 #else
+  ProfileScope scope("subprocess.df");
   FILE *pipe = popen("df -h / 2>/dev/null | tail -1 | awk '{print $4 \" free / "
                      "\" $2 \" total\"}'",
                      "r");
@@ -0,0 +1,1072 @@
+#include "json_scanner.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__GNUC__) || defined(__clang__))
+#define DEVOPS_JSON_X86 1
+#include <immintrin.h>
+#endif
+
+namespace devops {
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 64;
+constexpr size_t NO_ERROR = static_cast<size_t>(-1);
+
+// Per-block bitmasks; bit i describes byte i of the 64-byte block.
+struct BlockMasks {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t op;
+  uint64_t whitespace;
+  uint64_t control;
+  uint64_t nonAscii;
+};
+
+using ClassifyFn = void (*)(const unsigned char *block, BlockMasks &masks);
+
+enum CharClass : uint8_t {
+  CLASS_QUOTE = 1,
+  CLASS_BACKSLASH = 2,
+  CLASS_OP = 4,
+  CLASS_WHITESPACE = 8,
+  CLASS_CONTROL = 16,
+  CLASS_NON_ASCII = 32,
+};
+
+struct ClassTable {
+  uint8_t classes[256];
+
+  constexpr ClassTable() : classes() {
+    for (int c = 0; c < 256; c++) {
+      uint8_t cls = 0;
+      if (c == '"') {
+        cls |= CLASS_QUOTE;
+      } else if (c == '\\') {
+        cls |= CLASS_BACKSLASH;
+      } else if (c == '{' || c == '}' || c == '[' || c == ']' || c == ',' ||
+                 c == ':') {
+        cls |= CLASS_OP;
+      } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        cls |= CLASS_WHITESPACE;
+      }
+      if (c < 0x20) {
+        cls |= CLASS_CONTROL;
+      }
+      if (c >= 0x80) {
+        cls |= CLASS_NON_ASCII;
+      }
+      classes[c] = cls;
+    }
+  }
+};
+
+constexpr ClassTable CLASSES;
+
+uint8_t classOf(unsigned char c) { return CLASSES.classes[c]; }
+
+// Characters that end a number or literal token.
+bool isTokenEnd(unsigned char c) {
+  return (classOf(c) & (CLASS_QUOTE | CLASS_OP | CLASS_WHITESPACE)) != 0;
+}
+
+bool isDigit(unsigned char c) { return c >= '0' && c <= '9'; }
+
+int hexValue(unsigned char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+void classifyScalar(const unsigned char *block, BlockMasks &masks) {
+  masks = BlockMasks{};
+  for (size_t i = 0; i < BLOCK_SIZE; i++) {
+    const uint64_t bit = uint64_t{1} << i;
+    const uint8_t cls = classOf(block[i]);
+    if (cls == 0) {
+      continue;
+    }
+    masks.quote |= (cls & CLASS_QUOTE) ? bit : 0;
+    masks.backslash |= (cls & CLASS_BACKSLASH) ? bit : 0;
+    masks.op |= (cls & CLASS_OP) ? bit : 0;
+    masks.whitespace |= (cls & CLASS_WHITESPACE) ? bit : 0;
+    masks.control |= (cls & CLASS_CONTROL) ? bit : 0;
+    masks.nonAscii |= (cls & CLASS_NON_ASCII) ? bit : 0;
+  }
+}
+
+#ifdef DEVOPS_JSON_X86
+
+// SSE4.2: PCMPESTRM matches each 16-byte chunk against the operator and
+// whitespace character sets in one instruction each.
+__attribute__((target("sse4.2"))) void
+classifySse42(const unsigned char *block, BlockMasks &masks) {
+  const __m128i opSet = _mm_setr_epi8('{', '}', '[', ']', ',', ':', 0, 0, 0, 0,
+                                      0, 0, 0, 0, 0, 0);
+  const __m128i wsSet = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0,
+                                      0, 0, 0, 0, 0, 0);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i controlMax = _mm_set1_epi8(0x1F);
+  constexpr int MODE = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+
+  masks = BlockMasks{};
+  for (int chunk = 0; chunk < 4; chunk++) {
+    const __m128i v = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(block + chunk * 16));
+    const int shift = chunk * 16;
+    auto bits = [shift](int mask) {
+      return static_cast<uint64_t>(static_cast<uint16_t>(mask)) << shift;
+    };
+    masks.op |= bits(_mm_cvtsi128_si32(_mm_cmpestrm(opSet, 6, v, 16, MODE)));
+    masks.whitespace |=
+        bits(_mm_cvtsi128_si32(_mm_cmpestrm(wsSet, 4, v, 16, MODE)));
+    masks.quote |= bits(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)));
+    masks.backslash |= bits(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)));
+    // Unsigned v <= 0x1F  <=>  min(v, 0x1F) == v.
+    masks.control |=
+        bits(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, controlMax), v)));
+    masks.nonAscii |= bits(_mm_movemask_epi8(v));
+  }
+}
+
+__attribute__((target("avx2"))) uint64_t
+combineAvx2(__m256i low, __m256i high) {
+  return static_cast<uint64_t>(
+             static_cast<uint32_t>(_mm256_movemask_epi8(low))) |
+         (static_cast<uint64_t>(
+              static_cast<uint32_t>(_mm256_movemask_epi8(high)))
+          << 32);
+}
+
+__attribute__((target("avx2"))) void
+classifyAvx2(const unsigned char *block, BlockMasks &masks) {
+  const __m256i lo =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+  const __m256i hi =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  masks.quote = combineAvx2(_mm256_cmpeq_epi8(lo, quote),
+                            _mm256_cmpeq_epi8(hi, quote));
+  masks.backslash = combineAvx2(_mm256_cmpeq_epi8(lo, backslash),
+                                _mm256_cmpeq_epi8(hi, backslash));
+
+  // '[' and ']' differ from '{' and '}' only in bit 0x20, so setting that
+  // bit folds both bracket kinds onto the braces.
+  const __m256i fold = _mm256_set1_epi8(0x20);
+  const __m256i loFolded = _mm256_or_si256(lo, fold);
+  const __m256i hiFolded = _mm256_or_si256(hi, fold);
+  const __m256i openBrace = _mm256_set1_epi8('{');
+  const __m256i closeBrace = _mm256_set1_epi8('}');
+  const __m256i comma = _mm256_set1_epi8(',');
+  const __m256i colon = _mm256_set1_epi8(':');
+  const __m256i loOp = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(loFolded, openBrace),
+                      _mm256_cmpeq_epi8(loFolded, closeBrace)),
+      _mm256_or_si256(_mm256_cmpeq_epi8(lo, comma),
+                      _mm256_cmpeq_epi8(lo, colon)));
+  const __m256i hiOp = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(hiFolded, openBrace),
+                      _mm256_cmpeq_epi8(hiFolded, closeBrace)),
+      _mm256_or_si256(_mm256_cmpeq_epi8(hi, comma),
+                      _mm256_cmpeq_epi8(hi, colon)));
+  masks.op = combineAvx2(loOp, hiOp);
+
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i lf = _mm256_set1_epi8('\n');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i loWs = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(lo, space), _mm256_cmpeq_epi8(lo, tab)),
+      _mm256_or_si256(_mm256_cmpeq_epi8(lo, lf), _mm256_cmpeq_epi8(lo, cr)));
+  const __m256i hiWs = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(hi, space), _mm256_cmpeq_epi8(hi, tab)),
+      _mm256_or_si256(_mm256_cmpeq_epi8(hi, lf), _mm256_cmpeq_epi8(hi, cr)));
+  masks.whitespace = combineAvx2(loWs, hiWs);
+
+  const __m256i controlMax = _mm256_set1_epi8(0x1F);
+  masks.control = combineAvx2(
+      _mm256_cmpeq_epi8(_mm256_min_epu8(lo, controlMax), lo),
+      _mm256_cmpeq_epi8(_mm256_min_epu8(hi, controlMax), hi));
+  masks.nonAscii = combineAvx2(lo, hi);
+}
+
+#endif
+
+ClassifyFn classifierFor(JsonScanner::SimdLevel level) {
+  switch (level) {
+#ifdef DEVOPS_JSON_X86
+  case JsonScanner::SimdLevel::AVX2:
+    return classifyAvx2;
+  case JsonScanner::SimdLevel::SSE42:
+    return classifySse42;
+#endif
+  default:
+    return classifyScalar;
+  }
+}
+
+int countTrailingZeros(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#else
+  int n = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+// Bit i set when an odd number of quotes precede or sit at byte i, i.e. the
+// byte is inside a string (the opening quote included, the closing one not).
+uint64_t prefixXor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+// Marks the bytes escaped by a backslash: runs of backslashes escape the
+// following byte only when the run has odd length. `carry` is set when the
+// previous block ended in such a run.
+uint64_t findEscaped(uint64_t backslash, uint64_t &carry) {
+  constexpr uint64_t EVEN_BITS = 0x5555555555555555ULL;
+  backslash &= ~carry;
+  const uint64_t followsEscape = (backslash << 1) | carry;
+  const uint64_t oddStarts = backslash & ~EVEN_BITS & ~followsEscape;
+  uint64_t evenStartRuns = oddStarts + backslash;
+  carry = evenStartRuns < oddStarts ? 1 : 0;
+  const uint64_t invert = evenStartRuns << 1;
+  return (EVEN_BITS ^ invert) & followsEscape;
+}
+
+void appendUtf8(std::string &out, uint32_t codepoint) {
+  if (codepoint < 0x80) {
+    out += static_cast<char>(codepoint);
+  } else if (codepoint < 0x800) {
+    out += static_cast<char>(0xC0 | (codepoint >> 6));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else if (codepoint < 0x10000) {
+    out += static_cast<char>(0xE0 | (codepoint >> 12));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (codepoint >> 18));
+    out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  }
+}
+
+uint32_t readHex4(const unsigned char *p) {
+  return static_cast<uint32_t>((hexValue(p[0]) << 12) |
+                               (hexValue(p[1]) << 8) |
+                               (hexValue(p[2]) << 4) | hexValue(p[3]));
+}
+
+// Decodes the body of a string the scanner has already validated.
+std::string unescape(std::string_view raw) {
+  std::string out;
+  out.reserve(raw.size());
+  const auto *p = reinterpret_cast<const unsigned char *>(raw.data());
+  const auto *end = p + raw.size();
+  while (p < end) {
+    if (*p != '\\') {
+      out += static_cast<char>(*p++);
+      continue;
+    }
+    const unsigned char c = p[1];
+    p += 2;
+    switch (c) {
+    case 'b':
+      out += '\b';
+      break;
+    case 'f':
+      out += '\f';
+      break;
+    case 'n':
+      out += '\n';
+      break;
+    case 'r':
+      out += '\r';
+      break;
+    case 't':
+      out += '\t';
+      break;
+    case 'u': {
+      uint32_t codepoint = readHex4(p);
+      p += 4;
+      if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+        const uint32_t low = readHex4(p + 2);
+        p += 6;
+        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+      }
+      appendUtf8(out, codepoint);
+      break;
+    }
+    default:
+      out += static_cast<char>(c);
+      break;
+    }
+  }
+  return out;
+}
+
+const char *tokenName(unsigned char c) {
+  switch (c) {
+  case '{':
+    return "'{'";
+  case '}':
+    return "'}'";
+  case '[':
+    return "'['";
+  case ']':
+    return "']'";
+  case ',':
+    return "','";
+  case ':':
+    return "':'";
+  case '"':
+    return "string literal";
+  case 't':
+    return "true literal";
+  case 'f':
+    return "false literal";
+  case 'n':
+    return "null literal";
+  default:
+    return "number literal";
+  }
+}
+
+class Scanner {
+public:
+  Scanner(std::string_view input, ClassifyFn classify)
+      : data_(reinterpret_cast<const unsigned char *>(input.data())),
+        size_(input.size()), classify_(classify) {}
+
+  JsonScanResult run();
+
+private:
+  enum class Expect { Value, FirstValue, FirstKey, Key, Colon, Next };
+
+  void buildIndex();
+  void checkEscape(size_t pos);
+  void checkUtf8(size_t from, size_t limit);
+  void walkIndex();
+
+  bool scanValue(size_t i, Expect &expect);
+  bool stringEnd(size_t i, size_t &end);
+  bool lexScalar(size_t pos, size_t &end);
+  bool lexNumber(size_t pos, size_t &end);
+  bool tokenEnd(size_t i, size_t &end);
+  void unexpected(size_t i, const char *context, const char *expected);
+  void unexpectedAfterValue(size_t pos);
+  bool isNumberEnd(size_t start, size_t end) const;
+  bool overflows(size_t start, size_t end) const;
+
+  void lexError(size_t pos, const std::string &message);
+  void fail(size_t byte, const std::string &message);
+
+  const unsigned char *data_;
+  size_t size_;
+  ClassifyFn classify_;
+
+  std::vector<uint32_t> &index_ = threadIndex();
+  std::vector<char> &stack_ = threadStack();
+  bool unterminatedString_ = false;
+  size_t skipEscapesBefore_ = 0;
+
+  // Lexical errors (inside strings) are found during indexing; grammar
+  // errors while walking the index. The earlier of the two wins.
+  size_t lexErrorByte_ = NO_ERROR;
+  std::string lexErrorMessage_;
+  size_t errorByte_ = NO_ERROR;
+  std::string errorMessage_;
+  bool numberEndedAtNewline_ = false;
+  bool numberOverflow_ = false;
+
+  bool versionKey_ = false;
+  JsonScanResult result_;
+
+  // Reused across files on the same thread so steady-state validation does
+  // not allocate for the index or the nesting stack.
+  static std::vector<uint32_t> &threadIndex() {
+    thread_local std::vector<uint32_t> index;
+    return index;
+  }
+  static std::vector<char> &threadStack() {
+    thread_local std::vector<char> stack;
+    return stack;
+  }
+};
+
+JsonScanResult Scanner::run() {
+  index_.clear();
+  stack_.clear();
+
+  buildIndex();
+  walkIndex();
+
+  size_t byte = errorByte_;
+  const std::string *message = &errorMessage_;
+  if (lexErrorByte_ <= byte) {
+    byte = lexErrorByte_;
+    message = &lexErrorMessage_;
+  }
+
+  if (byte != NO_ERROR && message == &errorMessage_ && numberOverflow_) {
+    result_ = JsonScanResult{};
+    result_.valid = false;
+    result_.numberOverflow = true;
+    result_.error = *message;
+  } else if (byte != NO_ERROR) {
+    result_ = JsonScanResult{};
+    result_.valid = false;
+    result_.errorByte = byte;
+
+    // Line and column as nlohmann counts them: a newline that was the last
+    // byte read already starts the next line.
+    const size_t read = byte < size_ ? byte : size_;
+    size_t lineStart = 0;
+    result_.errorLine = 1;
+    for (size_t i = 0; i < read; i++) {
+      if (data_[i] == '\n') {
+        result_.errorLine++;
+        lineStart = i + 1;
+      }
+    }
+    result_.errorColumn = byte - lineStart;
+    if (message == &errorMessage_ && numberEndedAtNewline_) {
+      // nlohmann reads one byte past a number and puts it back; putting
+      // back a newline leaves its column counter at 0.
+      result_.errorColumn = 0;
+    }
+    result_.error = "parse error at line " + std::to_string(result_.errorLine) +
+                    ", column " + std::to_string(result_.errorColumn) + ": " +
+                    *message;
+  }
+
+  // Do not let one huge document pin memory for the rest of the run.
+  constexpr size_t MAX_RETAINED = 1 << 20;
+  if (index_.capacity() > MAX_RETAINED) {
+    std::vector<uint32_t>().swap(index_);
+  }
+  return result_;
+}
+
+void Scanner::lexError(size_t pos, const std::string &message) {
+  if (pos + 1 < lexErrorByte_) {
+    lexErrorByte_ = pos + 1;
+    lexErrorMessage_ = "syntax error - " + message;
+  }
+}
+
+void Scanner::fail(size_t byte, const std::string &message) {
+  if (errorByte_ != NO_ERROR) {
+    return;
+  }
+  errorByte_ = byte;
+  errorMessage_ = message;
+}
+
+void Scanner::buildIndex() {
+  // A leading 0xEF must start a complete UTF-8 byte order mark.
+  size_t start = 0;
+  if (size_ > 0 && data_[0] == 0xEF) {
+    static const unsigned char BOM[] = {0xEF, 0xBB, 0xBF};
+    for (start = 1; start < 3; start++) {
+      if (start >= size_ || data_[start] != BOM[start]) {
+        fail(start + 1, "syntax error while parsing value - invalid BOM; "
+                        "must be 0xEF 0xBB 0xBF if given");
+        return;
+      }
+    }
+  }
+
+  uint64_t escapeCarry = 0;
+  uint64_t inStringCarry = 0;
+  uint64_t scalarCarry = 0;
+  size_t firstNonAscii = NO_ERROR;
+  unsigned char tail[BLOCK_SIZE];
+
+  for (size_t base = start; base < size_; base += BLOCK_SIZE) {
+    const unsigned char *block = data_ + base;
+    if (size_ - base < BLOCK_SIZE) {
+      // Pad the last block with whitespace, which never adds structurals.
+      std::memset(tail, ' ', BLOCK_SIZE);
+      std::memcpy(tail, block, size_ - base);
+      block = tail;
+    }
+
+    BlockMasks masks;
+    classify_(block, masks);
+
+    const uint64_t escaped = findEscaped(masks.backslash, escapeCarry);
+    const uint64_t quotes = masks.quote & ~escaped;
+    const uint64_t inString = prefixXor(quotes) ^ inStringCarry;
+    inStringCarry = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+    const uint64_t stringBody = inString & ~quotes;
+
+    if (uint64_t bad = masks.control & stringBody) {
+      const size_t pos = base + countTrailingZeros(bad);
+      char hex[8];
+      std::snprintf(hex, sizeof(hex), "%04X", data_[pos]);
+      lexError(pos, std::string("invalid string: control character U+") + hex +
+                        " must be escaped to \\u" + hex);
+    }
+
+    for (uint64_t escapes = escaped & stringBody; escapes != 0;
+         escapes &= escapes - 1) {
+      checkEscape(base + countTrailingZeros(escapes));
+    }
+
+    if (masks.nonAscii != 0 && firstNonAscii == NO_ERROR) {
+      firstNonAscii = base;
+    }
+
+    // Scalars (numbers and literals) are runs of bytes outside strings that
+    // are not operators, whitespace or quotes; only their first byte is
+    // indexed.
+    const uint64_t scalar =
+        ~(masks.op | masks.whitespace | masks.quote) & ~inString;
+    const uint64_t scalarStart = scalar & ~((scalar << 1) | scalarCarry);
+    scalarCarry = scalar >> 63;
+
+    uint64_t structurals =
+        (masks.op & ~inString) | (quotes & inString) | scalarStart;
+    while (structurals != 0) {
+      index_.push_back(
+          static_cast<uint32_t>(base + countTrailingZeros(structurals)));
+      structurals &= structurals - 1;
+    }
+
+    // Anything after a lexical error is irrelevant: the walk below reports
+    // that error unless it fails earlier.
+    if (lexErrorByte_ != NO_ERROR) {
+      break;
+    }
+  }
+
+  unterminatedString_ = inStringCarry != 0;
+
+  if (firstNonAscii != NO_ERROR) {
+    checkUtf8(firstNonAscii,
+              lexErrorByte_ == NO_ERROR ? size_ : lexErrorByte_ - 1);
+  }
+}
+
+// `pos` is the byte after an escaping backslash inside a string.
+void Scanner::checkEscape(size_t pos) {
+  if (pos < skipEscapesBefore_ || pos >= size_) {
+    return;
+  }
+  switch (data_[pos]) {
+  case '"':
+  case '\\':
+  case '/':
+  case 'b':
+  case 'f':
+  case 'n':
+  case 'r':
+  case 't':
+    return;
+  case 'u':
+    break;
+  default:
+    lexError(pos, "invalid string: forbidden character after backslash");
+    return;
+  }
+
+  auto readCodepoint = [this](size_t at, uint32_t &codepoint) {
+    for (size_t i = 0; i < 4; i++) {
+      if (at + i >= size_ || hexValue(data_[at + i]) < 0) {
+        lexError(at + i, "invalid string: '\\u' must be followed by 4 hex "
+                         "digits");
+        return false;
+      }
+    }
+    codepoint = readHex4(data_ + at);
+    return true;
+  };
+
+  uint32_t codepoint;
+  if (!readCodepoint(pos + 1, codepoint)) {
+    return;
+  }
+  if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+    lexError(pos + 4, "invalid string: surrogate U+DC00..U+DFFF must follow "
+                      "U+D800..U+DBFF");
+    return;
+  }
+  if (codepoint < 0xD800 || codepoint > 0xDBFF) {
+    return;
+  }
+
+  const size_t next = pos + 5;
+  for (size_t i = 0; i < 2; i++) {
+    if (next + i >= size_ || data_[next + i] != "\\u"[i]) {
+      lexError(next + i, "invalid string: surrogate U+D800..U+DBFF must be "
+                         "followed by U+DC00..U+DFFF");
+      return;
+    }
+  }
+  uint32_t low;
+  if (!readCodepoint(next + 2, low)) {
+    return;
+  }
+  if (low < 0xDC00 || low > 0xDFFF) {
+    lexError(next + 5, "invalid string: surrogate U+D800..U+DBFF must be "
+                       "followed by U+DC00..U+DFFF");
+    return;
+  }
+  // The low surrogate's escape was validated here; skip it in the loop.
+  skipEscapesBefore_ = next + 6;
+}
+
+// Validates UTF-8 in [from, limit). Reports the byte at which the sequence
+// stops being well formed, as nlohmann does.
+void Scanner::checkUtf8(size_t from, size_t limit) {
+  size_t i = from;
+  while (i < limit) {
+    // ASCII fast path, eight bytes at a time.
+    if (i + 8 <= limit) {
+      uint64_t word;
+      std::memcpy(&word, data_ + i, sizeof(word));
+      if ((word & 0x8080808080808080ULL) == 0) {
+        i += 8;
+        continue;
+      }
+    }
+    const unsigned char lead = data_[i];
+    if (lead < 0x80) {
+      i++;
+      continue;
+    }
+
+    size_t length;
+    unsigned char secondMin = 0x80;
+    unsigned char secondMax = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      length = 3;
+      secondMin = lead == 0xE0 ? 0xA0 : 0x80;
+      secondMax = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      length = 4;
+      secondMin = lead == 0xF0 ? 0x90 : 0x80;
+      secondMax = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+      lexError(i, "invalid string: ill-formed UTF-8 byte");
+      return;
+    }
+
+    for (size_t k = 1; k < length; k++) {
+      const size_t at = i + k;
+      const unsigned char low = k == 1 ? secondMin : 0x80;
+      const unsigned char high = k == 1 ? secondMax : 0xBF;
+      if (at >= size_ || data_[at] < low || data_[at] > high) {
+        lexError(at, "invalid string: ill-formed UTF-8 byte");
+        return;
+      }
+    }
+    i += length;
+  }
+}
+
+bool Scanner::stringEnd(size_t i, size_t &end) {
+  // After a lexical error the index stops early, so a final string may have
+  // no closing quote in it; the lexical error is earlier and wins.
+  if (i + 1 == index_.size() &&
+      (unterminatedString_ || lexErrorByte_ != NO_ERROR)) {
+    fail(size_ + 1, "syntax error while parsing value - invalid string: "
+                    "missing closing quote");
+    return false;
+  }
+  // Only whitespace separates the closing quote from the next structural.
+  size_t close = i + 1 < index_.size() ? index_[i + 1] : size_;
+  do {
+    close--;
+  } while (data_[close] != '"');
+  end = close + 1;
+  return true;
+}
+
+// Numbers and literals are lexed the way nlohmann's lexer does it: a number
+// ends at the first byte that cannot continue it, so "1x" is the number 1
+// followed by a second (invalid) token.
+bool Scanner::lexNumber(size_t pos, size_t &end) {
+  auto invalid = [this](size_t at, const char *message) {
+    fail(at + 1,
+         std::string("syntax error while parsing value - invalid number; ") +
+             message);
+    return false;
+  };
+  auto at = [this](size_t p) -> unsigned char {
+    return p < size_ ? data_[p] : 0;
+  };
+
+  size_t p = pos;
+  if (at(p) == '-') {
+    p++;
+  }
+  if (at(p) == '0') {
+    p++;
+  } else if (isDigit(at(p))) {
+    while (isDigit(at(p))) {
+      p++;
+    }
+  } else {
+    return invalid(p, "expected digit after '-'");
+  }
+  if (at(p) == '.') {
+    p++;
+    if (!isDigit(at(p))) {
+      return invalid(p, "expected digit after '.'");
+    }
+    while (isDigit(at(p))) {
+      p++;
+    }
+  }
+  if (at(p) == 'e' || at(p) == 'E') {
+    p++;
+    if (at(p) == '+' || at(p) == '-') {
+      p++;
+    }
+    if (!isDigit(at(p))) {
+      return invalid(p, "expected digit after exponent sign");
+    }
+    while (isDigit(at(p))) {
+      p++;
+    }
+  }
+  end = p;
+  return true;
+}
+
+bool Scanner::lexScalar(size_t pos, size_t &end) {
+  const unsigned char first = data_[pos];
+  const char *literal = first == 't'   ? "true"
+                        : first == 'f' ? "false"
+                        : first == 'n' ? "null"
+                                       : nullptr;
+  if (literal == nullptr) {
+    if (first == '-' || isDigit(first)) {
+      return lexNumber(pos, end);
+    }
+    fail(pos + 1, "syntax error while parsing value - invalid literal");
+    return false;
+  }
+
+  size_t p = pos;
+  for (const char *l = literal; *l != '\0'; l++, p++) {
+    if (p >= size_ || data_[p] != static_cast<unsigned char>(*l)) {
+      fail(p + 1, "syntax error while parsing value - invalid literal");
+      return false;
+    }
+  }
+  end = p;
+  return true;
+}
+
+bool Scanner::tokenEnd(size_t i, size_t &end) {
+  const size_t pos = index_[i];
+  const unsigned char c = data_[pos];
+  if (classOf(c) & CLASS_OP) {
+    end = pos + 1;
+    return true;
+  }
+  if (c == '"') {
+    return stringEnd(i, end);
+  }
+  return lexScalar(pos, end);
+}
+
+// nlohmann converts floating-point values with strtod and rejects the ones
+// that come out infinite. Only a number with an exponent, or with more
+// digits than DBL_MAX has, can get that large.
+bool Scanner::overflows(size_t start, size_t end) const {
+  const unsigned char first = data_[start];
+  if (first != '-' && !isDigit(first)) {
+    return false;
+  }
+  const char *token = reinterpret_cast<const char *>(data_ + start);
+  const size_t length = end - start;
+  if (length < 309 && std::memchr(token, 'e', length) == nullptr &&
+      std::memchr(token, 'E', length) == nullptr) {
+    return false;
+  }
+  return std::isinf(std::strtod(std::string(token, length).c_str(), nullptr));
+}
+
+bool Scanner::isNumberEnd(size_t start, size_t end) const {
+  const unsigned char first = data_[start];
+  return (first == '-' || isDigit(first)) && end < size_ && data_[end] == '\n';
+}
+
+// Reports the token at index i where it does not fit. Like nlohmann, the
+// token is read completely first, so errors inside it take precedence.
+void Scanner::unexpected(size_t i, const char *context, const char *expected) {
+  size_t end;
+  if (!tokenEnd(i, end)) {
+    return;
+  }
+  numberEndedAtNewline_ = isNumberEnd(index_[i], end);
+  fail(end, std::string("syntax error while parsing ") + context +
+                " - unexpected " + tokenName(data_[index_[i]]) + "; " +
+                expected);
+}
+
+// A scalar value whose run of bytes continues past its token: the rest is
+// the next token, which can only be out of place after a value.
+void Scanner::unexpectedAfterValue(size_t pos) {
+  size_t end;
+  if (!lexScalar(pos, end)) {
+    return;
+  }
+  std::string message = "syntax error while parsing ";
+  if (stack_.empty()) {
+    message += "value - unexpected " + std::string(tokenName(data_[pos])) +
+               "; expected end of input";
+  } else if (stack_.back() == '{') {
+    message += "object - unexpected " + std::string(tokenName(data_[pos])) +
+               "; expected '}'";
+  } else {
+    message += "array - unexpected " + std::string(tokenName(data_[pos])) +
+               "; expected ']'";
+  }
+  numberEndedAtNewline_ = isNumberEnd(pos, end);
+  fail(end, message);
+}
+
+bool Scanner::scanValue(size_t i, Expect &expect) {
+  const size_t pos = index_[i];
+  const unsigned char c = data_[pos];
+  const bool versionValue = versionKey_;
+  versionKey_ = false;
+
+  switch (c) {
+  case '{':
+    stack_.push_back('{');
+    expect = Expect::FirstKey;
+    break;
+  case '[':
+    stack_.push_back('[');
+    expect = Expect::FirstValue;
+    break;
+  case '"': {
+    size_t end;
+    if (!stringEnd(i, end)) {
+      return false;
+    }
+    if (versionValue && lexErrorByte_ == NO_ERROR) {
+      result_.hasVersion = true;
+      result_.version = unescape(std::string_view(
+          reinterpret_cast<const char *>(data_ + pos + 1), end - pos - 2));
+    }
+    expect = Expect::Next;
+    return true;
+  }
+  case '}':
+  case ']':
+  case ',':
+  case ':':
+    unexpected(i, "value", "expected '[', '{', or literal");
+    return false;
+  default: {
+    size_t end;
+    if (!lexScalar(pos, end)) {
+      return false;
+    }
+    // Checked when the value is parsed, before the token that follows.
+    if (overflows(pos, end)) {
+      fail(end, "number overflow parsing '" +
+                    std::string(reinterpret_cast<const char *>(data_ + pos),
+                                end - pos) +
+                    "'");
+      numberOverflow_ = errorByte_ == end;
+      return false;
+    }
+    if (end < size_ && !isTokenEnd(data_[end])) {
+      unexpectedAfterValue(end);
+      return false;
+    }
+    expect = Expect::Next;
+    break;
+  }
+  }
+
+  if (versionValue) {
+    result_.hasVersion = false;
+    result_.version.clear();
+  }
+  return true;
+}
+
+void Scanner::walkIndex() {
+  Expect expect = Expect::Value;
+
+  for (size_t i = 0; i < index_.size(); i++) {
+    const size_t pos = index_[i];
+    const unsigned char c = data_[pos];
+
+    switch (expect) {
+    case Expect::FirstValue:
+      if (c == ']') {
+        stack_.pop_back();
+        expect = Expect::Next;
+        break;
+      }
+      [[fallthrough]];
+    case Expect::Value:
+      if (!scanValue(i, expect)) {
+        return;
+      }
+      break;
+
+    case Expect::FirstKey:
+      if (c == '}') {
+        if (stack_.size() == 1) {
+          result_.emptyRootObject = true;
+        }
+        stack_.pop_back();
+        expect = Expect::Next;
+        break;
+      }
+      [[fallthrough]];
+    case Expect::Key: {
+      if (c != '"') {
+        unexpected(i, "object key", "expected string literal");
+        return;
+      }
+      size_t end;
+      if (!stringEnd(i, end)) {
+        return;
+      }
+      if (stack_.size() == 1 && lexErrorByte_ == NO_ERROR) {
+        std::string_view key(reinterpret_cast<const char *>(data_ + pos + 1),
+                             end - pos - 2);
+        versionKey_ = key == "version" ||
+                      (key.find('\\') != std::string_view::npos &&
+                       unescape(key) == "version");
+      }
+      expect = Expect::Colon;
+      break;
+    }
+
+    case Expect::Colon:
+      if (c != ':') {
+        unexpected(i, "object separator", "expected ':'");
+        return;
+      }
+      expect = Expect::Value;
+      break;
+
+    case Expect::Next:
+      if (stack_.empty()) {
+        unexpected(i, "value", "expected end of input");
+        return;
+      }
+      if (c == ',') {
+        expect = stack_.back() == '{' ? Expect::Key : Expect::Value;
+      } else if (c == (stack_.back() == '{' ? '}' : ']')) {
+        stack_.pop_back();
+      } else if (stack_.back() == '{') {
+        unexpected(i, "object", "expected '}'");
+        return;
+      } else {
+        unexpected(i, "array", "expected ']'");
+        return;
+      }
+      break;
+    }
+  }
+
+  if (expect == Expect::Next && stack_.empty()) {
+    return;
+  }
+
+  std::string message;
+  switch (expect) {
+  case Expect::FirstKey:
+  case Expect::Key:
+    message = "object key - unexpected end of input; expected string literal";
+    break;
+  case Expect::Colon:
+    message = "object separator - unexpected end of input; expected ':'";
+    break;
+  case Expect::Next:
+    message = stack_.back() == '{'
+                  ? "object - unexpected end of input; expected '}'"
+                  : "array - unexpected end of input; expected ']'";
+    break;
+  default:
+    message = "value - unexpected end of input; expected '[', '{', or literal";
+    break;
+  }
+  fail(size_ + 1, "syntax error while parsing " + message);
+}
+
+} // namespace
+
+JsonScanResult JsonScanner::scan(std::string_view input) {
+  return scan(input, detectedLevel());
+}
+
+JsonScanResult JsonScanner::scan(std::string_view input, SimdLevel level) {
+  if (static_cast<int>(level) > static_cast<int>(detectedLevel())) {
+    level = detectedLevel();
+  }
+  return Scanner(input, classifierFor(level)).run();
+}
+
+JsonScanner::SimdLevel JsonScanner::detectedLevel() {
+  static const SimdLevel level = [] {
+#ifdef DEVOPS_JSON_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+      return SimdLevel::SSE42;
+    }
+#endif
+    return SimdLevel::Scalar;
+  }();
+  return level;
+}
+
+const char *JsonScanner::levelName(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::AVX2:
+    return "avx2";
+  case SimdLevel::SSE42:
+    return "sse4.2";
+  default:
+    return "scalar";
+  }
+}
+
+} // namespace devops
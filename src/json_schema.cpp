@@ -0,0 +1,944 @@
+#include "json_schema.h"
+#include "hash.h"
+#include "mapped_file.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace devops {
+
+namespace {
+
+// Bump when the serialized node table changes shape, or when compiling
+// starts to reject schemas that cached tables may come from.
+constexpr uint32_t SCHEMA_CACHE_REVISION = 4;
+constexpr int64_t NO_NODE = -1;
+
+enum TypeBits : uint8_t {
+  TYPE_NULL = 1,
+  TYPE_BOOLEAN = 2,
+  TYPE_OBJECT = 4,
+  TYPE_ARRAY = 8,
+  TYPE_NUMBER = 16,
+  TYPE_INTEGER = 32,
+  TYPE_STRING = 64,
+};
+
+uint8_t typeFromName(const std::string &name) {
+  if (name == "null") {
+    return TYPE_NULL;
+  } else if (name == "boolean") {
+    return TYPE_BOOLEAN;
+  } else if (name == "object") {
+    return TYPE_OBJECT;
+  } else if (name == "array") {
+    return TYPE_ARRAY;
+  } else if (name == "number") {
+    return TYPE_NUMBER | TYPE_INTEGER;
+  } else if (name == "integer") {
+    return TYPE_INTEGER;
+  } else if (name == "string") {
+    return TYPE_STRING;
+  }
+  throw std::runtime_error("unknown type '" + name + "'");
+}
+
+uint8_t typeOf(const json &value) {
+  switch (value.type()) {
+  case json::value_t::null:
+    return TYPE_NULL;
+  case json::value_t::boolean:
+    return TYPE_BOOLEAN;
+  case json::value_t::object:
+    return TYPE_OBJECT;
+  case json::value_t::array:
+    return TYPE_ARRAY;
+  case json::value_t::number_integer:
+  case json::value_t::number_unsigned:
+    return TYPE_NUMBER | TYPE_INTEGER;
+  case json::value_t::number_float: {
+    // Any finite double of 2^53 or more is whole; smaller ones fit in an
+    // int64_t, so the cast is only made when it is defined.
+    const double d = value.get<double>();
+    const bool whole =
+        std::isfinite(d) &&
+        (std::fabs(d) >= 9007199254740992.0 ||
+         d == static_cast<double>(static_cast<int64_t>(d)));
+    return whole ? TYPE_NUMBER | TYPE_INTEGER : TYPE_NUMBER;
+  }
+  case json::value_t::string:
+    return TYPE_STRING;
+  default:
+    return 0;
+  }
+}
+
+std::string describeTypes(uint8_t types) {
+  static const std::pair<uint8_t, const char *> NAMES[] = {
+      {TYPE_NULL, "null"},     {TYPE_BOOLEAN, "boolean"},
+      {TYPE_OBJECT, "object"}, {TYPE_ARRAY, "array"},
+      {TYPE_NUMBER, "number"}, {TYPE_INTEGER, "integer"},
+      {TYPE_STRING, "string"},
+  };
+  std::string out;
+  for (const auto &[bit, name] : NAMES) {
+    if ((types & bit) && !(bit == TYPE_INTEGER && (types & TYPE_NUMBER))) {
+      out += out.empty() ? "" : " or ";
+      out += name;
+    }
+  }
+  return out;
+}
+
+std::string instanceTypeName(const json &value) {
+  if (value.is_number_integer() || value.is_number_unsigned()) {
+    return "integer";
+  }
+  if (value.is_number_float()) {
+    return "number";
+  }
+  return value.type_name();
+}
+
+size_t utf8Length(const std::string &s) {
+  size_t length = 0;
+  for (unsigned char c : s) {
+    length += (c & 0xC0) != 0x80;
+  }
+  return length;
+}
+
+void appendPointerToken(std::string &pointer, const std::string &token) {
+  pointer += '/';
+  for (char c : token) {
+    if (c == '~') {
+      pointer += "~0";
+    } else if (c == '/') {
+      pointer += "~1";
+    } else {
+      pointer += c;
+    }
+  }
+}
+
+std::string toHex(uint64_t value) {
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx",
+                static_cast<unsigned long long>(value));
+  return buffer;
+}
+
+std::regex compilePattern(const std::string &source) {
+  try {
+    return std::regex(source, std::regex::ECMAScript | std::regex::optimize);
+  } catch (const std::regex_error &e) {
+    throw std::runtime_error("invalid pattern '" + source + "': " + e.what());
+  }
+}
+
+} // namespace
+
+struct CompiledSchema::Node {
+  bool alwaysFalse = false;
+  uint8_t types = 0; // 0 accepts every type
+
+  bool hasEnum = false;
+  std::vector<json> enumValues;
+  bool hasConst = false;
+  json constValue;
+
+  std::vector<std::string> required;
+  std::unordered_map<std::string, uint32_t> properties;
+  std::vector<std::pair<std::string, uint32_t>> patternProperties;
+  std::vector<std::regex> propertyPatterns;
+  int64_t additionalProperties = NO_NODE;
+
+  int64_t items = NO_NODE;
+  std::optional<size_t> minItems, maxItems;
+
+  std::optional<size_t> minLength, maxLength;
+  std::string pattern;
+  std::optional<std::regex> patternRegex;
+
+  std::optional<double> minimum, maximum, exclusiveMinimum, exclusiveMaximum;
+
+  std::vector<uint32_t> allOf, anyOf, oneOf;
+  int64_t notSchema = NO_NODE;
+  int64_t ref = NO_NODE;
+};
+
+// Turns the schema document into nodes. Subschemas are keyed by their JSON
+// pointer, so a `$ref` and the definition it points at share one node and
+// recursive schemas terminate.
+class CompiledSchema::Compiler {
+public:
+  Compiler(const json &root, std::vector<Node> &nodes)
+      : root_(root), nodes_(nodes) {}
+
+  // Compiles the schema at `pointer` and everything it refers to.
+  void build(const json &schema, const std::string &pointer) {
+    compile(schema, pointer);
+    rejectInPlaceCycles();
+  }
+
+  uint32_t compile(const json &schema, const std::string &pointer) {
+    auto found = byPointer_.find(pointer);
+    if (found != byPointer_.end()) {
+      return found->second;
+    }
+    const uint32_t index = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+    byPointer_.emplace(pointer, index);
+
+    // Children are compiled into a local node because compiling them grows
+    // nodes_ and would invalidate a reference into it.
+    Node node;
+    if (schema.is_boolean()) {
+      node.alwaysFalse = !schema.get<bool>();
+      nodes_[index] = std::move(node);
+      return index;
+    }
+    if (!schema.is_object()) {
+      throw std::runtime_error("schema at '" + where(pointer) +
+                               "' must be an object or a boolean");
+    }
+
+    if (auto it = schema.find("$ref"); it != schema.end()) {
+      node.ref = resolveRef(*it, pointer);
+      refs_.emplace(index, std::make_pair(it->get<std::string>(), pointer));
+    }
+    if (auto it = schema.find("type"); it != schema.end()) {
+      if (it->is_string()) {
+        node.types = typeFromName(it->get<std::string>());
+      } else if (it->is_array()) {
+        for (const auto &name : *it) {
+          node.types |= typeFromName(stringIn(name, "type", pointer));
+        }
+      } else {
+        throw std::runtime_error("type at '" + where(pointer) +
+                                 "' must be a string or an array");
+      }
+    }
+    if (auto it = schema.find("enum"); it != schema.end() && it->is_array()) {
+      node.hasEnum = true;
+      node.enumValues.assign(it->begin(), it->end());
+    }
+    if (auto it = schema.find("const"); it != schema.end()) {
+      node.hasConst = true;
+      node.constValue = *it;
+    }
+    if (auto it = schema.find("required"); it != schema.end()) {
+      if (!it->is_array()) {
+        throw std::runtime_error("required at '" + where(pointer) +
+                                 "' must be an array of strings");
+      }
+      for (const auto &name : *it) {
+        node.required.push_back(stringIn(name, "required", pointer));
+      }
+    }
+    if (auto it = schema.find("properties"); it != schema.end()) {
+      for (const auto &[name, sub] : it->items()) {
+        std::string child = pointer + "/properties";
+        appendPointerToken(child, name);
+        node.properties.emplace(name, compile(sub, child));
+      }
+    }
+    if (auto it = schema.find("patternProperties"); it != schema.end()) {
+      for (const auto &[source, sub] : it->items()) {
+        std::string child = pointer + "/patternProperties";
+        appendPointerToken(child, source);
+        node.patternProperties.emplace_back(source, compile(sub, child));
+        node.propertyPatterns.push_back(compilePattern(source));
+      }
+    }
+    if (auto it = schema.find("additionalProperties"); it != schema.end()) {
+      node.additionalProperties =
+          compile(*it, pointer + "/additionalProperties");
+    }
+    if (auto it = schema.find("items"); it != schema.end()) {
+      node.items = compile(*it, pointer + "/items");
+    }
+    if (auto it = schema.find("pattern"); it != schema.end()) {
+      if (!it->is_string()) {
+        throw std::runtime_error("pattern at '" + where(pointer) +
+                                 "' must be a string");
+      }
+      node.pattern = it->get<std::string>();
+      node.patternRegex = compilePattern(node.pattern);
+    }
+    if (auto it = schema.find("not"); it != schema.end()) {
+      node.notSchema = compile(*it, pointer + "/not");
+    }
+    compileList(schema, "allOf", pointer, node.allOf);
+    compileList(schema, "anyOf", pointer, node.anyOf);
+    compileList(schema, "oneOf", pointer, node.oneOf);
+
+    readSize(schema, "minItems", pointer, node.minItems);
+    readSize(schema, "maxItems", pointer, node.maxItems);
+    readSize(schema, "minLength", pointer, node.minLength);
+    readSize(schema, "maxLength", pointer, node.maxLength);
+    readNumber(schema, "minimum", node.minimum);
+    readNumber(schema, "maximum", node.maximum);
+    readNumber(schema, "exclusiveMinimum", node.exclusiveMinimum);
+    readNumber(schema, "exclusiveMaximum", node.exclusiveMaximum);
+
+    nodes_[index] = std::move(node);
+    return index;
+  }
+
+private:
+  static std::string where(const std::string &pointer) {
+    return pointer.empty() ? "#" : "#" + pointer;
+  }
+
+  // An entry of the `keyword` array, which must be a string.
+  static std::string stringIn(const json &entry, const char *keyword,
+                              const std::string &pointer) {
+    if (!entry.is_string()) {
+      throw std::runtime_error(std::string(keyword) + " at '" +
+                               where(pointer) +
+                               "' must only list strings");
+    }
+    return entry.get<std::string>();
+  }
+
+  uint32_t resolveRef(const json &ref, const std::string &pointer) {
+    const std::string target = ref.is_string() ? ref.get<std::string>() : "";
+    if (target.empty() || target[0] != '#') {
+      throw std::runtime_error("unsupported $ref '" + target + "' at '" +
+                               where(pointer) +
+                               "': only local references are supported");
+    }
+    const std::string targetPointer = target.substr(1);
+    try {
+      const json &resolved = root_.at(json::json_pointer(targetPointer));
+      return compile(resolved, targetPointer);
+    } catch (const json::exception &) {
+      throw std::runtime_error("unresolvable $ref '" + target + "' at '" +
+                               where(pointer) + "'");
+    }
+  }
+
+  // check() applies $ref, allOf, anyOf, oneOf and not to the same value,
+  // so a cycle made of them would never end. Such a cycle always contains a
+  // $ref; that one is reported.
+  void rejectInPlaceCycles() const {
+    enum State : uint8_t { Unvisited, Active, Done };
+    std::vector<uint8_t> state(nodes_.size(), Unvisited);
+    std::vector<std::pair<uint32_t, size_t>> path; // node, next edge
+    for (uint32_t start = 0; start < nodes_.size(); start++) {
+      if (state[start] != Unvisited) {
+        continue;
+      }
+      state[start] = Active;
+      path.emplace_back(start, 0);
+      while (!path.empty()) {
+        const uint32_t index = path.back().first;
+        const std::vector<uint32_t> targets = inPlaceTargets(nodes_[index]);
+        if (path.back().second == targets.size()) {
+          state[index] = Done;
+          path.pop_back();
+          continue;
+        }
+        const uint32_t target = targets[path.back().second++];
+        if (state[target] == Active) {
+          throw cycleError(path, target);
+        }
+        if (state[target] == Unvisited) {
+          state[target] = Active;
+          path.emplace_back(target, 0);
+        }
+      }
+    }
+  }
+
+  static std::vector<uint32_t> inPlaceTargets(const Node &node) {
+    std::vector<uint32_t> targets(node.allOf);
+    targets.insert(targets.end(), node.anyOf.begin(), node.anyOf.end());
+    targets.insert(targets.end(), node.oneOf.begin(), node.oneOf.end());
+    for (int64_t target : {node.ref, node.notSchema}) {
+      if (target != NO_NODE) {
+        targets.push_back(static_cast<uint32_t>(target));
+      }
+    }
+    return targets;
+  }
+
+  // `path` ends with the edge into `target`, which is already on it.
+  std::runtime_error
+  cycleError(const std::vector<std::pair<uint32_t, size_t>> &path,
+             uint32_t target) const {
+    size_t first = path.size() - 1;
+    while (path[first].first != target) {
+      first--;
+    }
+    auto ref = refs_.end();
+    for (size_t i = first; i < path.size(); i++) {
+      const uint32_t next =
+          i + 1 < path.size() ? path[i + 1].first : target;
+      if (nodes_[path[i].first].ref == next) {
+        ref = refs_.find(path[i].first);
+        break;
+      }
+    }
+    if (ref == refs_.end()) {
+      return std::runtime_error("schema at '" + where("") +
+                                "' applies itself to the same value");
+    }
+    return std::runtime_error("$ref '" + ref->second.first + "' at '" +
+                              where(ref->second.second) +
+                              "' leads back to itself without descending "
+                              "into the value");
+  }
+
+  void compileList(const json &schema, const char *keyword,
+                   const std::string &pointer, std::vector<uint32_t> &out) {
+    auto it = schema.find(keyword);
+    if (it == schema.end()) {
+      return;
+    }
+    if (!it->is_array() || it->empty()) {
+      throw std::runtime_error(std::string(keyword) + " at '" +
+                               where(pointer) +
+                               "' must be a non-empty array");
+    }
+    for (size_t i = 0; i < it->size(); i++) {
+      out.push_back(compile((*it)[i], pointer + "/" + keyword + "/" +
+                                          std::to_string(i)));
+    }
+  }
+
+  static void readSize(const json &schema, const char *keyword,
+                       const std::string &pointer,
+                       std::optional<size_t> &out) {
+    auto it = schema.find(keyword);
+    if (it == schema.end()) {
+      return;
+    }
+    if (it->is_number_unsigned()) {
+      out = it->get<size_t>();
+      return;
+    }
+    // 2.0 is allowed; negative, fractional and huge values are not.
+    const double d = it->is_number() ? it->get<double>() : -1;
+    const double limit = std::ldexp(1.0, std::numeric_limits<size_t>::digits);
+    if (!(d >= 0 && d < limit) || std::floor(d) != d) {
+      throw std::runtime_error(std::string(keyword) + " at '" +
+                               where(pointer) +
+                               "' must be a non-negative integer");
+    }
+    out = static_cast<size_t>(d);
+  }
+
+  static void readNumber(const json &schema, const char *keyword,
+                         std::optional<double> &out) {
+    auto it = schema.find(keyword);
+    if (it != schema.end() && it->is_number()) {
+      out = it->get<double>();
+    }
+  }
+
+  const json &root_;
+  std::vector<Node> &nodes_;
+  std::unordered_map<std::string, uint32_t> byPointer_;
+  // The text and location of each node's $ref.
+  std::unordered_map<uint32_t, std::pair<std::string, std::string>> refs_;
+};
+
+CompiledSchema::CompiledSchema() = default;
+CompiledSchema::~CompiledSchema() = default;
+
+size_t CompiledSchema::nodeCount() const { return nodes_.size(); }
+
+std::shared_ptr<const CompiledSchema>
+CompiledSchema::compile(const json &schema, uint64_t hash) {
+  std::shared_ptr<CompiledSchema> compiled(new CompiledSchema());
+  Compiler(schema, compiled->nodes_).build(schema, "");
+  compiled->hash_ = hash;
+  return compiled;
+}
+
+std::shared_ptr<const CompiledSchema>
+CompiledSchema::compile(const json &document, const std::string &entry,
+                        uint64_t hash) {
+  const json *schema = nullptr;
+  try {
+    schema = &document.at(json::json_pointer(entry));
+  } catch (const json::exception &) {
+    throw std::runtime_error("no schema at '#" + entry + "'");
+  }
+  std::shared_ptr<CompiledSchema> compiled(new CompiledSchema());
+  Compiler(document, compiled->nodes_).build(*schema, entry);
+  compiled->hash_ = hash;
+  return compiled;
+}
+
+std::shared_ptr<const CompiledSchema>
+CompiledSchema::loadFile(const std::string &path,
+                         const std::string &cacheDir) {
+  MappedFile file(path);
+  const std::string_view content = file.view();
+  const uint64_t hash = Hash::xxh64(content, SCHEMA_CACHE_REVISION);
+
+  std::string cachePath;
+  if (!cacheDir.empty()) {
+    cachePath =
+        (fs::path(cacheDir) / "schemas" / (toHex(hash) + ".cbor")).string();
+    std::ifstream in(cachePath, std::ios::binary);
+    if (in.is_open()) {
+      std::stringstream buffer;
+      buffer << in.rdbuf();
+      const std::string data = buffer.str();
+      try {
+        json table = json::from_cbor(data.begin(), data.end());
+        if (table.value("revision", 0u) == SCHEMA_CACHE_REVISION) {
+          std::shared_ptr<CompiledSchema> cached = deserialize(table);
+          cached->hash_ = hash;
+          cached->loadedFromCache_ = true;
+          return cached;
+        }
+      } catch (const std::exception &) {
+        // Corrupt or foreign file: recompile and overwrite it below.
+      }
+    }
+  }
+
+  json schema;
+  try {
+    schema = json::parse(content.begin(), content.end());
+  } catch (const json::parse_error &e) {
+    throw std::runtime_error("schema " + path + " is not valid JSON: " +
+                             e.what());
+  }
+  std::shared_ptr<const CompiledSchema> compiled = compile(schema, hash);
+
+  if (!cachePath.empty()) {
+    std::error_code ec;
+    fs::create_directories(fs::path(cachePath).parent_path(), ec);
+    const std::string tempPath = cachePath + ".tmp";
+    const std::vector<uint8_t> bytes = json::to_cbor(compiled->serialize());
+    {
+      std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+      out.write(reinterpret_cast<const char *>(bytes.data()),
+                static_cast<std::streamsize>(bytes.size()));
+    }
+    fs::rename(tempPath, cachePath, ec);
+  }
+  return compiled;
+}
+
+// Serialized form: one object per node with short keys; node references
+// are indices, patterns are stored as source and recompiled on load.
+json CompiledSchema::serialize() const {
+  json nodes = json::array();
+  for (const Node &node : nodes_) {
+    json n = json::object();
+    if (node.alwaysFalse) {
+      n["false"] = true;
+    }
+    if (node.types) {
+      n["t"] = node.types;
+    }
+    if (node.hasEnum) {
+      n["enum"] = node.enumValues;
+    }
+    if (node.hasConst) {
+      n["const"] = node.constValue;
+    }
+    if (!node.required.empty()) {
+      n["req"] = node.required;
+    }
+    if (!node.properties.empty()) {
+      n["props"] = node.properties;
+    }
+    if (!node.patternProperties.empty()) {
+      n["pprops"] = node.patternProperties;
+    }
+    if (node.additionalProperties != NO_NODE) {
+      n["addl"] = node.additionalProperties;
+    }
+    if (node.items != NO_NODE) {
+      n["items"] = node.items;
+    }
+    if (node.minItems) {
+      n["minI"] = *node.minItems;
+    }
+    if (node.maxItems) {
+      n["maxI"] = *node.maxItems;
+    }
+    if (node.minLength) {
+      n["minL"] = *node.minLength;
+    }
+    if (node.maxLength) {
+      n["maxL"] = *node.maxLength;
+    }
+    if (node.patternRegex) {
+      n["pat"] = node.pattern;
+    }
+    if (node.minimum) {
+      n["min"] = *node.minimum;
+    }
+    if (node.maximum) {
+      n["max"] = *node.maximum;
+    }
+    if (node.exclusiveMinimum) {
+      n["xmin"] = *node.exclusiveMinimum;
+    }
+    if (node.exclusiveMaximum) {
+      n["xmax"] = *node.exclusiveMaximum;
+    }
+    if (!node.allOf.empty()) {
+      n["all"] = node.allOf;
+    }
+    if (!node.anyOf.empty()) {
+      n["any"] = node.anyOf;
+    }
+    if (!node.oneOf.empty()) {
+      n["one"] = node.oneOf;
+    }
+    if (node.notSchema != NO_NODE) {
+      n["not"] = node.notSchema;
+    }
+    if (node.ref != NO_NODE) {
+      n["ref"] = node.ref;
+    }
+    nodes.push_back(std::move(n));
+  }
+  return json{{"revision", SCHEMA_CACHE_REVISION}, {"nodes", std::move(nodes)}};
+}
+
+std::shared_ptr<CompiledSchema>
+CompiledSchema::deserialize(const json &table) {
+  std::shared_ptr<CompiledSchema> schema(new CompiledSchema());
+  const json &nodes = table.at("nodes");
+  const int64_t count = static_cast<int64_t>(nodes.size());
+  auto index = [count](const json &value) {
+    const int64_t i = value.get<int64_t>();
+    if (i < 0 || i >= count) {
+      throw std::runtime_error("node index out of range");
+    }
+    return i;
+  };
+
+  schema->nodes_.resize(nodes.size());
+  for (size_t i = 0; i < nodes.size(); i++) {
+    const json &n = nodes[i];
+    Node &node = schema->nodes_[i];
+    node.alwaysFalse = n.contains("false");
+    node.types = n.value("t", uint8_t{0});
+    if (auto it = n.find("enum"); it != n.end()) {
+      node.hasEnum = true;
+      node.enumValues.assign(it->begin(), it->end());
+    }
+    if (auto it = n.find("const"); it != n.end()) {
+      node.hasConst = true;
+      node.constValue = *it;
+    }
+    if (auto it = n.find("req"); it != n.end()) {
+      node.required = it->get<std::vector<std::string>>();
+    }
+    if (auto it = n.find("props"); it != n.end()) {
+      for (const auto &[name, child] : it->items()) {
+        node.properties.emplace(name, static_cast<uint32_t>(index(child)));
+      }
+    }
+    if (auto it = n.find("pprops"); it != n.end()) {
+      for (const auto &entry : *it) {
+        const std::string source = entry.at(0).get<std::string>();
+        node.patternProperties.emplace_back(
+            source, static_cast<uint32_t>(index(entry.at(1))));
+        node.propertyPatterns.push_back(compilePattern(source));
+      }
+    }
+    if (auto it = n.find("addl"); it != n.end()) {
+      node.additionalProperties = index(*it);
+    }
+    if (auto it = n.find("items"); it != n.end()) {
+      node.items = index(*it);
+    }
+    if (auto it = n.find("pat"); it != n.end()) {
+      node.pattern = it->get<std::string>();
+      node.patternRegex = compilePattern(node.pattern);
+    }
+    auto readList = [&](const char *key, std::vector<uint32_t> &out) {
+      if (auto it = n.find(key); it != n.end()) {
+        for (const auto &child : *it) {
+          out.push_back(static_cast<uint32_t>(index(child)));
+        }
+      }
+    };
+    readList("all", node.allOf);
+    readList("any", node.anyOf);
+    readList("one", node.oneOf);
+    if (auto it = n.find("not"); it != n.end()) {
+      node.notSchema = index(*it);
+    }
+    if (auto it = n.find("ref"); it != n.end()) {
+      node.ref = index(*it);
+    }
+    auto readOptional = [&](const char *key, auto &out) {
+      if (auto it = n.find(key); it != n.end()) {
+        out = it->get<typename std::decay_t<decltype(out)>::value_type>();
+      }
+    };
+    readOptional("minI", node.minItems);
+    readOptional("maxI", node.maxItems);
+    readOptional("minL", node.minLength);
+    readOptional("maxL", node.maxLength);
+    readOptional("min", node.minimum);
+    readOptional("max", node.maximum);
+    readOptional("xmin", node.exclusiveMinimum);
+    readOptional("xmax", node.exclusiveMaximum);
+  }
+  if (schema->nodes_.empty()) {
+    throw std::runtime_error("empty node table");
+  }
+  return schema;
+}
+
+bool CompiledSchema::validate(const json &instance,
+                              std::vector<SchemaViolation> &violations,
+                              size_t maxViolations) const {
+  std::string path;
+  return check(0, instance, path, &violations,
+               violations.size() + maxViolations);
+}
+
+// With `violations` null the check only answers yes or no and stops at the
+// first mismatch; anyOf, oneOf and not use that mode for their branches.
+bool CompiledSchema::check(uint32_t index, const json &instance,
+                           std::string &path,
+                           std::vector<SchemaViolation> *violations,
+                           size_t maxViolations) const {
+  const Node &node = nodes_[index];
+  bool valid = true;
+
+  auto fail = [&](std::string message) {
+    valid = false;
+    if (violations && violations->size() < maxViolations) {
+      violations->push_back({path, std::move(message)});
+    }
+    return violations == nullptr;
+  };
+
+  if (node.alwaysFalse) {
+    fail("no value is allowed here");
+    return false;
+  }
+
+  if (node.ref != NO_NODE &&
+      !check(static_cast<uint32_t>(node.ref), instance, path, violations,
+             maxViolations)) {
+    valid = false;
+    if (!violations) {
+      return false;
+    }
+  }
+
+  const uint8_t type = typeOf(instance);
+  if (node.types != 0 && (node.types & type) == 0) {
+    // Nothing below is meaningful for a value of the wrong type.
+    fail("expected " + describeTypes(node.types) + ", got " +
+         instanceTypeName(instance));
+    return false;
+  }
+
+  if (node.hasEnum) {
+    bool found = false;
+    for (const json &candidate : node.enumValues) {
+      if (candidate == instance) {
+        found = true;
+        break;
+      }
+    }
+    if (!found && fail("value " + instance.dump() + " is not one of " +
+                       json(node.enumValues).dump())) {
+      return false;
+    }
+  }
+  if (node.hasConst && node.constValue != instance &&
+      fail("value must be " + node.constValue.dump())) {
+    return false;
+  }
+
+  if (type & TYPE_OBJECT) {
+    for (const std::string &name : node.required) {
+      if (!instance.contains(name) &&
+          fail("missing required property '" + name + "'")) {
+        return false;
+      }
+    }
+
+    const bool checkMembers = !node.properties.empty() ||
+                              !node.patternProperties.empty() ||
+                              node.additionalProperties != NO_NODE;
+    if (checkMembers) {
+      for (const auto &[name, value] : instance.items()) {
+        const size_t pathLength = path.size();
+        appendPointerToken(path, name);
+        bool matched = false;
+
+        auto property = node.properties.find(name);
+        if (property != node.properties.end()) {
+          matched = true;
+          if (!check(property->second, value, path, violations,
+                     maxViolations)) {
+            valid = false;
+          }
+        }
+        for (size_t p = 0; p < node.propertyPatterns.size(); p++) {
+          if (std::regex_search(name, node.propertyPatterns[p])) {
+            matched = true;
+            if (!check(node.patternProperties[p].second, value, path,
+                       violations, maxViolations)) {
+              valid = false;
+            }
+          }
+        }
+        if (!matched && node.additionalProperties != NO_NODE) {
+          const uint32_t additional =
+              static_cast<uint32_t>(node.additionalProperties);
+          if (nodes_[additional].alwaysFalse) {
+            path.resize(pathLength);
+            fail("additional property '" + name + "' is not allowed");
+          } else if (!check(additional, value, path, violations,
+                            maxViolations)) {
+            valid = false;
+          }
+        }
+
+        path.resize(pathLength);
+        if (!valid && !violations) {
+          return false;
+        }
+      }
+    }
+  }
+
+  if (type & TYPE_ARRAY) {
+    const size_t size = instance.size();
+    if (node.minItems && size < *node.minItems &&
+        fail("expected at least " + std::to_string(*node.minItems) +
+             " items, got " + std::to_string(size))) {
+      return false;
+    }
+    if (node.maxItems && size > *node.maxItems &&
+        fail("expected at most " + std::to_string(*node.maxItems) +
+             " items, got " + std::to_string(size))) {
+      return false;
+    }
+    if (node.items != NO_NODE) {
+      for (size_t i = 0; i < size; i++) {
+        const size_t pathLength = path.size();
+        path += "/" + std::to_string(i);
+        if (!check(static_cast<uint32_t>(node.items), instance[i], path,
+                   violations, maxViolations)) {
+          valid = false;
+        }
+        path.resize(pathLength);
+        if (!valid && !violations) {
+          return false;
+        }
+      }
+    }
+  }
+
+  if (type & TYPE_STRING) {
+    const std::string &text = instance.get_ref<const std::string &>();
+    if (node.minLength || node.maxLength) {
+      const size_t length = utf8Length(text);
+      if (node.minLength && length < *node.minLength &&
+          fail("string shorter than " + std::to_string(*node.minLength) +
+               " characters")) {
+        return false;
+      }
+      if (node.maxLength && length > *node.maxLength &&
+          fail("string longer than " + std::to_string(*node.maxLength) +
+               " characters")) {
+        return false;
+      }
+    }
+    if (node.patternRegex && !std::regex_search(text, *node.patternRegex) &&
+        fail("string does not match pattern '" + node.pattern + "'")) {
+      return false;
+    }
+  }
+
+  if (type & TYPE_NUMBER) {
+    const double number = instance.get<double>();
+    if (node.minimum && number < *node.minimum &&
+        fail("value " + instance.dump() + " is less than minimum " +
+             json(*node.minimum).dump())) {
+      return false;
+    }
+    if (node.maximum && number > *node.maximum &&
+        fail("value " + instance.dump() + " is greater than maximum " +
+             json(*node.maximum).dump())) {
+      return false;
+    }
+    if (node.exclusiveMinimum && number <= *node.exclusiveMinimum &&
+        fail("value " + instance.dump() + " must be greater than " +
+             json(*node.exclusiveMinimum).dump())) {
+      return false;
+    }
+    if (node.exclusiveMaximum && number >= *node.exclusiveMaximum &&
+        fail("value " + instance.dump() + " must be less than " +
+             json(*node.exclusiveMaximum).dump())) {
+      return false;
+    }
+  }
+
+  for (uint32_t sub : node.allOf) {
+    if (!check(sub, instance, path, violations, maxViolations)) {
+      valid = false;
+      if (!violations) {
+        return false;
+      }
+    }
+  }
+  if (!node.anyOf.empty()) {
+    bool any = false;
+    for (uint32_t sub : node.anyOf) {
+      if (check(sub, instance, path, nullptr, 0)) {
+        any = true;
+        break;
+      }
+    }
+    if (!any && fail("value does not match any schema in anyOf")) {
+      return false;
+    }
+  }
+  if (!node.oneOf.empty()) {
+    size_t matches = 0;
+    for (uint32_t sub : node.oneOf) {
+      if (check(sub, instance, path, nullptr, 0) && ++matches > 1) {
+        break;
+      }
+    }
+    if (matches != 1 &&
+        fail(matches == 0 ? "value does not match any schema in oneOf"
+                          : "value matches more than one schema in oneOf")) {
+      return false;
+    }
+  }
+  if (node.notSchema != NO_NODE &&
+      check(static_cast<uint32_t>(node.notSchema), instance, path, nullptr,
+            0) &&
+      fail("value must not match the 'not' schema")) {
+    return false;
+  }
+
+  return valid;
+}
+
+} // namespace devops
@@ -0,0 +1,1007 @@
+#include "kubernetes_schemas.h"
+#include "hash.h"
+#include "json_schema.h"
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace devops {
+
+namespace {
+
+// The bundle is split into several literals to stay under compiler limits
+// on string literal length. "definitions" holds the schemas; "kinds" maps
+// apiVersion/kind to a definition ("schema": null when the kind is served
+// but not bundled) and to the minor versions that added and removed it.
+// A property carrying "x-since": N only exists from 1.N on.
+const char *const BUNDLE_PARTS[] = {
+    R"json({
+"definitions": {
+  "String": {"type": "string"},
+  "Boolean": {"type": "boolean"},
+  "Integer": {"type": "integer"},
+  "Object": {"type": "object"},
+  "ObjectList": {"type": "array", "items": {"type": "object"}},
+  "StringList": {"type": "array", "items": {"type": "string"}},
+  "StringMap": {"type": "object", "additionalProperties": {"type": "string"}},
+  "IntOrString": {"type": ["integer", "string"]},
+  "Quantity": {"type": ["string", "number"]},
+  "QuantityMap": {"type": "object",
+                  "additionalProperties": {"$ref": "#/definitions/Quantity"}},
+  "Port": {"type": "integer", "minimum": 1, "maximum": 65535},
+  "Protocol": {"enum": ["TCP", "UDP", "SCTP"]},
+
+  "ObjectMeta": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "name": {"type": "string", "maxLength": 253},
+      "generateName": {"type": "string"},
+      "namespace": {"type": "string", "maxLength": 63},
+      "selfLink": {"type": "string"},
+      "uid": {"type": "string"},
+      "resourceVersion": {"type": "string"},
+      "generation": {"type": "integer"},
+      "creationTimestamp": {"type": ["string", "null"]},
+      "deletionTimestamp": {"type": ["string", "null"]},
+      "deletionGracePeriodSeconds": {"type": "integer"},
+      "labels": {"$ref": "#/definitions/StringMap"},
+      "annotations": {"$ref": "#/definitions/StringMap"},
+      "ownerReferences": {"$ref": "#/definitions/ObjectList"},
+      "finalizers": {"$ref": "#/definitions/StringList"},
+      "managedFields": {"$ref": "#/definitions/ObjectList"}
+    }
+  },
+  "LabelSelector": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "matchLabels": {"$ref": "#/definitions/StringMap"},
+      "matchExpressions": {
+        "type": "array",
+        "items": {
+          "type": "object",
+          "additionalProperties": false,
+          "required": ["key", "operator"],
+          "properties": {
+            "key": {"type": "string"},
+            "operator": {"enum": ["In", "NotIn", "Exists", "DoesNotExist"]},
+            "values": {"$ref": "#/definitions/StringList"}
+          }
+        }
+      }
+    }
+  },
+  "LocalObjectReference": {
+    "type": "object",
+    "properties": {"name": {"type": "string"}}
+  },
+)json",
+    R"json(
+  "ContainerPort": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["containerPort"],
+    "properties": {
+      "name": {"type": "string", "maxLength": 15},
+      "containerPort": {"$ref": "#/definitions/Port"},
+      "hostPort": {"$ref": "#/definitions/Port"},
+      "hostIP": {"type": "string"},
+      "protocol": {"$ref": "#/definitions/Protocol"}
+    }
+  },
+  "EnvVar": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["name"],
+    "properties": {
+      "name": {"type": "string", "minLength": 1},
+      "value": {"type": "string"},
+      "valueFrom": {"type": "object"}
+    }
+  },
+  "ResourceRequirements": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "limits": {"$ref": "#/definitions/QuantityMap"},
+      "requests": {"$ref": "#/definitions/QuantityMap"},
+      "claims": {"$ref": "#/definitions/ObjectList", "x-since": 26}
+    }
+  },
+  "Probe": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "exec": {"type": "object"},
+      "httpGet": {
+        "type": "object",
+        "required": ["port"],
+        "properties": {
+          "path": {"type": "string"},
+          "port": {"$ref": "#/definitions/IntOrString"},
+          "host": {"type": "string"},
+          "scheme": {"enum": ["HTTP", "HTTPS"]},
+          "httpHeaders": {"$ref": "#/definitions/ObjectList"}
+        }
+      },
+      "tcpSocket": {"type": "object", "required": ["port"]},
+      "grpc": {"type": "object", "required": ["port"]},
+      "initialDelaySeconds": {"type": "integer", "minimum": 0},
+      "timeoutSeconds": {"type": "integer", "minimum": 1},
+      "periodSeconds": {"type": "integer", "minimum": 1},
+      "successThreshold": {"type": "integer", "minimum": 1},
+      "failureThreshold": {"type": "integer", "minimum": 1},
+      "terminationGracePeriodSeconds": {"type": "integer"}
+    }
+  },
+  "VolumeMount": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["name", "mountPath"],
+    "properties": {
+      "name": {"type": "string"},
+      "mountPath": {"type": "string"},
+      "readOnly": {"type": "boolean"},
+      "subPath": {"type": "string"},
+      "subPathExpr": {"type": "string"},
+      "mountPropagation": {"enum": ["None", "HostToContainer", "Bidirectional"]},
+      "recursiveReadOnly": {"type": "string", "x-since": 30}
+    }
+  },
+  "Container": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["name"],
+    "properties": {
+      "name": {"type": "string", "minLength": 1, "maxLength": 63},
+      "image": {"type": "string"},
+      "command": {"$ref": "#/definitions/StringList"},
+      "args": {"$ref": "#/definitions/StringList"},
+      "workingDir": {"type": "string"},
+      "ports": {"type": "array", "items": {"$ref": "#/definitions/ContainerPort"}},
+      "envFrom": {"$ref": "#/definitions/ObjectList"},
+      "env": {"type": "array", "items": {"$ref": "#/definitions/EnvVar"}},
+      "resources": {"$ref": "#/definitions/ResourceRequirements"},
+      "resizePolicy": {"$ref": "#/definitions/ObjectList", "x-since": 27},
+      "restartPolicy": {"enum": ["Always"], "x-since": 28},
+      "volumeMounts": {"type": "array", "items": {"$ref": "#/definitions/VolumeMount"}},
+      "volumeDevices": {"$ref": "#/definitions/ObjectList"},
+      "livenessProbe": {"$ref": "#/definitions/Probe"},
+      "readinessProbe": {"$ref": "#/definitions/Probe"},
+      "startupProbe": {"$ref": "#/definitions/Probe"},
+      "lifecycle": {"type": "object"},
+      "terminationMessagePath": {"type": "string"},
+      "terminationMessagePolicy": {"enum": ["File", "FallbackToLogsOnError"]},
+      "imagePullPolicy": {"enum": ["Always", "IfNotPresent", "Never"]},
+      "securityContext": {"type": "object"},
+      "stdin": {"type": "boolean"},
+      "stdinOnce": {"type": "boolean"},
+      "tty": {"type": "boolean"}
+    }
+  },
+  "Volume": {
+    "type": "object",
+    "required": ["name"],
+    "properties": {"name": {"type": "string", "maxLength": 63}}
+  },
+  "PodSpec": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["containers"],
+    "properties": {
+      "volumes": {"type": "array", "items": {"$ref": "#/definitions/Volume"}},
+      "initContainers": {"type": "array", "items": {"$ref": "#/definitions/Container"}},
+      "containers": {"type": "array", "minItems": 1,
+                     "items": {"$ref": "#/definitions/Container"}},
+      "ephemeralContainers": {"$ref": "#/definitions/ObjectList"},
+      "restartPolicy": {"enum": ["Always", "OnFailure", "Never"]},
+      "terminationGracePeriodSeconds": {"type": "integer", "minimum": 0},
+      "activeDeadlineSeconds": {"type": "integer", "minimum": 1},
+      "dnsPolicy": {"enum": ["ClusterFirstWithHostNet", "ClusterFirst", "Default", "None"]},
+      "nodeSelector": {"$ref": "#/definitions/StringMap"},
+      "serviceAccountName": {"type": "string"},
+      "serviceAccount": {"type": "string"},
+      "automountServiceAccountToken": {"type": "boolean"},
+      "nodeName": {"type": "string"},
+      "hostNetwork": {"type": "boolean"},
+      "hostPID": {"type": "boolean"},
+      "hostIPC": {"type": "boolean"},
+      "shareProcessNamespace": {"type": "boolean"},
+      "securityContext": {"type": "object"},
+      "imagePullSecrets": {"type": "array",
+                           "items": {"$ref": "#/definitions/LocalObjectReference"}},
+      "hostname": {"type": "string"},
+      "subdomain": {"type": "string"},
+      "affinity": {"type": "object"},
+      "schedulerName": {"type": "string"},
+      "tolerations": {"$ref": "#/definitions/ObjectList"},
+      "hostAliases": {"$ref": "#/definitions/ObjectList"},
+      "priorityClassName": {"type": "string"},
+      "priority": {"type": "integer"},
+      "dnsConfig": {"type": "object"},
+      "readinessGates": {"$ref": "#/definitions/ObjectList"},
+      "runtimeClassName": {"type": "string"},
+      "enableServiceLinks": {"type": "boolean"},
+      "preemptionPolicy": {"enum": ["PreemptLowerPriority", "Never"]},
+      "overhead": {"$ref": "#/definitions/QuantityMap"},
+      "topologySpreadConstraints": {"$ref": "#/definitions/ObjectList"},
+      "setHostnameAsFQDN": {"type": "boolean"},
+      "os": {"type": "object"},
+      "hostUsers": {"type": "boolean", "x-since": 25},
+      "schedulingGates": {"$ref": "#/definitions/ObjectList", "x-since": 26},
+      "resourceClaims": {"$ref": "#/definitions/ObjectList", "x-since": 26}
+    }
+  },
+  "PodTemplateSpec": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {"$ref": "#/definitions/PodSpec"}
+    }
+  },
+)json",
+    R"json(
+  "Pod": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {"$ref": "#/definitions/PodSpec"},
+      "status": {"type": "object"}
+    }
+  },
+  "Deployment": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["selector", "template"],
+        "properties": {
+          "replicas": {"type": "integer", "minimum": 0},
+          "selector": {"$ref": "#/definitions/LabelSelector"},
+          "template": {"$ref": "#/definitions/PodTemplateSpec"},
+          "strategy": {
+            "type": "object",
+            "additionalProperties": false,
+            "properties": {
+              "type": {"enum": ["Recreate", "RollingUpdate"]},
+              "rollingUpdate": {
+                "type": "object",
+                "additionalProperties": false,
+                "properties": {
+                  "maxUnavailable": {"$ref": "#/definitions/IntOrString"},
+                  "maxSurge": {"$ref": "#/definitions/IntOrString"}
+                }
+              }
+            }
+          },
+          "minReadySeconds": {"type": "integer", "minimum": 0},
+          "revisionHistoryLimit": {"type": "integer", "minimum": 0},
+          "paused": {"type": "boolean"},
+          "progressDeadlineSeconds": {"type": "integer", "minimum": 1}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "StatefulSet": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["selector", "template"],
+        "properties": {
+          "replicas": {"type": "integer", "minimum": 0},
+          "selector": {"$ref": "#/definitions/LabelSelector"},
+          "template": {"$ref": "#/definitions/PodTemplateSpec"},
+          "volumeClaimTemplates": {"$ref": "#/definitions/ObjectList"},
+          "serviceName": {"type": "string"},
+          "podManagementPolicy": {"enum": ["OrderedReady", "Parallel"]},
+          "updateStrategy": {"type": "object"},
+          "revisionHistoryLimit": {"type": "integer", "minimum": 0},
+          "minReadySeconds": {"type": "integer", "minimum": 0},
+          "persistentVolumeClaimRetentionPolicy": {"type": "object"},
+          "ordinals": {"type": "object", "x-since": 26}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "DaemonSet": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["selector", "template"],
+        "properties": {
+          "selector": {"$ref": "#/definitions/LabelSelector"},
+          "template": {"$ref": "#/definitions/PodTemplateSpec"},
+          "updateStrategy": {"type": "object"},
+          "minReadySeconds": {"type": "integer", "minimum": 0},
+          "revisionHistoryLimit": {"type": "integer", "minimum": 0}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "ReplicaSet": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["selector"],
+        "properties": {
+          "replicas": {"type": "integer", "minimum": 0},
+          "minReadySeconds": {"type": "integer", "minimum": 0},
+          "selector": {"$ref": "#/definitions/LabelSelector"},
+          "template": {"$ref": "#/definitions/PodTemplateSpec"}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "JobSpec": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["template"],
+    "properties": {
+      "parallelism": {"type": "integer", "minimum": 0},
+      "completions": {"type": "integer", "minimum": 0},
+      "activeDeadlineSeconds": {"type": "integer", "minimum": 1},
+      "podFailurePolicy": {"type": "object", "x-since": 25},
+      "backoffLimit": {"type": "integer", "minimum": 0},
+      "backoffLimitPerIndex": {"type": "integer", "x-since": 28},
+      "maxFailedIndexes": {"type": "integer", "x-since": 28},
+      "selector": {"$ref": "#/definitions/LabelSelector"},
+      "manualSelector": {"type": "boolean"},
+      "template": {"$ref": "#/definitions/PodTemplateSpec"},
+      "ttlSecondsAfterFinished": {"type": "integer", "minimum": 0},
+      "completionMode": {"enum": ["NonIndexed", "Indexed"]},
+      "suspend": {"type": "boolean"},
+      "podReplacementPolicy": {"enum": ["TerminatingOrFailed", "Failed"], "x-since": 28},
+      "successPolicy": {"type": "object", "x-since": 30},
+      "managedBy": {"type": "string", "x-since": 30}
+    }
+  },
+  "Job": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {"$ref": "#/definitions/JobSpec"},
+      "status": {"type": "object"}
+    }
+  },
+  "CronJob": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["schedule", "jobTemplate"],
+        "properties": {
+          "schedule": {"type": "string", "minLength": 1},
+          "timeZone": {"type": "string"},
+          "startingDeadlineSeconds": {"type": "integer", "minimum": 0},
+          "concurrencyPolicy": {"enum": ["Allow", "Forbid", "Replace"]},
+          "suspend": {"type": "boolean"},
+          "jobTemplate": {
+            "type": "object",
+            "additionalProperties": false,
+            "properties": {
+              "metadata": {"$ref": "#/definitions/ObjectMeta"},
+              "spec": {"$ref": "#/definitions/JobSpec"}
+            }
+          },
+          "successfulJobsHistoryLimit": {"type": "integer", "minimum": 0},
+          "failedJobsHistoryLimit": {"type": "integer", "minimum": 0}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+)json",
+    R"json(
+  "Service": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "properties": {
+          "ports": {
+            "type": "array",
+            "items": {
+              "type": "object",
+              "additionalProperties": false,
+              "required": ["port"],
+              "properties": {
+                "name": {"type": "string"},
+                "protocol": {"$ref": "#/definitions/Protocol"},
+                "appProtocol": {"type": "string"},
+                "port": {"$ref": "#/definitions/Port"},
+                "targetPort": {"$ref": "#/definitions/IntOrString"},
+                "nodePort": {"$ref": "#/definitions/Port"}
+              }
+            }
+          },
+          "selector": {"$ref": "#/definitions/StringMap"},
+          "clusterIP": {"type": "string"},
+          "clusterIPs": {"$ref": "#/definitions/StringList"},
+          "type": {"enum": ["ClusterIP", "NodePort", "LoadBalancer", "ExternalName"]},
+          "externalIPs": {"$ref": "#/definitions/StringList"},
+          "sessionAffinity": {"enum": ["ClientIP", "None"]},
+          "loadBalancerIP": {"type": "string"},
+          "loadBalancerSourceRanges": {"$ref": "#/definitions/StringList"},
+          "externalName": {"type": "string"},
+          "externalTrafficPolicy": {"enum": ["Cluster", "Local"]},
+          "healthCheckNodePort": {"type": "integer"},
+          "publishNotReadyAddresses": {"type": "boolean"},
+          "sessionAffinityConfig": {"type": "object"},
+          "ipFamilies": {"type": "array", "items": {"enum": ["IPv4", "IPv6"]}},
+          "ipFamilyPolicy": {"enum": ["SingleStack", "PreferDualStack", "RequireDualStack"]},
+          "allocateLoadBalancerNodePorts": {"type": "boolean"},
+          "loadBalancerClass": {"type": "string"},
+          "internalTrafficPolicy": {"enum": ["Cluster", "Local"]},
+          "trafficDistribution": {"type": "string", "x-since": 30}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "ConfigMap": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "data": {"$ref": "#/definitions/StringMap"},
+      "binaryData": {"$ref": "#/definitions/StringMap"},
+      "immutable": {"type": "boolean"}
+    }
+  },
+  "Secret": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "data": {"$ref": "#/definitions/StringMap"},
+      "stringData": {"$ref": "#/definitions/StringMap"},
+      "type": {"type": "string"},
+      "immutable": {"type": "boolean"}
+    }
+  },
+  "Namespace": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "properties": {"finalizers": {"$ref": "#/definitions/StringList"}}
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "ServiceAccount": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "secrets": {"$ref": "#/definitions/ObjectList"},
+      "imagePullSecrets": {"type": "array",
+                           "items": {"$ref": "#/definitions/LocalObjectReference"}},
+      "automountServiceAccountToken": {"type": "boolean"}
+    }
+  },
+  "PersistentVolumeClaim": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "properties": {
+          "accessModes": {
+            "type": "array",
+            "items": {"enum": ["ReadWriteOnce", "ReadOnlyMany", "ReadWriteMany",
+                               "ReadWriteOncePod"]}
+          },
+          "selector": {"$ref": "#/definitions/LabelSelector"},
+          "resources": {"$ref": "#/definitions/ResourceRequirements"},
+          "volumeName": {"type": "string"},
+          "storageClassName": {"type": "string"},
+          "volumeMode": {"enum": ["Block", "Filesystem"]},
+          "dataSource": {"type": "object"},
+          "dataSourceRef": {"type": "object"},
+          "volumeAttributesClassName": {"type": "string", "x-since": 29}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "StorageClass": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["provisioner"],
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "provisioner": {"type": "string"},
+      "parameters": {"$ref": "#/definitions/StringMap"},
+      "reclaimPolicy": {"enum": ["Delete", "Retain", "Recycle"]},
+      "mountOptions": {"$ref": "#/definitions/StringList"},
+      "allowVolumeExpansion": {"type": "boolean"},
+      "volumeBindingMode": {"enum": ["Immediate", "WaitForFirstConsumer"]},
+      "allowedTopologies": {"$ref": "#/definitions/ObjectList"}
+    }
+  },
+)json",
+    R"json(
+  "Ingress": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "properties": {
+          "ingressClassName": {"type": "string"},
+          "defaultBackend": {"$ref": "#/definitions/IngressBackend"},
+          "tls": {"$ref": "#/definitions/ObjectList"},
+          "rules": {
+            "type": "array",
+            "items": {
+              "type": "object",
+              "additionalProperties": false,
+              "properties": {
+                "host": {"type": "string"},
+                "http": {
+                  "type": "object",
+                  "additionalProperties": false,
+                  "required": ["paths"],
+                  "properties": {
+                    "paths": {
+                      "type": "array",
+                      "items": {
+                        "type": "object",
+                        "additionalProperties": false,
+                        "required": ["pathType", "backend"],
+                        "properties": {
+                          "path": {"type": "string"},
+                          "pathType": {"enum": ["Exact", "Prefix",
+                                                "ImplementationSpecific"]},
+                          "backend": {"$ref": "#/definitions/IngressBackend"}
+                        }
+                      }
+                    }
+                  }
+                }
+              }
+            }
+          }
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "IngressBackend": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "service": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["name"],
+        "properties": {
+          "name": {"type": "string"},
+          "port": {
+            "type": "object",
+            "additionalProperties": false,
+            "properties": {
+              "name": {"type": "string"},
+              "number": {"$ref": "#/definitions/Port"}
+            }
+          }
+        }
+      },
+      "resource": {"type": "object"}
+    }
+  },
+  "NetworkPolicy": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["podSelector"],
+        "properties": {
+          "podSelector": {"$ref": "#/definitions/LabelSelector"},
+          "ingress": {"$ref": "#/definitions/ObjectList"},
+          "egress": {"$ref": "#/definitions/ObjectList"},
+          "policyTypes": {"type": "array", "items": {"enum": ["Ingress", "Egress"]}}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "PodDisruptionBudget": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "properties": {
+          "minAvailable": {"$ref": "#/definitions/IntOrString"},
+          "maxUnavailable": {"$ref": "#/definitions/IntOrString"},
+          "selector": {"$ref": "#/definitions/LabelSelector"},
+          "unhealthyPodEvictionPolicy": {"enum": ["IfHealthyBudget", "AlwaysAllow"],
+                                         "x-since": 26}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "CrossVersionObjectReference": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["kind", "name"],
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "name": {"type": "string"}
+    }
+  },
+  "HorizontalPodAutoscalerV1": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["scaleTargetRef", "maxReplicas"],
+        "properties": {
+          "scaleTargetRef": {"$ref": "#/definitions/CrossVersionObjectReference"},
+          "minReplicas": {"type": "integer", "minimum": 1},
+          "maxReplicas": {"type": "integer", "minimum": 1},
+          "targetCPUUtilizationPercentage": {"type": "integer"}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+  "HorizontalPodAutoscalerV2": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "spec": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["scaleTargetRef", "maxReplicas"],
+        "properties": {
+          "scaleTargetRef": {"$ref": "#/definitions/CrossVersionObjectReference"},
+          "minReplicas": {"type": "integer", "minimum": 1},
+          "maxReplicas": {"type": "integer", "minimum": 1},
+          "metrics": {"$ref": "#/definitions/ObjectList"},
+          "behavior": {"type": "object"}
+        }
+      },
+      "status": {"type": "object"}
+    }
+  },
+)json",
+    R"json(
+  "PolicyRule": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["verbs"],
+    "properties": {
+      "verbs": {"$ref": "#/definitions/StringList"},
+      "apiGroups": {"$ref": "#/definitions/StringList"},
+      "resources": {"$ref": "#/definitions/StringList"},
+      "resourceNames": {"$ref": "#/definitions/StringList"},
+      "nonResourceURLs": {"$ref": "#/definitions/StringList"}
+    }
+  },
+  "Role": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "rules": {"type": "array", "items": {"$ref": "#/definitions/PolicyRule"}}
+    }
+  },
+  "ClusterRole": {
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "rules": {"type": "array", "items": {"$ref": "#/definitions/PolicyRule"}},
+      "aggregationRule": {"type": "object"}
+    }
+  },
+  "RoleBinding": {
+    "type": "object",
+    "additionalProperties": false,
+    "required": ["roleRef"],
+    "properties": {
+      "apiVersion": {"type": "string"},
+      "kind": {"type": "string"},
+      "metadata": {"$ref": "#/definitions/ObjectMeta"},
+      "subjects": {
+        "type": "array",
+        "items": {
+          "type": "object",
+          "additionalProperties": false,
+          "required": ["kind", "name"],
+          "properties": {
+            "kind": {"type": "string"},
+            "apiGroup": {"type": "string"},
+            "name": {"type": "string"},
+            "namespace": {"type": "string"}
+          }
+        }
+      },
+      "roleRef": {
+        "type": "object",
+        "additionalProperties": false,
+        "required": ["apiGroup", "kind", "name"],
+        "properties": {
+          "apiGroup": {"type": "string"},
+          "kind": {"type": "string"},
+          "name": {"type": "string"}
+        }
+      }
+    }
+  }
+},
+)json",
+    R"json(
+"kinds": [
+  {"apiVersion": "v1", "kind": "Pod", "schema": "Pod", "added": 0},
+  {"apiVersion": "v1", "kind": "Service", "schema": "Service", "added": 0},
+  {"apiVersion": "v1", "kind": "ConfigMap", "schema": "ConfigMap", "added": 0},
+  {"apiVersion": "v1", "kind": "Secret", "schema": "Secret", "added": 0},
+  {"apiVersion": "v1", "kind": "Namespace", "schema": "Namespace", "added": 0},
+  {"apiVersion": "v1", "kind": "ServiceAccount", "schema": "ServiceAccount", "added": 0},
+  {"apiVersion": "v1", "kind": "PersistentVolumeClaim", "schema": "PersistentVolumeClaim", "added": 0},
+  {"apiVersion": "v1", "kind": "PersistentVolume", "schema": null, "added": 0},
+  {"apiVersion": "v1", "kind": "Endpoints", "schema": null, "added": 0},
+  {"apiVersion": "v1", "kind": "LimitRange", "schema": null, "added": 0},
+  {"apiVersion": "v1", "kind": "ResourceQuota", "schema": null, "added": 0},
+  {"apiVersion": "apps/v1", "kind": "Deployment", "schema": "Deployment", "added": 9},
+  {"apiVersion": "apps/v1", "kind": "StatefulSet", "schema": "StatefulSet", "added": 9},
+  {"apiVersion": "apps/v1", "kind": "DaemonSet", "schema": "DaemonSet", "added": 9},
+  {"apiVersion": "apps/v1", "kind": "ReplicaSet", "schema": "ReplicaSet", "added": 9},
+  {"apiVersion": "apps/v1beta1", "kind": "Deployment", "schema": null, "added": 0, "removed": 16},
+  {"apiVersion": "apps/v1beta2", "kind": "Deployment", "schema": null, "added": 8, "removed": 16},
+  {"apiVersion": "extensions/v1beta1", "kind": "Deployment", "schema": null, "added": 0, "removed": 16},
+  {"apiVersion": "extensions/v1beta1", "kind": "DaemonSet", "schema": null, "added": 0, "removed": 16},
+  {"apiVersion": "extensions/v1beta1", "kind": "Ingress", "schema": null, "added": 0, "removed": 22},
+  {"apiVersion": "batch/v1", "kind": "Job", "schema": "Job", "added": 0},
+  {"apiVersion": "batch/v1", "kind": "CronJob", "schema": "CronJob", "added": 21},
+  {"apiVersion": "batch/v1beta1", "kind": "CronJob", "schema": "CronJob", "added": 8, "removed": 25},
+  {"apiVersion": "networking.k8s.io/v1", "kind": "Ingress", "schema": "Ingress", "added": 19},
+  {"apiVersion": "networking.k8s.io/v1", "kind": "IngressClass", "schema": null, "added": 19},
+  {"apiVersion": "networking.k8s.io/v1", "kind": "NetworkPolicy", "schema": "NetworkPolicy", "added": 7},
+  {"apiVersion": "networking.k8s.io/v1beta1", "kind": "Ingress", "schema": null, "added": 14, "removed": 22},
+  {"apiVersion": "policy/v1", "kind": "PodDisruptionBudget", "schema": "PodDisruptionBudget", "added": 21},
+  {"apiVersion": "policy/v1beta1", "kind": "PodDisruptionBudget", "schema": "PodDisruptionBudget", "added": 5, "removed": 25},
+  {"apiVersion": "policy/v1beta1", "kind": "PodSecurityPolicy", "schema": null, "added": 10, "removed": 25},
+  {"apiVersion": "autoscaling/v1", "kind": "HorizontalPodAutoscaler", "schema": "HorizontalPodAutoscalerV1", "added": 0},
+  {"apiVersion": "autoscaling/v2", "kind": "HorizontalPodAutoscaler", "schema": "HorizontalPodAutoscalerV2", "added": 23},
+  {"apiVersion": "autoscaling/v2beta1", "kind": "HorizontalPodAutoscaler", "schema": "HorizontalPodAutoscalerV2", "added": 8, "removed": 25},
+  {"apiVersion": "autoscaling/v2beta2", "kind": "HorizontalPodAutoscaler", "schema": "HorizontalPodAutoscalerV2", "added": 12, "removed": 26},
+  {"apiVersion": "rbac.authorization.k8s.io/v1", "kind": "Role", "schema": "Role", "added": 8},
+  {"apiVersion": "rbac.authorization.k8s.io/v1", "kind": "ClusterRole", "schema": "ClusterRole", "added": 8},
+  {"apiVersion": "rbac.authorization.k8s.io/v1", "kind": "RoleBinding", "schema": "RoleBinding", "added": 8},
+  {"apiVersion": "rbac.authorization.k8s.io/v1", "kind": "ClusterRoleBinding", "schema": "RoleBinding", "added": 8},
+  {"apiVersion": "rbac.authorization.k8s.io/v1beta1", "kind": "Role", "schema": null, "added": 6, "removed": 22},
+  {"apiVersion": "rbac.authorization.k8s.io/v1beta1", "kind": "ClusterRole", "schema": null, "added": 6, "removed": 22},
+  {"apiVersion": "rbac.authorization.k8s.io/v1beta1", "kind": "RoleBinding", "schema": null, "added": 6, "removed": 22},
+  {"apiVersion": "rbac.authorization.k8s.io/v1beta1", "kind": "ClusterRoleBinding", "schema": null, "added": 6, "removed": 22},
+  {"apiVersion": "storage.k8s.io/v1", "kind": "StorageClass", "schema": "StorageClass", "added": 6},
+  {"apiVersion": "storage.k8s.io/v1", "kind": "CSIStorageCapacity", "schema": null, "added": 24},
+  {"apiVersion": "storage.k8s.io/v1beta1", "kind": "CSIStorageCapacity", "schema": null, "added": 21, "removed": 27},
+  {"apiVersion": "flowcontrol.apiserver.k8s.io/v1beta2", "kind": "FlowSchema", "schema": null, "added": 23, "removed": 29},
+  {"apiVersion": "flowcontrol.apiserver.k8s.io/v1", "kind": "FlowSchema", "schema": null, "added": 29}
+]
+})json",
+};
+
+std::string bundleText() {
+  std::string text;
+  for (const char *part : BUNDLE_PARTS) {
+    text += part;
+  }
+  return text;
+}
+
+int parseMinor(const std::string &version) {
+  if (version.empty() || version == "latest") {
+    return KubernetesSchemas::MAX_MINOR;
+  }
+  const char *p = version.c_str();
+  if (*p == 'v') {
+    p++;
+  }
+  if (p[0] != '1' || p[1] != '.') {
+    return -1;
+  }
+  char *end = nullptr;
+  long minor = std::strtol(p + 2, &end, 10);
+  if (end == p + 2 || (*end != '\0' && *end != '.')) {
+    return -1;
+  }
+  return static_cast<int>(minor);
+}
+
+// Drops properties annotated "x-since" later than `minor`.
+void stripNewerProperties(json &schema, int minor) {
+  if (!schema.is_object()) {
+    return;
+  }
+  if (auto it = schema.find("properties"); it != schema.end()) {
+    for (auto property = it->begin(); property != it->end();) {
+      if (property->value("x-since", 0) > minor) {
+        property = it->erase(property);
+      } else {
+        ++property;
+      }
+    }
+  }
+  for (auto &[key, value] : schema.items()) {
+    if (value.is_object()) {
+      stripNewerProperties(value, minor);
+    }
+  }
+}
+
+} // namespace
+
+KubernetesSchemas::KubernetesSchemas(const std::string &version)
+    : minor_(parseMinor(version)) {
+  if (minor_ < MIN_MINOR || minor_ > MAX_MINOR) {
+    throw std::runtime_error("unsupported Kubernetes version '" + version +
+                             "' (bundled: " + supportedVersions() + ")");
+  }
+
+  const std::string text = bundleText();
+  hash_ = Hash::xxh64(text, static_cast<uint64_t>(minor_));
+
+  json bundle = json::parse(text);
+  stripNewerProperties(bundle["definitions"], minor_);
+
+  // Kinds served under several apiVersions share one compiled schema.
+  std::unordered_map<std::string, std::shared_ptr<const CompiledSchema>>
+      compiled;
+  for (const json &kind : bundle["kinds"]) {
+    Entry entry;
+    entry.added = kind.value("added", 0);
+    entry.removed = kind.value("removed", 0);
+    const bool served =
+        entry.added <= minor_ && (entry.removed == 0 || minor_ < entry.removed);
+    if (served && kind["schema"].is_string()) {
+      const std::string name = kind["schema"].get<std::string>();
+      auto &schema = compiled[name];
+      if (!schema) {
+        schema = CompiledSchema::compile(bundle, "/definitions/" + name, hash_);
+      }
+      entry.schema = schema;
+    }
+    index_.emplace(kind["apiVersion"].get<std::string>() + ' ' +
+                       kind["kind"].get<std::string>(),
+                   std::move(entry));
+  }
+}
+
+KubernetesSchemas::~KubernetesSchemas() = default;
+
+KubernetesSchemas::Match
+KubernetesSchemas::find(const std::string &apiVersion,
+                        const std::string &kind) const {
+  Match match;
+  auto it = index_.find(apiVersion + ' ' + kind);
+  if (it == index_.end()) {
+    return match;
+  }
+
+  const Entry &entry = it->second;
+  if (entry.added > minor_) {
+    match.status = Match::Status::NotServed;
+    match.reason = apiVersion + " " + kind + " is not served by Kubernetes " +
+                   version() + " (added in 1." + std::to_string(entry.added) +
+                   ")";
+  } else if (entry.removed != 0 && entry.removed <= minor_) {
+    match.status = Match::Status::NotServed;
+    match.reason = apiVersion + " " + kind + " is not served by Kubernetes " +
+                   version() + " (removed in 1." +
+                   std::to_string(entry.removed) + ")";
+  } else if (entry.schema) {
+    match.status = Match::Status::Checked;
+    match.schema = entry.schema.get();
+  } else {
+    match.status = Match::Status::Unchecked;
+  }
+  return match;
+}
+
+std::string KubernetesSchemas::version() const {
+  return "1." + std::to_string(minor_);
+}
+
+std::string KubernetesSchemas::supportedVersions() {
+  return "1." + std::to_string(MIN_MINOR) + " to 1." +
+         std::to_string(MAX_MINOR);
+}
+
+} // namespace devops
@@ -1,69 +1,323 @@
 #include "artifact_analyzer.h"
 #include "config_validator.h"
+#include "directory_walker.h"
 #include "health_checker.h"
+#include "json_schema.h"
+#include "kubernetes_schemas.h"
+#include "profiler.h"
+#include "regression_bench.h"
+#include "report.h"
 #include "utils.h"
+#include "validation_cache.h"
+#include "validation_server.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
 #include <filesystem>
-#include <iostream>
 #include <string>
 #include <vector>
 
 void printBanner() {
-  std::cout << devops::Color::BOLD << devops::Color::CYAN << R"(
+  devops::Report::out() << devops::Color::BOLD << devops::Color::CYAN << R"(
 ╔══════════════════════════════════════════════════════════════╗
 ║                    DEVOPS VALIDATOR                          ║
 ║              Multi-Platform DevOps CLI Tool                  ║
 ║                     Version 1.0.0                            ║
 ╚══════════════════════════════════════════════════════════════╝
-)" << devops::Color::RESET
-            << std::endl;
+)" << devops::Color::RESET << '\n';
 }
 
 void printUsage(const char *programName) {
-  std::cout << devops::Color::BOLD << "Usage:" << devops::Color::RESET
-            << std::endl;
-  std::cout << "  " << programName << " <command> [options]" << std::endl;
-  std::cout << std::endl;
-  std::cout << devops::Color::BOLD << "Commands:" << devops::Color::RESET
-            << std::endl;
-  std::cout
-      << "  " << devops::Color::GREEN << "validate" << devops::Color::RESET
+  std::ostream &out = devops::Report::out();
+  out << devops::Color::BOLD << "Usage:" << devops::Color::RESET << '\n';
+  out << "  " << programName << " <command> [options]" << '\n';
+  out << '\n';
+  out << devops::Color::BOLD << "Commands:" << devops::Color::RESET << '\n';
+  out << "  " << devops::Color::GREEN << "validate" << devops::Color::RESET
       << " <file|dir>    Validate configuration files (JSON/YAML/TOML/ENV)"
-      << std::endl;
-  std::cout
-      << "  " << devops::Color::GREEN << "analyze" << devops::Color::RESET
+      << '\n';
+  out << "  " << devops::Color::GREEN << "analyze" << devops::Color::RESET
       << "  <file|dir>    Analyze build artifacts (DEB/RPM/Docker/Archives)"
-      << std::endl;
-  std::cout << "  " << devops::Color::GREEN << "health" << devops::Color::RESET
-            << "              Check system and DevOps tools health"
-            << std::endl;
-  std::cout << "  " << devops::Color::GREEN << "version" << devops::Color::RESET
-            << "             Show version information" << std::endl;
-  std::cout << "  " << devops::Color::GREEN << "help" << devops::Color::RESET
-            << "                Show this help message" << std::endl;
-  std::cout << std::endl;
-  std::cout << devops::Color::BOLD << "Examples:" << devops::Color::RESET
-            << std::endl;
-  std::cout << "  " << programName << " validate config.json" << std::endl;
-  std::cout << "  " << programName << " validate /path/to/configs/"
-            << std::endl;
-  std::cout << "  " << programName << " analyze build.deb" << std::endl;
-  std::cout << "  " << programName << " analyze /path/to/artifacts/"
-            << std::endl;
-  std::cout << "  " << programName << " health" << std::endl;
-  std::cout << std::endl;
+      << '\n';
+  out << "  " << devops::Color::GREEN << "serve" << devops::Color::RESET
+      << "   --socket PATH  Keep validators warm and serve validate "
+         "requests"
+      << '\n';
+  out << "  " << devops::Color::GREEN << "bench" << devops::Color::RESET
+      << "   [dir]          Time the validators; save or compare a baseline"
+      << '\n';
+  out << "  " << devops::Color::GREEN << "health" << devops::Color::RESET
+      << "              Check system and DevOps tools health" << '\n';
+  out << "  " << devops::Color::GREEN << "version" << devops::Color::RESET
+      << "             Show version information" << '\n';
+  out << "  " << devops::Color::GREEN << "help" << devops::Color::RESET
+      << "                Show this help message" << '\n';
+  out << '\n';
+  out << devops::Color::BOLD << "Validate options:" << devops::Color::RESET
+      << '\n';
+  out << "  -j, --jobs N        Validate directories with N worker threads "
+         "(0 = all cores)"
+      << '\n';
+  out << "  --json-backend B    JSON checker: simd (default) or nlohmann"
+      << '\n';
+  out << "  --schema FILE       Also check JSON/YAML documents against a "
+         "JSON Schema"
+      << '\n';
+  out << "  --k8s-version V     Check Kubernetes manifests against the "
+         "bundled schemas for V"
+      << '\n';
+  out << "                      ("
+      << devops::KubernetesSchemas::supportedVersions() << ", or latest)"
+      << '\n';
+  out << "  --watch             Keep watching a directory and revalidate "
+         "changed files (Linux)"
+      << '\n';
+  out << "  --git-rev REV       Validate the files of a commit, read from "
+         "the object store"
+      << '\n';
+  out << "  --repo PATH         Repository for --git-rev (default: .)" << '\n';
+  out << "  --changed-since REV Only files whose content differs from REV"
+      << '\n';
+  out << "  --server PATH       Send the request to a running 'serve' "
+         "instance"
+      << '\n';
+  out << "                      (which uses its own --schema, --k8s-version "
+         "and backend)"
+      << '\n';
+  out << "  --format F          Report as human (default), jsonl, sarif or "
+         "junit"
+      << '\n';
+  out << "  --color WHEN        Colour output: auto (default), always or never"
+      << '\n';
+  out << "  --inside-archives   Also validate config files inside tar, "
+         "tar.gz and zip archives"
+      << '\n';
+  out << "  --no-ignore         Also validate files excluded by .gitignore, "
+         ".devopsignore"
+      << '\n';
+  out << "                      and the default excludes (.git, "
+         "node_modules, vendor)"
+      << '\n';
+  out << "  --no-cache          Do not read or write the validation cache"
+      << '\n';
+  out << "  --cache-dir DIR     Cache location (default "
+         ".devops-validator-cache)"
+      << '\n';
+  out << '\n';
+  out << devops::Color::BOLD << "Analyze options:" << devops::Color::RESET
+      << '\n';
+  out << "  -r, --recursive     Also analyze artifacts in subdirectories"
+      << '\n';
+  out << "  -j, --jobs N        Analyze directories with N worker threads "
+         "(0 = all cores)"
+      << '\n';
+  out << "  --max-in-flight S   Compressed bytes streamed at once, e.g. 1G "
+         "(default 256M, 0 = no limit)"
+      << '\n';
+  out << "  --no-ignore         Also analyze files excluded by ignore files "
+         "and default excludes"
+      << '\n';
+  out << '\n';
+  out << devops::Color::BOLD
+      << "Profiling options (validate, analyze, health):"
+      << devops::Color::RESET << '\n';
+  out << "  --profile           Print time per phase (walk, read, parse, "
+         "subprocess, ...)"
+      << '\n';
+  out << "  --trace FILE        Write a Chrome trace (chrome://tracing, "
+         "Perfetto) of every phase"
+      << '\n';
+  out << '\n';
+  out << devops::Color::BOLD << "Bench options:" << devops::Color::RESET
+      << '\n';
+  out << "  --save FILE         Write the results as JSON, e.g. for a release"
+      << '\n';
+  out << "  --compare FILE      Compare with saved results; exit 1 on a "
+         "regression"
+      << '\n';
+  out << "  --threshold PCT     Slowdown or allocation growth that counts as "
+         "a regression (default 5)"
+      << '\n';
+  out << "  --trials N          Repetitions of the workload (default 10)"
+      << '\n';
+  out << "  --files N           Size of the generated corpus when no dir is "
+         "given (default 600)"
+      << '\n';
+  out << '\n';
+  out << devops::Color::BOLD << "Examples:" << devops::Color::RESET << '\n';
+  out << "  " << programName << " validate config.json" << '\n';
+  out << "  " << programName << " validate /path/to/configs/" << '\n';
+  out << "  " << programName << " validate --jobs 8 /path/to/configs/" << '\n';
+  out << "  " << programName
+      << " validate --schema schema.json /path/to/configs/" << '\n';
+  out << "  " << programName << " validate --k8s-version 1.29 manifests/"
+      << '\n';
+  out << "  " << programName
+      << " validate --format sarif /path/to/configs/ > results.sarif" << '\n';
+  out << "  " << programName << " validate --watch /path/to/configs/" << '\n';
+  out << "  " << programName << " validate --inside-archives bundle.tar.gz"
+      << '\n';
+  out << "  " << programName
+      << " validate --git-rev main --changed-since origin/main" << '\n';
+  out << "  " << programName
+      << " serve --socket /tmp/devops-validator.sock --jobs 0" << '\n';
+  out << "  " << programName
+      << " validate --server /tmp/devops-validator.sock config.yaml" << '\n';
+  out << "  " << programName << " bench --save baseline.json" << '\n';
+  out << "  " << programName << " bench --compare baseline.json --threshold 10"
+      << '\n';
+  out << "  " << programName
+      << " validate --profile --trace trace.json -j 0 /path/to/configs/"
+      << '\n';
+  out << "  " << programName << " analyze build.deb" << '\n';
+  out << "  " << programName << " analyze /path/to/artifacts/" << '\n';
+  out << "  " << programName << " analyze -r -j 0 /srv/release-staging/"
+      << '\n';
+  out << "  " << programName << " health" << '\n';
+  out << '\n';
 }
 
 void printVersion() {
-  std::cout << "DevOps Validator v1.0.0" << std::endl;
-  std::cout << "Built with CMake for multi-platform deployment" << std::endl;
-  std::cout << "Supports: Linux, macOS, Windows" << std::endl;
-  std::cout << "Package formats: DEB, RPM, MSI, Homebrew, pip, npm"
-            << std::endl;
+  std::ostream &out = devops::Report::out();
+  out << "DevOps Validator v1.0.0" << '\n';
+  out << "Built with CMake for multi-platform deployment" << '\n';
+  out << "Supports: Linux, macOS, Windows" << '\n';
+  out << "Package formats: DEB, RPM, MSI, Homebrew, pip, npm" << '\n';
 }
 
+// "4096", "512K", "256M" or "2G" (binary multiples) into `bytes`.
+bool parseByteSize(const std::string &text, uint64_t &bytes) {
+  size_t digits = 0;
+  while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9') {
+    digits++;
+  }
+  if (digits == 0 || digits > 15 || digits + 1 < text.size()) {
+    return false;
+  }
+  bytes = std::stoull(text.substr(0, digits));
+  if (digits < text.size()) {
+    const std::string units = "KMG";
+    const size_t unit = units.find(static_cast<char>(
+        std::toupper(static_cast<unsigned char>(text[digits]))));
+    const unsigned shift = 10 * static_cast<unsigned>(unit + 1);
+    if (unit == std::string::npos || bytes > (UINT64_MAX >> shift)) {
+      return false;
+    }
+    bytes <<= shift;
+  }
+  return true;
+}
+
+// Sends `target` (a file, or every config file under a directory) to the
+// server and prints the results like a local run. Returns the exit status,
+// or -1 when the server cannot be reached so the caller validates locally.
+int validateWithServer(const std::string &socketPath,
+                       const std::string &target,
+                       const devops::WalkOptions &walkOptions) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  const bool directory = fs::is_directory(target, ec);
+
+  std::vector<std::string> paths;
+  if (directory) {
+    try {
+      devops::DirectoryWalker(walkOptions)
+          .walk(target, [&paths](const std::string &path) {
+            if (devops::ConfigValidator::isConfigFile(path)) {
+              paths.push_back(fs::absolute(path).string());
+            }
+          });
+    } catch (const std::exception &e) {
+      devops::Utils::printError(e.what());
+      return 1;
+    }
+    std::sort(paths.begin(), paths.end());
+  } else {
+    paths.push_back(fs::absolute(target, ec).string());
+  }
+
+  std::vector<devops::ValidationClient::FileResult> results;
+  std::string error;
+  if (!devops::ValidationClient::validate(socketPath, paths, results, error)) {
+    devops::Utils::printWarning(error + "; validating locally");
+    return -1;
+  }
+
+  size_t valid = 0;
+  for (const auto &[path, result] : results) {
+    devops::Report::fileResult(path, result, directory);
+    valid += result.valid ? 1 : 0;
+  }
+  if (directory) {
+    std::ostream &out = devops::Report::out();
+    out << "\n"
+        << devops::Color::BOLD << "=== Directory Validation Summary ==="
+        << devops::Color::RESET << '\n';
+    out << "Files checked: " << results.size() << '\n';
+    out << "Files valid: " << valid << '\n';
+    out << "Files invalid: " << (results.size() - valid) << '\n';
+  }
+  return valid == results.size() ? 0 : 1;
+}
+
+int runCommand(int argc, char *argv[]);
+
 int main(int argc, char *argv[]) {
-  printBanner();
+  // Output and profiling options are read before anything is printed.
+  // Clients of a running server skip the banner, as they run once per file
+  // from editors and hooks, and so do structured reports.
+  bool client = false;
+  bool profile = false;
+  std::string tracePath;
+  devops::ReportFormat format = devops::ReportFormat::Human;
+  devops::ColorMode color = devops::ColorMode::Auto;
+  for (int i = 2; i < argc; i++) {
+    const std::string arg = argv[i];
+    client |= std::string(argv[1]) == "validate" && arg == "--server";
+    if (arg == "--profile") {
+      profile = true;
+    } else if (arg == "--trace" && i + 1 < argc) {
+      tracePath = argv[++i];
+    } else if ((arg == "--format" || arg == "--color") && i + 1 < argc) {
+      const std::string value = argv[++i];
+      const bool known = arg == "--format"
+                             ? devops::Report::parseFormat(value, format)
+                             : devops::Report::parseColorMode(value, color);
+      if (!known) {
+        devops::Utils::printError("Invalid value for " + arg + ": " + value);
+        return 1;
+      }
+    }
+  }
+  devops::Report::configure(format, color);
+  if (!client && format == devops::ReportFormat::Human) {
+    printBanner();
+  }
 
+  if (profile || !tracePath.empty()) {
+    devops::Profiler::enable();
+  }
+  int status = runCommand(argc, argv);
+  if (profile) {
+    devops::Profiler::printSummary();
+  }
+  if (!tracePath.empty()) {
+    try {
+      devops::Profiler::writeTrace(tracePath);
+      devops::Utils::printInfo("Trace written to " + tracePath);
+    } catch (const std::exception &e) {
+      devops::Utils::printError(e.what());
+      status = 1;
+    }
+  }
+  // Commands may already have finished the report, after which nothing is
+  // flushed at exit.
+  devops::Report::flush();
+  return status;
+}
+
+int runCommand(int argc, char *argv[]) {
   if (argc < 2) {
     printUsage(argv[0]);
     return 1;
@@ -81,24 +335,253 @@ int main(int argc, char *argv[]) {
     return 0;
   }
 
-  if (command == "validate") {
-    if (argc < 3) {
+  if (command == "validate" || command == "serve") {
+    const bool serve = command == "serve";
+    devops::ConfigValidator validator;
+    unsigned jobs = 1;
+    std::string target;
+    std::string schemaPath;
+    std::string k8sVersion;
+    std::string socketPath;
+    std::string cacheDir = devops::ValidationCache::DEFAULT_DIRECTORY;
+    bool useCache = true;
+    bool stopServer = false;
+    bool watch = false;
+    std::string gitRev;
+    std::string gitSince;
+    std::string repoPath = ".";
+    devops::WalkOptions walkOptions;
+    bool insideArchives = false;
+    bool backendSet = false;
+
+    for (int i = 2; i < argc; i++) {
+      std::string arg = argv[i];
+      if (arg == "--jobs" || arg == "-j") {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        try {
+          jobs = static_cast<unsigned>(std::stoul(argv[++i]));
+          validator.setJobs(jobs);
+        } catch (const std::exception &) {
+          devops::Utils::printError("Invalid job count: " +
+                                    std::string(argv[i]));
+          return 1;
+        }
+      } else if (arg == "--json-backend") {
+        std::string backend = i + 1 < argc ? argv[++i] : "";
+        if (backend == "simd") {
+          validator.setJsonBackend(devops::JsonBackend::Simd);
+        } else if (backend == "nlohmann") {
+          validator.setJsonBackend(devops::JsonBackend::Nlohmann);
+        } else {
+          devops::Utils::printError("Unknown JSON backend: " + backend +
+                                    " (expected simd or nlohmann)");
+          return 1;
+        }
+        backendSet = true;
+      } else if (arg == "--schema") {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        schemaPath = argv[++i];
+      } else if (arg == "--k8s-version") {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        k8sVersion = argv[++i];
+      } else if ((serve && arg == "--socket") ||
+                 (!serve && arg == "--server")) {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        socketPath = argv[++i];
+      } else if (!serve && arg == "--watch") {
+        watch = true;
+      } else if (!serve && (arg == "--git-rev" || arg == "--repo" ||
+                            arg == "--changed-since")) {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--git-rev") {
+          gitRev = value;
+        } else if (arg == "--repo") {
+          repoPath = value;
+        } else {
+          gitSince = value;
+        }
+      } else if (serve && arg == "--stop") {
+        stopServer = true;
+      } else if (arg == "--format" || arg == "--color" || arg == "--trace") {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        i++; // already applied before the banner
+      } else if (arg == "--profile") {
+        // already applied before the banner
+      } else if (!serve && arg == "--inside-archives") {
+        insideArchives = true;
+        validator.setInsideArchives(true);
+      } else if (arg == "--no-ignore") {
+        walkOptions.ignoreFiles = false;
+        walkOptions.defaultExcludes = false;
+        validator.setWalkOptions(walkOptions);
+      } else if (arg == "--no-cache") {
+        useCache = false;
+      } else if (arg == "--cache-dir") {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        cacheDir = argv[++i];
+      } else if (!serve && target.empty()) {
+        target = arg;
+      } else {
+        devops::Utils::printError("Unexpected argument: " + arg);
+        return 1;
+      }
+    }
+
+    if (serve && socketPath.empty()) {
+      devops::Utils::printError("Missing --socket PATH");
+      devops::Report::out()
+          << "Usage: " << argv[0]
+          << " serve --socket PATH [--stop] [validate options]" << '\n';
+      return 1;
+    }
+    const bool gitMode = !gitRev.empty() || !gitSince.empty();
+    if (gitMode && (!target.empty() || watch || !socketPath.empty())) {
+      devops::Utils::printError("--git-rev and --changed-since take no file "
+                                "argument and cannot be combined with --watch "
+                                "or --server");
+      return 1;
+    }
+    if (watch && !serve && !socketPath.empty()) {
+      devops::Utils::printError("--watch validates locally and cannot be "
+                                "combined with --server");
+      return 1;
+    }
+    // The server validates with the options it was started with.
+    if (!serve && !socketPath.empty() &&
+        (!schemaPath.empty() || !k8sVersion.empty() || backendSet)) {
+      devops::Utils::printError("--schema, --k8s-version and --json-backend "
+                                "belong on 'serve' and cannot be combined "
+                                "with --server");
+      return 1;
+    }
+    if (insideArchives && (gitMode || watch || !socketPath.empty())) {
+      devops::Utils::printError("--inside-archives cannot be combined with "
+                                "--git-rev, --watch or --server");
+      return 1;
+    }
+    if (!serve && !gitMode && target.empty()) {
       devops::Utils::printError("Missing file or directory argument");
-      std::cout << "Usage: " << argv[0] << " validate <file|dir>" << std::endl;
+      devops::Report::out() << "Usage: " << argv[0]
+                            << " validate [--jobs N] [--no-cache] <file|dir>"
+                            << '\n';
       return 1;
     }
 
-    std::string target = argv[2];
-    devops::ConfigValidator validator;
+    if (stopServer) {
+      std::string error;
+      if (!devops::ValidationClient::shutdown(socketPath, error)) {
+        devops::Utils::printError(error);
+        return 1;
+      }
+      devops::Utils::printSuccess("Server on " + socketPath + " stopped");
+      return 0;
+    }
+
+    if (!socketPath.empty() && !serve) {
+      int status = validateWithServer(socketPath, target, walkOptions);
+      if (status >= 0) {
+        return status;
+      }
+    }
+
+    std::shared_ptr<devops::ValidationCache> cache;
+    if (useCache) {
+      cache = std::make_shared<devops::ValidationCache>(cacheDir);
+      cache->load();
+      validator.setCache(cache);
+    }
+
+    if (!schemaPath.empty()) {
+      try {
+        auto schema = devops::CompiledSchema::loadFile(
+            schemaPath, useCache ? cacheDir : std::string());
+        devops::Utils::printInfo(
+            "Schema: " + schemaPath + " (" +
+            std::to_string(schema->nodeCount()) + " nodes, " +
+            (schema->loadedFromCache() ? "loaded from cache" : "compiled") +
+            ")");
+        validator.setSchema(std::move(schema));
+      } catch (const std::exception &e) {
+        devops::Utils::printError(std::string("Invalid schema: ") + e.what());
+        return 1;
+      }
+    }
+
+    if (!k8sVersion.empty()) {
+      try {
+        auto schemas = std::make_shared<devops::KubernetesSchemas>(k8sVersion);
+        devops::Utils::printInfo("Kubernetes schemas: " + schemas->version() +
+                                 " (" + std::to_string(schemas->kindCount()) +
+                                 " kinds)");
+        validator.setKubernetesSchemas(std::move(schemas));
+      } catch (const std::exception &e) {
+        devops::Utils::printError(e.what());
+        return 1;
+      }
+    }
+
+    if (serve) {
+      try {
+        devops::ValidationServer server(validator, cache, socketPath, jobs);
+        devops::Utils::printInfo("Serving on " + socketPath);
+        devops::Report::flush();
+        server.run();
+        devops::Utils::printInfo("Server stopped");
+        return 0;
+      } catch (const std::exception &e) {
+        devops::Utils::printError(std::string("Server failed: ") + e.what());
+        return 1;
+      }
+    }
 
     try {
-      if (std::filesystem::is_directory(target)) {
-        auto result = validator.validateDirectory(target);
-        return result.valid ? 0 : 1;
+      bool valid;
+      if (gitMode) {
+        valid = validator
+                    .validateGitRevision(repoPath,
+                                         gitRev.empty() ? "HEAD" : gitRev,
+                                         gitSince)
+                    .valid;
+      } else if (watch) {
+        if (!std::filesystem::is_directory(target)) {
+          devops::Utils::printError("--watch needs a directory: " + target);
+          return 1;
+        }
+        valid = validator.watchDirectory(target).valid;
+      } else if (std::filesystem::is_directory(target)) {
+        valid = validator.validateDirectory(target).valid;
       } else {
-        auto result = validator.validateFile(target);
-        return result.valid ? 0 : 1;
+        valid = validator.validateFile(target).valid;
+      }
+
+      if (cache && !cache->save()) {
+        devops::Utils::printWarning("Could not write validation cache to " +
+                                    cache->directory());
       }
+      devops::Report::finish();
+      return valid ? 0 : 1;
     } catch (const std::exception &e) {
       devops::Utils::printError(std::string("Validation failed: ") + e.what());
       return 1;
@@ -106,15 +589,70 @@ int main(int argc, char *argv[]) {
   }
 
   if (command == "analyze") {
-    if (argc < 3) {
+    devops::ArtifactAnalyzer analyzer;
+    std::string target;
+    bool usageError = false;
+    for (int i = 2; i < argc; i++) {
+      const std::string arg = argv[i];
+      if (arg == "--format" || arg == "--color" || arg == "--trace") {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        i++; // already applied before the banner
+      } else if (arg == "--jobs" || arg == "-j" ||
+                 arg == "--max-in-flight") {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        const std::string value = argv[++i];
+        uint64_t bytes = 0;
+        if (arg == "--max-in-flight") {
+          if (!parseByteSize(value, bytes)) {
+            devops::Utils::printError("Invalid size for " + arg + ": " +
+                                      value + " (e.g. 512M or 2G)");
+            return 1;
+          }
+          analyzer.setMaxInFlightBytes(bytes);
+          continue;
+        }
+        try {
+          analyzer.setJobs(static_cast<unsigned>(std::stoul(value)));
+        } catch (const std::exception &) {
+          devops::Utils::printError("Invalid job count: " + value);
+          return 1;
+        }
+      } else if (arg == "--recursive" || arg == "-r") {
+        analyzer.setRecursive(true);
+      } else if (arg == "--no-ignore") {
+        devops::WalkOptions walkOptions;
+        walkOptions.ignoreFiles = false;
+        walkOptions.defaultExcludes = false;
+        analyzer.setWalkOptions(walkOptions);
+      } else if (arg == "--profile") {
+        // already applied before the banner
+      } else if (target.empty() && (arg.empty() || arg[0] != '-')) {
+        target = arg;
+      } else {
+        devops::Utils::printError("Unexpected argument: " + arg);
+        usageError = true;
+        break;
+      }
+    }
+    if (target.empty() && !usageError) {
       devops::Utils::printError("Missing file or directory argument");
-      std::cout << "Usage: " << argv[0] << " analyze <file|dir>" << std::endl;
+      usageError = true;
+    }
+    if (usageError) {
+      devops::Report::out()
+          << "Usage: " << argv[0]
+          << " analyze [-r] [-j N] [--max-in-flight SIZE] [--no-ignore] "
+             "<file|dir>"
+          << '\n';
       return 1;
     }
 
-    std::string target = argv[2];
-    devops::ArtifactAnalyzer analyzer;
-
     try {
       if (std::filesystem::is_directory(target)) {
         analyzer.analyzeDirectory(target);
@@ -128,6 +666,118 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if (command == "bench") {
+    std::string corpusDir;
+    std::string savePath;
+    std::string comparePath;
+    unsigned trials = devops::RegressionBench::DEFAULT_TRIALS;
+    double threshold = 5.0;
+    devops::CorpusOptions corpus;
+    corpus.files = devops::RegressionBench::DEFAULT_FILES;
+    bool filesGiven = false;
+
+    for (int i = 2; i < argc; i++) {
+      std::string arg = argv[i];
+      if (arg == "--save" || arg == "--compare" || arg == "--trials" ||
+          arg == "--threshold" || arg == "--files" || arg == "--format" ||
+          arg == "--color") {
+        if (i + 1 >= argc) {
+          devops::Utils::printError("Missing value for " + arg);
+          return 1;
+        }
+        const std::string value = argv[++i];
+        try {
+          if (arg == "--save") {
+            savePath = value;
+          } else if (arg == "--compare") {
+            comparePath = value;
+          } else if (arg == "--trials") {
+            trials = static_cast<unsigned>(std::stoul(value));
+          } else if (arg == "--threshold") {
+            threshold = std::stod(value);
+          } else if (arg == "--files") {
+            corpus.files = std::stoul(value);
+            filesGiven = true;
+          }
+        } catch (const std::exception &) {
+          devops::Utils::printError("Invalid value for " + arg + ": " + value);
+          return 1;
+        }
+      } else if (corpusDir.empty() && arg.rfind("--", 0) != 0) {
+        corpusDir = arg;
+      } else {
+        devops::Utils::printError("Unexpected argument: " + arg);
+        return 1;
+      }
+    }
+    if (trials == 0) {
+      devops::Utils::printError("--trials must be at least 1");
+      return 1;
+    }
+
+    try {
+      devops::BenchRun baseline;
+      if (!comparePath.empty()) {
+        baseline = devops::RegressionBench::load(comparePath);
+        // Compare like with like: regenerate the baseline's corpus.
+        if (corpusDir.empty() && baseline.corpusDir.empty() && !filesGiven) {
+          corpus = baseline.generated;
+        }
+        if (trials < 6 || baseline.trials < 6) {
+          devops::Utils::printWarning(
+              "Fewer than 6 trials a side: no change can be significant");
+        }
+      }
+
+      devops::Utils::printInfo("Running " + std::to_string(trials) +
+                               " trials...");
+      devops::Report::flush();
+      const devops::BenchRun run =
+          devops::RegressionBench::run(corpusDir, corpus, trials);
+      devops::RegressionBench::printRun(run);
+
+      int status = 0;
+      if (!comparePath.empty()) {
+        if (baseline.corpusDir != run.corpusDir ||
+            baseline.generated.files != run.generated.files ||
+            baseline.generated.seed != run.generated.seed) {
+          devops::Utils::printWarning(
+              "The baseline was recorded on a different corpus");
+        }
+        if (baseline.cpus != run.cpus) {
+          devops::Utils::printWarning(
+              "The baseline was recorded on a machine with " +
+              std::to_string(baseline.cpus) + " CPUs, this one has " +
+              std::to_string(run.cpus));
+        }
+        const size_t regressions = devops::RegressionBench::printComparison(
+            devops::RegressionBench::compare(baseline, run, threshold));
+        char limit[32];
+        std::snprintf(limit, sizeof(limit), "%g%%", threshold);
+        if (regressions) {
+          devops::Utils::printError(std::to_string(regressions) +
+                                    " regression(s) above " + limit +
+                                    " against " + comparePath +
+                                    " (version " + baseline.toolVersion +
+                                    ")");
+          status = 1;
+        } else {
+          devops::Utils::printSuccess(std::string("No regressions above ") +
+                                      limit);
+        }
+      }
+
+      if (!savePath.empty()) {
+        devops::RegressionBench::save(run, savePath);
+        devops::Utils::printSuccess("Saved results to " + savePath);
+      }
+      return status;
+    } catch (const std::exception &e) {
+      devops::Utils::printError(std::string("Benchmark failed: ") + e.what());
+      return 1;
+    }
+  }
+
   if (command == "health") {
     try {
       devops::HealthChecker checker;
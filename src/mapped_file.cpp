@@ -0,0 +1,156 @@
+#include "mapped_file.h"
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace devops {
+
+namespace {
+
+std::atomic<uint64_t> filesMapped{0};
+std::atomic<uint64_t> bytesMapped{0};
+std::atomic<uint64_t> filesRead{0};
+std::atomic<uint64_t> bytesCopied{0};
+
+#ifndef _WIN32
+// Closes the descriptor on every exit path; a mapping outlives its fd.
+struct FileDescriptor {
+  int fd;
+  ~FileDescriptor() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+
+std::runtime_error ioError(const std::string &what, const std::string &path) {
+  return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+#endif
+
+} // namespace
+
+MappedFile::MappedFile(const std::string &path) {
+#ifdef _WIN32
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open file: " + path);
+  }
+  size_ = static_cast<size_t>(file.tellg());
+  file.seekg(0);
+  buffer_.reset(new char[size_ == 0 ? 1 : size_]);
+  if (!file.read(buffer_.get(), static_cast<std::streamsize>(size_))) {
+    throw std::runtime_error("Failed to read file: " + path);
+  }
+  data_ = buffer_.get();
+  filesRead++;
+  bytesCopied += size_;
+#else
+  FileDescriptor file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (file.fd < 0) {
+    throw ioError("Failed to open file:", path);
+  }
+
+  struct stat info;
+  if (::fstat(file.fd, &info) != 0) {
+    throw ioError("Failed to stat file:", path);
+  }
+
+  if (S_ISREG(info.st_mode) &&
+      static_cast<size_t>(info.st_size) > SMALL_FILE_LIMIT) {
+    size_t length = static_cast<size_t>(info.st_size);
+    void *address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file.fd, 0);
+    if (address != MAP_FAILED) {
+      ::madvise(address, length, MADV_SEQUENTIAL);
+      data_ = static_cast<const char *>(address);
+      size_ = length;
+      mapped_ = true;
+      filesMapped++;
+      bytesMapped += length;
+      return;
+    }
+    // Some filesystems cannot be mapped; fall through to read().
+  }
+
+  // Regular files are read with their stat size as a hint; pipes and other
+  // special files grow the buffer until EOF.
+  size_t capacity = S_ISREG(info.st_mode)
+                        ? static_cast<size_t>(info.st_size) + 1
+                        : SMALL_FILE_LIMIT;
+  buffer_.reset(new char[capacity]);
+
+  for (;;) {
+    if (size_ == capacity) {
+      std::unique_ptr<char[]> grown(new char[capacity * 2]);
+      std::memcpy(grown.get(), buffer_.get(), size_);
+      buffer_ = std::move(grown);
+      capacity *= 2;
+    }
+
+    ssize_t count = ::read(file.fd, buffer_.get() + size_, capacity - size_);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw ioError("Failed to read file:", path);
+    }
+    if (count == 0) {
+      break;
+    }
+    size_ += static_cast<size_t>(count);
+  }
+
+  data_ = buffer_.get();
+  filesRead++;
+  bytesCopied += size_;
+#endif
+}
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mapped_(std::exchange(other.mapped_, false)),
+      buffer_(std::move(other.buffer_)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    release();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    mapped_ = std::exchange(other.mapped_, false);
+    buffer_ = std::move(other.buffer_);
+  }
+  return *this;
+}
+
+void MappedFile::release() {
+#ifndef _WIN32
+  if (mapped_) {
+    ::munmap(const_cast<char *>(data_), size_);
+  }
+#endif
+  buffer_.reset();
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = false;
+}
+
+MappedFile::Stats MappedFile::stats() {
+  return Stats{filesMapped.load(), bytesMapped.load(), filesRead.load(),
+               bytesCopied.load()};
+}
+
+} // namespace devops
@@ -0,0 +1,188 @@
+#include "profiler.h"
+#include "report.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace devops {
+
+namespace {
+
+struct Span {
+  const char *phase;
+  std::string detail;
+  uint64_t start;
+  uint64_t duration;
+};
+
+// One per thread that has recorded anything. The mutex is only ever
+// contended by printSummary() and writeTrace().
+struct ThreadLog {
+  uint32_t tid;
+  std::mutex mutex;
+  std::vector<Span> spans;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadLog>> logs;
+  uint64_t origin = 0;
+};
+
+// Never destroyed: output flushed by static destructors at exit may still
+// record spans.
+Registry &registry() {
+  static Registry *instance = new Registry();
+  return *instance;
+}
+
+ThreadLog &threadLog() {
+  // Logs belong to the registry so that spans of threads that have exited
+  // are still written.
+  thread_local ThreadLog *log = nullptr;
+  if (!log) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.logs.push_back(std::make_unique<ThreadLog>());
+    log = r.logs.back().get();
+    log->tid = static_cast<uint32_t>(r.logs.size());
+  }
+  return *log;
+}
+
+// Runs `visit` on every log with its mutex held.
+template <typename Visit> void forEachLog(Visit &&visit) {
+  Registry &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (const auto &log : r.logs) {
+    std::lock_guard<std::mutex> logLock(log->mutex);
+    visit(*log);
+  }
+}
+
+} // namespace
+
+void Profiler::enable() {
+  registry().origin = now();
+  threadLog(); // the enabling thread is track 1
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+uint64_t Profiler::now() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+void Profiler::record(const char *phase, std::string_view detail,
+                      uint64_t start, uint64_t end) {
+  ThreadLog &log = threadLog();
+  std::lock_guard<std::mutex> lock(log.mutex);
+  log.spans.push_back({phase, std::string(detail), start, end - start});
+}
+
+void Profiler::printSummary() {
+  std::map<std::string, std::vector<uint64_t>> durations;
+  forEachLog([&durations](const ThreadLog &log) {
+    for (const Span &span : log.spans) {
+      durations[span.phase].push_back(span.duration);
+    }
+  });
+
+  struct Row {
+    std::string phase;
+    size_t count;
+    uint64_t total;
+    uint64_t p50;
+    uint64_t p99;
+  };
+  std::vector<Row> rows;
+  for (auto &[phase, values] : durations) {
+    std::sort(values.begin(), values.end());
+    uint64_t total = 0;
+    for (uint64_t value : values) {
+      total += value;
+    }
+    const size_t n = values.size();
+    rows.push_back({phase, n, total, values[n / 2],
+                    values[std::min(n - 1, n * 99 / 100)]});
+  }
+  std::sort(rows.begin(), rows.end(),
+            [](const Row &a, const Row &b) { return a.total > b.total; });
+
+  std::ostream &out = Report::out();
+  out << "\n"
+      << Color::BOLD << "=== Profile ===" << Color::RESET << '\n';
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-20s %8s %12s %12s %12s", "phase",
+                "count", "total ms", "p50 us", "p99 us");
+  out << line << '\n';
+  for (const Row &row : rows) {
+    std::snprintf(line, sizeof(line), "%-20s %8zu %12.2f %12.1f %12.1f",
+                  row.phase.c_str(), row.count,
+                  static_cast<double>(row.total) / 1e6,
+                  static_cast<double>(row.p50) / 1e3,
+                  static_cast<double>(row.p99) / 1e3);
+    out << line << '\n';
+  }
+  std::snprintf(line, sizeof(line),
+                "Wall time %.2f ms; totals add up across threads and "
+                "include nested phases",
+                static_cast<double>(now() - registry().origin) / 1e6);
+  out << line << '\n';
+}
+
+void Profiler::writeTrace(const std::string &path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Cannot write trace to " + path);
+  }
+
+  // Written event by event: a large run has far too many spans to build a
+  // DOM for.
+  const uint64_t origin = registry().origin;
+  char number[64];
+  bool first = true;
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  forEachLog([&](const ThreadLog &log) {
+    out << (first ? "\n" : ",\n");
+    first = false;
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << log.tid << ",\"args\":{\"name\":\""
+        << (log.tid == 1 ? std::string("main")
+                         : "worker " + std::to_string(log.tid - 1))
+        << "\"}}";
+    for (const Span &span : log.spans) {
+      const std::string_view phase(span.phase);
+      std::snprintf(number, sizeof(number), "\"ts\":%.3f,\"dur\":%.3f",
+                    static_cast<double>(span.start - origin) / 1e3,
+                    static_cast<double>(span.duration) / 1e3);
+      out << ",\n{\"name\":\"" << phase << "\",\"cat\":\""
+          << phase.substr(0, phase.find('.')) << "\",\"ph\":\"X\","
+          << number << ",\"pid\":1,\"tid\":" << log.tid;
+      if (!span.detail.empty()) {
+        out << ",\"args\":{\"detail\":"
+            << nlohmann::json(span.detail)
+                   .dump(-1, ' ', false,
+                         nlohmann::json::error_handler_t::replace)
+            << "}";
+      }
+      out << "}";
+    }
+  });
+  out << "\n]}\n";
+  if (!out) {
+    throw std::runtime_error("Cannot write trace to " + path);
+  }
+}
+
+} // namespace devops
@@ -0,0 +1,388 @@
+#include "regression_bench.h"
+#include "allocation_counter.h"
+#include "config_validator.h"
+#include "directory_walker.h"
+#include "file_type.h"
+#include "report.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <thread>
+
+#ifndef DEVOPS_VALIDATOR_VERSION
+#define DEVOPS_VALIDATOR_VERSION "unknown"
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace devops {
+
+namespace {
+
+const char *validatorKey(FileType type) {
+  switch (type) {
+  case FileType::Json:
+    return "json";
+  case FileType::Yaml:
+    return "yaml";
+  case FileType::Toml:
+    return "toml";
+  case FileType::Env:
+    return "env";
+  default:
+    return nullptr;
+  }
+}
+
+// Keeps saved files short and diffs between them quiet.
+json rounded(const std::vector<double> &values, double scale) {
+  json out = json::array();
+  for (double value : values) {
+    out.push_back(std::round(value * scale) / scale);
+  }
+  return out;
+}
+
+} // namespace
+
+BenchRun RegressionBench::run(const std::string &corpusDir,
+                              const CorpusOptions &generated,
+                              unsigned trials) {
+  BenchRun result;
+  result.toolVersion = DEVOPS_VALIDATOR_VERSION;
+  result.trials = trials;
+  result.cpus = std::thread::hardware_concurrency();
+
+  std::string root = corpusDir;
+  std::string tempDir;
+  if (root.empty()) {
+    const auto stamp =
+        std::chrono::steady_clock::now().time_since_epoch().count();
+    tempDir = (fs::temp_directory_path() /
+               ("devops-validator-bench-" + std::to_string(stamp)))
+                  .string();
+    root = tempDir;
+    result.generated = generated;
+  } else {
+    result.corpusDir = corpusDir;
+  }
+
+  // Files are read up front so that only validation is timed.
+  struct Input {
+    std::string path;
+    std::string content;
+  };
+  std::map<std::string, std::vector<Input>> inputs;
+  try {
+    if (!tempDir.empty()) {
+      generateCorpus(tempDir, generated);
+    }
+    DirectoryWalker().walk(root, [&inputs](const std::string &path) {
+      if (const char *key = validatorKey(FileTypeDetector::fromName(path))) {
+        inputs[key].push_back({path, Utils::readFile(path)});
+      }
+    });
+  } catch (...) {
+    if (!tempDir.empty()) {
+      std::error_code ec;
+      fs::remove_all(tempDir, ec);
+    }
+    throw;
+  }
+  if (!tempDir.empty()) {
+    std::error_code ec;
+    fs::remove_all(tempDir, ec);
+  }
+  if (inputs.empty()) {
+    throw std::runtime_error("No config files to benchmark in " + root);
+  }
+
+  for (auto &[key, files] : inputs) {
+    std::sort(files.begin(), files.end(),
+              [](const Input &a, const Input &b) { return a.path < b.path; });
+    BenchSamples &samples = result.validators[key];
+    samples.files = files.size();
+    for (const Input &input : files) {
+      samples.bytes += input.content.size();
+    }
+  }
+
+  ConfigValidator validator;
+  auto validateAll = [&validator](const std::vector<Input> &files) {
+    for (const Input &input : files) {
+      try {
+        validator.checkContent(input.content, input.path);
+      } catch (const std::exception &) {
+        // A file that throws is as much a part of the workload as one
+        // that reports errors.
+      }
+    }
+  };
+
+  for (const auto &[key, files] : inputs) {
+    validateAll(files); // warm-up
+  }
+
+  // Validators take turns within each trial so that drift in machine load
+  // affects them all alike.
+  AllocationCounter::enable(true);
+  for (unsigned trial = 0; trial < trials; trial++) {
+    for (const auto &[key, files] : inputs) {
+      const uint64_t allocBefore = AllocationCounter::count();
+      const auto start = std::chrono::steady_clock::now();
+      validateAll(files);
+      const double ns = std::chrono::duration<double, std::nano>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+      const double count = static_cast<double>(files.size());
+      BenchSamples &samples = result.validators[key];
+      samples.nsPerFile.push_back(ns / count);
+      samples.allocsPerFile.push_back(
+          static_cast<double>(AllocationCounter::count() - allocBefore) /
+          count);
+    }
+  }
+  AllocationCounter::enable(false);
+  return result;
+}
+
+void RegressionBench::save(const BenchRun &run, const std::string &path) {
+  json corpus = {{"source", run.corpusDir.empty() ? "generated" : "directory"}};
+  if (run.corpusDir.empty()) {
+    corpus["files"] = run.generated.files;
+    corpus["averageBytes"] = run.generated.averageBytes;
+    corpus["invalidFraction"] = run.generated.invalidFraction;
+    corpus["seed"] = run.generated.seed;
+  } else {
+    corpus["path"] = run.corpusDir;
+  }
+
+  json validators = json::object();
+  for (const auto &[key, samples] : run.validators) {
+    validators[key] = {{"files", samples.files},
+                       {"bytes", samples.bytes},
+                       {"nsPerFile", rounded(samples.nsPerFile, 10)},
+                       {"allocsPerFile", rounded(samples.allocsPerFile, 100)}};
+  }
+
+  const json document = {{"format", "devops-validator-bench"},
+                         {"formatVersion", FORMAT_VERSION},
+                         {"toolVersion", run.toolVersion},
+                         {"corpus", corpus},
+                         {"trials", run.trials},
+                         {"cpus", run.cpus},
+                         {"validators", validators}};
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << document.dump(2) << '\n';
+  if (!out) {
+    throw std::runtime_error("Cannot write " + path);
+  }
+}
+
+BenchRun RegressionBench::load(const std::string &path) {
+  BenchRun run;
+  try {
+    const json document = json::parse(Utils::readFile(path));
+    if (document.value("format", "") != "devops-validator-bench") {
+      throw std::runtime_error(path + " is not a bench result");
+    }
+    const int version = document.at("formatVersion").get<int>();
+    if (version != FORMAT_VERSION) {
+      throw std::runtime_error(path + " has bench format version " +
+                               std::to_string(version) + ", expected " +
+                               std::to_string(FORMAT_VERSION));
+    }
+
+    run.toolVersion = document.at("toolVersion").get<std::string>();
+    run.trials = document.at("trials").get<unsigned>();
+    run.cpus = document.at("cpus").get<unsigned>();
+    const json &corpus = document.at("corpus");
+    if (corpus.at("source").get<std::string>() == "generated") {
+      run.generated.files = corpus.at("files").get<size_t>();
+      run.generated.averageBytes = corpus.at("averageBytes").get<size_t>();
+      run.generated.invalidFraction =
+          corpus.at("invalidFraction").get<double>();
+      run.generated.seed = corpus.at("seed").get<uint64_t>();
+    } else {
+      run.corpusDir = corpus.at("path").get<std::string>();
+    }
+    for (const auto &[key, value] : document.at("validators").items()) {
+      BenchSamples &samples = run.validators[key];
+      samples.files = value.at("files").get<uint64_t>();
+      samples.bytes = value.at("bytes").get<uint64_t>();
+      samples.nsPerFile = value.at("nsPerFile").get<std::vector<double>>();
+      samples.allocsPerFile =
+          value.at("allocsPerFile").get<std::vector<double>>();
+    }
+  } catch (const json::exception &e) {
+    throw std::runtime_error(path + ": " + e.what());
+  }
+  return run;
+}
+
+std::vector<BenchChange> RegressionBench::compare(const BenchRun &baseline,
+                                                  const BenchRun &current,
+                                                  double thresholdPercent) {
+  std::vector<BenchChange> changes;
+  for (const auto &[key, before] : baseline.validators) {
+    auto it = current.validators.find(key);
+    if (it == current.validators.end()) {
+      continue;
+    }
+    const BenchSamples &after = it->second;
+    const struct {
+      const char *name;
+      const std::vector<double> &before;
+      const std::vector<double> &after;
+    } metrics[] = {{"time", before.nsPerFile, after.nsPerFile},
+                   {"allocs", before.allocsPerFile, after.allocsPerFile}};
+    for (const auto &metric : metrics) {
+      if (metric.before.empty() || metric.after.empty()) {
+        continue;
+      }
+      BenchChange change;
+      change.validator = key;
+      change.metric = metric.name;
+      change.baseline = median(metric.before);
+      change.current = median(metric.after);
+      if (change.baseline > 0) {
+        change.changePercent =
+            (change.current / change.baseline - 1.0) * 100.0;
+      } else if (change.current > 0) {
+        change.changePercent = 100.0;
+      }
+      change.pValue = mannWhitneyP(metric.before, metric.after);
+      change.significant = change.pValue < SIGNIFICANCE;
+      change.regression =
+          change.significant && change.changePercent > thresholdPercent;
+      changes.push_back(change);
+    }
+  }
+  return changes;
+}
+
+void RegressionBench::printRun(const BenchRun &run) {
+  std::ostream &out = Report::out();
+  out << "\n"
+      << Color::BOLD << "=== Benchmark (" << run.trials << " trials, "
+      << (run.corpusDir.empty() ? "generated corpus" : run.corpusDir)
+      << ") ===" << Color::RESET << '\n';
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-10s %8s %10s %14s %12s", "validator",
+                "files", "KiB", "median us/file", "allocs/file");
+  out << line << '\n';
+  for (const auto &[key, samples] : run.validators) {
+    std::snprintf(line, sizeof(line), "%-10s %8llu %10.1f %14.2f %12.1f",
+                  key.c_str(), static_cast<unsigned long long>(samples.files),
+                  static_cast<double>(samples.bytes) / 1024.0,
+                  median(samples.nsPerFile) / 1000.0,
+                  median(samples.allocsPerFile));
+    out << line << '\n';
+  }
+}
+
+size_t RegressionBench::printComparison(
+    const std::vector<BenchChange> &changes) {
+  std::ostream &out = Report::out();
+  out << "\n"
+      << Color::BOLD << "=== Comparison with baseline ===" << Color::RESET
+      << '\n';
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-10s %-7s %12s %12s %9s %9s",
+                "validator", "metric", "baseline", "current", "change",
+                "p-value");
+  out << line << '\n';
+
+  size_t regressions = 0;
+  for (const BenchChange &change : changes) {
+    // Time is shown in microseconds per file.
+    const double scale = change.metric == "time" ? 1000.0 : 1.0;
+    const std::string *color = &Color::RESET;
+    const char *verdict = "";
+    if (change.regression) {
+      color = &Color::RED;
+      verdict = "regression";
+      regressions++;
+    } else if (change.significant && change.changePercent < 0) {
+      color = &Color::GREEN;
+      verdict = "faster";
+    } else if (change.significant) {
+      verdict = "within threshold";
+    }
+    std::snprintf(line, sizeof(line),
+                  "%-10s %-7s %12.2f %12.2f %+8.1f%% %9.4f  %s",
+                  change.validator.c_str(), change.metric.c_str(),
+                  change.baseline / scale, change.current / scale,
+                  change.changePercent, change.pValue, verdict);
+    out << *color << line << Color::RESET << '\n';
+  }
+  return regressions;
+}
+
+double RegressionBench::mannWhitneyP(const std::vector<double> &a,
+                                     const std::vector<double> &b) {
+  const double n1 = static_cast<double>(a.size());
+  const double n2 = static_cast<double>(b.size());
+  const double n = n1 + n2;
+  if (a.empty() || b.empty()) {
+    return 1.0;
+  }
+
+  std::vector<std::pair<double, bool>> values; // value, from `a`
+  for (double value : a) {
+    values.emplace_back(value, true);
+  }
+  for (double value : b) {
+    values.emplace_back(value, false);
+  }
+  std::sort(values.begin(), values.end());
+
+  // Tied values share the mean of their ranks.
+  double rankSumA = 0;
+  double tieTerm = 0;
+  for (size_t i = 0; i < values.size();) {
+    size_t j = i;
+    while (j < values.size() && values[j].first == values[i].first) {
+      j++;
+    }
+    const double rank = (static_cast<double>(i + j) + 1.0) / 2.0;
+    const double ties = static_cast<double>(j - i);
+    tieTerm += ties * ties * ties - ties;
+    for (size_t k = i; k < j; k++) {
+      rankSumA += values[k].second ? rank : 0;
+    }
+    i = j;
+  }
+
+  const double u = rankSumA - n1 * (n1 + 1) / 2;
+  const double mean = n1 * n2 / 2;
+  const double variance =
+      n1 * n2 / 12 * ((n + 1) - tieTerm / (n * (n - 1)));
+  if (variance <= 0) {
+    return 1.0; // every value equal
+  }
+  // With continuity correction.
+  const double z =
+      std::max(0.0, std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+  return std::erfc(z / std::sqrt(2.0));
+}
+
+double RegressionBench::median(std::vector<double> values) {
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  const size_t mid = values.size() / 2;
+  return values.size() % 2 ? values[mid]
+                           : (values[mid - 1] + values[mid]) / 2;
+}
+
+} // namespace devops
@@ -0,0 +1,626 @@
+#include "report.h"
+#include "profiler.h"
+#include "utils.h"
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <streambuf>
+
+#ifdef _WIN32
+#include <io.h>
+#define isatty _isatty
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+
+#ifndef DEVOPS_VALIDATOR_VERSION
+#define DEVOPS_VALIDATOR_VERSION "unknown"
+#endif
+
+using json = nlohmann::json;
+
+namespace devops {
+
+namespace {
+
+// A terminal still sees output promptly: callers flush at the points where
+// they would otherwise block (waiting for events, before exiting).
+constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+std::atomic<uint64_t> g_bytesWritten{0};
+std::atomic<uint64_t> g_writeNanoseconds{0};
+
+// Buffered writer for one C stream. Also the streambuf behind out(), so
+// existing `<<` formatting works unchanged.
+class Channel : public std::streambuf {
+public:
+  explicit Channel(FILE *file) : file_(file) {}
+
+  void setColor(bool color) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    color_ = color;
+  }
+
+  void append(const char *data, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    appendLocked(data, size);
+  }
+
+  void flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushLocked();
+  }
+
+protected:
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      const char ch = traits_type::to_char_type(c);
+      append(&ch, 1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char *s, std::streamsize n) override {
+    append(s, static_cast<size_t>(n));
+    return n;
+  }
+
+  int sync() override {
+    flush();
+    return 0;
+  }
+
+private:
+  void appendLocked(const char *data, size_t size) {
+    if (color_) {
+      buffer_.append(data, size);
+    } else {
+      // Drops "ESC [ ... m" sequences, which may span appends.
+      for (size_t i = 0; i < size; i++) {
+        const char c = data[i];
+        if (inEscape_) {
+          inEscape_ = c != 'm';
+        } else if (c == '\033') {
+          inEscape_ = true;
+        } else {
+          buffer_.push_back(c);
+        }
+      }
+    }
+    if (buffer_.size() >= FLUSH_BYTES) {
+      flushLocked();
+    }
+  }
+
+  void flushLocked() {
+    if (buffer_.empty()) {
+      return;
+    }
+    ProfileScope scope("output.write");
+    const auto start = std::chrono::steady_clock::now();
+    std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    std::fflush(file_);
+    g_writeNanoseconds += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+    g_bytesWritten += buffer_.size();
+    buffer_.clear();
+  }
+
+  FILE *file_;
+  std::mutex mutex_;
+  std::string buffer_;
+  bool color_ = true;
+  bool inEscape_ = false;
+};
+
+bool colorFor(ColorMode mode, FILE *file) {
+  if (mode != ColorMode::Auto) {
+    return mode == ColorMode::Always;
+  }
+  return isatty(fileno(file)) && !std::getenv("NO_COLOR");
+}
+
+struct State {
+  ReportFormat format = ReportFormat::Human;
+  Channel stdoutChannel{stdout};
+  Channel stderrChannel{stderr};
+  std::ostream stdoutStream{&stdoutChannel};
+  std::ostream stderrStream{&stderrChannel};
+
+  std::mutex mutex; // guards the fields below
+  std::vector<std::pair<std::string, ValidationResult>> records;
+  size_t files = 0;
+  size_t invalid = 0;
+  bool finished = false;
+
+  State() {
+    stdoutChannel.setColor(colorFor(ColorMode::Auto, stdout));
+    stderrChannel.setColor(colorFor(ColorMode::Auto, stderr));
+  }
+
+  ~State() { finish(); }
+
+  void finish();
+
+  Channel &textChannel() {
+    return format == ReportFormat::Human ? stdoutChannel : stderrChannel;
+  }
+};
+
+State &state() {
+  static State instance;
+  return instance;
+}
+
+void renderHuman(const std::string &path, const ValidationResult &result,
+                 bool header, std::string &out) {
+  if (header) {
+    out += "\n" + Color::BOLD + "Validating: " + path + Color::RESET + "\n";
+  }
+  for (const Diagnostic &note : result.notes) {
+    out += Color::CYAN;
+    out += "ℹ ";
+    note.appendTo(out);
+    out += Color::RESET;
+    out += '\n';
+  }
+
+  const std::string type =
+      result.fileType.empty() ? "" : result.fileType + " ";
+  if (result.valid) {
+    out += Color::GREEN + "✓ Valid " + type + "file" + Color::RESET + "\n";
+  } else {
+    out += Color::RED + "✗ Invalid " + type + "file" + Color::RESET + "\n";
+  }
+  for (const Diagnostic &error : result.errors) {
+    out += Color::RED;
+    out += "  ERROR: ";
+    error.appendTo(out);
+    out += Color::RESET;
+    out += '\n';
+  }
+  for (const Diagnostic &warning : result.warnings) {
+    out += Color::YELLOW;
+    out += "  WARNING: ";
+    warning.appendTo(out);
+    out += Color::RESET;
+    out += '\n';
+  }
+}
+
+bool isValidUtf8(std::string_view text) {
+  size_t i = 0;
+  while (i < text.size()) {
+    const auto c = static_cast<unsigned char>(text[i]);
+    const size_t length = c < 0x80 ? 1 : (c >> 5) == 6 ? 2
+                                     : (c >> 4) == 14  ? 3
+                                     : (c >> 3) == 30  ? 4
+                                                       : 0;
+    if (length == 0 || i + length > text.size()) {
+      return false;
+    }
+    for (size_t k = 1; k < length; k++) {
+      if ((static_cast<unsigned char>(text[i + k]) >> 6) != 2) {
+        return false;
+      }
+    }
+    i += length;
+  }
+  return true;
+}
+
+// JSON Lines are written directly rather than through nlohmann::json, which
+// would build and free a DOM per file.
+void appendJsonString(std::string_view text, std::string &out) {
+  if (!isValidUtf8(text)) {
+    out += json(std::string(text))
+               .dump(-1, ' ', false, json::error_handler_t::replace);
+    return;
+  }
+  static const char HEX[] = "0123456789abcdef";
+  out += '"';
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        out += "\\u00";
+        out += HEX[(c >> 4) & 15];
+        out += HEX[c & 15];
+      } else {
+        out += c;
+      }
+    }
+  }
+  out += '"';
+}
+
+void appendJsonArray(const Diagnostics &items, std::string &out) {
+  out += '[';
+  for (size_t i = 0; i < items.size(); i++) {
+    if (i > 0) {
+      out += ',';
+    }
+    if (items[i].line == 0) {
+      appendJsonString(items[i].text, out);
+    } else {
+      appendJsonString(items[i].str(), out);
+    }
+  }
+  out += ']';
+}
+
+void renderJsonLine(const std::string &path, const ValidationResult &result,
+                    std::string &out) {
+  out += "{\"type\":\"result\",\"path\":";
+  appendJsonString(path, out);
+  out += ",\"fileType\":";
+  appendJsonString(result.fileType, out);
+  out += result.valid ? ",\"valid\":true,\"errors\":"
+                      : ",\"valid\":false,\"errors\":";
+  appendJsonArray(result.errors, out);
+  out += ",\"warnings\":";
+  appendJsonArray(result.warnings, out);
+  out += ",\"notes\":";
+  appendJsonArray(result.notes, out);
+  out += "}\n";
+}
+
+// Reads "line N" and ", column M" out of parser messages, 0 when absent.
+void findPosition(const std::string &message, unsigned &line,
+                  unsigned &column) {
+  line = column = 0;
+  auto number = [&message](size_t pos) {
+    unsigned value = 0;
+    while (pos < message.size() && message[pos] >= '0' && message[pos] <= '9') {
+      value = value * 10 + static_cast<unsigned>(message[pos++] - '0');
+    }
+    return value;
+  };
+  size_t pos = message.find("line ");
+  if (pos == std::string::npos) {
+    return;
+  }
+  line = number(pos + 5);
+  pos = message.find("column ", pos);
+  if (pos != std::string::npos) {
+    column = number(pos + 7);
+  }
+}
+
+std::string fileUri(const std::string &path) {
+  static const char HEX[] = "0123456789ABCDEF";
+  std::string uri;
+  for (unsigned char c : path) {
+    if (c == '\\') {
+      uri += '/';
+    } else if (std::isalnum(c) || std::strchr("-._~/:", c)) {
+      uri += static_cast<char>(c);
+    } else {
+      uri += '%';
+      uri += HEX[c >> 4];
+      uri += HEX[c & 15];
+    }
+  }
+  return uri;
+}
+
+std::string renderSarif(
+    const std::vector<std::pair<std::string, ValidationResult>> &records) {
+  json results = json::array();
+  // Positions come from the diagnostic, or failing that (parser messages
+  // such as yaml-cpp's) from its text.
+  auto add = [&results](const std::string &path, const std::string &rule,
+                        const std::string &level, const std::string &text,
+                        unsigned line = 0, unsigned column = 0) {
+    json location = {
+        {"physicalLocation", {{"artifactLocation", {{"uri", fileUri(path)}}}}}};
+    if (line == 0) {
+      findPosition(text, line, column);
+    }
+    if (line > 0) {
+      json region = {{"startLine", line}};
+      if (column > 0) {
+        region["startColumn"] = column;
+      }
+      location["physicalLocation"]["region"] = region;
+    }
+    results.push_back({{"ruleId", rule},
+                       {"level", level},
+                       {"message", {{"text", text}}},
+                       {"locations", json::array({location})}});
+  };
+
+  for (const auto &[path, result] : records) {
+    for (const Diagnostic &error : result.errors) {
+      add(path, "invalid-config", "error", error.str(), error.line,
+          error.column);
+    }
+    if (!result.valid && result.errors.empty()) {
+      add(path, "invalid-config", "error",
+          "Invalid " + result.fileType + " file");
+    }
+    for (const Diagnostic &warning : result.warnings) {
+      add(path, "config-warning", "warning", warning.str(), warning.line,
+          warning.column);
+    }
+  }
+
+  json rules = json::array(
+      {{{"id", "invalid-config"},
+        {"shortDescription", {{"text", "Configuration file is invalid"}}}},
+       {{"id", "config-warning"},
+        {"shortDescription",
+         {{"text", "Configuration file has a likely mistake"}}}}});
+  json sarif = {
+      {"$schema", "https://json.schemastore.org/sarif-2.1.0.json"},
+      {"version", "2.1.0"},
+      {"runs",
+       json::array({{{"tool",
+                       {{"driver",
+                         {{"name", "devops-validator"},
+                          {"version", DEVOPS_VALIDATOR_VERSION},
+                          {"informationUri",
+                           "https://github.com/neonix888/devops-validator"},
+                          {"rules", rules}}}}},
+                      {"results", results}}})}};
+  return sarif.dump(2, ' ', false, json::error_handler_t::replace) + "\n";
+}
+
+std::string xmlEscape(const std::string &text) {
+  std::string out;
+  out.reserve(text.size());
+  for (char c : text) {
+    switch (c) {
+    case '&':
+      out += "&amp;";
+      break;
+    case '<':
+      out += "&lt;";
+      break;
+    case '>':
+      out += "&gt;";
+      break;
+    case '"':
+      out += "&quot;";
+      break;
+    default:
+      // Control characters other than tab and newline are not valid XML.
+      if (static_cast<unsigned char>(c) >= 0x20 || c == '\t' || c == '\n') {
+        out += c;
+      }
+    }
+  }
+  return out;
+}
+
+std::string renderJUnit(
+    const std::vector<std::pair<std::string, ValidationResult>> &records,
+    size_t invalid) {
+  const std::string counts = "tests=\"" + std::to_string(records.size()) +
+                             "\" failures=\"" + std::to_string(invalid) + "\"";
+  std::string out = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+  out += "<testsuites name=\"devops-validator\" " + counts + ">\n";
+  out += "  <testsuite name=\"validate\" " + counts +
+         " errors=\"0\" skipped=\"0\">\n";
+  for (const auto &[path, result] : records) {
+    const std::string type =
+        result.fileType.empty() ? "config" : result.fileType;
+    out += "    <testcase name=\"" + xmlEscape(path) + "\" classname=\"" +
+           xmlEscape(type) + "\"";
+    if (result.valid && result.warnings.empty()) {
+      out += "/>\n";
+      continue;
+    }
+    out += ">\n";
+    if (!result.valid) {
+      std::string details;
+      for (const Diagnostic &error : result.errors) {
+        error.appendTo(details);
+        details += '\n';
+      }
+      const std::string summary = result.errors.empty()
+                                      ? "Invalid " + type + " file"
+                                      : result.errors.front().str();
+      out += "      <failure type=\"invalid\" message=\"" +
+             xmlEscape(summary) + "\">" + xmlEscape(details) +
+             "</failure>\n";
+    }
+    if (!result.warnings.empty()) {
+      std::string warnings;
+      for (const Diagnostic &warning : result.warnings) {
+        warnings += "WARNING: ";
+        warning.appendTo(warnings);
+        warnings += '\n';
+      }
+      out += "      <system-out>" + xmlEscape(warnings) + "</system-out>\n";
+    }
+    out += "    </testcase>\n";
+  }
+  out += "  </testsuite>\n</testsuites>\n";
+  return out;
+}
+
+void State::finish() {
+  std::string document;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished) {
+      return;
+    }
+    finished = true;
+
+    switch (format) {
+    case ReportFormat::Human:
+      break;
+    case ReportFormat::JsonLines:
+      // Only written when something was validated, so commands that
+      // produce no results keep stdout empty.
+      if (files > 0) {
+        document = "{\"type\":\"summary\",\"files\":" + std::to_string(files) +
+                   ",\"valid\":" + std::to_string(files - invalid) +
+                   ",\"invalid\":" + std::to_string(invalid) + "}\n";
+      }
+      break;
+    case ReportFormat::Sarif:
+      document = renderSarif(records);
+      break;
+    case ReportFormat::JUnit:
+      document = renderJUnit(records, invalid);
+      break;
+    }
+  }
+  stdoutChannel.append(document.data(), document.size());
+  stdoutChannel.flush();
+  stderrChannel.flush();
+}
+
+} // namespace
+
+void ReportBuffer::addFile(const std::string &path,
+                           const ValidationResult &result, bool header) {
+  ProfileScope scope("output.render", path);
+  files_++;
+  invalid_ += result.valid ? 0 : 1;
+  switch (Report::format()) {
+  case ReportFormat::Human:
+    renderHuman(path, result, header, text_);
+    break;
+  case ReportFormat::JsonLines:
+    renderJsonLine(path, result, text_);
+    break;
+  case ReportFormat::Sarif:
+  case ReportFormat::JUnit:
+    records_.emplace_back(path, result);
+    break;
+  }
+}
+
+bool Report::parseFormat(const std::string &name, ReportFormat &format) {
+  if (name == "human") {
+    format = ReportFormat::Human;
+  } else if (name == "jsonl") {
+    format = ReportFormat::JsonLines;
+  } else if (name == "sarif") {
+    format = ReportFormat::Sarif;
+  } else if (name == "junit") {
+    format = ReportFormat::JUnit;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool Report::parseColorMode(const std::string &name, ColorMode &mode) {
+  if (name == "auto") {
+    mode = ColorMode::Auto;
+  } else if (name == "always") {
+    mode = ColorMode::Always;
+  } else if (name == "never") {
+    mode = ColorMode::Never;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void Report::configure(ReportFormat format, ColorMode color) {
+  State &s = state();
+  s.format = format;
+  s.stdoutChannel.setColor(colorFor(color, stdout));
+  s.stderrChannel.setColor(colorFor(color, stderr));
+}
+
+ReportFormat Report::format() { return state().format; }
+
+std::ostream &Report::out() {
+  State &s = state();
+  return s.format == ReportFormat::Human ? s.stdoutStream : s.stderrStream;
+}
+
+void Report::message(Level level, const std::string &text) {
+  State &s = state();
+  std::string line;
+  switch (level) {
+  case Level::Success:
+    line = Color::GREEN + "✓ " + text + Color::RESET + "\n";
+    break;
+  case Level::Error:
+    line = Color::RED + "✗ " + text + Color::RESET + "\n";
+    break;
+  case Level::Warning:
+    line = Color::YELLOW + "⚠ " + text + Color::RESET + "\n";
+    break;
+  case Level::Info:
+    line = Color::CYAN + "ℹ " + text + Color::RESET + "\n";
+    break;
+  }
+
+  if (level == Level::Error) {
+    s.stdoutChannel.flush();
+    s.stderrChannel.append(line.data(), line.size());
+    s.stderrChannel.flush();
+  } else {
+    s.textChannel().append(line.data(), line.size());
+  }
+}
+
+void Report::fileResult(const std::string &path,
+                        const ValidationResult &result, bool header) {
+  ReportBuffer buffer;
+  buffer.addFile(path, result, header);
+  merge(buffer);
+}
+
+void Report::merge(ReportBuffer &buffer) {
+  State &s = state();
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.files += buffer.files_;
+    s.invalid += buffer.invalid_;
+    for (auto &record : buffer.records_) {
+      s.records.push_back(std::move(record));
+    }
+  }
+  // Results are the report itself, so they always go to stdout.
+  s.stdoutChannel.append(buffer.text_.data(), buffer.text_.size());
+  buffer.text_.clear();
+  buffer.records_.clear();
+  buffer.files_ = buffer.invalid_ = 0;
+}
+
+void Report::flush() {
+  State &s = state();
+  s.stdoutChannel.flush();
+  s.stderrChannel.flush();
+}
+
+void Report::finish() { state().finish(); }
+
+uint64_t Report::bytesWritten() { return g_bytesWritten.load(); }
+
+uint64_t Report::writeNanoseconds() { return g_writeNanoseconds.load(); }
+
+} // namespace devops
@@ -0,0 +1,368 @@
+#include "rpm_header.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace devops {
+
+namespace {
+
+constexpr size_t LEAD_SIZE = 96;
+constexpr size_t INTRO_SIZE = 16; // header magic, reserved, counts
+constexpr size_t ENTRY_SIZE = 16;
+// rpm's own sanity limits for a header.
+constexpr uint32_t MAX_ENTRIES = 0xFFFF;
+constexpr uint32_t MAX_DATA = 0x0FFFFFFF;
+
+enum Tag : uint32_t {
+  NAME = 1000,
+  VERSION = 1001,
+  RELEASE = 1002,
+  EPOCH = 1003,
+  SUMMARY = 1004,
+  SIZE = 1009,
+  LICENSE = 1014,
+  ARCH = 1022,
+  OLDFILENAMES = 1027,
+  PROVIDENAME = 1047,
+  REQUIREFLAGS = 1048,
+  REQUIRENAME = 1049,
+  REQUIREVERSION = 1050,
+  PROVIDEFLAGS = 1112,
+  PROVIDEVERSION = 1113,
+  DIRINDEXES = 1116,
+  BASENAMES = 1117,
+  DIRNAMES = 1118,
+  PAYLOADFORMAT = 1124,
+  PAYLOADCOMPRESSOR = 1125,
+  LONGSIZE = 5009,
+};
+
+enum Type : uint32_t {
+  INT32 = 4,
+  INT64 = 5,
+  STRING = 6,
+  STRING_ARRAY = 8,
+  I18NSTRING = 9,
+};
+
+// RPMSENSE_* comparison bits of the dependency flags.
+constexpr uint32_t SENSE_LESS = 0x02;
+constexpr uint32_t SENSE_GREATER = 0x04;
+constexpr uint32_t SENSE_EQUAL = 0x08;
+
+uint32_t be32(const char *p) {
+  const auto *u = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<uint32_t>(u[0]) << 24 | static_cast<uint32_t>(u[1]) << 16 |
+         static_cast<uint32_t>(u[2]) << 8 | u[3];
+}
+
+uint16_t be16(const char *p) {
+  const auto *u = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<uint16_t>(u[0] << 8 | u[1]);
+}
+
+std::runtime_error corrupt(const std::string &path, const std::string &what) {
+  return std::runtime_error("corrupt RPM header in " + path + ": " + what);
+}
+
+// Reads given byte ranges without moving through the rest of the file.
+class PositionalFile {
+public:
+  explicit PositionalFile(const std::string &path) : path_(path) {
+#ifdef _WIN32
+    file_.open(path, std::ios::binary);
+    if (!file_.is_open()) {
+      throw std::runtime_error("cannot open " + path);
+    }
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+      throw std::runtime_error("cannot open " + path + ": " +
+                               std::strerror(errno));
+    }
+#endif
+  }
+  ~PositionalFile() {
+#ifndef _WIN32
+    ::close(fd_);
+#endif
+  }
+  PositionalFile(const PositionalFile &) = delete;
+  PositionalFile &operator=(const PositionalFile &) = delete;
+
+  // Fills `out` from `offset`; throws if the file ends first.
+  void readAt(uint64_t offset, char *out, size_t n) {
+#ifdef _WIN32
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(offset));
+    if (!file_.read(out, static_cast<std::streamsize>(n))) {
+      throw std::runtime_error("truncated RPM package: " + path_);
+    }
+#else
+    size_t done = 0;
+    while (done < n) {
+      const ssize_t got = ::pread(fd_, out + done, n - done,
+                                  static_cast<off_t>(offset + done));
+      if (got < 0 && errno == EINTR) {
+        continue;
+      }
+      if (got < 0) {
+        throw std::runtime_error("cannot read " + path_ + ": " +
+                                 std::strerror(errno));
+      }
+      if (got == 0) {
+        throw std::runtime_error("truncated RPM package: " + path_);
+      }
+      done += static_cast<size_t>(got);
+    }
+#endif
+    bytesRead_ += n;
+  }
+
+  uint64_t bytesRead() const { return bytesRead_; }
+
+private:
+  std::string path_;
+  uint64_t bytesRead_ = 0;
+#ifdef _WIN32
+  std::ifstream file_;
+#else
+  int fd_ = -1;
+#endif
+};
+
+// The index entries and data store of a header, checked against each
+// other before anything is taken from them.
+class Header {
+public:
+  Header(std::string store, uint32_t entries, const std::string &path)
+      : store_(std::move(store)), entries_(entries), path_(path) {}
+
+  std::string string(uint32_t tag) const {
+    const std::vector<std::string> values = strings(tag);
+    return values.empty() ? std::string() : values.front();
+  }
+
+  // STRING, STRING_ARRAY and I18NSTRING entries; for the last, the first
+  // string is the untranslated one.
+  std::vector<std::string> strings(uint32_t tag) const {
+    std::vector<std::string> values;
+    uint32_t type = 0;
+    uint32_t count = 0;
+    std::string_view data;
+    if (!find(tag, type, count, data)) {
+      return values;
+    }
+    if (type != STRING && type != STRING_ARRAY && type != I18NSTRING) {
+      throw corrupt(path_, "tag " + std::to_string(tag) + " is not a string");
+    }
+    if (type == STRING) {
+      count = 1;
+    }
+    values.reserve(std::min<size_t>(count, data.size()));
+    for (uint32_t i = 0; i < count; i++) {
+      const size_t end = data.find('\0');
+      if (end == std::string_view::npos) {
+        throw corrupt(path_, "unterminated string");
+      }
+      values.emplace_back(data.substr(0, end));
+      data.remove_prefix(end + 1);
+    }
+    return values;
+  }
+
+  // INT32 and INT64 entries.
+  std::vector<uint64_t> numbers(uint32_t tag) const {
+    std::vector<uint64_t> values;
+    uint32_t type = 0;
+    uint32_t count = 0;
+    std::string_view data;
+    if (!find(tag, type, count, data)) {
+      return values;
+    }
+    const size_t width = type == INT64 ? 8 : type == INT32 ? 4 : 0;
+    if (width == 0) {
+      throw corrupt(path_, "tag " + std::to_string(tag) + " is not a number");
+    }
+    if (data.size() / width < count) {
+      throw corrupt(path_, "tag " + std::to_string(tag) + " overruns data");
+    }
+    values.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+      const char *p = data.data() + i * width;
+      values.push_back(width == 8 ? static_cast<uint64_t>(be32(p)) << 32 |
+                                        be32(p + 4)
+                                  : be32(p));
+    }
+    return values;
+  }
+
+private:
+  bool find(uint32_t tag, uint32_t &type, uint32_t &count,
+            std::string_view &data) const {
+    const size_t dataStart = static_cast<size_t>(entries_) * ENTRY_SIZE;
+    for (uint32_t i = 0; i < entries_; i++) {
+      const char *entry = store_.data() + i * ENTRY_SIZE;
+      if (be32(entry) != tag) {
+        continue;
+      }
+      type = be32(entry + 4);
+      const uint32_t offset = be32(entry + 8);
+      count = be32(entry + 12);
+      if (offset >= store_.size() - dataStart) {
+        throw corrupt(path_, "tag " + std::to_string(tag) +
+                                 " points outside the header");
+      }
+      data = std::string_view(store_).substr(dataStart + offset);
+      return true;
+    }
+    return false;
+  }
+
+  std::string store_;
+  uint32_t entries_;
+  const std::string &path_;
+};
+
+// Checks the header intro at `offset` and returns the size of the index and
+// data store after it.
+uint64_t headerSize(PositionalFile &file, uint64_t offset,
+                    const std::string &path, uint32_t &entries) {
+  char intro[INTRO_SIZE];
+  file.readAt(offset, intro, sizeof(intro));
+  if (std::memcmp(intro, "\x8E\xAD\xE8\x01", 4) != 0) {
+    throw corrupt(path, "bad header magic");
+  }
+  entries = be32(intro + 8);
+  const uint32_t dataSize = be32(intro + 12);
+  if (entries > MAX_ENTRIES || dataSize > MAX_DATA) {
+    throw corrupt(path, "header too large");
+  }
+  return uint64_t{entries} * ENTRY_SIZE + dataSize;
+}
+
+std::vector<RpmDependency> dependencies(const Header &header, uint32_t names,
+                                        uint32_t flags, uint32_t versions,
+                                        const std::string &path) {
+  std::vector<RpmDependency> result;
+  const std::vector<std::string> name = header.strings(names);
+  const std::vector<uint64_t> flag = header.numbers(flags);
+  const std::vector<std::string> version = header.strings(versions);
+  if ((!flag.empty() && flag.size() != name.size()) ||
+      (!version.empty() && version.size() != name.size())) {
+    throw corrupt(path, "dependency lists differ in length");
+  }
+  result.reserve(name.size());
+  for (size_t i = 0; i < name.size(); i++) {
+    RpmDependency dependency;
+    dependency.name = name[i];
+    if (!version.empty() && !version[i].empty() && !flag.empty()) {
+      const uint64_t sense = flag[i];
+      if (sense & SENSE_LESS) {
+        dependency.op = "<";
+      } else if (sense & SENSE_GREATER) {
+        dependency.op = ">";
+      }
+      if (sense & SENSE_EQUAL) {
+        dependency.op += "=";
+      }
+      if (!dependency.op.empty()) {
+        dependency.version = version[i];
+      }
+    }
+    result.push_back(std::move(dependency));
+  }
+  return result;
+}
+
+} // namespace
+
+std::string RpmDependency::str() const {
+  return op.empty() ? name : name + " " + op + " " + version;
+}
+
+RpmPackage RpmPackage::read(const std::string &path) {
+  PositionalFile file(path);
+  RpmPackage package;
+
+  char lead[LEAD_SIZE];
+  file.readAt(0, lead, sizeof(lead));
+  if (std::memcmp(lead, "\xED\xAB\xEE\xDB", 4) != 0) {
+    throw std::runtime_error("not an RPM package: " + path);
+  }
+  package.source = be16(lead + 6) == 1;
+  if (be16(lead + 78) != 5) {
+    throw std::runtime_error("unsupported RPM signature type in " + path);
+  }
+
+  // The signature header is skipped: only its size is needed to find the
+  // main header, which starts at the next multiple of 8.
+  uint32_t entries = 0;
+  const uint64_t signature = headerSize(file, LEAD_SIZE, path, entries);
+  const uint64_t start = LEAD_SIZE + INTRO_SIZE + (signature + 7) / 8 * 8;
+  std::string store(headerSize(file, start, path, entries), '\0');
+  file.readAt(start + INTRO_SIZE, store.data(), store.size());
+  const Header header(std::move(store), entries, path);
+  package.headerBytes = file.bytesRead();
+
+  package.name = header.string(NAME);
+  package.version = header.string(VERSION);
+  package.release = header.string(RELEASE);
+  package.arch = header.string(ARCH);
+  package.summary = header.string(SUMMARY);
+  package.license = header.string(LICENSE);
+  package.payloadFormat = header.string(PAYLOADFORMAT);
+  package.payloadCompressor = header.string(PAYLOADCOMPRESSOR);
+  if (package.name.empty()) {
+    throw corrupt(path, "no package name");
+  }
+  const std::vector<uint64_t> epoch = header.numbers(EPOCH);
+  if (!epoch.empty()) {
+    package.epoch = std::to_string(epoch.front());
+  }
+  std::vector<uint64_t> size = header.numbers(LONGSIZE);
+  if (size.empty()) {
+    size = header.numbers(SIZE);
+  }
+  if (!size.empty()) {
+    package.installedSize = size.front();
+  }
+
+  package.requirements = dependencies(header, REQUIRENAME, REQUIREFLAGS,
+                                      REQUIREVERSION, path);
+  package.provides =
+      dependencies(header, PROVIDENAME, PROVIDEFLAGS, PROVIDEVERSION, path);
+
+  // Since rpm 4.0 paths are split into directories and base names.
+  const std::vector<std::string> baseNames = header.strings(BASENAMES);
+  if (baseNames.empty()) {
+    package.files = header.strings(OLDFILENAMES);
+  } else {
+    const std::vector<std::string> dirNames = header.strings(DIRNAMES);
+    const std::vector<uint64_t> dirIndexes = header.numbers(DIRINDEXES);
+    if (dirIndexes.size() != baseNames.size()) {
+      throw corrupt(path, "file lists differ in length");
+    }
+    package.files.reserve(baseNames.size());
+    for (size_t i = 0; i < baseNames.size(); i++) {
+      if (dirIndexes[i] >= dirNames.size()) {
+        throw corrupt(path, "file directory out of range");
+      }
+      package.files.push_back(dirNames[dirIndexes[i]] + baseNames[i]);
+    }
+  }
+  return package;
+}
+
+} // namespace devops
@@ -0,0 +1,1033 @@
+#include "toml_parser.h"
+#include <cstdint>
+#include <unordered_map>
+
+namespace devops {
+
+namespace {
+
+// Thrown internally to unwind to run() at the first error.
+struct TomlSyntaxError {
+  size_t line;
+  size_t column;
+  std::string message;
+};
+
+bool isBareKeyChar(char c) {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool isHexDigit(char c) {
+  return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Control characters other than tab are not allowed in strings or comments.
+bool isControl(char c) {
+  unsigned char u = static_cast<unsigned char>(c);
+  return (u < 0x20 && c != '\t') || u == 0x7F;
+}
+
+bool isValueTerminator(char c) {
+  return c == ' ' || c == '\t' || c == ',' || c == ']' || c == '}' ||
+         c == '#' || c == '\r' || c == '\n';
+}
+
+std::string describe(char c) {
+  switch (c) {
+  case '\n':
+    return "newline";
+  case '\r':
+    return "carriage return";
+  case '\t':
+    return "tab";
+  default:
+    if (isControl(c)) {
+      return "control character";
+    }
+    return std::string("'") + c + "'";
+  }
+}
+
+void appendUtf8(std::string &out, uint32_t codepoint) {
+  if (codepoint < 0x80) {
+    out += static_cast<char>(codepoint);
+  } else if (codepoint < 0x800) {
+    out += static_cast<char>(0xC0 | (codepoint >> 6));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else if (codepoint < 0x10000) {
+    out += static_cast<char>(0xE0 | (codepoint >> 12));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (codepoint >> 18));
+    out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  }
+}
+
+int twoDigits(std::string_view s, size_t at) {
+  return (s[at] - '0') * 10 + (s[at + 1] - '0');
+}
+
+bool allDigits(std::string_view s, size_t from, size_t count) {
+  if (from + count > s.size()) {
+    return false;
+  }
+  for (size_t i = from; i < from + count; i++) {
+    if (!isDigit(s[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool looksLikeDate(std::string_view token) {
+  return token.size() >= 10 && allDigits(token, 0, 4) && token[4] == '-' &&
+         allDigits(token, 5, 2) && token[7] == '-' && allDigits(token, 8, 2);
+}
+
+std::string joinKey(const std::vector<std::string> &keys, size_t count) {
+  std::string joined;
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) {
+      joined += '.';
+    }
+    joined += keys[i];
+  }
+  return joined;
+}
+
+} // namespace
+
+struct TomlParser::Node {
+  enum class Kind { Table, ArrayOfTables, Value };
+
+  Kind kind = Kind::Table;
+  // Defined by a [table] header (as opposed to implicitly by a longer one)
+  bool explicitTable = false;
+  // Created by a dotted key such as `a.b = 1`
+  bool dotted = false;
+  // Inline tables are complete once closed
+  bool frozen = false;
+
+  std::unordered_map<std::string, std::unique_ptr<Node>> children;
+  // Elements of an array of tables; new keys go to the last one
+  std::vector<std::unique_ptr<Node>> elements;
+
+  Node &target() {
+    return kind == Kind::ArrayOfTables ? *elements.back() : *this;
+  }
+
+  void freeze() {
+    frozen = true;
+    for (auto &child : children) {
+      child.second->freeze();
+    }
+  }
+};
+
+TomlParser::TomlParser(std::string_view content) : content_(content) {}
+
+TomlParser::~TomlParser() = default;
+
+TomlParseResult TomlParser::run() {
+  root_ = std::make_unique<Node>();
+  root_->explicitTable = true;
+  current_ = root_.get();
+
+  // Skip a UTF-8 byte order mark
+  if (content_.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+    pos_ = lineStart_ = 3;
+  }
+
+  try {
+    parseDocument();
+  } catch (const TomlSyntaxError &error) {
+    result_.valid = false;
+    result_.errorLine = error.line;
+    result_.errorColumn = error.column;
+    result_.error = error.message;
+  }
+
+  return std::move(result_);
+}
+
+void TomlParser::fail(const std::string &message) const {
+  failAt(line_, column(), message);
+}
+
+void TomlParser::failAt(size_t line, size_t column,
+                        const std::string &message) const {
+  throw TomlSyntaxError{line, column, message};
+}
+
+// ---------------------------------------------------------------------------
+// Whitespace, newlines and comments
+
+bool TomlParser::atNewline() const {
+  if (atEnd()) {
+    return false;
+  }
+  if (content_[pos_] == '\n') {
+    return true;
+  }
+  return content_[pos_] == '\r' && pos_ + 1 < content_.size() &&
+         content_[pos_ + 1] == '\n';
+}
+
+void TomlParser::consumeNewline() {
+  pos_ += content_[pos_] == '\r' ? 2 : 1;
+  line_++;
+  lineStart_ = pos_;
+}
+
+void TomlParser::skipWhitespace() {
+  while (!atEnd() && (peek() == ' ' || peek() == '\t')) {
+    pos_++;
+  }
+}
+
+void TomlParser::consumeUtf8() {
+  const unsigned char *p =
+      reinterpret_cast<const unsigned char *>(content_.data()) + pos_;
+  size_t available = content_.size() - pos_;
+  unsigned char lead = p[0];
+
+  size_t length;
+  uint32_t codepoint;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+    codepoint = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    codepoint = lead & 0x0F;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    codepoint = lead & 0x07;
+  } else {
+    fail("invalid UTF-8 byte");
+  }
+
+  if (available < length) {
+    fail("truncated UTF-8 sequence");
+  }
+  for (size_t i = 1; i < length; i++) {
+    if ((p[i] & 0xC0) != 0x80) {
+      fail("invalid UTF-8 sequence");
+    }
+    codepoint = (codepoint << 6) | (p[i] & 0x3F);
+  }
+
+  if ((length == 3 && codepoint < 0x800) ||
+      (length == 4 && (codepoint < 0x10000 || codepoint > 0x10FFFF))) {
+    fail("overlong or out of range UTF-8 sequence");
+  }
+  if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+    fail("UTF-8 encoded surrogate");
+  }
+
+  pos_ += length;
+}
+
+void TomlParser::skipComment() {
+  pos_++; // '#'
+  while (!atEnd() && !atNewline()) {
+    char c = peek();
+    if (static_cast<unsigned char>(c) >= 0x80) {
+      consumeUtf8();
+    } else if (isControl(c)) {
+      fail(describe(c) + " in comment");
+    } else {
+      pos_++;
+    }
+  }
+}
+
+void TomlParser::skipBlankLinesAndComments() {
+  for (;;) {
+    skipWhitespace();
+    if (atEnd()) {
+      return;
+    }
+    if (peek() == '#') {
+      skipComment();
+    } else if (atNewline()) {
+      consumeNewline();
+    } else {
+      return;
+    }
+  }
+}
+
+void TomlParser::expectLineEnd() {
+  skipWhitespace();
+  if (!atEnd() && peek() == '#') {
+    skipComment();
+  }
+  if (atEnd()) {
+    return;
+  }
+  if (!atNewline()) {
+    fail("expected end of line, found " + describe(peek()));
+  }
+  consumeNewline();
+}
+
+// ---------------------------------------------------------------------------
+// Document structure
+
+void TomlParser::parseDocument() {
+  for (;;) {
+    skipBlankLinesAndComments();
+    if (atEnd()) {
+      return;
+    }
+
+    if (peek() == '[') {
+      if (pos_ + 1 < content_.size() && content_[pos_ + 1] == '[') {
+        parseArrayTableHeader();
+      } else {
+        parseTableHeader();
+      }
+    } else {
+      parseKeyValue(*current_);
+    }
+    expectLineEnd();
+  }
+}
+
+TomlParser::Node &
+TomlParser::descendForHeader(const std::vector<std::string> &keys,
+                             size_t count, const std::string &header,
+                             size_t line, size_t column) {
+  Node *node = root_.get();
+  for (size_t i = 0; i < count; i++) {
+    auto &slot = node->children[keys[i]];
+    if (!slot) {
+      slot = std::make_unique<Node>();
+      result_.tables++;
+    } else if (slot->kind == Node::Kind::Value) {
+      failAt(line, column,
+             "cannot define table " + header + ": key '" +
+                 joinKey(keys, i + 1) + "' is already a value");
+    } else if (slot->frozen) {
+      failAt(line, column,
+             "cannot define table " + header + ": '" + joinKey(keys, i + 1) +
+                 "' is an inline table");
+    }
+    node = &slot->target();
+  }
+  return *node;
+}
+
+void TomlParser::parseTableHeader() {
+  const size_t headerLine = line_;
+  const size_t headerColumn = column();
+  pos_++; // '['
+  skipWhitespace();
+  std::vector<std::string> keys = parseKey();
+  skipWhitespace();
+  if (atEnd() || peek() != ']') {
+    fail("expected ']' to close table header");
+  }
+  pos_++;
+
+  const std::string header = "[" + joinKey(keys, keys.size()) + "]";
+  Node &parent = descendForHeader(keys, keys.size() - 1, header, headerLine,
+                                 headerColumn);
+
+  auto &slot = parent.children[keys.back()];
+  if (!slot) {
+    slot = std::make_unique<Node>();
+    result_.tables++;
+  } else if (slot->kind == Node::Kind::ArrayOfTables) {
+    failAt(headerLine, headerColumn,
+           "table " + header + " is already defined as an array of tables");
+  } else if (slot->kind == Node::Kind::Value || slot->frozen) {
+    failAt(headerLine, headerColumn,
+           "cannot define table " + header + ": key is already defined");
+  } else if (slot->explicitTable) {
+    failAt(headerLine, headerColumn,
+           "table " + header + " is defined more than once");
+  } else if (slot->dotted) {
+    failAt(headerLine, headerColumn,
+           "table " + header + " was already defined by dotted keys");
+  }
+
+  slot->explicitTable = true;
+  current_ = slot.get();
+}
+
+void TomlParser::parseArrayTableHeader() {
+  const size_t headerLine = line_;
+  const size_t headerColumn = column();
+  pos_ += 2; // '[['
+  skipWhitespace();
+  std::vector<std::string> keys = parseKey();
+  skipWhitespace();
+  if (content_.compare(pos_, 2, "]]") != 0) {
+    fail("expected ']]' to close array of tables header");
+  }
+  pos_ += 2;
+
+  const std::string header = "[[" + joinKey(keys, keys.size()) + "]]";
+  Node &parent = descendForHeader(keys, keys.size() - 1, header, headerLine,
+                                 headerColumn);
+
+  auto &slot = parent.children[keys.back()];
+  if (!slot) {
+    slot = std::make_unique<Node>();
+    slot->kind = Node::Kind::ArrayOfTables;
+  } else if (slot->kind != Node::Kind::ArrayOfTables) {
+    failAt(headerLine, headerColumn,
+           "cannot define array of tables " + header +
+               ": key is already defined as a " +
+               (slot->kind == Node::Kind::Value ? "value" : "table"));
+  }
+
+  slot->elements.push_back(std::make_unique<Node>());
+  slot->elements.back()->explicitTable = true;
+  result_.tables++;
+  current_ = slot->elements.back().get();
+}
+
+std::vector<std::string> TomlParser::parseKey() {
+  std::vector<std::string> keys;
+
+  for (;;) {
+    if (atEnd()) {
+      fail("expected key, found end of file");
+    }
+
+    std::string key;
+    char c = peek();
+    if (c == '"') {
+      if (content_.compare(pos_, 3, "\"\"\"") == 0) {
+        fail("multi-line strings cannot be used as keys");
+      }
+      parseBasicString(&key);
+    } else if (c == '\'') {
+      if (content_.compare(pos_, 3, "'''") == 0) {
+        fail("multi-line strings cannot be used as keys");
+      }
+      parseLiteralString(&key);
+    } else if (isBareKeyChar(c)) {
+      size_t start = pos_;
+      while (!atEnd() && isBareKeyChar(peek())) {
+        pos_++;
+      }
+      key.assign(content_.substr(start, pos_ - start));
+    } else {
+      fail("expected key, found " + describe(c));
+    }
+    keys.push_back(std::move(key));
+
+    skipWhitespace();
+    if (atEnd() || peek() != '.') {
+      return keys;
+    }
+    pos_++;
+    skipWhitespace();
+  }
+}
+
+void TomlParser::parseKeyValue(Node &table) {
+  const size_t keyLine = line_;
+  const size_t keyColumn = column();
+  std::vector<std::string> keys = parseKey();
+
+  if (atEnd() || peek() != '=') {
+    fail(atEnd() ? "expected '=' after key, found end of file"
+                 : "expected '=' after key, found " + describe(peek()));
+  }
+  pos_++;
+  skipWhitespace();
+
+  Node *node = &table;
+  for (size_t i = 0; i + 1 < keys.size(); i++) {
+    auto &slot = node->children[keys[i]];
+    if (!slot) {
+      slot = std::make_unique<Node>();
+      slot->dotted = true;
+      result_.tables++;
+    } else if (slot->kind != Node::Kind::Table || !slot->dotted ||
+               slot->frozen) {
+      failAt(keyLine, keyColumn,
+             "cannot add key '" + joinKey(keys, keys.size()) + "': '" +
+                 joinKey(keys, i + 1) + "' is already defined");
+    }
+    node = slot.get();
+  }
+
+  auto &slot = node->children[keys.back()];
+  if (slot) {
+    failAt(keyLine, keyColumn,
+           "duplicate key '" + joinKey(keys, keys.size()) + "'");
+  }
+  slot = std::make_unique<Node>();
+  slot->kind = Node::Kind::Value;
+  result_.keys++;
+
+  parseValue(*slot);
+}
+
+// ---------------------------------------------------------------------------
+// Values
+
+void TomlParser::parseValue(Node &node) {
+  if (atEnd()) {
+    fail("expected value, found end of file");
+  }
+
+  switch (peek()) {
+  case '"':
+    if (content_.compare(pos_, 3, "\"\"\"") == 0) {
+      parseMultilineBasicString();
+    } else {
+      parseBasicString(nullptr);
+    }
+    break;
+  case '\'':
+    if (content_.compare(pos_, 3, "'''") == 0) {
+      parseMultilineLiteralString();
+    } else {
+      parseLiteralString(nullptr);
+    }
+    break;
+  case '[':
+    parseArray();
+    break;
+  case '{':
+    node.kind = Node::Kind::Table;
+    parseInlineTable(node);
+    break;
+  default:
+    if (isValueTerminator(peek())) {
+      fail("expected value, found " + describe(peek()));
+    }
+    parseScalar();
+    break;
+  }
+}
+
+void TomlParser::parseArray() {
+  pos_++; // '['
+  for (;;) {
+    skipBlankLinesAndComments();
+    if (atEnd()) {
+      fail("unterminated array");
+    }
+    if (peek() == ']') {
+      pos_++;
+      return;
+    }
+
+    Node element;
+    element.kind = Node::Kind::Value;
+    parseValue(element);
+
+    skipBlankLinesAndComments();
+    if (atEnd()) {
+      fail("unterminated array");
+    }
+    if (peek() == ',') {
+      pos_++;
+    } else if (peek() == ']') {
+      pos_++;
+      return;
+    } else {
+      fail("expected ',' or ']' in array, found " + describe(peek()));
+    }
+  }
+}
+
+void TomlParser::parseInlineTable(Node &node) {
+  pos_++; // '{'
+  skipWhitespace();
+  if (!atEnd() && peek() == '}') {
+    pos_++;
+    node.freeze();
+    return;
+  }
+
+  for (;;) {
+    if (atEnd() || atNewline()) {
+      fail("inline tables must be on a single line");
+    }
+    parseKeyValue(node);
+    skipWhitespace();
+
+    if (atEnd() || atNewline()) {
+      fail("inline tables must be on a single line");
+    }
+    if (peek() == '}') {
+      pos_++;
+      break;
+    }
+    if (peek() != ',') {
+      fail("expected ',' or '}' in inline table, found " + describe(peek()));
+    }
+    pos_++;
+    skipWhitespace();
+    if (!atEnd() && peek() == '}') {
+      fail("trailing comma is not allowed in an inline table");
+    }
+  }
+
+  node.freeze();
+}
+
+void TomlParser::parseEscape(std::string *out) {
+  pos_++; // '\'
+  if (atEnd()) {
+    fail("unterminated escape sequence");
+  }
+
+  char c = peek();
+  char simple = 0;
+  switch (c) {
+  case 'b':
+    simple = '\b';
+    break;
+  case 't':
+    simple = '\t';
+    break;
+  case 'n':
+    simple = '\n';
+    break;
+  case 'f':
+    simple = '\f';
+    break;
+  case 'r':
+    simple = '\r';
+    break;
+  case '"':
+    simple = '"';
+    break;
+  case '\\':
+    simple = '\\';
+    break;
+  case 'u':
+  case 'U': {
+    size_t digits = c == 'u' ? 4 : 8;
+    if (pos_ + digits >= content_.size()) {
+      fail("truncated unicode escape");
+    }
+    uint32_t codepoint = 0;
+    for (size_t i = 1; i <= digits; i++) {
+      char h = content_[pos_ + i];
+      if (!isHexDigit(h)) {
+        fail("invalid unicode escape");
+      }
+      codepoint = codepoint * 16 +
+                  static_cast<uint32_t>(isDigit(h) ? h - '0'
+                                                   : (h | 0x20) - 'a' + 10);
+    }
+    if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+      fail("unicode escape is not a scalar value");
+    }
+    if (out) {
+      appendUtf8(*out, codepoint);
+    }
+    pos_ += digits + 1;
+    return;
+  }
+  default:
+    fail("invalid escape sequence '\\" + std::string(1, c) + "'");
+  }
+
+  if (out) {
+    *out += simple;
+  }
+  pos_++;
+}
+
+void TomlParser::parseBasicString(std::string *out) {
+  const size_t openLine = line_;
+  const size_t openColumn = column();
+  pos_++; // '"'
+
+  for (;;) {
+    if (atEnd() || atNewline()) {
+      failAt(openLine, openColumn, "unterminated string");
+    }
+
+    char c = peek();
+    if (c == '"') {
+      pos_++;
+      return;
+    }
+    if (c == '\\') {
+      parseEscape(out);
+    } else if (static_cast<unsigned char>(c) >= 0x80) {
+      size_t start = pos_;
+      consumeUtf8();
+      if (out) {
+        out->append(content_.substr(start, pos_ - start));
+      }
+    } else if (isControl(c)) {
+      fail(describe(c) + " in string");
+    } else {
+      if (out) {
+        *out += c;
+      }
+      pos_++;
+    }
+  }
+}
+
+void TomlParser::parseMultilineBasicString() {
+  const size_t openLine = line_;
+  const size_t openColumn = column();
+  pos_ += 3;
+  if (atNewline()) {
+    consumeNewline();
+  }
+
+  for (;;) {
+    if (atEnd()) {
+      failAt(openLine, openColumn, "unterminated multi-line string");
+    }
+
+    char c = peek();
+    if (c == '"') {
+      size_t quotes = 0;
+      while (pos_ + quotes < content_.size() &&
+             content_[pos_ + quotes] == '"') {
+        quotes++;
+      }
+      if (quotes >= 3) {
+        // Up to two quotes may directly precede the closing delimiter.
+        if (quotes > 5) {
+          fail("too many quotes at end of multi-line string");
+        }
+        pos_ += quotes;
+        return;
+      }
+      pos_ += quotes;
+    } else if (c == '\\') {
+      // A backslash at the end of a line trims the newline and any
+      // whitespace or newlines that follow it.
+      size_t look = pos_ + 1;
+      while (look < content_.size() &&
+             (content_[look] == ' ' || content_[look] == '\t')) {
+        look++;
+      }
+      size_t saved = pos_;
+      pos_ = look;
+      if (atNewline()) {
+        while (!atEnd() && (peek() == ' ' || peek() == '\t' || atNewline())) {
+          if (atNewline()) {
+            consumeNewline();
+          } else {
+            pos_++;
+          }
+        }
+      } else {
+        pos_ = saved;
+        parseEscape(nullptr);
+      }
+    } else if (atNewline()) {
+      consumeNewline();
+    } else if (static_cast<unsigned char>(c) >= 0x80) {
+      consumeUtf8();
+    } else if (isControl(c)) {
+      fail(describe(c) + " in string");
+    } else {
+      pos_++;
+    }
+  }
+}
+
+void TomlParser::parseLiteralString(std::string *out) {
+  const size_t openLine = line_;
+  const size_t openColumn = column();
+  pos_++; // '\''
+  size_t start = pos_;
+
+  for (;;) {
+    if (atEnd() || atNewline()) {
+      failAt(openLine, openColumn, "unterminated literal string");
+    }
+
+    char c = peek();
+    if (c == '\'') {
+      if (out) {
+        out->assign(content_.substr(start, pos_ - start));
+      }
+      pos_++;
+      return;
+    }
+    if (static_cast<unsigned char>(c) >= 0x80) {
+      consumeUtf8();
+    } else if (isControl(c)) {
+      fail(describe(c) + " in string");
+    } else {
+      pos_++;
+    }
+  }
+}
+
+void TomlParser::parseMultilineLiteralString() {
+  const size_t openLine = line_;
+  const size_t openColumn = column();
+  pos_ += 3;
+  if (atNewline()) {
+    consumeNewline();
+  }
+
+  for (;;) {
+    if (atEnd()) {
+      failAt(openLine, openColumn, "unterminated multi-line literal string");
+    }
+
+    char c = peek();
+    if (c == '\'') {
+      size_t quotes = 0;
+      while (pos_ + quotes < content_.size() &&
+             content_[pos_ + quotes] == '\'') {
+        quotes++;
+      }
+      if (quotes >= 3) {
+        if (quotes > 5) {
+          fail("too many quotes at end of multi-line literal string");
+        }
+        pos_ += quotes;
+        return;
+      }
+      pos_ += quotes;
+    } else if (atNewline()) {
+      consumeNewline();
+    } else if (static_cast<unsigned char>(c) >= 0x80) {
+      consumeUtf8();
+    } else if (isControl(c)) {
+      fail(describe(c) + " in string");
+    } else {
+      pos_++;
+    }
+  }
+}
+
+void TomlParser::parseScalar() {
+  const size_t start = pos_;
+  const size_t startColumn = column();
+
+  while (!atEnd() && !isValueTerminator(peek())) {
+    pos_++;
+  }
+
+  // Offset date-times may use a space instead of 'T' between date and time.
+  if (pos_ - start == 10 && looksLikeDate(content_.substr(start, 10)) &&
+      pos_ + 3 < content_.size() && content_[pos_] == ' ' &&
+      allDigits(content_, pos_ + 1, 2) && content_[pos_ + 3] == ':') {
+    pos_++;
+    while (!atEnd() && !isValueTerminator(peek())) {
+      pos_++;
+    }
+  }
+
+  std::string_view token = content_.substr(start, pos_ - start);
+
+  if (token == "true" || token == "false" || token == "inf" ||
+      token == "+inf" || token == "-inf" || token == "nan" ||
+      token == "+nan" || token == "-nan") {
+    return;
+  }
+
+  if (looksLikeDate(token)) {
+    checkDateTime(token, startColumn);
+  } else if (token.size() >= 3 && isDigit(token[0]) && isDigit(token[1]) &&
+             token[2] == ':') {
+    checkTime(token, startColumn);
+  } else {
+    checkNumber(token, startColumn);
+  }
+}
+
+void TomlParser::checkNumber(std::string_view token, size_t column) {
+  auto invalid = [&]() {
+    failAt(line_, column, "invalid value '" + std::string(token) + "'");
+  };
+
+  // Digits with single underscores between them; returns the digit count.
+  auto digitRun = [&](size_t &i, auto isValidDigit) {
+    size_t digits = 0;
+    bool lastUnderscore = false;
+    while (i < token.size()) {
+      char c = token[i];
+      if (isValidDigit(c)) {
+        digits++;
+        lastUnderscore = false;
+      } else if (c == '_') {
+        if (digits == 0 || lastUnderscore) {
+          invalid();
+        }
+        lastUnderscore = true;
+      } else {
+        break;
+      }
+      i++;
+    }
+    if (digits == 0 || lastUnderscore) {
+      invalid();
+    }
+    return digits;
+  };
+
+  if (token.size() > 2 && token[0] == '0' &&
+      (token[1] == 'x' || token[1] == 'o' || token[1] == 'b')) {
+    char base = token[1];
+    size_t i = 2;
+    if (base == 'x') {
+      digitRun(i, isHexDigit);
+    } else if (base == 'o') {
+      digitRun(i, [](char c) { return c >= '0' && c <= '7'; });
+    } else {
+      digitRun(i, [](char c) { return c == '0' || c == '1'; });
+    }
+    if (i != token.size()) {
+      invalid();
+    }
+    return;
+  }
+
+  size_t i = 0;
+  bool negative = false;
+  if (i < token.size() && (token[i] == '+' || token[i] == '-')) {
+    negative = token[i] == '-';
+    i++;
+  }
+
+  size_t intStart = i;
+  size_t intDigits = digitRun(i, isDigit);
+  if (token[intStart] == '0' && intDigits > 1) {
+    failAt(line_, column,
+           "leading zeros are not allowed in '" + std::string(token) + "'");
+  }
+
+  bool isFloat = false;
+  if (i < token.size() && token[i] == '.') {
+    i++;
+    digitRun(i, isDigit);
+    isFloat = true;
+  }
+  if (i < token.size() && (token[i] == 'e' || token[i] == 'E')) {
+    i++;
+    if (i < token.size() && (token[i] == '+' || token[i] == '-')) {
+      i++;
+    }
+    digitRun(i, isDigit);
+    isFloat = true;
+  }
+  if (i != token.size()) {
+    invalid();
+  }
+
+  if (!isFloat && intDigits >= 19) {
+    // Integers must fit in a signed 64-bit value.
+    char digits[32];
+    size_t count = 0;
+    for (size_t j = intStart; j < token.size() && count < sizeof(digits);
+         j++) {
+      if (token[j] != '_') {
+        digits[count++] = token[j];
+      }
+    }
+    std::string_view value(digits, count);
+    std::string_view limit =
+        negative ? "9223372036854775808" : "9223372036854775807";
+    if (value.size() > limit.size() ||
+        (value.size() == limit.size() && value > limit)) {
+      failAt(line_, column,
+             "integer '" + std::string(token) + "' is out of range");
+    }
+  }
+}
+
+void TomlParser::checkTime(std::string_view token, size_t column) {
+  auto invalid = [&]() {
+    failAt(line_, column, "invalid time '" + std::string(token) + "'");
+  };
+
+  // HH:MM:SS[.fraction]
+  if (token.size() < 8 || !allDigits(token, 0, 2) || token[2] != ':' ||
+      !allDigits(token, 3, 2) || token[5] != ':' || !allDigits(token, 6, 2)) {
+    invalid();
+  }
+  if (twoDigits(token, 0) > 23 || twoDigits(token, 3) > 59 ||
+      twoDigits(token, 6) > 60) {
+    invalid();
+  }
+
+  size_t i = 8;
+  if (i < token.size() && token[i] == '.') {
+    i++;
+    size_t digits = 0;
+    while (i < token.size() && isDigit(token[i])) {
+      i++;
+      digits++;
+    }
+    if (digits == 0) {
+      invalid();
+    }
+  }
+  if (i != token.size()) {
+    invalid();
+  }
+}
+
+void TomlParser::checkDateTime(std::string_view token, size_t column) {
+  auto invalid = [&]() {
+    failAt(line_, column, "invalid date-time '" + std::string(token) + "'");
+  };
+
+  int year = (token[0] - '0') * 1000 + (token[1] - '0') * 100 +
+             (token[2] - '0') * 10 + (token[3] - '0');
+  int month = twoDigits(token, 5);
+  int day = twoDigits(token, 8);
+
+  static const int daysInMonth[] = {31, 28, 31, 30, 31, 30,
+                                    31, 31, 30, 31, 30, 31};
+  if (month < 1 || month > 12 || day < 1) {
+    invalid();
+  }
+  bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+  int maxDay = daysInMonth[month - 1] + (month == 2 && leap ? 1 : 0);
+  if (day > maxDay) {
+    invalid();
+  }
+
+  if (token.size() == 10) {
+    return; // Local date
+  }
+
+  char separator = token[10];
+  if (separator != 'T' && separator != 't' && separator != ' ') {
+    invalid();
+  }
+
+  std::string_view rest = token.substr(11);
+  size_t timeEnd = 0;
+  while (timeEnd < rest.size() &&
+         (isDigit(rest[timeEnd]) || rest[timeEnd] == ':' ||
+          rest[timeEnd] == '.')) {
+    timeEnd++;
+  }
+  checkTime(rest.substr(0, timeEnd), column);
+
+  std::string_view offset = rest.substr(timeEnd);
+  if (offset.empty() || offset == "Z" || offset == "z") {
+    return;
+  }
+  if (offset.size() != 6 || (offset[0] != '+' && offset[0] != '-') ||
+      !allDigits(offset, 1, 2) || offset[3] != ':' || !allDigits(offset, 4, 2) ||
+      twoDigits(offset, 1) > 23 || twoDigits(offset, 4) > 59) {
+    invalid();
+  }
+}
+
+} // namespace devops
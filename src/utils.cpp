@@ -1,6 +1,7 @@
 #include "utils.h"
-#include <fstream>
-#include <iostream>
+#include "mapped_file.h"
+#include "profiler.h"
+#include "report.h"
 #include <sstream>
 #include <sys/stat.h>
 
@@ -12,13 +13,9 @@ bool Utils::fileExists(const std::string &path) {
 }
 
 std::string Utils::readFile(const std::string &path) {
-  std::ifstream file(path);
-  if (!file.is_open()) {
-    throw std::runtime_error("Failed to open file: " + path);
-  }
-  std::stringstream buffer;
-  buffer << file.rdbuf();
-  return buffer.str();
+  ProfileScope scope("read", path);
+  MappedFile file(path);
+  return std::string(file.view());
 }
 
 bool Utils::hasExtension(const std::string &path, const std::string &ext) {
@@ -41,19 +38,19 @@ std::vector<std::string> Utils::split(const std::string &str, char delimiter) {
 }
 
 void Utils::printSuccess(const std::string &message) {
-  std::cout << Color::GREEN << "✓ " << message << Color::RESET << std::endl;
+  Report::message(Report::Level::Success, message);
 }
 
 void Utils::printError(const std::string &message) {
-  std::cerr << Color::RED << "✗ " << message << Color::RESET << std::endl;
+  Report::message(Report::Level::Error, message);
 }
 
 void Utils::printWarning(const std::string &message) {
-  std::cout << Color::YELLOW << "⚠ " << message << Color::RESET << std::endl;
+  Report::message(Report::Level::Warning, message);
 }
 
 void Utils::printInfo(const std::string &message) {
-  std::cout << Color::CYAN << "ℹ " << message << Color::RESET << std::endl;
+  Report::message(Report::Level::Info, message);
 }
 
 std::string Utils::getFileExtension(const std::string &path) {
@@ -0,0 +1,294 @@
+#include "validation_cache.h"
+#include "hash.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#ifndef DEVOPS_VALIDATOR_VERSION
+#define DEVOPS_VALIDATOR_VERSION "unknown"
+#endif
+
+namespace fs = std::filesystem;
+
+namespace devops {
+
+namespace {
+
+constexpr char MAGIC[8] = {'D', 'V', 'C', 'A', 'C', 'H', 'E', '1'};
+constexpr const char *RESULTS_FILE = "results.bin";
+
+// Once the cache grows past this many entries, results not used by the
+// current run are dropped on save.
+constexpr size_t MAX_ENTRIES = 500000;
+
+// Sanity limit for lengths read from disk so a corrupt file cannot trigger
+// huge allocations.
+constexpr uint32_t MAX_FIELD = 16 * 1024 * 1024;
+
+// Bytes taken by an entry with an empty file type and no diagnostics:
+// hash, size, kind, valid flag and four length prefixes.
+constexpr size_t MIN_ENTRY_SIZE = 8 + 8 + 4 + 1 + 4 * 4;
+
+void writeU8(std::ostream &out, uint8_t value) {
+  out.put(static_cast<char>(value));
+}
+
+void writeU32(std::ostream &out, uint32_t value) {
+  char bytes[4];
+  for (int i = 0; i < 4; i++) {
+    bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+  out.write(bytes, sizeof(bytes));
+}
+
+void writeU64(std::ostream &out, uint64_t value) {
+  writeU32(out, static_cast<uint32_t>(value));
+  writeU32(out, static_cast<uint32_t>(value >> 32));
+}
+
+void writeString(std::ostream &out, const std::string &value) {
+  writeU32(out, static_cast<uint32_t>(value.size()));
+  out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+void writeDiagnostics(std::ostream &out, const Diagnostics &values) {
+  writeU32(out, static_cast<uint32_t>(values.size()));
+  for (const Diagnostic &value : values) {
+    writeU32(out, value.line);
+    writeU32(out, value.column);
+    writeU32(out, static_cast<uint32_t>(value.text.size()));
+    out.write(value.text.data(),
+              static_cast<std::streamsize>(value.text.size()));
+  }
+}
+
+// Bounds-checked cursor over the loaded cache file.
+class Reader {
+public:
+  explicit Reader(const std::string &data) : data_(data) {}
+
+  bool u8(uint8_t &value) {
+    if (pos_ + 1 > data_.size()) {
+      return false;
+    }
+    value = static_cast<uint8_t>(data_[pos_++]);
+    return true;
+  }
+
+  bool u32(uint32_t &value) {
+    if (pos_ + 4 > data_.size()) {
+      return false;
+    }
+    value = 0;
+    for (int i = 3; i >= 0; i--) {
+      value = (value << 8) | static_cast<uint8_t>(data_[pos_ + i]);
+    }
+    pos_ += 4;
+    return true;
+  }
+
+  bool u64(uint64_t &value) {
+    uint32_t low, high;
+    if (!u32(low) || !u32(high)) {
+      return false;
+    }
+    value = (static_cast<uint64_t>(high) << 32) | low;
+    return true;
+  }
+
+  bool string(std::string &value) {
+    uint32_t length;
+    if (!u32(length) || length > MAX_FIELD || pos_ + length > data_.size()) {
+      return false;
+    }
+    value.assign(data_, pos_, length);
+    pos_ += length;
+    return true;
+  }
+
+  bool diagnostics(Diagnostics &values) {
+    uint32_t count;
+    if (!u32(count) || count > MAX_FIELD) {
+      return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t line, column, length;
+      if (!u32(line) || !u32(column) || !u32(length) || length > MAX_FIELD ||
+          pos_ + length > data_.size()) {
+        return false;
+      }
+      values.add({std::string_view(data_).substr(pos_, length)}, line,
+                 column);
+      pos_ += length;
+    }
+    return true;
+  }
+
+  bool bytes(const char *expected, size_t length) {
+    if (pos_ + length > data_.size() ||
+        data_.compare(pos_, length, expected, length) != 0) {
+      return false;
+    }
+    pos_ += length;
+    return true;
+  }
+
+  size_t remaining() const { return data_.size() - pos_; }
+
+private:
+  const std::string &data_;
+  size_t pos_ = 0;
+};
+
+} // namespace
+
+ValidationCache::ValidationCache(std::string directory)
+    : directory_(std::move(directory)) {}
+
+std::string ValidationCache::resultsPath() const {
+  return (fs::path(directory_) / RESULTS_FILE).string();
+}
+
+CacheKey ValidationCache::makeKey(std::string_view content, uint32_t kind,
+                                 uint64_t salt) {
+  return CacheKey{Hash::xxh64(content, salt ^ kind), content.size(), kind};
+}
+
+void ValidationCache::load() {
+  // Anything unexpected while reading, including a failed allocation,
+  // leaves the cache empty rather than failing the run.
+  try {
+    loadEntries();
+  } catch (const std::exception &) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    entries_.clear();
+  }
+}
+
+void ValidationCache::loadEntries() {
+  std::ifstream file(resultsPath(), std::ios::binary);
+  if (!file.is_open()) {
+    return;
+  }
+
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  const std::string data = buffer.str();
+  Reader reader(data);
+
+  uint32_t revision;
+  std::string version;
+  uint64_t count;
+  if (!reader.bytes(MAGIC, sizeof(MAGIC)) || !reader.u32(revision) ||
+      !reader.string(version) || !reader.u64(count) ||
+      revision != kValidatorRevision || version != DEVOPS_VALIDATOR_VERSION) {
+    return;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  // The count comes from disk; never reserve more than the file can hold.
+  entries_.reserve(static_cast<size_t>(
+      std::min<uint64_t>(count, reader.remaining() / MIN_ENTRY_SIZE)));
+  for (uint64_t i = 0; i < count; i++) {
+    CacheKey key;
+    uint8_t valid;
+    ValidationResult result;
+    if (!reader.u64(key.hash) || !reader.u64(key.size) ||
+        !reader.u32(key.kind) || !reader.u8(valid) ||
+        !reader.string(result.fileType) ||
+        !reader.diagnostics(result.errors) ||
+        !reader.diagnostics(result.warnings) ||
+        !reader.diagnostics(result.notes)) {
+      // Truncated file: keep what was read so far.
+      break;
+    }
+    result.valid = valid != 0;
+    entries_[key].result = std::move(result);
+  }
+}
+
+bool ValidationCache::save() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  if (!dirty_) {
+    return true;
+  }
+
+  if (entries_.size() > MAX_ENTRIES) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      it = it->second.used ? std::next(it) : entries_.erase(it);
+    }
+  }
+
+  std::error_code ec;
+  fs::create_directories(directory_, ec);
+  if (ec) {
+    return false;
+  }
+
+  // Write to a temporary file and rename it into place so concurrent runs
+  // never observe a half-written cache.
+  const std::string finalPath = resultsPath();
+  const std::string tempPath = finalPath + ".tmp";
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      return false;
+    }
+
+    out.write(MAGIC, sizeof(MAGIC));
+    writeU32(out, kValidatorRevision);
+    writeString(out, DEVOPS_VALIDATOR_VERSION);
+    writeU64(out, entries_.size());
+
+    for (const auto &[key, entry] : entries_) {
+      writeU64(out, key.hash);
+      writeU64(out, key.size);
+      writeU32(out, key.kind);
+      writeU8(out, entry.result.valid ? 1 : 0);
+      writeString(out, entry.result.fileType);
+      writeDiagnostics(out, entry.result.errors);
+      writeDiagnostics(out, entry.result.warnings);
+      writeDiagnostics(out, entry.result.notes);
+    }
+
+    if (!out.good()) {
+      return false;
+    }
+  }
+
+  fs::rename(tempPath, finalPath, ec);
+  if (ec) {
+    fs::remove(tempPath, ec);
+    return false;
+  }
+
+  dirty_ = false;
+  return true;
+}
+
+bool ValidationCache::lookup(const CacheKey &key, ValidationResult &result) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    misses_++;
+    return false;
+  }
+
+  it->second.used = true;
+  result = it->second.result;
+  hits_++;
+  return true;
+}
+
+void ValidationCache::store(const CacheKey &key,
+                            const ValidationResult &result) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Entry &entry = entries_[key];
+  entry.result = result;
+  entry.used = true;
+  dirty_ = true;
+}
+
+} // namespace devops
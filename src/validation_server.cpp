@@ -0,0 +1,424 @@
+#include "validation_server.h"
+#include "validation_cache.h"
+#include "work_stealing_pool.h"
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace devops {
+
+namespace {
+
+// A request line longer than this closes the connection.
+constexpr size_t MAX_REQUEST = 16 * 1024 * 1024;
+
+// How often blocked loops wake up to notice a shutdown request.
+constexpr int POLL_INTERVAL_MS = 200;
+
+constexpr auto CACHE_SAVE_INTERVAL = std::chrono::seconds(30);
+
+json resultToJson(const std::string &path, const ValidationResult &result) {
+  return {{"path", path},
+          {"valid", result.valid},
+          {"fileType", result.fileType},
+          {"errors", result.errors.strings()},
+          {"warnings", result.warnings.strings()},
+          {"notes", result.notes.strings()}};
+}
+
+// Messages arrive rendered, positions included.
+void diagnosticsFromJson(const json &value, const char *key,
+                         Diagnostics &out) {
+  auto it = value.find(key);
+  if (it == value.end() || !it->is_array()) {
+    return;
+  }
+  for (const json &message : *it) {
+    if (message.is_string()) {
+      out.push_back(message.get_ref<const std::string &>());
+    }
+  }
+}
+
+ValidationResult resultFromJson(const json &value) {
+  ValidationResult result;
+  result.valid = value.value("valid", false);
+  result.fileType = value.value("fileType", "");
+  diagnosticsFromJson(value, "errors", result.errors);
+  diagnosticsFromJson(value, "warnings", result.warnings);
+  diagnosticsFromJson(value, "notes", result.notes);
+  return result;
+}
+
+#ifndef _WIN32
+
+volatile std::sig_atomic_t signalled = 0;
+
+void onSignal(int) { signalled = 1; }
+
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+bool fillAddress(const std::string &path, sockaddr_un &address) {
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+int connectTo(const std::string &path, std::string &error) {
+  sockaddr_un address;
+  if (!fillAddress(path, address)) {
+    error = "socket path is empty or too long: " + path;
+    return -1;
+  }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    error = std::string("socket: ") + std::strerror(errno);
+    return -1;
+  }
+  if (::connect(fd, reinterpret_cast<sockaddr *>(&address),
+                sizeof(address)) != 0) {
+    error = "cannot connect to " + path + ": " + std::strerror(errno);
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool sendAll(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, SEND_FLAGS);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    sent += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Reads one '\n'-terminated line into `line`, keeping any bytes after it in
+// `buffer`. With `stop` set, gives up when it becomes true.
+bool readLine(int fd, std::string &buffer, std::string &line,
+              const std::atomic<bool> *stop) {
+  while (true) {
+    size_t newline = buffer.find('\n');
+    if (newline != std::string::npos) {
+      line.assign(buffer, 0, newline);
+      buffer.erase(0, newline + 1);
+      return true;
+    }
+    if (buffer.size() > MAX_REQUEST) {
+      return false;
+    }
+
+    if (stop) {
+      pollfd pfd{fd, POLLIN, 0};
+      int ready = ::poll(&pfd, 1, POLL_INTERVAL_MS);
+      if (ready == 0 || (ready < 0 && errno == EINTR)) {
+        if (*stop || signalled) {
+          return false;
+        }
+        continue;
+      }
+      if (ready < 0) {
+        return false;
+      }
+    }
+
+    char chunk[64 * 1024];
+    ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    buffer.append(chunk, static_cast<size_t>(n));
+  }
+}
+
+// Sends one request and reads its response.
+bool roundTrip(const std::string &socketPath, const json &request,
+               json &response, std::string &error) {
+  int fd = connectTo(socketPath, error);
+  if (fd < 0) {
+    return false;
+  }
+  std::string buffer, line;
+  bool ok = sendAll(fd, request.dump() + "\n") &&
+            readLine(fd, buffer, line, nullptr);
+  ::close(fd);
+  if (!ok) {
+    error = "connection to " + socketPath + " closed unexpectedly";
+    return false;
+  }
+  try {
+    response = json::parse(line);
+  } catch (const json::exception &e) {
+    error = std::string("malformed response: ") + e.what();
+    return false;
+  }
+  if (response.contains("error")) {
+    error = response["error"].get<std::string>();
+    return false;
+  }
+  return true;
+}
+
+#endif
+
+} // namespace
+
+ValidationServer::ValidationServer(ConfigValidator &validator,
+                                   std::shared_ptr<ValidationCache> cache,
+                                   std::string socketPath, unsigned jobs)
+    : validator_(validator), cache_(std::move(cache)),
+      socketPath_(std::move(socketPath)) {
+  if (jobs == 0) {
+    jobs = WorkStealingPool::defaultThreadCount();
+  }
+  if (jobs > 1) {
+    pool_ = std::make_unique<WorkStealingPool>(jobs);
+  }
+}
+
+ValidationServer::~ValidationServer() = default;
+
+#ifdef _WIN32
+
+void ValidationServer::run() {
+  throw std::runtime_error("serve is not supported on Windows");
+}
+
+void ValidationServer::serveConnection(int) {}
+
+bool ValidationClient::validate(const std::string &,
+                                const std::vector<std::string> &,
+                                std::vector<FileResult> &,
+                                std::string &error) {
+  error = "--server is not supported on Windows";
+  return false;
+}
+
+bool ValidationClient::shutdown(const std::string &, std::string &error) {
+  error = "--server is not supported on Windows";
+  return false;
+}
+
+#else
+
+void ValidationServer::run() {
+  sockaddr_un address;
+  if (!fillAddress(socketPath_, address)) {
+    throw std::runtime_error("socket path is empty or too long: " +
+                             socketPath_);
+  }
+
+  // A socket file nobody answers on is left over from a crashed server.
+  std::string ignored;
+  int existing = connectTo(socketPath_, ignored);
+  if (existing >= 0) {
+    ::close(existing);
+    throw std::runtime_error("a server is already listening on " +
+                             socketPath_);
+  }
+  ::unlink(socketPath_.c_str());
+
+  int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0) {
+    throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+  }
+  // Only the owner may connect: requests name arbitrary files to read.
+  mode_t oldMask = ::umask(0077);
+  int bound = ::bind(listenFd, reinterpret_cast<sockaddr *>(&address),
+                     sizeof(address));
+  ::umask(oldMask);
+  if (bound != 0 || ::listen(listenFd, 64) != 0) {
+    std::string reason = std::strerror(errno);
+    ::close(listenFd);
+    throw std::runtime_error("cannot listen on " + socketPath_ + ": " +
+                             reason);
+  }
+
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = onSignal;
+  ::sigemptyset(&action.sa_mask);
+  ::sigaction(SIGINT, &action, nullptr);
+  ::sigaction(SIGTERM, &action, nullptr);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  auto lastSave = std::chrono::steady_clock::now();
+  while (!stopping_ && !signalled) {
+    pollfd pfd{listenFd, POLLIN, 0};
+    int ready = ::poll(&pfd, 1, POLL_INTERVAL_MS);
+
+    if (cache_ && std::chrono::steady_clock::now() - lastSave >=
+                      CACHE_SAVE_INTERVAL) {
+      cache_->save();
+      lastSave = std::chrono::steady_clock::now();
+    }
+    if (ready <= 0) {
+      continue;
+    }
+
+    int fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(connectionsMutex_);
+      connections_++;
+    }
+    std::thread([this, fd] {
+      serveConnection(fd);
+      ::close(fd);
+      std::lock_guard<std::mutex> lock(connectionsMutex_);
+      if (--connections_ == 0) {
+        connectionsDone_.notify_all();
+      }
+    }).detach();
+  }
+
+  ::close(listenFd);
+  ::unlink(socketPath_.c_str());
+
+  // Connection threads notice the stop flag within one poll interval.
+  stopping_ = true;
+  std::unique_lock<std::mutex> lock(connectionsMutex_);
+  connectionsDone_.wait(lock, [this] { return connections_ == 0; });
+  lock.unlock();
+
+  if (cache_) {
+    cache_->save();
+  }
+}
+
+void ValidationServer::serveConnection(int fd) {
+  std::string buffer, line;
+  while (readLine(fd, buffer, line, &stopping_)) {
+    if (!sendAll(fd, handleRequest(line) + "\n")) {
+      return;
+    }
+  }
+}
+
+bool ValidationClient::validate(const std::string &socketPath,
+                                const std::vector<std::string> &paths,
+                                std::vector<FileResult> &results,
+                                std::string &error) {
+  json response;
+  if (!roundTrip(socketPath, {{"paths", paths}}, response, error)) {
+    return false;
+  }
+  results.clear();
+  for (const json &item : response.value("results", json::array())) {
+    results.emplace_back(item.value("path", ""), resultFromJson(item));
+  }
+  return true;
+}
+
+bool ValidationClient::shutdown(const std::string &socketPath,
+                                std::string &error) {
+  json response;
+  return roundTrip(socketPath, {{"command", "shutdown"}}, response, error);
+}
+
+#endif
+
+std::string ValidationServer::handleRequest(const std::string &line) {
+  json request;
+  try {
+    request = json::parse(line);
+  } catch (const json::exception &e) {
+    return json{{"error", std::string("malformed request: ") + e.what()}}
+        .dump();
+  }
+
+  if (!request.is_object()) {
+    return json{{"error", "request must be a JSON object"}}.dump();
+  }
+  if (request.value("command", "") == "shutdown") {
+    stopping_ = true;
+    return json{{"ok", true}}.dump();
+  }
+
+  auto paths = request.find("paths");
+  if (paths == request.end() || !paths->is_array()) {
+    return json{{"error", "request needs a \"paths\" array"}}.dump();
+  }
+  std::vector<std::string> files;
+  for (const json &path : *paths) {
+    if (!path.is_string()) {
+      return json{{"error", "paths must be strings"}}.dump();
+    }
+    files.push_back(path.get<std::string>());
+  }
+
+  std::vector<ValidationResult> results = validatePaths(files);
+  json out = json::array();
+  for (size_t i = 0; i < files.size(); i++) {
+    out.push_back(resultToJson(files[i], results[i]));
+  }
+  // Messages quote file content, which need not be valid UTF-8.
+  return json{{"results", std::move(out)}}.dump(
+      -1, ' ', false, json::error_handler_t::replace);
+}
+
+std::vector<ValidationResult>
+ValidationServer::validatePaths(const std::vector<std::string> &paths) {
+  std::vector<ValidationResult> results(paths.size());
+
+  // A single file is checked on the connection thread: handing it to the
+  // pool would only add a context switch to the latency.
+  if (!pool_ || paths.size() == 1) {
+    for (size_t i = 0; i < paths.size(); i++) {
+      results[i] = validator_.check(paths[i]);
+    }
+    return results;
+  }
+
+  std::mutex mutex;
+  std::condition_variable done;
+  size_t remaining = paths.size();
+  for (size_t i = 0; i < paths.size(); i++) {
+    pool_->submit([&, i] {
+      ValidationResult result = validator_.check(paths[i]);
+      std::lock_guard<std::mutex> lock(mutex);
+      results[i] = std::move(result);
+      if (--remaining == 0) {
+        done.notify_all();
+      }
+    });
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&] { return remaining == 0; });
+  return results;
+}
+
+} // namespace devops
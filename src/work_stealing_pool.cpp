@@ -0,0 +1,129 @@
+#include "work_stealing_pool.h"
+
+namespace devops {
+
+namespace {
+// Identifies the pool and deque owned by the current thread so that tasks
+// spawned from a worker are pushed onto its own deque.
+thread_local const WorkStealingPool *currentPool = nullptr;
+thread_local unsigned currentWorker = 0;
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+  if (threads == 0) {
+    threads = 1;
+  }
+
+  workers_.reserve(threads);
+  for (unsigned i = 0; i < threads; i++) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+
+  threads_.reserve(threads);
+  for (unsigned i = 0; i < threads; i++) {
+    threads_.emplace_back([this, i] { run(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  workAvailable_.notify_all();
+
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::submit(Task task) {
+  unsigned target;
+  if (currentPool == this) {
+    target = currentWorker;
+  } else {
+    target = nextWorker_.fetch_add(1, std::memory_order_relaxed) %
+             static_cast<unsigned>(workers_.size());
+  }
+
+  // Count the task before it becomes visible so a worker can never pop it
+  // and decrement the counters first.
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_++;
+    pending_++;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+    workers_[target]->tasks.push_back(std::move(task));
+  }
+
+  workAvailable_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  allDone_.wait(lock, [this] { return pending_ == 0; });
+}
+
+unsigned WorkStealingPool::defaultThreadCount() {
+  unsigned count = std::thread::hardware_concurrency();
+  return count == 0 ? 1 : count;
+}
+
+bool WorkStealingPool::popLocal(unsigned index, Task &task) {
+  Worker &worker = *workers_[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks.front());
+  worker.tasks.pop_front();
+  return true;
+}
+
+bool WorkStealingPool::steal(unsigned thief, Task &task) {
+  const unsigned count = static_cast<unsigned>(workers_.size());
+  for (unsigned offset = 1; offset < count; offset++) {
+    Worker &victim = *workers_[(thief + offset) % count];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::run(unsigned index) {
+  currentPool = this;
+  currentWorker = index;
+
+  for (;;) {
+    Task task;
+    if (popLocal(index, task) || steal(index, task)) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_--;
+      }
+
+      task();
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_ == 0) {
+        allDone_.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    workAvailable_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+    if (stopping_ && queued_ == 0) {
+      return;
+    }
+  }
+}
+
+} // namespace devops
@@ -0,0 +1,405 @@
+#include "yaml_stream.h"
+#include <cerrno>
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+#include <unordered_map>
+#include <yaml-cpp/eventhandler.h>
+#include <yaml-cpp/exceptions.h>
+#include <yaml-cpp/parser.h>
+
+namespace devops {
+
+namespace {
+
+using Root = YamlDocumentFacts::Root;
+
+class FactsHandler : public YAML::EventHandler {
+public:
+  explicit FactsHandler(YamlDocumentFacts &facts) : facts_(facts) {}
+
+  void OnDocumentStart(const YAML::Mark &mark) override {
+    facts_.line = static_cast<size_t>(mark.line) + 1;
+    start_ = mark;
+  }
+
+  // Where the document started; null when the parser reported no start.
+  const YAML::Mark &start() const { return start_; }
+
+  void OnDocumentEnd() override {}
+
+  void OnNull(const YAML::Mark &, YAML::anchor_t) override {
+    node(Root::Null, nullptr);
+  }
+
+  void OnAlias(const YAML::Mark &, YAML::anchor_t) override {
+    node(Root::Scalar, nullptr);
+  }
+
+  void OnScalar(const YAML::Mark &, const std::string &, YAML::anchor_t,
+                const std::string &value) override {
+    node(Root::Scalar, &value);
+  }
+
+  void OnSequenceStart(const YAML::Mark &, const std::string &, YAML::anchor_t,
+                       YAML::EmitterStyle::value) override {
+    node(Root::Sequence, nullptr);
+    frames_.push_back({false, true, 0, false});
+  }
+
+  void OnSequenceEnd() override { frames_.pop_back(); }
+
+  void OnMapStart(const YAML::Mark &, const std::string &, YAML::anchor_t,
+                  YAML::EmitterStyle::value) override {
+    const bool firstItem =
+        frames_.size() == 1 && !frames_[0].map && frames_[0].items == 0;
+    node(Root::Map, nullptr);
+    frames_.push_back({true, true, 0, firstItem});
+  }
+
+  void OnMapEnd() override { frames_.pop_back(); }
+
+private:
+  YAML::Mark start_ = YAML::Mark::null_mark();
+
+  struct Frame {
+    bool map;
+    bool atKey; // maps alternate key and value nodes
+    size_t items;
+    bool firstItemOfRoot;
+  };
+
+  // Called for every node as it starts, before any frame it opens.
+  void node(Root kind, const std::string *scalar) {
+    if (frames_.empty()) {
+      facts_.root = kind;
+      return;
+    }
+
+    Frame &frame = frames_.back();
+    if (!frame.map) {
+      frame.items++;
+      return;
+    }
+    if (frame.atKey && scalar != nullptr) {
+      if (frames_.size() == 1) {
+        facts_.hasServices |= *scalar == "services";
+        facts_.hasVersion |= *scalar == "version";
+        facts_.hasApiVersion |= *scalar == "apiVersion";
+        facts_.hasKind |= *scalar == "kind";
+      } else if (frames_.size() == 2 && frame.firstItemOfRoot) {
+        facts_.hasHostsInFirstItem |= *scalar == "hosts";
+      }
+    }
+    frame.atKey = !frame.atKey;
+  }
+
+  YamlDocumentFacts &facts_;
+  std::vector<Frame> frames_;
+};
+
+bool isPlainInteger(const std::string &s) {
+  size_t i = (s[0] == '-' || s[0] == '+') ? 1 : 0;
+  if (i == s.size()) {
+    return false;
+  }
+  for (; i < s.size(); i++) {
+    if (s[i] < '0' || s[i] > '9') {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool isPlainFloat(const std::string &s) {
+  size_t i = (s[0] == '-' || s[0] == '+') ? 1 : 0;
+  size_t digits = 0;
+  while (i < s.size() && s[i] >= '0' && s[i] <= '9') {
+    i++;
+    digits++;
+  }
+  if (i < s.size() && s[i] == '.') {
+    i++;
+    while (i < s.size() && s[i] >= '0' && s[i] <= '9') {
+      i++;
+      digits++;
+    }
+  }
+  if (digits == 0) {
+    return false;
+  }
+  if (i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+    i++;
+    if (i < s.size() && (s[i] == '-' || s[i] == '+')) {
+      i++;
+    }
+    size_t exponent = 0;
+    while (i < s.size() && s[i] >= '0' && s[i] <= '9') {
+      i++;
+      exponent++;
+    }
+    if (exponent == 0) {
+      return false;
+    }
+  }
+  return i == s.size();
+}
+
+// Resolves a scalar per the YAML 1.2 core schema. Quoted scalars (tag "!")
+// and explicit !!str are always strings.
+nlohmann::json resolveScalar(const std::string &tag, const std::string &value) {
+  if (tag == "!" || tag == "tag:yaml.org,2002:str") {
+    return value;
+  }
+  if (tag != "?" && tag != "tag:yaml.org,2002:int" &&
+      tag != "tag:yaml.org,2002:float" && tag != "tag:yaml.org,2002:bool" &&
+      tag != "tag:yaml.org,2002:null") {
+    return value;
+  }
+  if (value.empty() || value == "~" || value == "null" || value == "Null" ||
+      value == "NULL") {
+    return nullptr;
+  }
+  if (value == "true" || value == "True" || value == "TRUE") {
+    return true;
+  }
+  if (value == "false" || value == "False" || value == "FALSE") {
+    return false;
+  }
+  if (isPlainInteger(value)) {
+    errno = 0;
+    char *end = nullptr;
+    long long number = std::strtoll(value.c_str(), &end, 10);
+    if (errno == 0) {
+      return number;
+    }
+    return std::strtod(value.c_str(), nullptr);
+  }
+  if (value.size() > 2 && value[0] == '0' &&
+      (value[1] == 'x' || value[1] == 'o')) {
+    char *end = nullptr;
+    long long number =
+        std::strtoll(value.c_str() + 2, &end, value[1] == 'x' ? 16 : 8);
+    if (*end == '\0') {
+      return number;
+    }
+  }
+  if (isPlainFloat(value)) {
+    return std::strtod(value.c_str(), nullptr);
+  }
+  return value;
+}
+
+// Builds the JSON value of one document from parser events.
+class JsonBuilder : public YAML::EventHandler {
+public:
+  explicit JsonBuilder(nlohmann::json &document) : document_(document) {}
+
+  void OnDocumentStart(const YAML::Mark &) override {}
+  void OnDocumentEnd() override {}
+
+  // Nodes that aliases may copy into one document. Each alias is a deep
+  // copy, so nested aliases ("billion laughs") grow exponentially.
+  static constexpr size_t MAX_ALIAS_NODES = 1000000;
+
+  void OnNull(const YAML::Mark &, YAML::anchor_t anchor) override {
+    add(nullptr, anchor, nullptr, 1);
+  }
+
+  void OnAlias(const YAML::Mark &mark, YAML::anchor_t anchor) override {
+    auto it = anchors_.find(anchor);
+    if (it == anchors_.end()) {
+      add(nlohmann::json(), 0, nullptr, 1);
+      return;
+    }
+    aliasNodes_ += it->second.nodes;
+    if (aliasNodes_ > MAX_ALIAS_NODES) {
+      throw YAML::ParserException(
+          mark, "aliases expand to more than " +
+                    std::to_string(MAX_ALIAS_NODES) + " nodes");
+    }
+    add(it->second.value, 0, nullptr, it->second.nodes);
+  }
+
+  void OnScalar(const YAML::Mark &, const std::string &tag,
+                YAML::anchor_t anchor, const std::string &value) override {
+    add(resolveScalar(tag, value), anchor, &value, 1);
+  }
+
+  void OnSequenceStart(const YAML::Mark &, const std::string &,
+                       YAML::anchor_t anchor,
+                       YAML::EmitterStyle::value) override {
+    frames_.push_back({nlohmann::json::array(), anchor, false, {}, 1});
+  }
+
+  void OnSequenceEnd() override { close(); }
+
+  void OnMapStart(const YAML::Mark &, const std::string &,
+                  YAML::anchor_t anchor, YAML::EmitterStyle::value) override {
+    frames_.push_back({nlohmann::json::object(), anchor, false, {}, 1});
+  }
+
+  void OnMapEnd() override { close(); }
+
+private:
+  struct Frame {
+    nlohmann::json value;
+    YAML::anchor_t anchor;
+    bool haveKey;
+    std::string key;
+    size_t nodes; // in `value`, counting itself
+  };
+
+  struct Anchored {
+    nlohmann::json value;
+    size_t nodes;
+  };
+
+  void close() {
+    Frame frame = std::move(frames_.back());
+    frames_.pop_back();
+    add(std::move(frame.value), frame.anchor, nullptr, frame.nodes);
+  }
+
+  // `text` is the scalar as written, used for mapping keys. `nodes` is the
+  // size of `value`.
+  void add(nlohmann::json value, YAML::anchor_t anchor,
+           const std::string *text, size_t nodes) {
+    if (anchor != 0) {
+      anchors_[anchor] = {value, nodes};
+    }
+    if (frames_.empty()) {
+      document_ = std::move(value);
+      return;
+    }
+
+    Frame &top = frames_.back();
+    top.nodes += nodes;
+    if (top.value.is_array()) {
+      top.value.push_back(std::move(value));
+    } else if (!top.haveKey) {
+      top.key = text ? *text : value.dump();
+      top.haveKey = true;
+    } else {
+      top.haveKey = false;
+      if (top.key == "<<") {
+        merge(top.value, value);
+      } else {
+        top.value[top.key] = std::move(value);
+      }
+    }
+  }
+
+  // `<<: *base` copies keys the mapping does not already define.
+  static void merge(nlohmann::json &target, const nlohmann::json &source) {
+    if (source.is_array()) {
+      for (const auto &item : source) {
+        merge(target, item);
+      }
+    } else if (source.is_object()) {
+      for (const auto &[key, value] : source.items()) {
+        if (!target.contains(key)) {
+          target[key] = value;
+        }
+      }
+    }
+  }
+
+  nlohmann::json &document_;
+  std::vector<Frame> frames_;
+  std::unordered_map<YAML::anchor_t, Anchored> anchors_;
+  size_t aliasNodes_ = 0;
+};
+
+// Forwards every event to two handlers.
+class TeeHandler : public YAML::EventHandler {
+public:
+  TeeHandler(YAML::EventHandler &first, YAML::EventHandler &second)
+      : first_(first), second_(second) {}
+
+  void OnDocumentStart(const YAML::Mark &mark) override {
+    first_.OnDocumentStart(mark);
+    second_.OnDocumentStart(mark);
+  }
+  void OnDocumentEnd() override {
+    first_.OnDocumentEnd();
+    second_.OnDocumentEnd();
+  }
+  void OnNull(const YAML::Mark &mark, YAML::anchor_t anchor) override {
+    first_.OnNull(mark, anchor);
+    second_.OnNull(mark, anchor);
+  }
+  void OnAlias(const YAML::Mark &mark, YAML::anchor_t anchor) override {
+    first_.OnAlias(mark, anchor);
+    second_.OnAlias(mark, anchor);
+  }
+  void OnScalar(const YAML::Mark &mark, const std::string &tag,
+                YAML::anchor_t anchor, const std::string &value) override {
+    first_.OnScalar(mark, tag, anchor, value);
+    second_.OnScalar(mark, tag, anchor, value);
+  }
+  void OnSequenceStart(const YAML::Mark &mark, const std::string &tag,
+                       YAML::anchor_t anchor,
+                       YAML::EmitterStyle::value style) override {
+    first_.OnSequenceStart(mark, tag, anchor, style);
+    second_.OnSequenceStart(mark, tag, anchor, style);
+  }
+  void OnSequenceEnd() override {
+    first_.OnSequenceEnd();
+    second_.OnSequenceEnd();
+  }
+  void OnMapStart(const YAML::Mark &mark, const std::string &tag,
+                  YAML::anchor_t anchor,
+                  YAML::EmitterStyle::value style) override {
+    first_.OnMapStart(mark, tag, anchor, style);
+    second_.OnMapStart(mark, tag, anchor, style);
+  }
+  void OnMapEnd() override {
+    first_.OnMapEnd();
+    second_.OnMapEnd();
+  }
+
+private:
+  YAML::EventHandler &first_;
+  YAML::EventHandler &second_;
+};
+
+} // namespace
+
+YamlStreamResult YamlStreamScanner::scan(std::istream &input,
+                                         const DocumentCallback &onDocument) {
+  YamlStreamResult result;
+  try {
+    YAML::Parser parser(input);
+    int previous = -1; // where the last document started
+    while (true) {
+      YamlDocumentFacts facts;
+      FactsHandler factsHandler(facts);
+      nlohmann::json document;
+      JsonBuilder builder(document);
+      TeeHandler tee(factsHandler, builder);
+      if (!parser.HandleNextDocument(
+              onDocument ? static_cast<YAML::EventHandler &>(tee)
+                         : factsHandler)) {
+        break;
+      }
+      // Some inputs (a lone ",") make yaml-cpp report the same empty
+      // document forever without consuming anything.
+      const YAML::Mark &start = factsHandler.start();
+      if (start.is_null() || start.pos <= previous) {
+        const YAML::Mark at = start.is_null() ? YAML::Mark() : start;
+        throw YAML::ParserException(at, "parser made no progress");
+      }
+      previous = start.pos;
+      result.documents.push_back(facts);
+      if (onDocument) {
+        onDocument(result.documents.size() - 1, document);
+      }
+    }
+  } catch (const YAML::Exception &e) {
+    result.valid = false;
+    result.error = e.what();
+  }
+  return result;
+}
+
+} // namespace devops
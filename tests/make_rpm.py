@@ -0,0 +1,66 @@
+"""Writes a small binary RPM for the analyze tests, plus a copy cut off in
+the middle of its main header. The payload is deliberately not a cpio
+archive: the header reader must never look at it.
+
+usage: make_rpm.py <output.rpm> <truncated.rpm>
+"""
+
+import struct
+import sys
+
+INT32, STRING, STRING_ARRAY, I18NSTRING = 4, 6, 8, 9
+LESS, GREATER, EQUAL = 0x02, 0x04, 0x08
+
+
+def header(entries):
+    """entries: (tag, type, value) with lists for arrays."""
+    index, store = b"", b""
+    for tag, kind, value in entries:
+        if kind == INT32:
+            store += b"\0" * (-len(store) % 4)
+            values = value if isinstance(value, list) else [value]
+            data = b"".join(struct.pack(">I", v) for v in values)
+        elif kind == STRING:
+            values = [value]
+            data = value.encode() + b"\0"
+        else:
+            values = value
+            data = b"".join(v.encode() + b"\0" for v in values)
+        index += struct.pack(">IIII", tag, kind, len(store), len(values))
+        store += data
+    intro = b"\x8e\xad\xe8\x01" + b"\0" * 4
+    return intro + struct.pack(">II", len(entries), len(store)) + index + store
+
+
+lead = (b"\xed\xab\xee\xdb" + struct.pack(">BBHH", 3, 0, 0, 1) +
+        b"hello-2.10-3".ljust(66, b"\0") + struct.pack(">HH", 1, 5) +
+        b"\0" * 16)
+payload = b"not a cpio payload\n" * 64
+signature = header([(1000, INT32, len(payload))])
+signature += b"\0" * (-len(signature) % 8)
+main = header([
+    (1000, STRING, "hello"),
+    (1001, STRING, "2.10"),
+    (1002, STRING, "3.el9"),
+    (1004, I18NSTRING, ["Prints a friendly greeting"]),
+    (1009, INT32, 1320960),
+    (1014, STRING, "GPL-3.0-or-later"),
+    (1022, STRING, "x86_64"),
+    (1047, STRING_ARRAY, ["hello", "hello(x86-64)"]),
+    (1048, INT32, [GREATER | EQUAL, 0]),
+    (1049, STRING_ARRAY, ["glibc", "/bin/sh"]),
+    (1050, STRING_ARRAY, ["2.34", ""]),
+    (1112, INT32, [EQUAL, EQUAL]),
+    (1113, STRING_ARRAY, ["2.10-3.el9", "2.10-3.el9"]),
+    (1116, INT32, [0, 1, 1]),
+    (1117, STRING_ARRAY, ["hello", "README", "NEWS"]),
+    (1118, STRING_ARRAY, ["/usr/bin/", "/usr/share/doc/hello/"]),
+    (1124, STRING, "cpio"),
+    (1125, STRING, "zstd"),
+])
+
+package = lead + signature + main + payload
+with open(sys.argv[1], "wb") as out:
+    out.write(package)
+with open(sys.argv[2], "wb") as out:
+    out.write(package[:len(lead) + len(signature) + 40])